@@ -109,3 +109,26 @@ void osal_free(void *ptr)
    	free(ptr);
 }
 
+
+/* Mutex is not needed when running single threaded, a NULL mutex
+ * disables locking in the stack */
+
+osal_mutex_t *osal_mtx_create(void)
+{
+   return NULL;
+}
+
+void osal_mtx_destroy(osal_mutex_t *mtx)
+{
+   (void)mtx;
+}
+
+void osal_mtx_lock(osal_mutex_t *mtx)
+{
+   (void)mtx;
+}
+
+void osal_mtx_unlock(osal_mutex_t *mtx)
+{
+   (void)mtx;
+}
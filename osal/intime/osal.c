@@ -86,3 +86,8 @@ osal_mutex_t * osal_mtx_create(void)
         /* return (void*)RtCreateMutex(NULL, FALSE, NULL); */
         return (void *)0;
 }
+
+void osal_mtx_destroy(osal_mutex_t * mtx)
+{
+        /* RtDeleteMutex((HANDLE)mtx); */
+}
@@ -20,6 +20,16 @@ extern "C"
 #define EC_PRINT(...) do {} while (0)
 #endif
 
+// USDT tracepoints of provider soem, defined by the build if sys/sdt.h exists
+#ifdef EC_USDT
+#include <sys/sdt.h>
+#define OSAL_TRACE1(name, a)             DTRACE_PROBE1(soem, name, a)
+#define OSAL_TRACE2(name, a, b)          DTRACE_PROBE2(soem, name, a, b)
+#define OSAL_TRACE3(name, a, b, c)       DTRACE_PROBE3(soem, name, a, b, c)
+#define OSAL_TRACE4(name, a, b, c, d)    DTRACE_PROBE4(soem, name, a, b, c, d)
+#define OSAL_TRACE5(name, a, b, c, d, e) DTRACE_PROBE5(soem, name, a, b, c, d, e)
+#endif
+
 #ifndef PACKED
 #define PACKED_BEGIN
 #define PACKED  __attribute__((__packed__))
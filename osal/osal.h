@@ -14,6 +14,37 @@ extern "C"
 #include "osal_defs.h"
 #include <stdint.h>
 
+/* Full memory barrier for data shared lock-free between threads,
+ * a port can define its own in osal_defs.h */
+#ifndef OSAL_MEMORY_BARRIER
+#ifdef _MSC_VER
+#define OSAL_MEMORY_BARRIER() MemoryBarrier()
+#else
+#define OSAL_MEMORY_BARRIER() __sync_synchronize()
+#endif
+#endif
+
+/* Atomic compare and swap of a 32 bit value, TRUE if *ptr was old and is now
+ * new, a port can define its own in osal_defs.h */
+#ifndef OSAL_CAS32
+#ifdef _MSC_VER
+#define OSAL_CAS32(ptr, old, new) \
+   (InterlockedCompareExchange((volatile LONG *)(ptr), (LONG)(new), (LONG)(old)) == (LONG)(old))
+#else
+#define OSAL_CAS32(ptr, old, new) __sync_bool_compare_and_swap((ptr), (old), (new))
+#endif
+#endif
+
+/* Static tracepoints, f.e. USDT probes, a no-op unless the port defines them
+ * in osal_defs.h. Arguments are only evaluated when the port defines them. */
+#ifndef OSAL_TRACE1
+#define OSAL_TRACE1(name, a)             do {} while (0)
+#define OSAL_TRACE2(name, a, b)          do {} while (0)
+#define OSAL_TRACE3(name, a, b, c)       do {} while (0)
+#define OSAL_TRACE4(name, a, b, c, d)    do {} while (0)
+#define OSAL_TRACE5(name, a, b, c, d, e) do {} while (0)
+#endif
+
 /* General types */
 typedef uint8_t             boolean;
 #define TRUE                1
@@ -40,6 +71,9 @@ typedef struct osal_timer
     ec_timet stop_time;
 } osal_timert;
 
+/** Opaque recursive mutex, implementation is OS specific */
+typedef struct osal_mutex osal_mutex_t;
+
 void osal_timer_start(osal_timert * self, uint32 timeout_us);
 boolean osal_timer_is_expired(osal_timert * self);
 int osal_usleep(uint32 usec);
@@ -47,6 +81,11 @@ ec_timet osal_current_time(void);
 void osal_time_diff(ec_timet *start, ec_timet *end, ec_timet *diff);
 int osal_thread_create(void *thandle, int stacksize, void *func, void *param);
 int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param);
+int osal_thread_join(void *thandle);
+osal_mutex_t *osal_mtx_create(void);
+void osal_mtx_destroy(osal_mutex_t *mtx);
+void osal_mtx_lock(osal_mutex_t *mtx);
+void osal_mtx_unlock(osal_mutex_t *mtx);
 
 #ifdef __cplusplus
 }
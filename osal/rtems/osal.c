@@ -142,3 +142,53 @@ int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param)
 
    return 1;
 }
+
+int osal_thread_join(void *thandle)
+{
+   pthread_t *threadp = thandle;
+
+   return (pthread_join(*threadp, NULL) == 0);
+}
+
+struct osal_mutex
+{
+   pthread_mutex_t mtx;
+};
+
+osal_mutex_t *osal_mtx_create(void)
+{
+   osal_mutex_t         *mtx;
+   pthread_mutexattr_t  attr;
+
+   mtx = malloc(sizeof(osal_mutex_t));
+   if(mtx == NULL)
+   {
+      return NULL;
+   }
+   pthread_mutexattr_init(&attr);
+   /* recursive so nested mailbox calls on the same slave do not deadlock */
+   pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+   if(pthread_mutex_init(&mtx->mtx, &attr) != 0)
+   {
+      free(mtx);
+      mtx = NULL;
+   }
+   pthread_mutexattr_destroy(&attr);
+   return mtx;
+}
+
+void osal_mtx_destroy(osal_mutex_t *mtx)
+{
+   pthread_mutex_destroy(&mtx->mtx);
+   free(mtx);
+}
+
+void osal_mtx_lock(osal_mutex_t *mtx)
+{
+   pthread_mutex_lock(&mtx->mtx);
+}
+
+void osal_mtx_unlock(osal_mutex_t *mtx)
+{
+   pthread_mutex_unlock(&mtx->mtx);
+}
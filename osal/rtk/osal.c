@@ -143,3 +143,30 @@ int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param)
    }
    return 1;
 }
+
+int osal_thread_join(void *thandle)
+{
+   /* tasks can not be joined, callers wait on their own completion flag */
+   (void)thandle;
+   return 1;
+}
+
+osal_mutex_t *osal_mtx_create(void)
+{
+   return (osal_mutex_t *)mtx_create();
+}
+
+void osal_mtx_destroy(osal_mutex_t *mtx)
+{
+   mtx_destroy((mtx_t *)mtx);
+}
+
+void osal_mtx_lock(osal_mutex_t *mtx)
+{
+   mtx_lock((mtx_t *)mtx);
+}
+
+void osal_mtx_unlock(osal_mutex_t *mtx)
+{
+   mtx_unlock((mtx_t *)mtx);
+}
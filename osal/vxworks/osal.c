@@ -12,6 +12,7 @@
 #include <osal.h>
 #include <vxWorks.h>
 #include <taskLib.h>
+#include <semLib.h>
 
 
 #define  timercmp(a, b, CMP)                                \
@@ -181,3 +182,36 @@ int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param)
    return 1;
 }
 
+int osal_thread_join(void *thandle)
+{
+   TASK_ID * tid = (TASK_ID *)thandle;
+
+   /* wait until the task has exited and is deleted */
+   while (taskIdVerify(*tid) == OK)
+   {
+      taskDelay(1);
+   }
+   return 1;
+}
+
+
+osal_mutex_t *osal_mtx_create(void)
+{
+   /* vxWorks mutex semaphores are recursive */
+   return (osal_mutex_t *)semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE);
+}
+
+void osal_mtx_destroy(osal_mutex_t *mtx)
+{
+   semDelete((SEM_ID)mtx);
+}
+
+void osal_mtx_lock(osal_mutex_t *mtx)
+{
+   semTake((SEM_ID)mtx, WAIT_FOREVER);
+}
+
+void osal_mtx_unlock(osal_mutex_t *mtx)
+{
+   semGive((SEM_ID)mtx);
+}
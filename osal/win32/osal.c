@@ -123,3 +123,49 @@ int osal_thread_create_rt(void **thandle, int stacksize, void *func, void *param
    }
    return ret;
 }
+
+int osal_thread_join(void *thandle)
+{
+   HANDLE *handle = thandle;
+
+   if (WaitForSingleObject(*handle, INFINITE) != WAIT_OBJECT_0)
+   {
+      return 0;
+   }
+   CloseHandle(*handle);
+   return 1;
+}
+
+struct osal_mutex
+{
+   CRITICAL_SECTION cs;
+};
+
+osal_mutex_t *osal_mtx_create(void)
+{
+   osal_mutex_t *mtx;
+
+   mtx = malloc(sizeof(osal_mutex_t));
+   if(mtx)
+   {
+      /* critical sections are recursive by design */
+      InitializeCriticalSection(&mtx->cs);
+   }
+   return mtx;
+}
+
+void osal_mtx_destroy(osal_mutex_t *mtx)
+{
+   DeleteCriticalSection(&mtx->cs);
+   free(mtx);
+}
+
+void osal_mtx_lock(osal_mutex_t *mtx)
+{
+   EnterCriticalSection(&mtx->cs);
+}
+
+void osal_mtx_unlock(osal_mutex_t *mtx)
+{
+   LeaveCriticalSection(&mtx->cs);
+}
@@ -28,6 +28,13 @@
  * packets. The software layer will detect the possible failure modes and
  * compensate. If needed the packets from interface A are resent through interface B.
  * This layer if fully transparent for the higher layers.
+ *
+ * With an ifname like "mux:eth0" the port is a client of a frame multiplexer
+ * (see test/linux/ecmux) instead of opening a raw socket. The multiplexer owns
+ * the NIC and exchanges frames with its clients through rings in shared
+ * memory, so several processes can use the same EtherCAT segment. Each client
+ * has its own range of frame indexes on the wire. "muxrt:eth0" attaches as the
+ * real-time client, whose frames always have priority.
  */
 
 #include <sys/types.h>
@@ -39,10 +46,12 @@
 #include <time.h>
 #include <arpa/inet.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <fcntl.h>
 #include <string.h>
 #include <netpacket/packet.h>
 #include <pthread.h>
+#include <sys/mman.h>
 
 #include "oshw.h"
 #include "osal.h"
@@ -81,9 +90,129 @@ static void ecx_clear_rxbufstat(int *rxbufstat)
    }
 }
 
+/** Put a frame in a frame multiplexer ring. The ring has a single producer,
+ * callers in one process serialize on tx_mutex of the port.
+ * @param[in] ring        = ring in shared memory
+ * @param[in] frame       = frame including ethernet header
+ * @param[in] length      = length of frame
+ * @return 1 if frame is put, 0 if ring is full
+ */
+int ecx_mux_put(ec_muxringt *ring, const void *frame, int length)
+{
+   ec_muxframet *f;
+   uint32 head;
+
+   head = ring->head;
+   if (((head - ring->tail) >= EC_MUX_RING) || (length > EC_BUFSIZE))
+   {
+      return 0;
+   }
+   f = &(ring->frame[head & (EC_MUX_RING - 1)]);
+   memcpy(f->data, frame, length);
+   f->length = length;
+   /* frame must be complete before it is visible to other process */
+   OSAL_MEMORY_BARRIER();
+   ring->head = head + 1;
+   return 1;
+}
+
+/** Get a frame from a frame multiplexer ring.
+ * @param[in] ring        = ring in shared memory
+ * @param[out] frame      = frame including ethernet header
+ * @param[in] size        = size of frame buffer
+ * @return length of frame, 0 if ring is empty
+ */
+int ecx_mux_get(ec_muxringt *ring, void *frame, int size)
+{
+   ec_muxframet *f;
+   uint32 tail;
+   int length;
+
+   tail = ring->tail;
+   if (tail == ring->head)
+   {
+      return 0;
+   }
+   /* read frame only after head */
+   OSAL_MEMORY_BARRIER();
+   f = &(ring->frame[tail & (EC_MUX_RING - 1)]);
+   length = f->length;
+   if (length > size)
+   {
+      length = size;
+   }
+   memcpy(frame, f->data, length);
+   OSAL_MEMORY_BARRIER();
+   ring->tail = tail + 1;
+   return length;
+}
+
+/** Attach port to a frame multiplexer as client.
+ * @param[in] port        = port context struct
+ * @param[in] ifname      = "mux:" or "muxrt:" followed by name of NIC device
+ * @return >0 if succeeded
+ */
+static int ecx_mux_attach(ecx_portt *port, const char *ifname)
+{
+   char name[64];
+   ec_muxshmt *mux;
+   int fd, slot, first, last;
+
+   if (strncmp(ifname, EC_MUX_PREFIXRT, strlen(EC_MUX_PREFIXRT)) == 0)
+   {
+      ifname += strlen(EC_MUX_PREFIXRT);
+      first = 0;
+      last = 0;
+   }
+   else
+   {
+      ifname += strlen(EC_MUX_PREFIX);
+      first = 1;
+      last = EC_MUX_CLIENTS - 1;
+   }
+   snprintf(name, sizeof(name), EC_MUX_SHMNAME, ifname);
+   fd = shm_open(name, O_RDWR, 0);
+   if (fd < 0)
+   {
+      return 0;
+   }
+   mux = mmap(NULL, sizeof(ec_muxshmt), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   if (mux == MAP_FAILED)
+   {
+      return 0;
+   }
+   if ((mux->magic != EC_MUX_MAGIC) || !mux->running)
+   {
+      munmap(mux, sizeof(ec_muxshmt));
+      return 0;
+   }
+   /* claim free slot */
+   for (slot = first; slot <= last; slot++)
+   {
+      if (__sync_bool_compare_and_swap(&(mux->client[slot].pid), 0, getpid()))
+      {
+         break;
+      }
+   }
+   if (slot > last)
+   {
+      munmap(mux, sizeof(ec_muxshmt));
+      return 0;
+   }
+   /* drop frames left for previous client of slot */
+   mux->client[slot].rx.tail = mux->client[slot].rx.head;
+   port->mux = mux;
+   port->muxslot = slot;
+
+   return 1;
+}
+
 /** Basic setup to connect NIC to socket.
  * @param[in] port        = port context struct
- * @param[in] ifname      = Name of NIC device, f.e. "eth0"
+ * @param[in] ifname      = Name of NIC device, f.e. "eth0", "mux:eth0" to
+ *                          attach to a frame multiplexer or "sock:5" to use
+ *                          an open socket, owned by SOEM from then on
  * @param[in] secondary   = if >0 then use secondary stack instead of primary
  * @return >0 if succeeded
  */
@@ -100,8 +229,8 @@ int ecx_setupnic(ecx_portt *port, const char *ifname, int secondary)
    rval = 0;
    if (secondary)
    {
-      /* secondary port struct available? */
-      if (port->redport)
+      /* secondary port struct available? a multiplexer client has no redundancy */
+      if (port->redport && !port->mux)
       {
          /* when using secondary socket it is automatically a redundant setup */
          psock = &(port->redport->sockhandle);
@@ -141,6 +270,40 @@ int ecx_setupnic(ecx_portt *port, const char *ifname, int secondary)
       port->stack.rxsa        = &(port->rxsa);
       ecx_clear_rxbufstat(&(port->rxbufstat[0]));
       psock = &(port->sockhandle);
+      port->mux = NULL;
+      port->muxslot = 0;
+      port->txframes = 0;
+      port->txdatagrams = 0;
+      if ((strncmp(ifname, EC_MUX_PREFIX, strlen(EC_MUX_PREFIX)) == 0) ||
+          (strncmp(ifname, EC_MUX_PREFIXRT, strlen(EC_MUX_PREFIXRT)) == 0))
+      {
+         for (i = 0; i < EC_MAXBUF; i++)
+         {
+            ec_setupheader(&(port->txbuf[i]));
+         }
+         ec_setupheader(&(port->txbuf2));
+         return ecx_mux_attach(port, ifname);
+      }
+      if (strncmp(ifname, EC_SOCK_PREFIX, strlen(EC_SOCK_PREFIX)) == 0)
+      {
+         /* connected socket, frames are sent and received as is */
+         *psock = atoi(ifname + strlen(EC_SOCK_PREFIX));
+         timeout.tv_sec =  0;
+         timeout.tv_usec = 1;
+         r = setsockopt(*psock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+         if (r != 0)
+         {
+            close(*psock);
+            *psock = -1;
+            return 0;
+         }
+         for (i = 0; i < EC_MAXBUF; i++)
+         {
+            ec_setupheader(&(port->txbuf[i]));
+         }
+         ec_setupheader(&(port->txbuf2));
+         return 1;
+      }
    }
    /* we use RAW packet socket, with packet type ETH_P_ECAT */
    *psock = socket(PF_PACKET, SOCK_RAW, htons(ETH_P_ECAT));
@@ -185,6 +348,12 @@ int ecx_setupnic(ecx_portt *port, const char *ifname, int secondary)
  */
 int ecx_closenic(ecx_portt *port)
 {
+   if (port->mux)
+   {
+      port->mux->client[port->muxslot].pid = 0;
+      munmap(port->mux, sizeof(ec_muxshmt));
+      port->mux = NULL;
+   }
    if (port->sockhandle >= 0)
       close(port->sockhandle);
    if ((port->redport) && (port->redport->sockhandle >= 0))
@@ -261,6 +430,33 @@ void ecx_setbufstat(ecx_portt *port, int idx, int bufstat)
       port->redport->rxbufstat[idx] = bufstat;
 }
 
+/** Count the datagrams of a frame in the tx buffer.
+ * @param[in] frame       = frame including ethernet header
+ * @param[in] length      = length of frame
+ * @return number of datagrams
+ */
+static uint32 ecx_countdatagrams(const uint8 *frame, int length)
+{
+   uint32 n = 0;
+   int pos;
+   uint16 dlength;
+
+   /* dlength of first datagram, behind ethernet header and elength */
+   pos = ETH_HEADERSIZE + EC_ELENGTHSIZE + 6;
+   while ((pos + 2) <= length)
+   {
+      n++;
+      dlength = frame[pos] + ((uint16)frame[pos + 1] << 8);
+      if (!(dlength & EC_DATAGRAMFOLLOWS))
+      {
+         break;
+      }
+      /* skip rest of header, data and WKC */
+      pos += 4 + (dlength & 0x07ff) + EC_WKCSIZE + 6;
+   }
+   return n;
+}
+
 /** Transmit buffer over socket (non blocking).
  * @param[in] port        = port context struct
  * @param[in] idx         = index in tx buffer array
@@ -282,7 +478,23 @@ int ecx_outframe(ecx_portt *port, int idx, int stacknumber)
    }
    lp = (*stack->txbuflength)[idx];
    (*stack->rxbufstat)[idx] = EC_BUF_TX;
-   rval = send(*stack->sock, (*stack->txbuf)[idx], lp, 0);
+   /* frames are sent from several threads, the mux ring has one producer */
+   pthread_mutex_lock( &(port->tx_mutex) );
+   if (port->mux)
+   {
+      rval = ecx_mux_put(&(port->mux->client[port->muxslot].tx), (*stack->txbuf)[idx], lp) ? lp : -1;
+   }
+   else
+   {
+      rval = send(*stack->sock, (*stack->txbuf)[idx], lp, 0);
+   }
+   if ((rval != -1) && !stacknumber)
+   {
+      port->txframes++;
+      port->txdatagrams += ecx_countdatagrams((*stack->txbuf)[idx], lp);
+   }
+   pthread_mutex_unlock( &(port->tx_mutex) );
+   OSAL_TRACE3(frame_tx, idx, stacknumber, lp);
    if (rval == -1)
    {
       (*stack->rxbufstat)[idx] = EC_BUF_EMPTY;
@@ -348,7 +560,14 @@ static int ecx_recvpkt(ecx_portt *port, int stacknumber)
       stack = &(port->redport->stack);
    }
    lp = sizeof(port->tempinbuf);
-   bytesrx = recv(*stack->sock, (*stack->tempbuf), lp, 0);
+   if (port->mux)
+   {
+      bytesrx = ecx_mux_get(&(port->mux->client[port->muxslot].rx), (*stack->tempbuf), lp);
+   }
+   else
+   {
+      bytesrx = recv(*stack->sock, (*stack->tempbuf), lp, 0);
+   }
    port->tempinbufs = bytesrx;
 
    return (bytesrx > 0);
@@ -413,6 +632,7 @@ int ecx_inframe(ecx_portt *port, int idx, int stacknumber)
             ecp =(ec_comt*)(&(*stack->tempbuf)[ETH_HEADERSIZE]);
             l = etohs(ecp->elength) & 0x0fff;
             idxf = ecp->index;
+            OSAL_TRACE3(frame_rx, idxf, stacknumber, l);
             /* found index equals requested index ? */
             if (idxf == idx)
             {
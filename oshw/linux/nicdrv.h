@@ -18,6 +18,59 @@ extern "C"
 
 #include <pthread.h>
 
+/** ifname prefix of a frame multiplexer client, f.e. "mux:eth0" */
+#define EC_MUX_PREFIX      "mux:"
+/** ifname prefix of the real-time frame multiplexer client, f.e. "muxrt:eth0".
+ *  This client owns slot 0, its frames are always sent first. */
+#define EC_MUX_PREFIXRT    "muxrt:"
+/** ifname prefix of an open datagram socket connected to a bus, f.e. a slave
+ *  simulator, followed by the socket descriptor, f.e. "sock:5". SOEM takes
+ *  ownership of the descriptor, it is closed by ecx_closenic. */
+#define EC_SOCK_PREFIX     "sock:"
+/** shared memory name of frame multiplexer, %s is the NIC name */
+#define EC_MUX_SHMNAME     "/soem-mux-%s"
+/** magic of frame multiplexer shared memory, "SMUX" */
+#define EC_MUX_MAGIC       0x584d5553
+/** number of client slots, each slot uses EC_MAXBUF frame indexes */
+#define EC_MUX_CLIENTS     (256 / EC_MAXBUF)
+/** frames per ring, must be a power of 2 */
+#define EC_MUX_RING        32
+
+/** frame in a frame multiplexer ring, including ethernet header */
+typedef struct
+{
+   int         length;
+   ec_bufT     data;
+} ec_muxframet;
+
+/** single producer single consumer frame ring in shared memory */
+typedef struct
+{
+   volatile uint32 head;
+   volatile uint32 tail;
+   ec_muxframet    frame[EC_MUX_RING];
+} ec_muxringt;
+
+/** client slot of the frame multiplexer */
+typedef struct
+{
+   /** process id of client, 0 = slot is free */
+   volatile int   pid;
+   /** frames from client to NIC */
+   ec_muxringt    tx;
+   /** frames from NIC to client */
+   ec_muxringt    rx;
+} ec_muxclientt;
+
+/** shared memory of the frame multiplexer, created by the dispatcher */
+typedef struct
+{
+   uint32         magic;
+   /** dispatcher is running */
+   volatile int   running;
+   ec_muxclientt  client[EC_MUX_CLIENTS];
+} ec_muxshmt;
+
 /** pointer structure to Tx and Rx stacks */
 typedef struct
 {
@@ -84,6 +137,16 @@ typedef struct
    pthread_mutex_t getindex_mutex;
    pthread_mutex_t tx_mutex;
    pthread_mutex_t rx_mutex;
+   /** frame multiplexer shared memory in client mode, NULL = raw socket */
+   ec_muxshmt      *mux;
+   /** client slot in frame multiplexer */
+   int             muxslot;
+   /** frames sent on primary stack, for round trip statistics, updated
+    *  under tx_mutex */
+   uint32          txframes;
+   /** datagrams sent on primary stack, for round trip statistics, updated
+    *  under tx_mutex */
+   uint32          txdatagrams;
 } ecx_portt;
 
 extern const uint16 priMAC[3];
@@ -112,6 +175,8 @@ int ecx_outframe(ecx_portt *port, int idx, int sock);
 int ecx_outframe_red(ecx_portt *port, int idx);
 int ecx_waitinframe(ecx_portt *port, int idx, int timeout);
 int ecx_srconfirm(ecx_portt *port, int idx,int timeout);
+int ecx_mux_put(ec_muxringt *ring, const void *frame, int length);
+int ecx_mux_get(ec_muxringt *ring, void *frame, int size);
 
 #ifdef __cplusplus
 }
@@ -21,6 +21,12 @@
 #include "ethercatsoe.h"
 #include "ethercateoe.h"
 #include "ethercatconfig.h"
+#include "ethercatsub.h"
+#include "ethercatcapture.h"
+#include "ethercatlog.h"
+#include "ethercatindex.h"
+#include "ethercateni.h"
+#include "ethercatdiag.h"
 #include "ethercatprint.h"
 
 #endif /* _EC_ETHERCAT_H */
@@ -80,6 +80,7 @@ int ecx_setupdatagram(ecx_portt *port, void *frame, uint8 com, uint8 idx, uint16
    datagramP->ADP = htoes(ADP);
    datagramP->ADO = htoes(ADO);
    datagramP->dlength = htoes(length);
+   datagramP->irpt = 0x0000;
    ecx_writedatagramdata(&frameP[ETH_HEADERSIZE + EC_HEADERSIZE], com, length, data);
    /* set WKC to zero */
    frameP[ETH_HEADERSIZE + EC_HEADERSIZE + length] = 0x00;
@@ -133,6 +134,7 @@ int ecx_adddatagram(ecx_portt *port, void *frame, uint8 com, uint8 idx, boolean
       /* this is the last datagram in the frame */
       datagramP->dlength = htoes(length);
    }
+   datagramP->irpt = 0x0000;
    ecx_writedatagramdata(&frameP[prevlength + EC_HEADERSIZE - EC_ELENGTHSIZE], com, length, data);
    /* set WKC to zero */
    frameP[prevlength + EC_HEADERSIZE - EC_ELENGTHSIZE + length] = 0x00;
@@ -0,0 +1,373 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Process data capture module.
+ *
+ * Selected byte ranges of the slave inputs of a group are copied to a ring
+ * buffer by ecx_receive_processdata_group, one record per cycle. A writer
+ * thread empties the ring buffer in large sequential writes through a write
+ * function of the application, so the cyclic task never waits on storage.
+ * If the ring buffer is full the record is dropped and counted as lost.
+ *
+ * The written stream is little endian. It starts with a header:
+ * magic (uint32), version (uint16), number of channels (uint16),
+ * record size (uint32), header size (uint32), followed per channel by
+ * slave (uint16), configured address (uint16), offset (uint16) and
+ * length (uint16). All records have the same size, so the n-th written
+ * record is found at header size + n * record size. A record holds a sequence
+ * number (uint32), the DC time of the cycle (int64) and the data of all
+ * channels in order. Lost records are not written, the file position only
+ * counts written records. The sequence number also counts lost records, so
+ * missing data shows only as a gap in the sequence numbers.
+ */
+
+#include <string.h>
+#include "osal.h"
+#include "oshw.h"
+#include "ethercat.h"
+
+/** sleep time of writer thread when there is nothing to write, in us */
+#define EC_CAPTURE_IDLE      1000
+
+/** Writer thread of a capture, runs until stopped and ring buffer is empty.
+ * @param[in]  param  = capture struct
+ */
+OSAL_THREAD_FUNC ecx_capture_thread(void *param)
+{
+   ec_capturet *capture = (ec_capturet *)param;
+   uint32 head, tail, n, length;
+
+   for (;;)
+   {
+      head = capture->head;
+      /* read records only after head */
+      OSAL_MEMORY_BARRIER();
+      tail = capture->tail;
+      /* contiguous records up to head or end of ring buffer */
+      n = (head >= tail) ? (head - tail) : (capture->records - tail);
+      length = n * capture->recordsize;
+      if ((n == 0) || ((head >= tail) && (length < capture->batch) && !capture->stop))
+      {
+         if ((n == 0) && capture->stop)
+         {
+            break;
+         }
+         osal_usleep(EC_CAPTURE_IDLE);
+         continue;
+      }
+      if (!capture->error)
+      {
+         if (capture->write(capture->arg, capture->ring + (tail * capture->recordsize), length) == (int)length)
+         {
+            capture->written += n;
+         }
+         else
+         {
+            capture->error = TRUE;
+         }
+      }
+      tail += n;
+      if (tail >= capture->records)
+      {
+         tail = 0;
+      }
+      /* records must be written before they can be reused by receive */
+      OSAL_MEMORY_BARRIER();
+      capture->tail = tail;
+   }
+   capture->running = 0;
+}
+
+/** Initialise a process data capture of a group.
+ * @param[in]  context  = context struct
+ * @param[out] capture  = capture struct
+ * @param[in]  group    = group number
+ * @param[in]  ring     = ring buffer for records
+ * @param[in]  size     = size of ring buffer in bytes
+ * @return 1 if initialised, 0 otherwise
+ */
+int ecx_capture_init(ecx_contextt *context, ec_capturet *capture, uint8 group, uint8 *ring, uint32 size)
+{
+   if ((group >= context->maxgroup) || (ring == NULL))
+   {
+      return 0;
+   }
+   memset(capture, 0x00, sizeof(ec_capturet));
+   capture->group = group;
+   capture->ring = ring;
+   capture->ringsize = size;
+   return 1;
+}
+
+/** Check that a byte range is in the inputs of a slave of the capture group.
+ * @param[in]  context  = context struct
+ * @param[in]  capture  = capture struct
+ * @param[in]  slave    = slave number
+ * @param[in]  offset   = offset in inputs of slave
+ * @param[in]  length   = length in bytes
+ * @return TRUE if range is valid
+ */
+static boolean ecx_capture_range(ecx_contextt *context, ec_capturet *capture, uint16 slave,
+   uint16 offset, uint16 length)
+{
+   uint32 ibytes;
+
+   if ((slave == 0) || (slave > *(context->slavecount)) ||
+       (context->slavelist[slave].group != capture->group) || (length == 0))
+   {
+      return FALSE;
+   }
+   ibytes = context->slavelist[slave].Ibytes;
+   if ((ibytes == 0) && context->slavelist[slave].Ibits)
+   {
+      ibytes = 1;
+   }
+   return ((uint32)(offset + length) <= ibytes);
+}
+
+/** Add a byte range of slave inputs to a capture. Must be called after the
+ * group is mapped and before the capture is started.
+ * @param[in]  context  = context struct
+ * @param[in]  capture  = capture struct
+ * @param[in]  slave    = slave number
+ * @param[in]  offset   = offset in inputs of slave
+ * @param[in]  length   = length in bytes
+ * @return channel number, -1 if range is invalid or channel list is full
+ */
+int ecx_capture_add(ecx_contextt *context, ec_capturet *capture, uint16 slave, uint16 offset, uint16 length)
+{
+   ec_capturechant *chan;
+
+   if (capture->running || (capture->nchan >= EC_MAXCAPTURECHAN) ||
+       !ecx_capture_range(context, capture, slave, offset, length))
+   {
+      return -1;
+   }
+   chan = &(capture->chan[capture->nchan]);
+   chan->slave = slave;
+   chan->offset = offset;
+   chan->length = length;
+   return capture->nchan++;
+}
+
+/** Only capture a record when a byte range of slave inputs changed, f.e. the
+ * sample counter of an oversampling slave.
+ * @param[in]  context  = context struct
+ * @param[in]  capture  = capture struct
+ * @param[in]  slave    = slave number
+ * @param[in]  offset   = offset in inputs of slave
+ * @param[in]  length   = length in bytes, max 8, 0 = capture every cycle
+ * @return 1 if trigger is set, 0 otherwise
+ */
+int ecx_capture_trigger(ecx_contextt *context, ec_capturet *capture, uint16 slave, uint16 offset, uint16 length)
+{
+   if (capture->running || (length > sizeof(capture->lasttrigger)))
+   {
+      return 0;
+   }
+   if (length && !ecx_capture_range(context, capture, slave, offset, length))
+   {
+      return 0;
+   }
+   capture->trigger.slave = slave;
+   capture->trigger.offset = offset;
+   capture->trigger.length = length;
+   memset(capture->lasttrigger, 0x00, sizeof(capture->lasttrigger));
+   return 1;
+}
+
+/** Start a capture. The stream header is written from the calling thread,
+ * then the writer thread is started and the capture is attached to its group.
+ * @param[in]  context  = context struct
+ * @param[in]  capture  = capture struct
+ * @param[in]  write    = write function, int write(void *arg, const void *data, uint32 length)
+ *                        returning the number of bytes written
+ * @param[in]  arg      = argument of write function
+ * @param[in]  batch    = minimum number of bytes per write, the end of the ring
+ *                        buffer and stop always write what is there
+ * @return 1 if capture is started, 0 otherwise
+ */
+int ecx_capture_start(ecx_contextt *context, ec_capturet *capture, void *write, void *arg, uint32 batch)
+{
+   uint8 header[EC_CAPTURE_HEADSIZE + (EC_MAXCAPTURECHAN * EC_CAPTURE_CHANSIZE)];
+   uint8 *p;
+   uint32 size, le32;
+   uint16 le16;
+   int i;
+
+   if (capture->running || (capture->nchan == 0) || (write == NULL) ||
+       (context->grouplist[capture->group].capture != NULL))
+   {
+      return 0;
+   }
+   capture->recordsize = EC_CAPTURE_RECHEAD;
+   for (i = 0; i < capture->nchan; i++)
+   {
+      capture->recordsize += capture->chan[i].length;
+   }
+   capture->records = capture->ringsize / capture->recordsize;
+   /* one record is always empty to tell a full from an empty ring buffer */
+   if (capture->records < 2)
+   {
+      return 0;
+   }
+   capture->write = write;
+   capture->arg = arg;
+   capture->batch = batch;
+   capture->head = 0;
+   capture->tail = 0;
+   capture->seq = 0;
+   capture->lost = 0;
+   capture->written = 0;
+   capture->error = FALSE;
+   capture->stop = 0;
+
+   size = EC_CAPTURE_HEADSIZE + (capture->nchan * EC_CAPTURE_CHANSIZE);
+   le32 = htoel(EC_CAPTURE_MAGIC);
+   memcpy(&header[0], &le32, sizeof(le32));
+   le16 = htoes(EC_CAPTURE_VERSION);
+   memcpy(&header[4], &le16, sizeof(le16));
+   le16 = htoes((uint16)capture->nchan);
+   memcpy(&header[6], &le16, sizeof(le16));
+   le32 = htoel(capture->recordsize);
+   memcpy(&header[8], &le32, sizeof(le32));
+   le32 = htoel(size);
+   memcpy(&header[12], &le32, sizeof(le32));
+   p = &header[EC_CAPTURE_HEADSIZE];
+   for (i = 0; i < capture->nchan; i++)
+   {
+      le16 = htoes(capture->chan[i].slave);
+      memcpy(p, &le16, sizeof(le16));
+      le16 = htoes(context->slavelist[capture->chan[i].slave].configadr);
+      memcpy(p + 2, &le16, sizeof(le16));
+      le16 = htoes(capture->chan[i].offset);
+      memcpy(p + 4, &le16, sizeof(le16));
+      le16 = htoes(capture->chan[i].length);
+      memcpy(p + 6, &le16, sizeof(le16));
+      p += EC_CAPTURE_CHANSIZE;
+   }
+   if (capture->write(capture->arg, header, size) != (int)size)
+   {
+      return 0;
+   }
+
+   capture->running = 1;
+   if (!osal_thread_create(&(capture->thread), 128000, &ecx_capture_thread, capture))
+   {
+      capture->running = 0;
+      capture->thread = 0;
+      return 0;
+   }
+   context->grouplist[capture->group].capture = capture;
+   return 1;
+}
+
+/** Stop a capture. The capture is detached from its group and the writer
+ * thread writes the remaining records before it ends, then it is joined.
+ * Call from the cyclic task or after the cyclic task has stopped receiving
+ * process data.
+ * @param[in]  context  = context struct
+ * @param[in]  capture  = capture struct
+ * @return number of records written
+ */
+uint32 ecx_capture_stop(ecx_contextt *context, ec_capturet *capture)
+{
+   if (context->grouplist[capture->group].capture == capture)
+   {
+      context->grouplist[capture->group].capture = NULL;
+   }
+   capture->stop = 1;
+   while (capture->running)
+   {
+      osal_usleep(EC_CAPTURE_IDLE);
+   }
+   if (capture->thread)
+   {
+      osal_thread_join(&(capture->thread));
+      capture->thread = 0;
+   }
+   return capture->written;
+}
+
+/** Copy the captured inputs of a group to a record in the ring buffer.
+ * Called by ecx_receive_processdata_group after the inputs are received.
+ * @param[in]  context  = context struct
+ * @param[in]  group    = group number
+ */
+void ecx_capture_push(ecx_contextt *context, uint8 group)
+{
+   ec_capturet *capture = context->grouplist[group].capture;
+   ec_capturechant *chan;
+   uint8 *record, *src;
+   uint32 head, next, le32;
+   int64 le64;
+   int i;
+
+   if (capture->trigger.length)
+   {
+      src = context->slavelist[capture->trigger.slave].inputs + capture->trigger.offset;
+      if (memcmp(src, capture->lasttrigger, capture->trigger.length) == 0)
+      {
+         return;
+      }
+      memcpy(capture->lasttrigger, src, capture->trigger.length);
+   }
+   head = capture->head;
+   next = head + 1;
+   if (next >= capture->records)
+   {
+      next = 0;
+   }
+   le32 = htoel(capture->seq);
+   capture->seq++;
+   if (next == capture->tail)
+   {
+      capture->lost++;
+      return;
+   }
+   record = capture->ring + (head * capture->recordsize);
+   memcpy(record, &le32, sizeof(le32));
+   le64 = htoell(*(context->DCtime));
+   memcpy(record + 4, &le64, sizeof(le64));
+   record += EC_CAPTURE_RECHEAD;
+   for (i = 0; i < capture->nchan; i++)
+   {
+      chan = &(capture->chan[i]);
+      memcpy(record, context->slavelist[chan->slave].inputs + chan->offset, chan->length);
+      record += chan->length;
+   }
+   /* record must be complete before it is visible to writer thread */
+   OSAL_MEMORY_BARRIER();
+   capture->head = next;
+}
+
+#ifdef EC_VER1
+int ec_capture_init(ec_capturet *capture, uint8 group, uint8 *ring, uint32 size)
+{
+   return ecx_capture_init(&ecx_context, capture, group, ring, size);
+}
+
+int ec_capture_add(ec_capturet *capture, uint16 slave, uint16 offset, uint16 length)
+{
+   return ecx_capture_add(&ecx_context, capture, slave, offset, length);
+}
+
+int ec_capture_trigger(ec_capturet *capture, uint16 slave, uint16 offset, uint16 length)
+{
+   return ecx_capture_trigger(&ecx_context, capture, slave, offset, length);
+}
+
+int ec_capture_start(ec_capturet *capture, void *write, void *arg, uint32 batch)
+{
+   return ecx_capture_start(&ecx_context, capture, write, arg, batch);
+}
+
+uint32 ec_capture_stop(ec_capturet *capture)
+{
+   return ecx_capture_stop(&ecx_context, capture);
+}
+#endif
@@ -0,0 +1,49 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Headerfile for ethercatcapture.c
+ */
+
+#ifndef _ethercatcapture_
+#define _ethercatcapture_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** magic of capture stream header, "SECP" */
+#define EC_CAPTURE_MAGIC     0x50434553
+/** version of capture stream format */
+#define EC_CAPTURE_VERSION   1
+/** size of fixed part of capture stream header */
+#define EC_CAPTURE_HEADSIZE  16
+/** size of one channel in capture stream header */
+#define EC_CAPTURE_CHANSIZE  8
+/** size of record header, sequence number and DC time */
+#define EC_CAPTURE_RECHEAD   12
+
+#ifdef EC_VER1
+int ec_capture_init(ec_capturet *capture, uint8 group, uint8 *ring, uint32 size);
+int ec_capture_add(ec_capturet *capture, uint16 slave, uint16 offset, uint16 length);
+int ec_capture_trigger(ec_capturet *capture, uint16 slave, uint16 offset, uint16 length);
+int ec_capture_start(ec_capturet *capture, void *write, void *arg, uint32 batch);
+uint32 ec_capture_stop(ec_capturet *capture);
+#endif
+
+int ecx_capture_init(ecx_contextt *context, ec_capturet *capture, uint8 group, uint8 *ring, uint32 size);
+int ecx_capture_add(ecx_contextt *context, ec_capturet *capture, uint16 slave, uint16 offset, uint16 length);
+int ecx_capture_trigger(ecx_contextt *context, ec_capturet *capture, uint16 slave, uint16 offset, uint16 length);
+int ecx_capture_start(ecx_contextt *context, ec_capturet *capture, void *write, void *arg, uint32 batch);
+uint32 ecx_capture_stop(ecx_contextt *context, ec_capturet *capture);
+void ecx_capture_push(ecx_contextt *context, uint8 group);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
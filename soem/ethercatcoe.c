@@ -76,6 +76,7 @@ void ecx_SDOerror(ecx_contextt *context, uint16 Slave, uint16 Index, uint8 SubId
    Ec.Etype = EC_ERR_TYPE_SDO_ERROR;
    Ec.AbortCode = AbortCode;
    ecx_pusherror(context, &Ec);
+   OSAL_TRACE4(sdo_abort, Slave, Index, SubIdx, AbortCode);
 }
 
 /** Report SDO info error
@@ -130,6 +131,8 @@ int ecx_SDOread(ecx_contextt *context, uint16 slave, uint16 index, uint8 subinde
    uint8 cnt, toggle;
    boolean NotLast;
 
+   OSAL_TRACE4(sdo_start, slave, index, subindex, 0);
+   ecx_mbxlock(context, slave);
    ec_clearmbx(&MbxIn);
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
    wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
@@ -307,6 +310,8 @@ int ecx_SDOread(ecx_contextt *context, uint16 slave, uint16 index, uint8 subinde
          }
       }
    }
+   ecx_mbxunlock(context, slave);
+   OSAL_TRACE4(sdo_end, slave, index, subindex, wkc);
    return wkc;
 }
 
@@ -338,6 +343,8 @@ int ecx_SDOwrite(ecx_contextt *context, uint16 Slave, uint16 Index, uint8 SubInd
    boolean  NotLast;
    uint8 *hp;
 
+   OSAL_TRACE4(sdo_start, Slave, Index, SubIndex, 1);
+   ecx_mbxlock(context, Slave);
    ec_clearmbx(&MbxIn);
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
    wkc = ecx_mbxreceive(context, Slave, (ec_mbxbuft *)&MbxIn, 0);
@@ -534,6 +541,8 @@ int ecx_SDOwrite(ecx_contextt *context, uint16 Slave, uint16 Index, uint8 SubInd
          }
       }
    }
+   ecx_mbxunlock(context, Slave);
+   OSAL_TRACE4(sdo_end, Slave, Index, SubIndex, wkc);
 
    return wkc;
 }
@@ -557,6 +566,7 @@ int ecx_RxPDO(ecx_contextt *context, uint16 Slave, uint16 RxPDOnumber, int psize
    uint8 cnt;
    uint16 framedatasize;
 
+   ecx_mbxlock(context, Slave);
    ec_clearmbx(&MbxIn);
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
    wkc = ecx_mbxreceive(context, Slave, (ec_mbxbuft *)&MbxIn, 0);
@@ -580,6 +590,7 @@ int ecx_RxPDO(ecx_contextt *context, uint16 Slave, uint16 RxPDOnumber, int psize
    memcpy(&SDOp->Command, p, framedatasize);
    /* send mailbox RxPDO request to slave */
    wkc = ecx_mbxsend(context, Slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+   ecx_mbxunlock(context, Slave);
 
    return wkc;
 }
@@ -604,6 +615,7 @@ int ecx_TxPDO(ecx_contextt *context, uint16 slave, uint16 TxPDOnumber , int *psi
    uint8 cnt;
    uint16 framedatasize;
 
+   ecx_mbxlock(context, slave);
    ec_clearmbx(&MbxIn);
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
    wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
@@ -662,17 +674,119 @@ int ecx_TxPDO(ecx_contextt *context, uint16 slave, uint16 TxPDOnumber , int *psi
          }
       }
    }
+   ecx_mbxunlock(context, slave);
 
    return wkc;
 }
 
-/** Read PDO assign structure
+/** Collected PDO entries of one slave during a PDO mapping read */
+typedef struct
+{
+   /** number of entries collected */
+   int          n;
+   /** bit offset of current SM in outputs and inputs of slave */
+   int          bitoffset[2];
+   /** collected entries */
+   ec_pdoentryt entry[EC_MAXSLAVEPDOENTRY];
+} ec_pdomapt;
+
+/** Add one mapped object to collected PDO entries.
+ * @param[in]  map       = collected PDO entries, NULL = not collected
+ * @param[in]  output    = TRUE if entry is in outputs
+ * @param[in]  mapping   = mapping entry, index, subindex and bitlength
+ * @param[in]  bitpos    = bit position of entry in the current SM
+ */
+static void ecx_pdomap_add(ec_pdomapt *map, boolean output, uint32 mapping, int bitpos)
+{
+   ec_pdoentryt *entry;
+
+   if ((map == NULL) || (map->n >= EC_MAXSLAVEPDOENTRY))
+   {
+      return;
+   }
+   entry = &map->entry[map->n++];
+   entry->index = (uint16)(mapping >> 16);
+   entry->subindex = (uint8)(mapping >> 8);
+   entry->bitlen = LO_BYTE(mapping);
+   entry->output = output;
+   entry->bitoffset = (uint16)(map->bitoffset[output ? 1 : 0] + bitpos);
+   entry->next = EC_PDOENTRY_NONE;
+}
+
+static uint16 ecx_pdoentry_hash(uint16 slave, uint16 index, uint8 subindex)
+{
+   uint32 key;
+
+   key = ((uint32)slave << 24) ^ ((uint32)index << 8) ^ subindex;
+   key *= 0x9e3779b1;
+   return (uint16)((key >> 16) & (EC_PDOHASHSIZE - 1));
+}
+
+/** Store PDO entries of a slave in the retained PDO entry list. Entries
+ * stored earlier for this slave are replaced.
+ * @param[in]  context = context struct
+ * @param[in]  Slave   = Slave number
+ * @param[in]  pentry  = PDO entries, in mapping order
+ * @param[in]  n       = number of PDO entries
+ * @return 1 if stored, 0 if the context has no PDO entry list or the list is full
+ */
+int ecx_pdoentry_store(ecx_contextt *context, uint16 Slave, const ec_pdoentryt *pentry, int n)
+{
+   ec_slavet *slave = &context->slavelist[Slave];
+   ec_pdoentryt *entry;
+   uint16 first, h;
+   int i, rval = 0;
+
+   if ((context->pdoentrylist == NULL) || (context->pdoentrycount == NULL) ||
+       (context->pdohash == NULL))
+   {
+      return 0;
+   }
+   if (context->pdolock) osal_mtx_lock(context->pdolock);
+   slave->npdoentry = 0;
+   if ((*(context->pdoentrycount) + n) <= context->maxpdoentry)
+   {
+      first = (uint16)*(context->pdoentrycount);
+      for (i = 0; i < n; i++)
+      {
+         entry = &context->pdoentrylist[first + i];
+         *entry = pentry[i];
+         entry->slave = Slave;
+         entry->next = EC_PDOENTRY_NONE;
+      }
+      /* entries are complete before they are linked into the hash table */
+      OSAL_MEMORY_BARRIER();
+      for (i = 0; i < n; i++)
+      {
+         entry = &context->pdoentrylist[first + i];
+         /* padding is not looked up */
+         if (entry->index)
+         {
+            h = ecx_pdoentry_hash(Slave, entry->index, entry->subindex);
+            entry->next = context->pdohash[h];
+            OSAL_MEMORY_BARRIER();
+            context->pdohash[h] = (uint16)(first + i);
+         }
+      }
+      *(context->pdoentrycount) += n;
+      slave->pdoentry = first;
+      slave->npdoentry = (uint16)n;
+      rval = 1;
+   }
+   if (context->pdolock) osal_mtx_unlock(context->pdolock);
+   return rval;
+}
+
+/** Read PDO assign structure and collect the mapped entries
  * @param[in]  context       = context struct
  * @param[in]  Slave         = Slave number
  * @param[in]  PDOassign     = PDO assign object
+ * @param[in]  map           = collected PDO entries, NULL = not collected
+ * @param[in]  output        = TRUE if PDO assign is for outputs
  * @return total bitlength of PDO assign
  */
-int ecx_readPDOassign(ecx_contextt *context, uint16 Slave, uint16 PDOassign)
+static int ecx_readPDOassign_map(ecx_contextt *context, uint16 Slave, uint16 PDOassign,
+   ec_pdomapt *map, boolean output)
 {
    uint16 idxloop, nidx, subidxloop, rdat, idx, subidx;
    uint8 subcnt;
@@ -713,6 +827,7 @@ int ecx_readPDOassign(ecx_contextt *context, uint16 Slave, uint16 PDOassign)
                /* extract bitlength of SDO */
                if (LO_BYTE(rdat2) < 0xff)
                {
+                  ecx_pdomap_add(map, output, (uint32)rdat2, bsize);
                   bsize += LO_BYTE(rdat2);
                }
                else
@@ -730,46 +845,62 @@ int ecx_readPDOassign(ecx_contextt *context, uint16 Slave, uint16 PDOassign)
    return bsize;
 }
 
-/** Read PDO assign structure in Complete Access mode
+/** Read PDO assign structure
+ * @param[in]  context       = context struct
+ * @param[in]  Slave         = Slave number
+ * @param[in]  PDOassign     = PDO assign object
+ * @return total bitlength of PDO assign
+ */
+int ecx_readPDOassign(ecx_contextt *context, uint16 Slave, uint16 PDOassign)
+{
+   return ecx_readPDOassign_map(context, Slave, PDOassign, NULL, FALSE);
+}
+
+/** Read PDO assign structure in Complete Access mode and collect the mapped entries
  * @param[in]  context       = context struct
  * @param[in]  Slave         = Slave number
- * @param[in]  Thread_n      = Calling thread index
  * @param[in]  PDOassign     = PDO assign object
+ * @param[in]  map           = collected PDO entries, NULL = not collected
+ * @param[in]  output        = TRUE if PDO assign is for outputs
  * @return total bitlength of PDO assign
  */
-int ecx_readPDOassignCA(ecx_contextt *context, uint16 Slave, int Thread_n,
-      uint16 PDOassign)
+static int ecx_readPDOassignCA_map(ecx_contextt *context, uint16 Slave, uint16 PDOassign,
+   ec_pdomapt *map, boolean output)
 {
    uint16 idxloop, nidx, subidxloop, idx, subidx;
    int wkc, bsize = 0, rdl;
+   /* scratch is per call so different slaves can be read concurrently */
+   ec_PDOassignt PDOassignbuf;
+   ec_PDOdesct PDOdescbuf;
 
    /* find maximum size of PDOassign buffer */
    rdl = sizeof(ec_PDOassignt);
-   context->PDOassign[Thread_n].n=0;
+   PDOassignbuf.n=0;
    /* read rxPDOassign in CA mode, all subindexes are read in one struct */
    wkc = ecx_SDOread(context, Slave, PDOassign, 0x00, TRUE, &rdl,
-         &(context->PDOassign[Thread_n]), EC_TIMEOUTRXM);
+         &PDOassignbuf, EC_TIMEOUTRXM);
    /* positive result from slave ? */
-   if ((wkc > 0) && (context->PDOassign[Thread_n].n > 0))
+   if ((wkc > 0) && (PDOassignbuf.n > 0))
    {
-      nidx = context->PDOassign[Thread_n].n;
+      nidx = PDOassignbuf.n;
       bsize = 0;
       /* for each PDO do */
       for (idxloop = 1; idxloop <= nidx; idxloop++)
       {
          /* get index from PDOassign struct */
-         idx = etohs(context->PDOassign[Thread_n].index[idxloop - 1]);
+         idx = etohs(PDOassignbuf.index[idxloop - 1]);
          if (idx > 0)
          {
-            rdl = sizeof(ec_PDOdesct); context->PDOdesc[Thread_n].n = 0;
+            rdl = sizeof(ec_PDOdesct); PDOdescbuf.n = 0;
             /* read SDO's that are mapped in PDO, CA mode */
             wkc = ecx_SDOread(context, Slave,idx, 0x00, TRUE, &rdl,
-                  &(context->PDOdesc[Thread_n]), EC_TIMEOUTRXM);
-            subidx = context->PDOdesc[Thread_n].n;
+                  &PDOdescbuf, EC_TIMEOUTRXM);
+            subidx = PDOdescbuf.n;
             /* extract all bitlengths of SDO's */
             for (subidxloop = 1; subidxloop <= subidx; subidxloop++)
             {
-               bsize += LO_BYTE(etohl(context->PDOdesc[Thread_n].PDO[subidxloop -1]));
+               ecx_pdomap_add(map, output, etohl(PDOdescbuf.PDO[subidxloop -1]), bsize);
+               bsize += LO_BYTE(etohl(PDOdescbuf.PDO[subidxloop -1]));
             }
          }
       }
@@ -779,6 +910,17 @@ int ecx_readPDOassignCA(ecx_contextt *context, uint16 Slave, int Thread_n,
    return bsize;
 }
 
+/** Read PDO assign structure in Complete Access mode
+ * @param[in]  context       = context struct
+ * @param[in]  Slave         = Slave number
+ * @param[in]  PDOassign     = PDO assign object
+ * @return total bitlength of PDO assign
+ */
+int ecx_readPDOassignCA(ecx_contextt *context, uint16 Slave, uint16 PDOassign)
+{
+   return ecx_readPDOassignCA_map(context, Slave, PDOassign, NULL, FALSE);
+}
+
 /** CoE read PDO mapping.
  *
  * CANopen has standard indexes defined for PDO mapping. This function
@@ -801,6 +943,9 @@ int ecx_readPDOassignCA(ecx_contextt *context, uint16 Slave, int Thread_n,
  * 1A00:00 is number of object defined for this PDO\n
  * 1A00:01 object mapping #1, f.e. 60100710 (SDO 6010 SI 07 bitlength 0x10)
  *
+ * The mapped objects are retained in the PDO entry list of the context,
+ * see ecx_pdoentry_find().
+ *
  * @param[in]  context = context struct
  * @param[in]  Slave   = Slave number
  * @param[out] Osize   = Size in bits of output mapping (rxPDO) found
@@ -814,10 +959,14 @@ int ecx_readPDOmap(ecx_contextt *context, uint16 Slave, int *Osize, int *Isize)
    uint8 nSM, iSM, tSM;
    int Tsize;
    uint8 SMt_bug_add;
+   ec_pdomapt map;
 
    *Isize = 0;
    *Osize = 0;
    SMt_bug_add = 0;
+   map.n = 0;
+   map.bitoffset[0] = 0;
+   map.bitoffset[1] = 0;
    rdl = sizeof(nSM); nSM = 0;
    /* read SyncManager Communication Type object count */
    wkc = ecx_SDOread(context, Slave, ECT_SDO_SMCOMMTYPE, 0x00, FALSE, &rdl, &nSM, EC_TIMEOUTRXM);
@@ -864,11 +1013,14 @@ int ecx_readPDOmap(ecx_contextt *context, uint16 Slave, int *Osize, int *Isize)
             if ((tSM == 3) || (tSM == 4))
             {
                /* read the assign PDO */
-               Tsize = ecx_readPDOassign(context, Slave, ECT_SDO_PDOASSIGN + iSM );
+               Tsize = ecx_readPDOassign_map(context, Slave, ECT_SDO_PDOASSIGN + iSM,
+                  &map, (tSM == 3));
                /* if a mapping is found */
                if (Tsize)
                {
                   context->slavelist[Slave].SM[iSM].SMlength = htoes((Tsize + 7) / 8);
+                  /* next SM starts at a byte boundary in the process data */
+                  map.bitoffset[(tSM == 3) ? 1 : 0] += ((Tsize + 7) / 8) * 8;
                   if (tSM == 3)
                   {
                      /* we are doing outputs */
@@ -888,6 +1040,7 @@ int ecx_readPDOmap(ecx_contextt *context, uint16 Slave, int *Osize, int *Isize)
    /* found some I/O bits ? */
    if ((*Isize > 0) || (*Osize > 0))
    {
+      (void)ecx_pdoentry_store(context, Slave, map.entry, map.n);
       retVal = 1;
    }
 
@@ -902,7 +1055,7 @@ int ecx_readPDOmap(ecx_contextt *context, uint16 Slave, int *Osize, int *Isize)
  *
  * @param[in]  context  = context struct
  * @param[in]  Slave    = Slave number
- * @param[in]  Thread_n = Calling thread index
+ * @param[in]  Thread_n = unused, scratch buffers are local to the call
  * @param[out] Osize    = Size in bits of output mapping (rxPDO) found
  * @param[out] Isize    = Size in bits of input mapping (txPDO) found
  * @return >0 if mapping successful.
@@ -914,19 +1067,25 @@ int ecx_readPDOmapCA(ecx_contextt *context, uint16 Slave, int Thread_n, int *Osi
    uint8 nSM, iSM, tSM;
    int Tsize;
    uint8 SMt_bug_add;
+   ec_SMcommtypet SMcommtype;
+   ec_pdomapt map;
 
+   (void)Thread_n;
    *Isize = 0;
    *Osize = 0;
    SMt_bug_add = 0;
+   map.n = 0;
+   map.bitoffset[0] = 0;
+   map.bitoffset[1] = 0;
    rdl = sizeof(ec_SMcommtypet);
-   context->SMcommtype[Thread_n].n = 0;
+   SMcommtype.n = 0;
    /* read SyncManager Communication Type object count Complete Access*/
    wkc = ecx_SDOread(context, Slave, ECT_SDO_SMCOMMTYPE, 0x00, TRUE, &rdl,
-         &(context->SMcommtype[Thread_n]), EC_TIMEOUTRXM);
+         &SMcommtype, EC_TIMEOUTRXM);
    /* positive result from slave ? */
-   if ((wkc > 0) && (context->SMcommtype[Thread_n].n > 2))
+   if ((wkc > 0) && (SMcommtype.n > 2))
    {
-      nSM = context->SMcommtype[Thread_n].n;
+      nSM = SMcommtype.n;
       /* limit to maximum number of SM defined, if true the slave can't be configured */
       if (nSM > EC_MAXSM)
       {
@@ -936,7 +1095,7 @@ int ecx_readPDOmapCA(ecx_contextt *context, uint16 Slave, int Thread_n, int *Osi
       /* iterate for every SM type defined */
       for (iSM = 2 ; iSM < nSM ; iSM++)
       {
-         tSM = context->SMcommtype[Thread_n].SMtype[iSM];
+         tSM = SMcommtype.SMtype[iSM];
 
 // start slave bug prevention code, remove if possible
          if((iSM == 2) && (tSM == 2)) // SM2 has type 2 == mailbox out, this is a bug in the slave!
@@ -959,12 +1118,14 @@ int ecx_readPDOmapCA(ecx_contextt *context, uint16 Slave, int Thread_n, int *Osi
          if ((tSM == 3) || (tSM == 4))
          {
             /* read the assign PDO */
-            Tsize = ecx_readPDOassignCA(context, Slave, Thread_n,
-                  ECT_SDO_PDOASSIGN + iSM );
+            Tsize = ecx_readPDOassignCA_map(context, Slave, ECT_SDO_PDOASSIGN + iSM,
+               &map, (tSM == 3));
             /* if a mapping is found */
             if (Tsize)
             {
                context->slavelist[Slave].SM[iSM].SMlength = htoes((Tsize + 7) / 8);
+               /* next SM starts at a byte boundary in the process data */
+               map.bitoffset[(tSM == 3) ? 1 : 0] += ((Tsize + 7) / 8) * 8;
                if (tSM == 3)
                {
                   /* we are doing outputs */
@@ -983,6 +1144,7 @@ int ecx_readPDOmapCA(ecx_contextt *context, uint16 Slave, int Thread_n, int *Osi
    /* found some I/O bits ? */
    if ((*Isize > 0) || (*Osize > 0))
    {
+      (void)ecx_pdoentry_store(context, Slave, map.entry, map.n);
       retVal = 1;
    }
    return retVal;
@@ -1007,6 +1169,7 @@ int ecx_readODlist(ecx_contextt *context, uint16 Slave, ec_ODlistt *pODlist)
 
    pODlist->Slave = Slave;
    pODlist->Entries = 0;
+   ecx_mbxlock(context, Slave);
    ec_clearmbx(&MbxIn);
    /* clear pending out mailbox in slave if available. Timeout is set to 0 */
    wkc = ecx_mbxreceive(context, Slave, &MbxIn, 0);
@@ -1104,6 +1267,7 @@ int ecx_readODlist(ecx_contextt *context, uint16 Slave, ec_ODlistt *pODlist)
       }
       while ((x <= 128) && !stop);
    }
+   ecx_mbxunlock(context, Slave);
    return wkc;
 }
 
@@ -1127,6 +1291,7 @@ int ecx_readODdescription(ecx_contextt *context, uint16 Item, ec_ODlistt *pODlis
    pODlist->ObjectCode[Item] = 0;
    pODlist->MaxSub[Item] = 0;
    pODlist->Name[Item][0] = 0;
+   ecx_mbxlock(context, Slave);
    ec_clearmbx(&MbxIn);
    /* clear pending out mailbox in slave if available. Timeout is set to 0 */
    wkc = ecx_mbxreceive(context, Slave, &MbxIn, 0);
@@ -1186,6 +1351,7 @@ int ecx_readODdescription(ecx_contextt *context, uint16 Item, ec_ODlistt *pODlis
          }
       }
    }
+   ecx_mbxunlock(context, Slave);
 
    return wkc;
 }
@@ -1212,6 +1378,7 @@ int ecx_readOEsingle(ecx_contextt *context, uint16 Item, uint8 SubI, ec_ODlistt
    wkc = 0;
    Slave = pODlist->Slave;
    Index = pODlist->Index[Item];
+   ecx_mbxlock(context, Slave);
    ec_clearmbx(&MbxIn);
    /* clear pending out mailbox in slave if available. Timeout is set to 0 */
    wkc = ecx_mbxreceive(context, Slave, &MbxIn, 0);
@@ -1279,6 +1446,7 @@ int ecx_readOEsingle(ecx_contextt *context, uint16 Item, uint8 SubI, ec_ODlistt
          }
       }
    }
+   ecx_mbxunlock(context, Slave);
 
    return wkc;
 }
@@ -1310,6 +1478,97 @@ int ecx_readOE(ecx_contextt *context, uint16 Item, ec_ODlistt *pODlist, ec_OElis
    return wkc;
 }
 
+/** Get retained PDO entry of a slave by number, for iteration over the
+ * mapped objects of a slave including padding.
+ *
+ * @param[in] context        = context struct
+ * @param[in] slave          = Slave number
+ * @param[in] n              = entry number, 0 .. slavelist[slave].npdoentry - 1
+ * @return PDO entry or NULL if not available
+ */
+const ec_pdoentryt *ecx_pdoentry_get(ecx_contextt *context, uint16 slave, uint16 n)
+{
+   if ((context->pdoentrylist == NULL) || (slave > *(context->slavecount)) ||
+       (n >= context->slavelist[slave].npdoentry))
+   {
+      return NULL;
+   }
+   return &context->pdoentrylist[context->slavelist[slave].pdoentry + n];
+}
+
+/** Find retained PDO entry of a mapped object. The entries are retained from
+ * the CoE PDO mapping read during configuration, no bus access is done.
+ *
+ * @param[in] context        = context struct
+ * @param[in] slave          = Slave number
+ * @param[in] index          = Object index
+ * @param[in] subindex       = Object subindex
+ * @return PDO entry or NULL if object is not mapped
+ */
+const ec_pdoentryt *ecx_pdoentry_find(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex)
+{
+   const ec_pdoentryt *entry;
+   uint16 i, first, last;
+
+   if ((context->pdoentrylist == NULL) || (context->pdohash == NULL) ||
+       (slave > *(context->slavecount)) || (context->slavelist[slave].npdoentry == 0))
+   {
+      return NULL;
+   }
+   first = context->slavelist[slave].pdoentry;
+   last = first + context->slavelist[slave].npdoentry;
+   i = context->pdohash[ecx_pdoentry_hash(slave, index, subindex)];
+   while (i != EC_PDOENTRY_NONE)
+   {
+      entry = &context->pdoentrylist[i];
+      /* entries of an earlier mapping read of the slave are skipped */
+      if ((i >= first) && (i < last) && (entry->slave == slave) &&
+          (entry->index == index) && (entry->subindex == subindex))
+      {
+         return entry;
+      }
+      i = entry->next;
+   }
+   return NULL;
+}
+
+/** Get location of a retained PDO entry in the IOmap. Valid after the
+ * process data of the slave is mapped.
+ *
+ * @param[in] context        = context struct
+ * @param[in] entry          = PDO entry
+ * @param[out] bit           = bit position of entry in returned byte
+ * @return pointer to first byte of entry in IOmap or NULL if not mapped
+ */
+uint8 *ecx_pdoentry_ptr(ecx_contextt *context, const ec_pdoentryt *entry, uint8 *bit)
+{
+   ec_slavet *slave;
+   uint8 *base;
+   int bitpos;
+
+   if (entry == NULL)
+   {
+      return NULL;
+   }
+   slave = &context->slavelist[entry->slave];
+   if (entry->output)
+   {
+      base = slave->outputs;
+      bitpos = slave->Ostartbit + entry->bitoffset;
+   }
+   else
+   {
+      base = slave->inputs;
+      bitpos = slave->Istartbit + entry->bitoffset;
+   }
+   if (base == NULL)
+   {
+      return NULL;
+   }
+   *bit = (uint8)(bitpos & 7);
+   return base + (bitpos >> 3);
+}
+
 #ifdef EC_VER1
 /** Report SDO error.
  *
@@ -1416,13 +1675,12 @@ int ec_readPDOassign(uint16 Slave, uint16 PDOassign)
 /** Read PDO assign structure in Complete Access mode
  * @param[in]  Slave         = Slave number
  * @param[in]  PDOassign     = PDO assign object
- * @param[in]  Thread_n      = Calling thread index
  * @return total bitlength of PDO assign
  * @see ecx_readPDOmap
  */
-int ec_readPDOassignCA(uint16 Slave, uint16 PDOassign, int Thread_n)
+int ec_readPDOassignCA(uint16 Slave, uint16 PDOassign)
 {
-   return ecx_readPDOassignCA(&ecx_context, Slave, Thread_n, PDOassign);
+   return ecx_readPDOassignCA(&ecx_context, Slave, PDOassign);
 }
 
 /** CoE read PDO mapping.
@@ -1450,7 +1708,7 @@ int ec_readPDOmap(uint16 Slave, int *Osize, int *Isize)
  * of designated slave. Slave has to support CA, otherwise use ec_readPDOmap().
  *
  * @param[in] Slave    = Slave number
- * @param[in] Thread_n = Calling thread index
+ * @param[in] Thread_n = unused, scratch buffers are local to the call
  * @param[out] Osize   = Size in bits of output mapping (rxPDO) found
  * @param[out] Isize   = Size in bits of input mapping (txPDO) found
  * @return >0 if mapping succesful.
@@ -1502,4 +1760,41 @@ int ec_readOE(uint16 Item, ec_ODlistt *pODlist, ec_OElistt *pOElist)
 {
    return ecx_readOE(&ecx_context, Item, pODlist, pOElist);
 }
+
+/** Get retained PDO entry of a slave by number.
+ *
+ * @param[in] slave          = Slave number
+ * @param[in] n              = entry number
+ * @return PDO entry or NULL if not available
+ * @see ecx_pdoentry_get
+ */
+const ec_pdoentryt *ec_pdoentry_get(uint16 slave, uint16 n)
+{
+   return ecx_pdoentry_get(&ecx_context, slave, n);
+}
+
+/** Find retained PDO entry of a mapped object.
+ *
+ * @param[in] slave          = Slave number
+ * @param[in] index          = Object index
+ * @param[in] subindex       = Object subindex
+ * @return PDO entry or NULL if object is not mapped
+ * @see ecx_pdoentry_find
+ */
+const ec_pdoentryt *ec_pdoentry_find(uint16 slave, uint16 index, uint8 subindex)
+{
+   return ecx_pdoentry_find(&ecx_context, slave, index, subindex);
+}
+
+/** Get location of a retained PDO entry in the IOmap.
+ *
+ * @param[in] entry          = PDO entry
+ * @param[out] bit           = bit position of entry in returned byte
+ * @return pointer to first byte of entry in IOmap or NULL if not mapped
+ * @see ecx_pdoentry_ptr
+ */
+uint8 *ec_pdoentry_ptr(const ec_pdoentryt *entry, uint8 *bit)
+{
+   return ecx_pdoentry_ptr(&ecx_context, entry, bit);
+}
 #endif
@@ -72,6 +72,9 @@ int ec_readODlist(uint16 Slave, ec_ODlistt *pODlist);
 int ec_readODdescription(uint16 Item, ec_ODlistt *pODlist);
 int ec_readOEsingle(uint16 Item, uint8 SubI, ec_ODlistt *pODlist, ec_OElistt *pOElist);
 int ec_readOE(uint16 Item, ec_ODlistt *pODlist, ec_OElistt *pOElist);
+const ec_pdoentryt *ec_pdoentry_get(uint16 slave, uint16 n);
+const ec_pdoentryt *ec_pdoentry_find(uint16 slave, uint16 index, uint8 subindex);
+uint8 *ec_pdoentry_ptr(const ec_pdoentryt *entry, uint8 *bit);
 #endif
 
 void ecx_SDOerror(ecx_contextt *context, uint16 Slave, uint16 Index, uint8 SubIdx, int32 AbortCode);
@@ -87,6 +90,10 @@ int ecx_readODlist(ecx_contextt *context, uint16 Slave, ec_ODlistt *pODlist);
 int ecx_readODdescription(ecx_contextt *context, uint16 Item, ec_ODlistt *pODlist);
 int ecx_readOEsingle(ecx_contextt *context, uint16 Item, uint8 SubI, ec_ODlistt *pODlist, ec_OElistt *pOElist);
 int ecx_readOE(ecx_contextt *context, uint16 Item, ec_ODlistt *pODlist, ec_OElistt *pOElist);
+int ecx_pdoentry_store(ecx_contextt *context, uint16 Slave, const ec_pdoentryt *pentry, int n);
+const ec_pdoentryt *ecx_pdoentry_get(ecx_contextt *context, uint16 slave, uint16 n);
+const ec_pdoentryt *ecx_pdoentry_find(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex);
+uint8 *ecx_pdoentry_ptr(ecx_contextt *context, const ec_pdoentryt *entry, uint8 *bit);
 
 #ifdef __cplusplus
 }
@@ -21,6 +21,8 @@
 #include "ethercatcoe.h"
 #include "ethercatsoe.h"
 #include "ethercatconfig.h"
+#include "ethercatlog.h"
+#include "ethercatindex.h"
 
 
 typedef struct
@@ -31,10 +33,12 @@ typedef struct
    uint16 slave;
 } ecx_mapt_t;
 
-ecx_mapt_t ecx_mapt[EC_MAX_MAPT];
-#if EC_MAX_MAPT > 1
-OSAL_THREAD_HANDLE ecx_threadh[EC_MAX_MAPT];
-#endif
+typedef struct
+{
+   int running;
+   ecx_contextt *context;
+   uint16 slave;
+} ecx_hookt_t;
 
 #ifdef EC_VER1
 /** Slave configuration structure */
@@ -69,10 +73,6 @@ typedef const struct
 #include "ethercatconfiglist.h"
 #endif
 
-/** standard SM0 flags configuration for mailbox slaves */
-#define EC_DEFAULTMBXSM0  0x00010026
-/** standard SM1 flags configuration for mailbox slaves */
-#define EC_DEFAULTMBXSM1  0x00010022
 /** standard SM0 flags configuration for digital output slaves */
 #define EC_DEFAULTDOSM0   0x00010044
 
@@ -100,6 +100,29 @@ int ec_findconfig( uint32 man, uint32 id)
 }
 #endif
 
+static int ecx_optslavecount(ecx_contextt *context)
+{
+   if (context->optslavecount == NULL)
+   {
+      return 0;
+   }
+   return *(context->optslavecount);
+}
+
+static ec_optslavet *ecx_find_optslave(ecx_contextt *context, uint16 slave)
+{
+   int opt;
+
+   for (opt = 0; opt < ecx_optslavecount(context); opt++)
+   {
+      if (context->optslavelist[opt].slave == slave)
+      {
+         return &(context->optslavelist[opt]);
+      }
+   }
+   return NULL;
+}
+
 void ecx_init_context(ecx_contextt *context)
 {
    int lp;
@@ -113,6 +136,21 @@ void ecx_init_context(ecx_contextt *context)
    {
       context->grouplist[lp].logstartaddr = lp << 16; /* default start address per group entry */
    }
+   /* retained PDO entries are rebuilt by the mapping */
+   if (context->pdoentrycount)
+   {
+      *(context->pdoentrycount) = 0;
+   }
+   if (context->pdohash)
+   {
+      memset(context->pdohash, 0xff, sizeof(uint16) * EC_PDOHASHSIZE);
+   }
+   /* optional slave reservations are kept, only their mapping state is reset */
+   for(lp = 0; lp < ecx_optslavecount(context); lp++)
+   {
+      context->optslavelist[lp].reserved = FALSE;
+      context->optslavelist[lp].mapped = FALSE;
+   }
 }
 
 int ecx_detect_slaves(ecx_contextt *context)
@@ -139,7 +177,7 @@ int ecx_detect_slaves(ecx_contextt *context)
       }
       else
       {
-         EC_PRINT("Error: too many slaves on network: num_slaves=%d, EC_MAXSLAVE=%d\n",
+         EC_LOG(context, EC_LOG_ERROR, EC_LOG_CONFIG, "Error: too many slaves on network: num_slaves=%d, EC_MAXSLAVE=%d\n",
                wkc, EC_MAXSLAVE);
          return -2;
       }
@@ -147,7 +185,10 @@ int ecx_detect_slaves(ecx_contextt *context)
    return wkc;
 }
 
-static void ecx_set_slaves_to_default(ecx_contextt *context)
+/** Reset all slaves to default register settings by broadcast writes.
+ * @param[in]  context = context struct
+ */
+void ecx_set_slaves_to_default(ecx_contextt *context)
 {
    uint8 b;
    uint16 w;
@@ -155,7 +196,8 @@ static void ecx_set_slaves_to_default(ecx_contextt *context)
    memset(&zbuf, 0x00, sizeof(zbuf));
    b = 0x00;
    ecx_BWR(context->port, 0x0000, ECT_REG_DLPORT      , sizeof(b) , &b, EC_TIMEOUTRET3);     /* deact loop manual */
-   w = htoes(0x0004);
+   /* DL and AL status changes are reported in the irpt field of all datagrams */
+   w = htoes(EC_EVENT_DLSTATUS | EC_EVENT_ALSTATUS);
    ecx_BWR(context->port, 0x0000, ECT_REG_IRQMASK     , sizeof(w) , &w, EC_TIMEOUTRET3);     /* set IRQ mask */
    ecx_BWR(context->port, 0x0000, ECT_REG_RXERR       , 8         , &zbuf, EC_TIMEOUTRET3);  /* reset CRC counters */
    ecx_BWR(context->port, 0x0000, ECT_REG_FMMU0       , 16 * 3    , &zbuf, EC_TIMEOUTRET3);  /* reset FMMU's */
@@ -177,6 +219,42 @@ static void ecx_set_slaves_to_default(ecx_contextt *context)
    ecx_BWR(context->port, 0x0000, ECT_REG_EEPCFG      , sizeof(b) , &b, EC_TIMEOUTRET3);     /* set Eeprom to master */
 }
 
+/** Per slave variant of ecx_set_slaves_to_default. Uses auto increment
+ * addressing so slaves in operation are not touched.
+ * @param[in]  context = context struct
+ * @param[in]  slave   = slave position on the network
+ */
+static void ecx_set_slave_to_default(ecx_contextt *context, uint16 slave)
+{
+   uint8 b;
+   uint16 w, ADPh;
+   uint8 zbuf[64];
+   memset(&zbuf, 0x00, sizeof(zbuf));
+   ADPh = (uint16)(1 - slave);
+   b = 0x00;
+   ecx_APWR(context->port, ADPh, ECT_REG_DLPORT      , sizeof(b) , &b, EC_TIMEOUTRET3);     /* deact loop manual */
+   w = htoes(EC_EVENT_DLSTATUS | EC_EVENT_ALSTATUS);
+   ecx_APWR(context->port, ADPh, ECT_REG_IRQMASK     , sizeof(w) , &w, EC_TIMEOUTRET3);     /* set IRQ mask */
+   ecx_APWR(context->port, ADPh, ECT_REG_RXERR       , 8         , &zbuf, EC_TIMEOUTRET3);  /* reset CRC counters */
+   ecx_APWR(context->port, ADPh, ECT_REG_FMMU0       , 16 * 3    , &zbuf, EC_TIMEOUTRET3);  /* reset FMMU's */
+   ecx_APWR(context->port, ADPh, ECT_REG_SM0         , 8 * 4     , &zbuf, EC_TIMEOUTRET3);  /* reset SyncM */
+   b = 0x00;
+   ecx_APWR(context->port, ADPh, ECT_REG_DCSYNCACT   , sizeof(b) , &b, EC_TIMEOUTRET3);     /* reset activation register */
+   ecx_APWR(context->port, ADPh, ECT_REG_DCSYSTIME   , 4         , &zbuf, EC_TIMEOUTRET3);  /* reset system time+ofs */
+   w = htoes(0x1000);
+   ecx_APWR(context->port, ADPh, ECT_REG_DCSPEEDCNT  , sizeof(w) , &w, EC_TIMEOUTRET3);     /* DC speedstart */
+   w = htoes(0x0c00);
+   ecx_APWR(context->port, ADPh, ECT_REG_DCTIMEFILT  , sizeof(w) , &w, EC_TIMEOUTRET3);     /* DC filt expr */
+   b = 0x00;
+   ecx_APWR(context->port, ADPh, ECT_REG_DLALIAS     , sizeof(b) , &b, EC_TIMEOUTRET3);     /* Ignore Alias register */
+   b = EC_STATE_INIT | EC_STATE_ACK;
+   ecx_APWR(context->port, ADPh, ECT_REG_ALCTL       , sizeof(b) , &b, EC_TIMEOUTRET3);     /* Reset slave to Init */
+   b = 2;
+   ecx_APWR(context->port, ADPh, ECT_REG_EEPCFG      , sizeof(b) , &b, EC_TIMEOUTRET3);     /* force Eeprom from PDI */
+   b = 0;
+   ecx_APWR(context->port, ADPh, ECT_REG_EEPCFG      , sizeof(b) , &b, EC_TIMEOUTRET3);     /* set Eeprom to master */
+}
+
 #ifdef EC_VER1
 static int ecx_config_from_table(ecx_contextt *context, uint16 slave)
 {
@@ -289,313 +367,447 @@ static int ecx_lookup_prev_sii(ecx_contextt *context, uint16 slave)
          context->slavelist[slave].FMMU1func = context->slavelist[i].FMMU1func;
          context->slavelist[slave].FMMU2func = context->slavelist[i].FMMU2func;
          context->slavelist[slave].FMMU3func = context->slavelist[i].FMMU3func;
-         EC_PRINT("Copy SII slave %d from %d.\n", slave, i);
+         EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "Copy SII slave %d from %d.\n", slave, i);
          return 1;
       }
    }
    return 0;
 }
 
-#undef EC_PRINT
-#define EC_PRINT OSEE_PRINT
+/** Read DL status and port descriptor of a slave and derive its topology
+ * (number of active links) and active port mask.
+ * @param[in]  context = context struct
+ * @param[in]  slave   = slave number
+ */
+static void ecx_config_topology(ecx_contextt *context, uint16 slave)
+{
+   uint16 configadr, topology, val16;
+   uint8 b, h;
+
+   configadr = context->slavelist[slave].configadr;
+   topology = ecx_FPRDw(context->port, configadr, ECT_REG_DLSTAT, EC_TIMEOUTRET3); /* extract topology from DL status */
+   topology = etohs(topology);
+   h = 0;
+   b = 0;
+   if ((topology & 0x0300) == 0x0200) /* port0 open and communication established */
+   {
+      h++;
+      b |= 0x01;
+   }
+   if ((topology & 0x0c00) == 0x0800) /* port1 open and communication established */
+   {
+      h++;
+      b |= 0x02;
+   }
+   if ((topology & 0x3000) == 0x2000) /* port2 open and communication established */
+   {
+      h++;
+      b |= 0x04;
+   }
+   if ((topology & 0xc000) == 0x8000) /* port3 open and communication established */
+   {
+      h++;
+      b |= 0x08;
+   }
+   /* ptype = Physical type*/
+   val16 = ecx_FPRDw(context->port, configadr, ECT_REG_PORTDES, EC_TIMEOUTRET3);
+   context->slavelist[slave].ptype = LO_BYTE(etohs(val16));
+   context->slavelist[slave].topology = h;
+   context->slavelist[slave].activeports = b;
+}
 
-/** Enumerate and init all slaves.
+/** Read DC support and topology of a slave and search its parent. The slaves
+ * before it must already be done.
+ * @param[in]  context = context struct
+ * @param[in]  slave   = slave number
+ */
+void ecx_config_links(ecx_contextt *context, uint16 slave)
+{
+   uint16 configadr, topology, val16;
+   int16 topoc, slavec;
+
+   configadr = context->slavelist[slave].configadr;
+   val16 = ecx_FPRDw(context->port, configadr, ECT_REG_ESCSUP, EC_TIMEOUTRET3);
+   if ((etohs(val16) & 0x04) > 0)  /* Support DC? */
+   {
+      context->slavelist[slave].hasdc = TRUE;
+   }
+   else
+   {
+      context->slavelist[slave].hasdc = FALSE;
+   }
+   ecx_config_topology(context, slave);
+   /* 0=no links, not possible             */
+   /* 1=1 link  , end of line              */
+   /* 2=2 links , one before and one after */
+   /* 3=3 links , split point              */
+   /* 4=4 links , cross point              */
+   /* search for parent */
+   context->slavelist[slave].parent = 0; /* parent is master */
+   if (slave > 1)
+   {
+      topoc = 0;
+      slavec = slave - 1;
+      do
+      {
+         topology = context->slavelist[slavec].topology;
+         if (topology == 1)
+         {
+            topoc--; /* endpoint found */
+         }
+         if (topology == 3)
+         {
+            topoc++; /* split found */
+         }
+         if (topology == 4)
+         {
+            topoc += 2; /* cross found */
+         }
+         if (((topoc >= 0) && (topology > 1)) ||
+             (slavec == 1)) /* parent found */
+         {
+            context->slavelist[slave].parent = slavec;
+            slavec = 1;
+         }
+         slavec--;
+      }
+      while (slavec > 0);
+   }
+}
+
+/** Enumerate and init a consecutive range of slaves. Slaves before first
+ * must already be initialised, they are used as candidates in the parent search.
  *
  * @param[in] context      = context struct
+ * @param[in] first        = first slave to init
+ * @param[in] last         = last slave to init
  * @param[in] usetable     = TRUE when using configtable to init slaves, FALSE otherwise
- * @return Workcounter of slave discover datagram = number of slaves found
  */
-int ecx_config_init(ecx_contextt *context, uint8 usetable)
+static void ecx_config_init_slaves(ecx_contextt *context, uint16 first, uint16 last, uint8 usetable)
 {
    uint16 slave, ADPh, configadr, ssigen;
-   uint16 topology, estat;
-   int16 topoc, slavec, aliasadr;
-   uint8 b,h;
+   uint16 estat;
+   int16 aliasadr;
+   uint8 b;
    uint8 SMc;
    uint32 eedat;
-   int wkc, cindex, nSM;
+   int cindex, nSM;
    uint16 val16;
+   ec_eepromSMt eepSM;
+   ec_eepromFMMUt eepFMMU;
 
-   EC_PRINT("ec_config_init %d\n",usetable);
-   ecx_init_context(context);
-   wkc = ecx_detect_slaves(context);
-   if (wkc > 0)
+   for (slave = first; slave <= last; slave++)
    {
-      ecx_set_slaves_to_default(context);
-      for (slave = 1; slave <= *(context->slavecount); slave++)
+      ecx_mbxlock_init(context, slave);
+      ADPh = (uint16)(1 - slave);
+      val16 = ecx_APRDw(context->port, ADPh, ECT_REG_PDICTL, EC_TIMEOUTRET3); /* read interface type of slave */
+      context->slavelist[slave].Itype = etohs(val16);
+      /* a node offset is used to improve readability of network frames */
+      /* this has no impact on the number of addressable slaves (auto wrap around) */
+      ecx_APWRw(context->port, ADPh, ECT_REG_STADR, htoes(slave + EC_NODEOFFSET) , EC_TIMEOUTRET3); /* set node address of slave */
+      if (slave == 1)
       {
-         ADPh = (uint16)(1 - slave);
-         val16 = ecx_APRDw(context->port, ADPh, ECT_REG_PDICTL, EC_TIMEOUTRET3); /* read interface type of slave */
-         context->slavelist[slave].Itype = etohs(val16);
-         /* a node offset is used to improve readability of network frames */
-         /* this has no impact on the number of addressable slaves (auto wrap around) */
-         ecx_APWRw(context->port, ADPh, ECT_REG_STADR, htoes(slave + EC_NODEOFFSET) , EC_TIMEOUTRET3); /* set node address of slave */
-         if (slave == 1)
-         {
-            b = 1; /* kill non ecat frames for first slave */
-         }
-         else
-         {
-            b = 0; /* pass all frames for following slaves */
-         }
-         ecx_APWRw(context->port, ADPh, ECT_REG_DLCTL, htoes(b), EC_TIMEOUTRET3); /* set non ecat frame behaviour */
-         configadr = ecx_APRDw(context->port, ADPh, ECT_REG_STADR, EC_TIMEOUTRET3);
-         configadr = etohs(configadr);
-         context->slavelist[slave].configadr = configadr;
-         ecx_FPRD(context->port, configadr, ECT_REG_ALIAS, sizeof(aliasadr), &aliasadr, EC_TIMEOUTRET3);
-         context->slavelist[slave].aliasadr = etohs(aliasadr);
-         ecx_FPRD(context->port, configadr, ECT_REG_EEPSTAT, sizeof(estat), &estat, EC_TIMEOUTRET3);
-         estat = etohs(estat);
-         if (estat & EC_ESTAT_R64) /* check if slave can read 8 byte chunks */
-         {
-            context->slavelist[slave].eep_8byte = 1;
-         }
-         ecx_readeeprom1(context, slave, ECT_SII_MANUF); /* Manuf */
+         b = 1; /* kill non ecat frames for first slave */
       }
-      for (slave = 1; slave <= *(context->slavecount); slave++)
+      else
       {
-         eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* Manuf */
-         context->slavelist[slave].eep_man = etohl(eedat);
-         ecx_readeeprom1(context, slave, ECT_SII_ID); /* ID */
+         b = 0; /* pass all frames for following slaves */
       }
-      for (slave = 1; slave <= *(context->slavecount); slave++)
+      ecx_APWRw(context->port, ADPh, ECT_REG_DLCTL, htoes(b), EC_TIMEOUTRET3); /* set non ecat frame behaviour */
+      configadr = ecx_APRDw(context->port, ADPh, ECT_REG_STADR, EC_TIMEOUTRET3);
+      configadr = etohs(configadr);
+      context->slavelist[slave].configadr = configadr;
+      ecx_FPRD(context->port, configadr, ECT_REG_ALIAS, sizeof(aliasadr), &aliasadr, EC_TIMEOUTRET3);
+      context->slavelist[slave].aliasadr = etohs(aliasadr);
+      ecx_FPRD(context->port, configadr, ECT_REG_EEPSTAT, sizeof(estat), &estat, EC_TIMEOUTRET3);
+      estat = etohs(estat);
+      if (estat & EC_ESTAT_R64) /* check if slave can read 8 byte chunks */
       {
-         eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* ID */
-         context->slavelist[slave].eep_id = etohl(eedat);
-         ecx_readeeprom1(context, slave, ECT_SII_REV); /* revision */
+         context->slavelist[slave].eep_8byte = 1;
       }
-      for (slave = 1; slave <= *(context->slavecount); slave++)
+      ecx_readeeprom1(context, slave, ECT_SII_MANUF); /* Manuf */
+   }
+   for (slave = first; slave <= last; slave++)
+   {
+      eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* Manuf */
+      context->slavelist[slave].eep_man = etohl(eedat);
+      ecx_readeeprom1(context, slave, ECT_SII_ID); /* ID */
+   }
+   for (slave = first; slave <= last; slave++)
+   {
+      eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* ID */
+      context->slavelist[slave].eep_id = etohl(eedat);
+      ecx_readeeprom1(context, slave, ECT_SII_REV); /* revision */
+   }
+   for (slave = first; slave <= last; slave++)
+   {
+      eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* revision */
+      context->slavelist[slave].eep_rev = etohl(eedat);
+      ecx_readeeprom1(context, slave, ECT_SII_SERIAL); /* serial number */
+   }
+   for (slave = first; slave <= last; slave++)
+   {
+      eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* serial number */
+      context->slavelist[slave].eep_ser = etohl(eedat);
+      ecx_readeeprom1(context, slave, ECT_SII_RXMBXADR); /* write mailbox address + mailboxsize */
+   }
+   for (slave = first; slave <= last; slave++)
+   {
+      eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* write mailbox address and mailboxsize */
+      context->slavelist[slave].mbx_wo = (uint16)LO_WORD(etohl(eedat));
+      context->slavelist[slave].mbx_l = (uint16)HI_WORD(etohl(eedat));
+      if (context->slavelist[slave].mbx_l > 0)
       {
-         eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* revision */
-         context->slavelist[slave].eep_rev = etohl(eedat);
-         ecx_readeeprom1(context, slave, ECT_SII_RXMBXADR); /* write mailbox address + mailboxsize */
+         ecx_readeeprom1(context, slave, ECT_SII_TXMBXADR); /* read mailbox offset */
       }
-      for (slave = 1; slave <= *(context->slavecount); slave++)
+   }
+   for (slave = first; slave <= last; slave++)
+   {
+      if (context->slavelist[slave].mbx_l > 0)
       {
-         eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* write mailbox address and mailboxsize */
-         context->slavelist[slave].mbx_wo = (uint16)LO_WORD(etohl(eedat));
-         context->slavelist[slave].mbx_l = (uint16)HI_WORD(etohl(eedat));
-         if (context->slavelist[slave].mbx_l > 0)
+         eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* read mailbox offset */
+         context->slavelist[slave].mbx_ro = (uint16)LO_WORD(etohl(eedat)); /* read mailbox offset */
+         context->slavelist[slave].mbx_rl = (uint16)HI_WORD(etohl(eedat)); /*read mailbox length */
+         if (context->slavelist[slave].mbx_rl == 0)
          {
-            ecx_readeeprom1(context, slave, ECT_SII_TXMBXADR); /* read mailbox offset */
+            context->slavelist[slave].mbx_rl = context->slavelist[slave].mbx_l;
          }
+         ecx_readeeprom1(context, slave, ECT_SII_MBXPROTO);
       }
-      for (slave = 1; slave <= *(context->slavecount); slave++)
+      configadr = context->slavelist[slave].configadr;
+      ecx_config_links(context, slave);
+      (void)ecx_statecheck(context, slave, EC_STATE_INIT,  EC_TIMEOUTSTATE); //* check state change Init */
+
+      /* set default mailbox configuration if slave has mailbox */
+      if (context->slavelist[slave].mbx_l>0)
+      {
+         context->slavelist[slave].SMtype[0] = 1;
+         context->slavelist[slave].SMtype[1] = 2;
+         context->slavelist[slave].SMtype[2] = 3;
+         context->slavelist[slave].SMtype[3] = 4;
+         context->slavelist[slave].SM[0].StartAddr = htoes(context->slavelist[slave].mbx_wo);
+         context->slavelist[slave].SM[0].SMlength = htoes(context->slavelist[slave].mbx_l);
+         context->slavelist[slave].SM[0].SMflags = htoel(EC_DEFAULTMBXSM0);
+         context->slavelist[slave].SM[1].StartAddr = htoes(context->slavelist[slave].mbx_ro);
+         context->slavelist[slave].SM[1].SMlength = htoes(context->slavelist[slave].mbx_rl);
+         context->slavelist[slave].SM[1].SMflags = htoel(EC_DEFAULTMBXSM1);
+         eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP);
+         context->slavelist[slave].mbx_proto = etohl(eedat);
+      }
+      cindex = 0;
+      /* use configuration table ? */
+      if (usetable == 1)
       {
-         if (context->slavelist[slave].mbx_l > 0)
+         cindex = ecx_config_from_table(context, slave);
+      }
+      /* slave not in configuration table, find out via SII */
+      if (!cindex && !ecx_lookup_prev_sii(context, slave))
+      {
+         ssigen = ecx_siifind(context, slave, ECT_SII_GENERAL);
+         /* SII general section */
+         if (ssigen)
          {
-            eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* read mailbox offset */
-            context->slavelist[slave].mbx_ro = (uint16)LO_WORD(etohl(eedat)); /* read mailbox offset */
-            context->slavelist[slave].mbx_rl = (uint16)HI_WORD(etohl(eedat)); /*read mailbox length */
-            if (context->slavelist[slave].mbx_rl == 0)
+            context->slavelist[slave].CoEdetails = ecx_siigetbyte(context, slave, ssigen + 0x07);
+            context->slavelist[slave].FoEdetails = ecx_siigetbyte(context, slave, ssigen + 0x08);
+            context->slavelist[slave].EoEdetails = ecx_siigetbyte(context, slave, ssigen + 0x09);
+            context->slavelist[slave].SoEdetails = ecx_siigetbyte(context, slave, ssigen + 0x0a);
+            if((ecx_siigetbyte(context, slave, ssigen + 0x0d) & 0x02) > 0)
             {
-               context->slavelist[slave].mbx_rl = context->slavelist[slave].mbx_l;
+               context->slavelist[slave].blockLRW = 1;
+               context->slavelist[0].blockLRW++;
             }
-            ecx_readeeprom1(context, slave, ECT_SII_MBXPROTO);
+            context->slavelist[slave].Ebuscurrent = ecx_siigetbyte(context, slave, ssigen + 0x0e);
+            context->slavelist[slave].Ebuscurrent += ecx_siigetbyte(context, slave, ssigen + 0x0f) << 8;
+            context->slavelist[0].Ebuscurrent += context->slavelist[slave].Ebuscurrent;
          }
-         configadr = context->slavelist[slave].configadr;
-         val16 = ecx_FPRDw(context->port, configadr, ECT_REG_ESCSUP, EC_TIMEOUTRET3);
-         if ((etohs(val16) & 0x04) > 0)  /* Support DC? */
+         /* SII strings section */
+         if (ecx_siifind(context, slave, ECT_SII_STRING) > 0)
          {
-            context->slavelist[slave].hasdc = TRUE;
+            ecx_siistring(context, context->slavelist[slave].name, slave, 1);
          }
+         /* no name for slave found, use constructed name */
          else
          {
-            context->slavelist[slave].hasdc = FALSE;
-         }
-         topology = ecx_FPRDw(context->port, configadr, ECT_REG_DLSTAT, EC_TIMEOUTRET3); /* extract topology from DL status */
-         topology = etohs(topology);
-         h = 0;
-         b = 0;
-         if ((topology & 0x0300) == 0x0200) /* port0 open and communication established */
-         {
-            h++;
-            b |= 0x01;
-         }
-         if ((topology & 0x0c00) == 0x0800) /* port1 open and communication established */
-         {
-            h++;
-            b |= 0x02;
+            sprintf(context->slavelist[slave].name, "? M:%8.8x I:%8.8x",
+                    (unsigned int)context->slavelist[slave].eep_man,
+                    (unsigned int)context->slavelist[slave].eep_id);
          }
-         if ((topology & 0x3000) == 0x2000) /* port2 open and communication established */
+         /* SII SM section */
+         nSM = ecx_siiSM(context, slave, &eepSM);
+         if (nSM>0)
          {
-            h++;
-            b |= 0x04;
-         }
-         if ((topology & 0xc000) == 0x8000) /* port3 open and communication established */
-         {
-            h++;
-            b |= 0x08;
-         }
-         /* ptype = Physical type*/
-         val16 = ecx_FPRDw(context->port, configadr, ECT_REG_PORTDES, EC_TIMEOUTRET3);
-         context->slavelist[slave].ptype = LO_BYTE(etohs(val16));
-         context->slavelist[slave].topology = h;
-         context->slavelist[slave].activeports = b;
-         /* 0=no links, not possible             */
-         /* 1=1 link  , end of line              */
-         /* 2=2 links , one before and one after */
-         /* 3=3 links , split point              */
-         /* 4=4 links , cross point              */
-         /* search for parent */
-         context->slavelist[slave].parent = 0; /* parent is master */
-         if (slave > 1)
-         {
-            topoc = 0;
-            slavec = slave - 1;
-            do
+            context->slavelist[slave].SM[0].StartAddr = htoes(eepSM.PhStart);
+            context->slavelist[slave].SM[0].SMlength = htoes(eepSM.Plength);
+            context->slavelist[slave].SM[0].SMflags =
+               htoel((eepSM.Creg) + (eepSM.Activate << 16));
+            SMc = 1;
+            while ((SMc < EC_MAXSM) &&  ecx_siiSMnext(context, slave, &eepSM, SMc))
             {
-               topology = context->slavelist[slavec].topology;
-               if (topology == 1)
-               {
-                  topoc--; /* endpoint found */
-               }
-               if (topology == 3)
-               {
-                  topoc++; /* split found */
-               }
-               if (topology == 4)
-               {
-                  topoc += 2; /* cross found */
-               }
-               if (((topoc >= 0) && (topology > 1)) ||
-                   (slavec == 1)) /* parent found */
-               {
-                  context->slavelist[slave].parent = slavec;
-                  slavec = 1;
-               }
-               slavec--;
+               context->slavelist[slave].SM[SMc].StartAddr = htoes(eepSM.PhStart);
+               context->slavelist[slave].SM[SMc].SMlength = htoes(eepSM.Plength);
+               context->slavelist[slave].SM[SMc].SMflags =
+                  htoel((eepSM.Creg) + (eepSM.Activate << 16));
+               SMc++;
             }
-            while (slavec > 0);
          }
-         (void)ecx_statecheck(context, slave, EC_STATE_INIT,  EC_TIMEOUTSTATE); //* check state change Init */
-
-         /* set default mailbox configuration if slave has mailbox */
-         if (context->slavelist[slave].mbx_l>0)
+         /* SII FMMU section */
+         if (ecx_siiFMMU(context, slave, &eepFMMU))
          {
-            context->slavelist[slave].SMtype[0] = 1;
-            context->slavelist[slave].SMtype[1] = 2;
-            context->slavelist[slave].SMtype[2] = 3;
-            context->slavelist[slave].SMtype[3] = 4;
-            context->slavelist[slave].SM[0].StartAddr = htoes(context->slavelist[slave].mbx_wo);
-            context->slavelist[slave].SM[0].SMlength = htoes(context->slavelist[slave].mbx_l);
-            context->slavelist[slave].SM[0].SMflags = htoel(EC_DEFAULTMBXSM0);
-            context->slavelist[slave].SM[1].StartAddr = htoes(context->slavelist[slave].mbx_ro);
-            context->slavelist[slave].SM[1].SMlength = htoes(context->slavelist[slave].mbx_rl);
-            context->slavelist[slave].SM[1].SMflags = htoel(EC_DEFAULTMBXSM1);
-            eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP);
-            context->slavelist[slave].mbx_proto = etohl(eedat);
-         }
-         cindex = 0;
-         /* use configuration table ? */
-         if (usetable == 1)
-         {
-            cindex = ecx_config_from_table(context, slave);
-         }
-         /* slave not in configuration table, find out via SII */
-         if (!cindex && !ecx_lookup_prev_sii(context, slave))
-         {
-            ssigen = ecx_siifind(context, slave, ECT_SII_GENERAL);
-            /* SII general section */
-            if (ssigen)
+            if (eepFMMU.FMMU0 !=0xff)
             {
-               context->slavelist[slave].CoEdetails = ecx_siigetbyte(context, slave, ssigen + 0x07);
-               context->slavelist[slave].FoEdetails = ecx_siigetbyte(context, slave, ssigen + 0x08);
-               context->slavelist[slave].EoEdetails = ecx_siigetbyte(context, slave, ssigen + 0x09);
-               context->slavelist[slave].SoEdetails = ecx_siigetbyte(context, slave, ssigen + 0x0a);
-               if((ecx_siigetbyte(context, slave, ssigen + 0x0d) & 0x02) > 0)
-               {
-                  context->slavelist[slave].blockLRW = 1;
-                  context->slavelist[0].blockLRW++;
-               }
-               context->slavelist[slave].Ebuscurrent = ecx_siigetbyte(context, slave, ssigen + 0x0e);
-               context->slavelist[slave].Ebuscurrent += ecx_siigetbyte(context, slave, ssigen + 0x0f) << 8;
-               context->slavelist[0].Ebuscurrent += context->slavelist[slave].Ebuscurrent;
+               context->slavelist[slave].FMMU0func = eepFMMU.FMMU0;
             }
-            /* SII strings section */
-            if (ecx_siifind(context, slave, ECT_SII_STRING) > 0)
+            if (eepFMMU.FMMU1 !=0xff)
             {
-               ecx_siistring(context, context->slavelist[slave].name, slave, 1);
+               context->slavelist[slave].FMMU1func = eepFMMU.FMMU1;
             }
-            /* no name for slave found, use constructed name */
-            else
+            if (eepFMMU.FMMU2 !=0xff)
             {
-               sprintf(context->slavelist[slave].name, "? M:%8.8x I:%8.8x",
-                       (unsigned int)context->slavelist[slave].eep_man,
-                       (unsigned int)context->slavelist[slave].eep_id);
+               context->slavelist[slave].FMMU2func = eepFMMU.FMMU2;
             }
-            /* SII SM section */
-            nSM = ecx_siiSM(context, slave, context->eepSM);
-            if (nSM>0)
+            if (eepFMMU.FMMU3 !=0xff)
             {
-               context->slavelist[slave].SM[0].StartAddr = htoes(context->eepSM->PhStart);
-               context->slavelist[slave].SM[0].SMlength = htoes(context->eepSM->Plength);
-               context->slavelist[slave].SM[0].SMflags =
-                  htoel((context->eepSM->Creg) + (context->eepSM->Activate << 16));
-               SMc = 1;
-               while ((SMc < EC_MAXSM) &&  ecx_siiSMnext(context, slave, context->eepSM, SMc))
-               {
-                  context->slavelist[slave].SM[SMc].StartAddr = htoes(context->eepSM->PhStart);
-                  context->slavelist[slave].SM[SMc].SMlength = htoes(context->eepSM->Plength);
-                  context->slavelist[slave].SM[SMc].SMflags =
-                     htoel((context->eepSM->Creg) + (context->eepSM->Activate << 16));
-                  SMc++;
-               }
-            }
-            /* SII FMMU section */
-            if (ecx_siiFMMU(context, slave, context->eepFMMU))
-            {
-               if (context->eepFMMU->FMMU0 !=0xff)
-               {
-                  context->slavelist[slave].FMMU0func = context->eepFMMU->FMMU0;
-               }
-               if (context->eepFMMU->FMMU1 !=0xff)
-               {
-                  context->slavelist[slave].FMMU1func = context->eepFMMU->FMMU1;
-               }
-               if (context->eepFMMU->FMMU2 !=0xff)
-               {
-                  context->slavelist[slave].FMMU2func = context->eepFMMU->FMMU2;
-               }
-               if (context->eepFMMU->FMMU3 !=0xff)
-               {
-                  context->slavelist[slave].FMMU3func = context->eepFMMU->FMMU3;
-               }
+               context->slavelist[slave].FMMU3func = eepFMMU.FMMU3;
             }
          }
+      }
 
-         if (context->slavelist[slave].mbx_l > 0)
+      if (context->slavelist[slave].mbx_l > 0)
+      {
+         if (context->slavelist[slave].SM[0].StartAddr == 0x0000) /* should never happen */
          {
-            if (context->slavelist[slave].SM[0].StartAddr == 0x0000) /* should never happen */
-            {
-               EC_PRINT("Slave %d has no proper mailbox in configuration, try default.\n", slave);
-               context->slavelist[slave].SM[0].StartAddr = htoes(0x1000);
-               context->slavelist[slave].SM[0].SMlength = htoes(0x0080);
-               context->slavelist[slave].SM[0].SMflags = htoel(EC_DEFAULTMBXSM0);
-               context->slavelist[slave].SMtype[0] = 1;
-            }
-            if (context->slavelist[slave].SM[1].StartAddr == 0x0000) /* should never happen */
-            {
-               EC_PRINT("Slave %d has no proper mailbox out configuration, try default.\n", slave);
-               context->slavelist[slave].SM[1].StartAddr = htoes(0x1080);
-               context->slavelist[slave].SM[1].SMlength = htoes(0x0080);
-               context->slavelist[slave].SM[1].SMflags = htoel(EC_DEFAULTMBXSM1);
-               context->slavelist[slave].SMtype[1] = 2;
-            }
-            /* program SM0 mailbox in and SM1 mailbox out for slave */
-            /* writing both SM in one datagram will solve timing issue in old NETX */
-            ecx_FPWR(context->port, configadr, ECT_REG_SM0, sizeof(ec_smt) * 2,
-               &(context->slavelist[slave].SM[0]), EC_TIMEOUTRET3);
+            EC_LOG(context, EC_LOG_WARNING, EC_LOG_CONFIG, "Slave %d has no proper mailbox in configuration, try default.\n", slave);
+            context->slavelist[slave].SM[0].StartAddr = htoes(0x1000);
+            context->slavelist[slave].SM[0].SMlength = htoes(0x0080);
+            context->slavelist[slave].SM[0].SMflags = htoel(EC_DEFAULTMBXSM0);
+            context->slavelist[slave].SMtype[0] = 1;
+         }
+         if (context->slavelist[slave].SM[1].StartAddr == 0x0000) /* should never happen */
+         {
+            EC_LOG(context, EC_LOG_WARNING, EC_LOG_CONFIG, "Slave %d has no proper mailbox out configuration, try default.\n", slave);
+            context->slavelist[slave].SM[1].StartAddr = htoes(0x1080);
+            context->slavelist[slave].SM[1].SMlength = htoes(0x0080);
+            context->slavelist[slave].SM[1].SMflags = htoel(EC_DEFAULTMBXSM1);
+            context->slavelist[slave].SMtype[1] = 2;
          }
-         /* some slaves need eeprom available to PDI in init->preop transition */
-         ecx_eeprom2pdi(context, slave);
-         /* request pre_op for slave */
-         ecx_FPWRw(context->port, configadr, ECT_REG_ALCTL, htoes(EC_STATE_PRE_OP | EC_STATE_ACK) , EC_TIMEOUTRET3); /* set preop status */
+         /* program SM0 mailbox in and SM1 mailbox out for slave */
+         /* writing both SM in one datagram will solve timing issue in old NETX */
+         ecx_FPWR(context->port, configadr, ECT_REG_SM0, sizeof(ec_smt) * 2,
+            &(context->slavelist[slave].SM[0]), EC_TIMEOUTRET3);
       }
+      /* some slaves need eeprom available to PDI in init->preop transition */
+      ecx_eeprom2pdi(context, slave);
+      /* request pre_op for slave */
+      ecx_FPWRw(context->port, configadr, ECT_REG_ALCTL, htoes(EC_STATE_PRE_OP | EC_STATE_ACK) , EC_TIMEOUTRET3); /* set preop status */
+   }
+}
+
+/** Enumerate and init all slaves.
+ *
+ * @param[in] context      = context struct
+ * @param[in] usetable     = TRUE when using configtable to init slaves, FALSE otherwise
+ * @return Workcounter of slave discover datagram = number of slaves found
+ */
+int ecx_config_init(ecx_contextt *context, uint8 usetable)
+{
+   int wkc;
+
+   EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "ec_config_init %d\n",usetable);
+   ecx_init_context(context);
+   wkc = ecx_detect_slaves(context);
+   if (wkc > 0)
+   {
+      ecx_set_slaves_to_default(context);
+      ecx_config_init_slaves(context, 1, *(context->slavecount), usetable);
    }
+   ecx_slaveindex_update(context);
    return wkc;
 }
 
+/** Enumerate and init slaves appended to the network after ecx_config_init.
+ * Only slaves beyond the current slave count are addressed, slaves already in
+ * operation keep running and no broadcast writes are issued.
+ *
+ * @param[in] context      = context struct
+ * @param[in] usetable     = TRUE when using configtable to init slaves, FALSE otherwise
+ * @return number of new slaves found, 0 if none, -1 if the position of
+ * known slaves changed, -2 if too many slaves
+ */
+static int ecx_config_init_appended(ecx_contextt *context, uint8 usetable)
+{
+   uint16 slave, first, w, configadr;
+   int wkc;
+
+   wkc = ecx_BRD(context->port, 0x0000, ECT_REG_TYPE, sizeof(w), &w, EC_TIMEOUTSAFE);  /* detect number of slaves */
+   if (wkc <= *(context->slavecount))
+   {
+      return 0;
+   }
+   if ((wkc >= EC_MAXSLAVE) || (wkc >= context->maxslave))
+   {
+      EC_LOG(context, EC_LOG_ERROR, EC_LOG_CONFIG, "Error: too many slaves on network: num_slaves=%d, EC_MAXSLAVE=%d\n",
+            wkc, EC_MAXSLAVE);
+      return -2;
+   }
+   /* new slaves must be appended, known slaves keep their position */
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      configadr = ecx_APRDw(context->port, (uint16)(1 - slave), ECT_REG_STADR, EC_TIMEOUTRET3);
+      if (etohs(configadr) != context->slavelist[slave].configadr)
+      {
+         EC_LOG(context, EC_LOG_ERROR, EC_LOG_RECOVER, "Error: slave %d moved, online configuration not possible\n", slave);
+         return -1;
+      }
+   }
+   first = *(context->slavecount) + 1;
+   for (slave = first; slave <= wkc; slave++)
+   {
+      memset(&(context->slavelist[slave]), 0x00, sizeof(ec_slavet));
+      ecx_set_slave_to_default(context, slave);
+   }
+   /* links of known slaves changed, needed for parent search and DC */
+   for (slave = 1; slave < first; slave++)
+   {
+      ecx_config_topology(context, slave);
+   }
+   *(context->slavecount) = wkc;
+   ecx_config_init_slaves(context, first, wkc, usetable);
+   ecx_slaveindex_update(context);
+   return wkc - first + 1;
+}
+
+/** Enumerate and init slaves that were connected to the network after
+ * ecx_config_init and put them in a new group. Slaves already in operation
+ * keep running. The new group is then brought up with ecx_configdc_group,
+ * ecx_config_map_group with a separate IOmap and per slave state requests.
+ *
+ * @param[in] context      = context struct
+ * @param[in] group        = group to assign the new slaves to, must not be 0
+ * @param[in] usetable     = TRUE when using configtable to init slaves, FALSE otherwise
+ * @return number of new slaves found, 0 if none, -1 if the position of
+ * known slaves changed, -2 if too many slaves, -3 if group is 0 or out of range
+ */
+int ecx_config_init_group(ecx_contextt *context, uint8 group, uint8 usetable)
+{
+   uint16 slave;
+   int n;
+
+   if ((group == 0) || (group >= context->maxgroup))
+   {
+      return -3;
+   }
+   EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "ec_config_init_group %d %d\n", group, usetable);
+   n = ecx_config_init_appended(context, usetable);
+   if (n > 0)
+   {
+      for (slave = *(context->slavecount) - n + 1; slave <= *(context->slavecount); slave++)
+      {
+         context->slavelist[slave].group = group;
+      }
+   }
+   return n;
+}
+
 /* If slave has SII mapping and same slave ID done before, use previous mapping.
  * This is safe because SII mapping is constant for same slave ID.
  */
@@ -623,30 +835,25 @@ static int ecx_lookup_mapping(ecx_contextt *context, uint16 slave, int *Osize, i
          *Isize = context->slavelist[i].Ibits;
          context->slavelist[slave].Obits = *Osize;
          context->slavelist[slave].Ibits = *Isize;
-         EC_PRINT("Copy mapping slave %d from %d.\n", slave, i);
+         EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "Copy mapping slave %d from %d.\n", slave, i);
          return 1;
       }
    }
    return 0;
 }
 
-static int ecx_map_coe_soe(ecx_contextt *context, uint16 slave, int thread_n)
+static int ecx_map_coe_soe(ecx_contextt *context, uint16 slave)
 {
    int Isize, Osize;
    int rval;
 
    ecx_statecheck(context, slave, EC_STATE_PRE_OP, EC_TIMEOUTSTATE); /* check state change pre-op */
 
-   EC_PRINT(" >Slave %d, configadr %x, state %2.2x\n",
+   EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, " >Slave %d, configadr %x, state %2.2x\n",
             slave, context->slavelist[slave].configadr, context->slavelist[slave].state);
 
-   /* execute special slave configuration hook Pre-Op to Safe-OP */
-   if(context->slavelist[slave].PO2SOconfig) /* only if registered */
-   {
-      context->slavelist[slave].PO2SOconfig(slave);
-   }
-   /* if slave not found in configlist find IO mapping in slave self */
-   if (!context->slavelist[slave].configindex)
+   /* if slave not found in configlist or ENI find IO mapping in slave self */
+   if (!context->slavelist[slave].configindex && !context->slavelist[slave].eniindex)
    {
       Isize = 0;
       Osize = 0;
@@ -656,14 +863,14 @@ static int ecx_map_coe_soe(ecx_contextt *context, uint16 slave, int thread_n)
          if (context->slavelist[slave].CoEdetails & ECT_COEDET_SDOCA) /* has Complete Access */
          {
             /* read PDO mapping via CoE and use Complete Access */
-            rval = ecx_readPDOmapCA(context, slave, thread_n, &Osize, &Isize);
+            rval = ecx_readPDOmapCA(context, slave, 0, &Osize, &Isize);
          }
          if (!rval) /* CA not available or not succeeded */
          {
             /* read PDO mapping via CoE */
             rval = ecx_readPDOmap(context, slave, &Osize, &Isize);
          }
-         EC_PRINT("  CoE Osize:%d Isize:%d\n", Osize, Isize);
+         EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "  CoE Osize:%d Isize:%d\n", Osize, Isize);
       }
       if ((!Isize && !Osize) && (context->slavelist[slave].mbx_proto & ECT_MBXPROT_SOE)) /* has SoE */
       {
@@ -671,7 +878,7 @@ static int ecx_map_coe_soe(ecx_contextt *context, uint16 slave, int thread_n)
          rval = ecx_readIDNmap(context, slave, &Osize, &Isize);
          context->slavelist[slave].SM[2].SMlength = htoes((Osize + 7) / 8);
          context->slavelist[slave].SM[3].SMlength = htoes((Isize + 7) / 8);
-         EC_PRINT("  SoE Osize:%d Isize:%d\n", Osize, Isize);
+         EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "  SoE Osize:%d Isize:%d\n", Osize, Isize);
       }
       context->slavelist[slave].Obits = Osize;
       context->slavelist[slave].Ibits = Isize;
@@ -689,6 +896,10 @@ static int ecx_map_sii(ecx_contextt *context, uint16 slave)
    Osize = context->slavelist[slave].Obits;
    Isize = context->slavelist[slave].Ibits;
 
+   if (context->slavelist[slave].eniindex) /* mapping is taken from ENI */
+   {
+      return 1;
+   }
    if (!Isize && !Osize) /* find PDO in previous slave with same ID */
    {
       (void)ecx_lookup_mapping(context, slave, &Osize, &Isize);
@@ -697,31 +908,31 @@ static int ecx_map_sii(ecx_contextt *context, uint16 slave)
    {
       memset(&eepPDO, 0, sizeof(eepPDO));
       Isize = (int)ecx_siiPDO(context, slave, &eepPDO, 0);
-      EC_PRINT("  SII Isize:%d\n", Isize);
+      EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "  SII Isize:%d\n", Isize);
       for( nSM=0 ; nSM < EC_MAXSM ; nSM++ )
       {
          if (eepPDO.SMbitsize[nSM] > 0)
          {
             context->slavelist[slave].SM[nSM].SMlength =  htoes((eepPDO.SMbitsize[nSM] + 7) / 8);
             context->slavelist[slave].SMtype[nSM] = 4;
-            EC_PRINT("    SM%d length %d\n", nSM, eepPDO.SMbitsize[nSM]);
+            EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "    SM%d length %d\n", nSM, eepPDO.SMbitsize[nSM]);
          }
       }
       Osize = (int)ecx_siiPDO(context, slave, &eepPDO, 1);
-      EC_PRINT("  SII Osize:%d\n", Osize);
+      EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "  SII Osize:%d\n", Osize);
       for( nSM=0 ; nSM < EC_MAXSM ; nSM++ )
       {
          if (eepPDO.SMbitsize[nSM] > 0)
          {
             context->slavelist[slave].SM[nSM].SMlength =  htoes((eepPDO.SMbitsize[nSM] + 7) / 8);
             context->slavelist[slave].SMtype[nSM] = 3;
-            EC_PRINT("    SM%d length %d\n", nSM, eepPDO.SMbitsize[nSM]);
+            EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "    SM%d length %d\n", nSM, eepPDO.SMbitsize[nSM]);
          }
       }
    }
    context->slavelist[slave].Obits = Osize;
    context->slavelist[slave].Ibits = Isize;
-   EC_PRINT("     ISIZE:%d %d OSIZE:%d\n",
+   EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "     ISIZE:%d %d OSIZE:%d\n",
       context->slavelist[slave].Ibits, Isize,context->slavelist[slave].Obits);
 
    return 1;
@@ -734,12 +945,12 @@ static int ecx_map_sm(ecx_contextt *context, uint16 slave)
 
    configadr = context->slavelist[slave].configadr;
 
-   EC_PRINT("  SM programming\n");
+   EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "  SM programming\n");
    if (!context->slavelist[slave].mbx_l && context->slavelist[slave].SM[0].StartAddr)
    {
       ecx_FPWR(context->port, configadr, ECT_REG_SM0,
          sizeof(ec_smt), &(context->slavelist[slave].SM[0]), EC_TIMEOUTRET3);
-      EC_PRINT("    SM0 Type:%d StartAddr:%4.4x Flags:%8.8x\n",
+      EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "    SM0 Type:%d StartAddr:%4.4x Flags:%8.8x\n",
           context->slavelist[slave].SMtype[0],
           context->slavelist[slave].SM[0].StartAddr,
           context->slavelist[slave].SM[0].SMflags);
@@ -748,7 +959,7 @@ static int ecx_map_sm(ecx_contextt *context, uint16 slave)
    {
       ecx_FPWR(context->port, configadr, ECT_REG_SM1,
          sizeof(ec_smt), &context->slavelist[slave].SM[1], EC_TIMEOUTRET3);
-      EC_PRINT("    SM1 Type:%d StartAddr:%4.4x Flags:%8.8x\n",
+      EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "    SM1 Type:%d StartAddr:%4.4x Flags:%8.8x\n",
           context->slavelist[slave].SMtype[1],
           context->slavelist[slave].SM[1].StartAddr,
           context->slavelist[slave].SM[1].SMflags);
@@ -772,7 +983,7 @@ static int ecx_map_sm(ecx_contextt *context, uint16 slave)
          }
          ecx_FPWR(context->port, configadr, (uint16)(ECT_REG_SM0 + (nSM * sizeof(ec_smt))),
             sizeof(ec_smt), &context->slavelist[slave].SM[nSM], EC_TIMEOUTRET3);
-         EC_PRINT("    SM%d Type:%d StartAddr:%4.4x Flags:%8.8x\n", nSM,
+         EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "    SM%d Type:%d StartAddr:%4.4x Flags:%8.8x\n", nSM,
              context->slavelist[slave].SMtype[nSM],
              context->slavelist[slave].SM[nSM].StartAddr,
              context->slavelist[slave].SM[nSM].SMflags);
@@ -795,15 +1006,15 @@ OSAL_THREAD_FUNC ecx_mapper_thread(void *param)
 {
    ecx_mapt_t *maptp;
    maptp = param;
-   ecx_map_coe_soe(maptp->context, maptp->slave, maptp->thread_n);
+   ecx_map_coe_soe(maptp->context, maptp->slave);
    maptp->running = 0;
 }
 
-static int ecx_find_mapt(void)
+static int ecx_find_mapt(ecx_mapt_t *mapt)
 {
    int p;
    p = 0;
-   while((p < EC_MAX_MAPT) && ecx_mapt[p].running)
+   while((p < EC_MAX_MAPT) && mapt[p].running)
    {
       p++;
    }
@@ -816,28 +1027,159 @@ static int ecx_find_mapt(void)
       return -1;
    }
 }
-#endif
 
-static int ecx_get_threadcount(void)
+static int ecx_get_threadcount(ecx_mapt_t *mapt)
 {
    int thrc, thrn;
    thrc = 0;
    for(thrn = 0 ; thrn < EC_MAX_MAPT ; thrn++)
    {
-      thrc += ecx_mapt[thrn].running;
+      thrc += mapt[thrn].running;
    }
    return thrc;
 }
+#endif
+
+/** Execute PO2SOconfig hook of slave and record its execution time.
+ * @param[in]  context = context struct
+ * @param[in]  slave   = slave number
+ */
+static void ecx_exec_PO2SOconfig(ecx_contextt *context, uint16 slave)
+{
+   ec_timet tstart, tend;
+
+   tstart = osal_current_time();
+   context->slavelist[slave].PO2SOconfig(slave);
+   tend = osal_current_time();
+   context->slavelist[slave].PO2SOconfigtime =
+      ((tend.sec - tstart.sec) * 1000000) + tend.usec - tstart.usec;
+   EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "  PO2SOconfig slave %d took %uus\n",
+            slave, context->slavelist[slave].PO2SOconfigtime);
+}
+
+OSAL_THREAD_FUNC ecx_hook_thread(void *param)
+{
+   ecx_hookt_t *hookp;
+   hookp = param;
+   ecx_exec_PO2SOconfig(hookp->context, hookp->slave);
+   hookp->running = 0;
+}
+
+/** Execute PO2SOconfig hooks of a list of slaves. Up to context->maxhookthreads
+ * hooks run in parallel, each in its own thread. Returns when all hooks
+ * are finished.
+ * @param[in]  context  = context struct
+ * @param[in]  slavelst = list of slave numbers, all with a registered hook
+ * @param[in]  n        = number of slaves in list
+ */
+static void ecx_run_PO2SOconfig(ecx_contextt *context, uint16 *slavelst, int n)
+{
+   ecx_hookt_t hookt[EC_MAX_HOOKT];
+   OSAL_THREAD_HANDLE hookth[EC_MAX_HOOKT];
+   int maxthr, thrn, thrc, i;
+
+   maxthr = context->maxhookthreads;
+   if (maxthr > EC_MAX_HOOKT)
+   {
+      maxthr = EC_MAX_HOOKT;
+   }
+   if ((maxthr <= 1) || (n <= 1))
+   {
+      /* serialised version */
+      for (i = 0; i < n; i++)
+      {
+         ecx_exec_PO2SOconfig(context, slavelst[i]);
+      }
+      return;
+   }
+   for (thrn = 0; thrn < maxthr; thrn++)
+   {
+      hookt[thrn].running = 0;
+   }
+   for (i = 0; i < n; i++)
+   {
+      /* wait for free hook thread */
+      do
+      {
+         thrn = 0;
+         while ((thrn < maxthr) && hookt[thrn].running)
+         {
+            thrn++;
+         }
+         if (thrn >= maxthr)
+         {
+            osal_usleep(1000);
+         }
+      } while (thrn >= maxthr);
+      hookt[thrn].context = context;
+      hookt[thrn].slave = slavelst[i];
+      hookt[thrn].running = 1;
+      if (!osal_thread_create(&(hookth[thrn]), 128000,
+            &ecx_hook_thread, &(hookt[thrn])))
+      {
+         /* no thread available, execute in caller */
+         ecx_exec_PO2SOconfig(context, slavelst[i]);
+         hookt[thrn].running = 0;
+      }
+   }
+   /* wait for all hooks to finish */
+   do
+   {
+      thrc = 0;
+      for (thrn = 0; thrn < maxthr; thrn++)
+      {
+         thrc += hookt[thrn].running;
+      }
+      if (thrc)
+      {
+         osal_usleep(1000);
+      }
+   } while (thrc);
+}
+
+/** Execute PO2SOconfig hooks of all slaves in a group that reached PRE-OP.
+ * @param[in]  context = context struct
+ * @param[in]  group   = group number, 0 = all groups
+ */
+static void ecx_config_PO2SOconfig(ecx_contextt *context, uint8 group)
+{
+   uint16 slavelst[EC_MAXSLAVE];
+   uint16 slave;
+   int n;
+
+   n = 0;
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      if ((!group || (group == context->slavelist[slave].group)) &&
+          context->slavelist[slave].PO2SOconfig)
+      {
+         /* check state change pre-op */
+         ecx_statecheck(context, slave, EC_STATE_PRE_OP, EC_TIMEOUTSTATE);
+         slavelst[n++] = slave;
+      }
+   }
+   ecx_run_PO2SOconfig(context, slavelst, n);
+}
 
 static void ecx_config_find_mappings(ecx_contextt *context, uint8 group)
 {
+#if EC_MAX_MAPT > 1
+   /* thread state is local, so several contexts can be configured in parallel */
+   ecx_mapt_t mapt[EC_MAX_MAPT];
+   OSAL_THREAD_HANDLE threadh[EC_MAX_MAPT];
    int thrn, thrc;
+#endif
    uint16 slave;
 
+   /* execute special slave configuration hooks Pre-Op to Safe-OP,
+    * all hooks have to be finished before the mapping is read */
+   ecx_config_PO2SOconfig(context, group);
+#if EC_MAX_MAPT > 1
    for (thrn = 0; thrn < EC_MAX_MAPT; thrn++)
    {
-      ecx_mapt[thrn].running = 0;
+      mapt[thrn].running = 0;
    }
+#endif
    /* find CoE and SoE mapping of slaves in multiple threads */
    for (slave = 1; slave <= *(context->slavecount); slave++)
    {
@@ -845,31 +1187,38 @@ static void ecx_config_find_mappings(ecx_contextt *context, uint8 group)
       {
 #if EC_MAX_MAPT > 1
             /* multi-threaded version */
-            while ((thrn = ecx_find_mapt()) < 0)
+            while ((thrn = ecx_find_mapt(mapt)) < 0)
             {
                osal_usleep(1000);
             }
-            ecx_mapt[thrn].context = context;
-            ecx_mapt[thrn].slave = slave;
-            ecx_mapt[thrn].thread_n = thrn;
-            ecx_mapt[thrn].running = 1;
-            osal_thread_create(&(ecx_threadh[thrn]), 128000,
-               &ecx_mapper_thread, &(ecx_mapt[thrn]));
+            mapt[thrn].context = context;
+            mapt[thrn].slave = slave;
+            mapt[thrn].thread_n = thrn;
+            mapt[thrn].running = 1;
+            if (!osal_thread_create(&(threadh[thrn]), 128000,
+                  &ecx_mapper_thread, &(mapt[thrn])))
+            {
+               /* no thread available, map in caller */
+               ecx_map_coe_soe(context, slave);
+               mapt[thrn].running = 0;
+            }
 #else
             /* serialised version */
-            ecx_map_coe_soe(context, slave, 0);
+            ecx_map_coe_soe(context, slave);
 #endif
       }
    }
+#if EC_MAX_MAPT > 1
    /* wait for all threads to finish */
    do
    {
-      thrc = ecx_get_threadcount();
+      thrc = ecx_get_threadcount(mapt);
       if (thrc)
       {
          osal_usleep(1000);
       }
    } while (thrc);
+#endif
    /* find SII mapping of slave and program SM */
    for (slave = 1; slave <= *(context->slavecount); slave++)
    {
@@ -894,7 +1243,7 @@ static void ecx_config_create_input_mappings(ecx_contextt *context, void *pIOmap
    uint16 configadr;
    uint8 FMMUc;
 
-   EC_PRINT(" =Slave %d, INPUT MAPPING\n", slave);
+   EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, " =Slave %d, INPUT MAPPING\n", slave);
 
    configadr = context->slavelist[slave].configadr;
    FMMUc = context->slavelist[slave].FMMUunused;
@@ -908,12 +1257,12 @@ static void ecx_config_create_input_mappings(ecx_contextt *context, void *pIOmap
    /* search for SM that contribute to the input mapping */
    while ((SMc < (EC_MAXSM - 1)) && (FMMUdone < ((context->slavelist[slave].Ibits + 7) / 8)))
    {
-      EC_PRINT("    FMMU %d\n", FMMUc);
+      EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, "    FMMU %d\n", FMMUc);
       while ((SMc < (EC_MAXSM - 1)) && (context->slavelist[slave].SMtype[SMc] != 4))
       {
          SMc++;
       }
-      EC_PRINT("      SM%d\n", SMc);
+      EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, "      SM%d\n", SMc);
       context->slavelist[slave].FMMU[FMMUc].PhysStart =
          context->slavelist[slave].SM[SMc].StartAddr;
       SMlength = etohs(context->slavelist[slave].SM[SMc].SMlength);
@@ -932,7 +1281,7 @@ static void ecx_config_create_input_mappings(ecx_contextt *context, void *pIOmap
          {
             break;
          }
-         EC_PRINT("      SM%d\n", SMc);
+         EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, "      SM%d\n", SMc);
          SMlength = etohs(context->slavelist[slave].SM[SMc].SMlength);
          ByteCount += SMlength;
          BitCount += SMlength * 8;
@@ -996,10 +1345,11 @@ static void ecx_config_create_input_mappings(ecx_contextt *context, void *pIOmap
       if (!context->slavelist[slave].inputs)
       {
          context->slavelist[slave].inputs =
-            (uint8 *)(pIOmap)+etohl(context->slavelist[slave].FMMU[FMMUc].LogStart);
+            (uint8 *)(pIOmap) + etohl(context->slavelist[slave].FMMU[FMMUc].LogStart) -
+            context->grouplist[group].logstartaddr;
          context->slavelist[slave].Istartbit =
             context->slavelist[slave].FMMU[FMMUc].LogStartbit;
-         EC_PRINT("    Inputs %p startbit %d\n",
+         EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, "    Inputs %p startbit %d\n",
             context->slavelist[slave].inputs,
             context->slavelist[slave].Istartbit);
       }
@@ -1021,109 +1371,436 @@ static void ecx_config_create_output_mappings(ecx_contextt *context, void *pIOma
    uint16 configadr;
    uint8 FMMUc;
 
-   EC_PRINT("  OUTPUT MAPPING\n");
+   EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, "  OUTPUT MAPPING\n");
 
    FMMUc = context->slavelist[slave].FMMUunused;
    configadr = context->slavelist[slave].configadr;
 
-   /* search for SM that contribute to the output mapping */
-   while ((SMc < (EC_MAXSM - 1)) && (FMMUdone < ((context->slavelist[slave].Obits + 7) / 8)))
+   /* search for SM that contribute to the output mapping */
+   while ((SMc < (EC_MAXSM - 1)) && (FMMUdone < ((context->slavelist[slave].Obits + 7) / 8)))
+   {
+      EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, "    FMMU %d\n", FMMUc);
+      while ((SMc < (EC_MAXSM - 1)) && (context->slavelist[slave].SMtype[SMc] != 3))
+      {
+         SMc++;
+      }
+      EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, "      SM%d\n", SMc);
+      context->slavelist[slave].FMMU[FMMUc].PhysStart =
+         context->slavelist[slave].SM[SMc].StartAddr;
+      SMlength = etohs(context->slavelist[slave].SM[SMc].SMlength);
+      ByteCount += SMlength;
+      BitCount += SMlength * 8;
+      EndAddr = etohs(context->slavelist[slave].SM[SMc].StartAddr) + SMlength;
+      while ((BitCount < context->slavelist[slave].Obits) && (SMc < (EC_MAXSM - 1))) /* more SM for output */
+      {
+         SMc++;
+         while ((SMc < (EC_MAXSM - 1)) && (context->slavelist[slave].SMtype[SMc] != 3))
+         {
+            SMc++;
+         }
+         /* if addresses from more SM connect use one FMMU otherwise break up in multiple FMMU */
+         if (etohs(context->slavelist[slave].SM[SMc].StartAddr) > EndAddr)
+         {
+            break;
+         }
+         EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, "      SM%d\n", SMc);
+         SMlength = etohs(context->slavelist[slave].SM[SMc].SMlength);
+         ByteCount += SMlength;
+         BitCount += SMlength * 8;
+         EndAddr = etohs(context->slavelist[slave].SM[SMc].StartAddr) + SMlength;
+      }
+
+      /* bit oriented slave */
+      if (!context->slavelist[slave].Obytes)
+      {
+         context->slavelist[slave].FMMU[FMMUc].LogStart = htoel(*LogAddr);
+         context->slavelist[slave].FMMU[FMMUc].LogStartbit = *BitPos;
+         *BitPos += context->slavelist[slave].Obits - 1;
+         if (*BitPos > 7)
+         {
+            *LogAddr += 1;
+            *BitPos -= 8;
+         }
+         FMMUsize = *LogAddr - etohl(context->slavelist[slave].FMMU[FMMUc].LogStart) + 1;
+         context->slavelist[slave].FMMU[FMMUc].LogLength = htoes(FMMUsize);
+         context->slavelist[slave].FMMU[FMMUc].LogEndbit = *BitPos;
+         *BitPos += 1;
+         if (*BitPos > 7)
+         {
+            *LogAddr += 1;
+            *BitPos -= 8;
+         }
+      }
+      /* byte oriented slave */
+      else
+      {
+         if (*BitPos)
+         {
+            *LogAddr += 1;
+            *BitPos = 0;
+         }
+         context->slavelist[slave].FMMU[FMMUc].LogStart = htoel(*LogAddr);
+         context->slavelist[slave].FMMU[FMMUc].LogStartbit = *BitPos;
+         *BitPos = 7;
+         FMMUsize = ByteCount;
+         if ((FMMUsize + FMMUdone)> (int)context->slavelist[slave].Obytes)
+         {
+            FMMUsize = context->slavelist[slave].Obytes - FMMUdone;
+         }
+         *LogAddr += FMMUsize;
+         context->slavelist[slave].FMMU[FMMUc].LogLength = htoes(FMMUsize);
+         context->slavelist[slave].FMMU[FMMUc].LogEndbit = *BitPos;
+         *BitPos = 0;
+      }
+      FMMUdone += FMMUsize;
+      context->slavelist[slave].FMMU[FMMUc].PhysStartBit = 0;
+      context->slavelist[slave].FMMU[FMMUc].FMMUtype = 2;
+      context->slavelist[slave].FMMU[FMMUc].FMMUactive = 1;
+      /* program FMMU for output */
+      ecx_FPWR(context->port, configadr, ECT_REG_FMMU0 + (sizeof(ec_fmmut) * FMMUc),
+         sizeof(ec_fmmut), &(context->slavelist[slave].FMMU[FMMUc]), EC_TIMEOUTRET3);
+      context->grouplist[group].outputsWKC++;
+      if (!context->slavelist[slave].outputs)
+      {
+         context->slavelist[slave].outputs =
+            (uint8 *)(pIOmap) + etohl(context->slavelist[slave].FMMU[FMMUc].LogStart) -
+            context->grouplist[group].logstartaddr;
+         context->slavelist[slave].Ostartbit =
+            context->slavelist[slave].FMMU[FMMUc].LogStartbit;
+         EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, "    slave %d Outputs %p startbit %d\n",
+            slave,
+            context->slavelist[slave].outputs,
+            context->slavelist[slave].Ostartbit);
+      }
+      FMMUc++;
+   }
+   context->slavelist[slave].FMMUunused = FMMUc;
+}
+
+/** Check optional slave reservations before mapping a group. Reservations
+ * of slaves that are present are mapped the normal way, for absent slaves
+ * IOmap space is reserved.
+ * @param[in]  context = context struct
+ * @param[in]  group   = group to map, 0 = all groups
+ */
+static void ecx_config_check_optional(ecx_contextt *context, uint8 group)
+{
+   ec_optslavet *optsl;
+   ec_slavet *csl;
+   int opt;
+
+   for (opt = 0; opt < ecx_optslavecount(context); opt++)
+   {
+      optsl = &(context->optslavelist[opt]);
+      if (group && (group != optsl->group))
+      {
+         continue;
+      }
+      optsl->mapgroup = group;
+      optsl->reserved = TRUE;
+      optsl->mapped = FALSE;
+      optsl->Ostartbit = 0;
+      optsl->Istartbit = 0;
+      if (optsl->slave <= *(context->slavecount))
+      {
+         csl = &(context->slavelist[optsl->slave]);
+         if ((csl->eep_man != optsl->eep_man) || (csl->eep_id != optsl->eep_id) ||
+             (csl->group != optsl->group))
+         {
+            EC_LOG(context, EC_LOG_WARNING, EC_LOG_RECOVER, "Optional slave %d does not match reservation\n", optsl->slave);
+            optsl->reserved = FALSE;
+         }
+         else
+         {
+            optsl->mapped = TRUE;
+         }
+      }
+   }
+}
+
+/** Take over the mapping of present optional slaves as their reservation,
+ * so the slave is mapped in the same place when it reconnects.
+ * @param[in]  context = context struct
+ * @param[in]  pIOmap  = pointer to IOmap of group
+ * @param[in]  group   = group mapped, 0 = all groups
+ */
+static void ecx_config_store_optional(ecx_contextt *context, void *pIOmap, uint8 group)
+{
+   ec_optslavet *optsl;
+   ec_slavet *csl;
+   int opt;
+
+   for (opt = 0; opt < ecx_optslavecount(context); opt++)
+   {
+      optsl = &(context->optslavelist[opt]);
+      if (optsl->reserved && optsl->mapped && (optsl->mapgroup == group))
+      {
+         csl = &(context->slavelist[optsl->slave]);
+         optsl->Obits = csl->Obits;
+         optsl->Ibits = csl->Ibits;
+         if (csl->outputs)
+         {
+            optsl->Ologaddr = (uint32)(csl->outputs - (uint8 *)pIOmap) +
+               context->grouplist[group].logstartaddr;
+            optsl->Ostartbit = csl->Ostartbit;
+         }
+         if (csl->inputs)
+         {
+            optsl->Ilogaddr = (uint32)(csl->inputs - (uint8 *)pIOmap) +
+               context->grouplist[group].logstartaddr;
+            optsl->Istartbit = csl->Istartbit;
+         }
+      }
+   }
+}
+
+/** Map an optional slave that appeared on the network into its reserved
+ * IOmap space and request SAFE_OP.
+ * @param[in]  context = context struct
+ * @param[in]  optsl   = reservation of the slave
+ * @return 1 if mapped, 0 otherwise
+ */
+static int ecx_config_map_optional(ecx_contextt *context, ec_optslavet *optsl)
+{
+   uint16 slave, configadr;
+   uint32 LogAddr;
+   uint8 BitPos, group;
+   ec_slavet *csl;
+
+   slave = optsl->slave;
+   group = optsl->mapgroup;
+   csl = &(context->slavelist[slave]);
+   configadr = csl->configadr;
+   if ((csl->eep_man != optsl->eep_man) || (csl->eep_id != optsl->eep_id))
+   {
+      EC_LOG(context, EC_LOG_WARNING, EC_LOG_RECOVER, "Optional slave %d does not match reservation\n", slave);
+      return 0;
+   }
+   csl->group = optsl->group;
+   if (csl->PO2SOconfig)
+   {
+      ecx_statecheck(context, slave, EC_STATE_PRE_OP, EC_TIMEOUTSTATE);
+      ecx_run_PO2SOconfig(context, &slave, 1);
+   }
+   ecx_map_coe_soe(context, slave);
+   ecx_map_sii(context, slave);
+   ecx_map_sm(context, slave);
+   if ((csl->Obits > optsl->Obits) || (csl->Ibits > optsl->Ibits))
+   {
+      EC_LOG(context, EC_LOG_WARNING, EC_LOG_RECOVER, "Optional slave %d does not fit in reservation O:%d/%d I:%d/%d\n",
+         slave, csl->Obits, optsl->Obits, csl->Ibits, optsl->Ibits);
+      return 0;
+   }
+   if (csl->Obits)
+   {
+      LogAddr = optsl->Ologaddr;
+      BitPos = optsl->Ostartbit;
+      ecx_config_create_output_mappings(context, context->grouplist[group].outputs,
+         group, slave, &LogAddr, &BitPos);
+   }
+   if (csl->Ibits)
+   {
+      LogAddr = optsl->Ilogaddr;
+      BitPos = optsl->Istartbit;
+      ecx_config_create_input_mappings(context, context->grouplist[group].outputs,
+         group, slave, &LogAddr, &BitPos);
+   }
+   ecx_eeprom2pdi(context, slave); /* set Eeprom control to PDI */
+   ecx_FPWRw(context->port, configadr, ECT_REG_ALCTL, htoes(EC_STATE_SAFE_OP) , EC_TIMEOUTRET3); /* set safeop status */
+   if (csl->blockLRW)
+   {
+      context->grouplist[group].blockLRW++;
+   }
+   context->grouplist[group].Ebuscurrent += csl->Ebuscurrent;
+   optsl->mapped = TRUE;
+   return 1;
+}
+
+/** Remove an optional slave that left the network from its group, the
+ * reserved IOmap space is kept.
+ * @param[in]  context = context struct
+ * @param[in]  optsl   = reservation of the slave
+ */
+static void ecx_config_unmap_optional(ecx_contextt *context, ec_optslavet *optsl)
+{
+   ec_slavet *csl;
+   ec_groupt *grp;
+   uint8 FMMUc;
+
+   csl = &(context->slavelist[optsl->slave]);
+   grp = &(context->grouplist[optsl->mapgroup]);
+   for (FMMUc = 0; FMMUc < csl->FMMUunused; FMMUc++)
+   {
+      if (csl->FMMU[FMMUc].FMMUactive && csl->FMMU[FMMUc].LogLength)
+      {
+         if (csl->FMMU[FMMUc].FMMUtype == 2)
+         {
+            grp->outputsWKC--;
+         }
+         else if (csl->FMMU[FMMUc].FMMUtype == 1)
+         {
+            grp->inputsWKC--;
+         }
+      }
+   }
+   if (csl->blockLRW)
+   {
+      grp->blockLRW--;
+   }
+   grp->Ebuscurrent -= csl->Ebuscurrent;
+   memset(csl, 0x00, sizeof(ec_slavet));
+   optsl->mapped = FALSE;
+}
+
+/** Find IO segment of a logical address during mapping.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group being mapped
+ * @param[in]  currentsegment = segment currently filled by mapping
+ * @param[in]  logaddr        = logical address
+ * @return segment number
+ */
+static uint16 ecx_config_segment(ecx_contextt *context, uint8 group, uint16 currentsegment,
+   uint32 logaddr)
+{
+   uint32 segend;
+   uint16 seg;
+
+   segend = context->grouplist[group].logstartaddr;
+   for (seg = 0; seg < currentsegment; seg++)
+   {
+      segend += context->grouplist[group].IOsegment[seg];
+      if (logaddr < segend)
+      {
+         return seg;
+      }
+   }
+   return currentsegment;
+}
+
+/** Apply slave to slave routes of a consumer. The consumer output FMMU
+ * holding the routed bytes is pointed to the logical address of the producer
+ * inputs, if the routed bytes are only part of the FMMU it is split in two.
+ * Called after the producer inputs are mapped and before the consumer is
+ * requested to SAFE_OP.
+ * @param[in]  context        = context struct
+ * @param[in]  pIOmap         = pointer to IOmap
+ * @param[in]  group          = group being mapped
+ * @param[in]  consumer       = consumer slave
+ * @param[in]  currentsegment = segment currently filled by mapping
+ */
+static void ecx_config_apply_routes(ecx_contextt *context, void *pIOmap, uint8 group,
+   uint16 consumer, uint16 currentsegment)
+{
+   ec_routet *route;
+   ec_slavet *csl, *psl;
+   ec_fmmut *fmmu, *rfmmu;
+   uint32 logaddr;
+   uint16 offset, len;
+   uint8 FMMUc;
+   int r;
+
+   if (context->routecount == NULL)
    {
-      EC_PRINT("    FMMU %d\n", FMMUc);
-      while ((SMc < (EC_MAXSM - 1)) && (context->slavelist[slave].SMtype[SMc] != 3))
+      return;
+   }
+   csl = &(context->slavelist[consumer]);
+   for (r = 0; r < *(context->routecount); r++)
+   {
+      route = &(context->routelist[r]);
+      if (route->consumer != consumer)
       {
-         SMc++;
+         continue;
       }
-      EC_PRINT("      SM%d\n", SMc);
-      context->slavelist[slave].FMMU[FMMUc].PhysStart =
-         context->slavelist[slave].SM[SMc].StartAddr;
-      SMlength = etohs(context->slavelist[slave].SM[SMc].SMlength);
-      ByteCount += SMlength;
-      BitCount += SMlength * 8;
-      EndAddr = etohs(context->slavelist[slave].SM[SMc].StartAddr) + SMlength;
-      while ((BitCount < context->slavelist[slave].Obits) && (SMc < (EC_MAXSM - 1))) /* more SM for output */
+      route->logaddr = 0;
+      /* with redundancy the secondary port passes the slaves in reverse
+         order, the consumer would read the inputs of the previous cycle */
+      if (context->port->redstate)
       {
-         SMc++;
-         while ((SMc < (EC_MAXSM - 1)) && (context->slavelist[slave].SMtype[SMc] != 3))
-         {
-            SMc++;
-         }
-         /* if addresses from more SM connect use one FMMU otherwise break up in multiple FMMU */
-         if (etohs(context->slavelist[slave].SM[SMc].StartAddr) > EndAddr)
+         EC_LOG(context, EC_LOG_ERROR, EC_LOG_MAP, "Route %d from slave %d to slave %d not possible with redundancy\n",
+            r + 1, route->producer, consumer);
+         continue;
+      }
+      psl = &(context->slavelist[route->producer]);
+      if ((route->producer >= consumer) || (route->producer > *(context->slavecount)) ||
+          (psl->inputs == NULL) || psl->Istartbit ||
+          ((uint32)route->Ioffset + route->length > psl->Ibytes) ||
+          (group && (psl->group != group)) ||
+          psl->blockLRW || csl->blockLRW || csl->Ostartbit)
+      {
+         EC_LOG(context, EC_LOG_ERROR, EC_LOG_MAP, "Route %d from slave %d to slave %d not possible\n",
+            r + 1, route->producer, consumer);
+         continue;
+      }
+      logaddr = (uint32)(psl->inputs - (uint8 *)pIOmap) +
+         context->grouplist[group].logstartaddr + route->Ioffset;
+      /* find output FMMU holding the routed bytes */
+      offset = 0;
+      fmmu = NULL;
+      for (FMMUc = 0; FMMUc < csl->FMMUunused; FMMUc++)
+      {
+         if (csl->FMMU[FMMUc].FMMUtype == 2)
          {
-            break;
+            len = etohs(csl->FMMU[FMMUc].LogLength);
+            if ((route->Ooffset >= offset) && ((route->Ooffset + route->length) <= (offset + len)))
+            {
+               fmmu = &(csl->FMMU[FMMUc]);
+               break;
+            }
+            offset += len;
          }
-         EC_PRINT("      SM%d\n", SMc);
-         SMlength = etohs(context->slavelist[slave].SM[SMc].SMlength);
-         ByteCount += SMlength;
-         BitCount += SMlength * 8;
-         EndAddr = etohs(context->slavelist[slave].SM[SMc].StartAddr) + SMlength;
       }
-
-      /* bit oriented slave */
-      if (!context->slavelist[slave].Obytes)
+      if (fmmu == NULL)
       {
-         context->slavelist[slave].FMMU[FMMUc].LogStart = htoel(*LogAddr);
-         context->slavelist[slave].FMMU[FMMUc].LogStartbit = *BitPos;
-         *BitPos += context->slavelist[slave].Obits - 1;
-         if (*BitPos > 7)
+         EC_LOG(context, EC_LOG_ERROR, EC_LOG_MAP, "Route %d outside outputs of slave %d\n", r + 1, consumer);
+         continue;
+      }
+      len = etohs(fmmu->LogLength);
+      if ((route->Ooffset == offset) && (route->length == len))
+      {
+         /* whole FMMU is routed, only move it */
+         fmmu->LogStart = htoel(logaddr);
+      }
+      else
+      {
+         /* routed bytes must be at start or end of the FMMU to split it */
+         if (((route->Ooffset != offset) && ((route->Ooffset + route->length) != (offset + len))) ||
+             (csl->FMMUunused >= EC_MAXFMMU))
          {
-            *LogAddr += 1;
-            *BitPos -= 8;
+            EC_LOG(context, EC_LOG_ERROR, EC_LOG_MAP, "Route %d can not split FMMU %d of slave %d\n", r + 1, FMMUc, consumer);
+            continue;
          }
-         FMMUsize = *LogAddr - etohl(context->slavelist[slave].FMMU[FMMUc].LogStart) + 1;
-         context->slavelist[slave].FMMU[FMMUc].LogLength = htoes(FMMUsize);
-         context->slavelist[slave].FMMU[FMMUc].LogEndbit = *BitPos;
-         *BitPos += 1;
-         if (*BitPos > 7)
+         rfmmu = &(csl->FMMU[csl->FMMUunused]);
+         *rfmmu = *fmmu;
+         rfmmu->LogStart = htoel(logaddr);
+         rfmmu->LogLength = htoes(route->length);
+         rfmmu->LogStartbit = 0;
+         rfmmu->LogEndbit = 7;
+         if (route->Ooffset == offset)
          {
-            *LogAddr += 1;
-            *BitPos -= 8;
+            fmmu->PhysStart = htoes(etohs(fmmu->PhysStart) + route->length);
+            fmmu->LogStart = htoel(etohl(fmmu->LogStart) + route->length);
          }
-      }
-      /* byte oriented slave */
-      else
-      {
-         if (*BitPos)
+         else
          {
-            *LogAddr += 1;
-            *BitPos = 0;
+            rfmmu->PhysStart = htoes(etohs(fmmu->PhysStart) + route->Ooffset - offset);
          }
-         context->slavelist[slave].FMMU[FMMUc].LogStart = htoel(*LogAddr);
-         context->slavelist[slave].FMMU[FMMUc].LogStartbit = *BitPos;
-         *BitPos = 7;
-         FMMUsize = ByteCount;
-         if ((FMMUsize + FMMUdone)> (int)context->slavelist[slave].Obytes)
+         fmmu->LogLength = htoes(len - route->length);
+         /* one more write FMMU only counts if it is in another datagram */
+         if (ecx_config_segment(context, group, currentsegment, logaddr) !=
+             ecx_config_segment(context, group, currentsegment, etohl(fmmu->LogStart)))
          {
-            FMMUsize = context->slavelist[slave].Obytes - FMMUdone;
+            context->grouplist[group].outputsWKC++;
          }
-         *LogAddr += FMMUsize;
-         context->slavelist[slave].FMMU[FMMUc].LogLength = htoes(FMMUsize);
-         context->slavelist[slave].FMMU[FMMUc].LogEndbit = *BitPos;
-         *BitPos = 0;
-      }
-      FMMUdone += FMMUsize;
-      context->slavelist[slave].FMMU[FMMUc].PhysStartBit = 0;
-      context->slavelist[slave].FMMU[FMMUc].FMMUtype = 2;
-      context->slavelist[slave].FMMU[FMMUc].FMMUactive = 1;
-      /* program FMMU for output */
-      ecx_FPWR(context->port, configadr, ECT_REG_FMMU0 + (sizeof(ec_fmmut) * FMMUc),
-         sizeof(ec_fmmut), &(context->slavelist[slave].FMMU[FMMUc]), EC_TIMEOUTRET3);
-      context->grouplist[group].outputsWKC++;
-      if (!context->slavelist[slave].outputs)
-      {
-         context->slavelist[slave].outputs =
-            (uint8 *)(pIOmap)+etohl(context->slavelist[slave].FMMU[FMMUc].LogStart);
-         context->slavelist[slave].Ostartbit =
-            context->slavelist[slave].FMMU[FMMUc].LogStartbit;
-         EC_PRINT("    slave %d Outputs %p startbit %d\n",
-            slave,
-            context->slavelist[slave].outputs,
-            context->slavelist[slave].Ostartbit);
+         ecx_FPWR(context->port, csl->configadr, ECT_REG_FMMU0 + (sizeof(ec_fmmut) * csl->FMMUunused),
+            sizeof(ec_fmmut), rfmmu, EC_TIMEOUTRET3);
+         csl->FMMUunused++;
       }
-      FMMUc++;
+      ecx_FPWR(context->port, csl->configadr, ECT_REG_FMMU0 + (sizeof(ec_fmmut) * FMMUc),
+         sizeof(ec_fmmut), fmmu, EC_TIMEOUTRET3);
+      route->logaddr = logaddr;
+      EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, "Route %d slave %d inputs to slave %d outputs at %8.8x\n",
+         r + 1, route->producer, consumer, logaddr);
    }
-   context->slavelist[slave].FMMUunused = FMMUc;
 }
 
 /** Map all PDOs in one group of slaves to IOmap with Outputs/Inputs
@@ -1144,19 +1821,25 @@ int ecx_config_map_group(ecx_contextt *context, void *pIOmap, uint8 group)
    uint32 diff;
    uint16 currentsegment = 0;
    uint32 segmentsize = 0;
+   ec_optslavet *optsl;
+   int opt;
 
    if ((*(context->slavecount) > 0) && (group < context->maxgroup))
    {
-      EC_PRINT("ec_config_map_group IOmap:%p group:%d\n", pIOmap, group);
+      EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, "ec_config_map_group IOmap:%p group:%d\n", pIOmap, group);
       LogAddr = context->grouplist[group].logstartaddr;
       oLogAddr = LogAddr;
       BitPos = 0;
       context->grouplist[group].nsegments = 0;
       context->grouplist[group].outputsWKC = 0;
       context->grouplist[group].inputsWKC = 0;
+      context->grouplist[group].cycle = 0;
+      context->grouplist[group].nsegorder = 0;
+      context->grouplist[group].overlap = FALSE;
 
       /* Find mappings and program syncmanagers */
       ecx_config_find_mappings(context, group);
+      ecx_config_check_optional(context, group);
 
       /* do output mapping of slave and program FMMUs */
       for (slave = 1; slave <= *(context->slavecount); slave++)
@@ -1187,6 +1870,36 @@ int ecx_config_map_group(ecx_contextt *context, void *pIOmap, uint8 group)
             }
          }
       }
+      /* reserve outputs of absent optional slaves */
+      for (opt = 0; opt < ecx_optslavecount(context); opt++)
+      {
+         optsl = &(context->optslavelist[opt]);
+         if (optsl->reserved && !optsl->mapped && (optsl->mapgroup == group) && optsl->Obits)
+         {
+            if (BitPos)
+            {
+               LogAddr++;
+               BitPos = 0;
+            }
+            optsl->Ologaddr = LogAddr;
+            LogAddr += (optsl->Obits + 7) / 8;
+            diff = LogAddr - oLogAddr;
+            oLogAddr = LogAddr;
+            if ((segmentsize + diff) > (EC_MAXLRWDATA - EC_FIRSTDCDATAGRAM))
+            {
+               context->grouplist[group].IOsegment[currentsegment] = segmentsize;
+               if (currentsegment < (EC_MAXIOSEGMENTS - 1))
+               {
+                  currentsegment++;
+                  segmentsize = diff;
+               }
+            }
+            else
+            {
+               segmentsize += diff;
+            }
+         }
+      }
       if (BitPos)
       {
          LogAddr++;
@@ -1207,7 +1920,7 @@ int ecx_config_map_group(ecx_contextt *context, void *pIOmap, uint8 group)
          }
       }
       context->grouplist[group].outputs = pIOmap;
-      context->grouplist[group].Obytes = LogAddr;
+      context->grouplist[group].Obytes = LogAddr - context->grouplist[group].logstartaddr;
       context->grouplist[group].nsegments = currentsegment + 1;
       context->grouplist[group].Isegment = currentsegment;
       context->grouplist[group].Ioffset = segmentsize;
@@ -1244,6 +1957,10 @@ int ecx_config_map_group(ecx_contextt *context, void *pIOmap, uint8 group)
                   segmentsize += diff;
                }
             }
+            if (context->slavelist[slave].Obits)
+            {
+               ecx_config_apply_routes(context, pIOmap, group, slave, currentsegment);
+            }
 
             ecx_eeprom2pdi(context, slave); /* set Eeprom control to PDI */
             ecx_FPWRw(context->port, configadr, ECT_REG_ALCTL, htoes(EC_STATE_SAFE_OP) , EC_TIMEOUTRET3); /* set safeop status */
@@ -1255,6 +1972,36 @@ int ecx_config_map_group(ecx_contextt *context, void *pIOmap, uint8 group)
             context->grouplist[group].Ebuscurrent += context->slavelist[slave].Ebuscurrent;
          }
       }
+      /* reserve inputs of absent optional slaves */
+      for (opt = 0; opt < ecx_optslavecount(context); opt++)
+      {
+         optsl = &(context->optslavelist[opt]);
+         if (optsl->reserved && !optsl->mapped && (optsl->mapgroup == group) && optsl->Ibits)
+         {
+            if (BitPos)
+            {
+               LogAddr++;
+               BitPos = 0;
+            }
+            optsl->Ilogaddr = LogAddr;
+            LogAddr += (optsl->Ibits + 7) / 8;
+            diff = LogAddr - oLogAddr;
+            oLogAddr = LogAddr;
+            if ((segmentsize + diff) > (EC_MAXLRWDATA - EC_FIRSTDCDATAGRAM))
+            {
+               context->grouplist[group].IOsegment[currentsegment] = segmentsize;
+               if (currentsegment < (EC_MAXIOSEGMENTS - 1))
+               {
+                  currentsegment++;
+                  segmentsize = diff;
+               }
+            }
+            else
+            {
+               segmentsize += diff;
+            }
+         }
+      }
       if (BitPos)
       {
          LogAddr++;
@@ -1277,14 +2024,17 @@ int ecx_config_map_group(ecx_contextt *context, void *pIOmap, uint8 group)
       context->grouplist[group].IOsegment[currentsegment] = segmentsize;
       context->grouplist[group].nsegments = currentsegment + 1;
       context->grouplist[group].inputs = (uint8 *)(pIOmap) + context->grouplist[group].Obytes;
-      context->grouplist[group].Ibytes = LogAddr - context->grouplist[group].Obytes;
+      context->grouplist[group].Ibytes = LogAddr - context->grouplist[group].logstartaddr -
+         context->grouplist[group].Obytes;
       if (!group)
       {
          context->slavelist[0].inputs = (uint8 *)(pIOmap) + context->slavelist[0].Obytes;
          context->slavelist[0].Ibytes = LogAddr - context->slavelist[0].Obytes; /* store input bytes in master record */
       }
 
-      EC_PRINT("IOmapSize %d\n", LogAddr - context->grouplist[group].logstartaddr);
+      ecx_config_store_optional(context, pIOmap, group);
+
+      EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, "IOmapSize %d\n", LogAddr - context->grouplist[group].logstartaddr);
 
       return (LogAddr - context->grouplist[group].logstartaddr);
    }
@@ -1314,7 +2064,7 @@ int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 grou
 
    if ((*(context->slavecount) > 0) && (group < context->maxgroup))
    {
-      EC_PRINT("ec_config_map_group IOmap:%p group:%d\n", pIOmap, group);
+      EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, "ec_config_map_group IOmap:%p group:%d\n", pIOmap, group);
       mLogAddr = context->grouplist[group].logstartaddr;
       siLogAddr = mLogAddr;
       soLogAddr = mLogAddr;
@@ -1322,6 +2072,9 @@ int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 grou
       context->grouplist[group].nsegments = 0;
       context->grouplist[group].outputsWKC = 0;
       context->grouplist[group].inputsWKC = 0;
+      context->grouplist[group].cycle = 0;
+      context->grouplist[group].nsegorder = 0;
+      context->grouplist[group].overlap = TRUE;
 
       /* Find mappings and program syncmanagers */
       ecx_config_find_mappings(context, group);
@@ -1394,15 +2147,19 @@ int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 grou
       context->grouplist[group].Isegment = 0;
       context->grouplist[group].Ioffset = 0;
 
-      context->grouplist[group].Obytes = soLogAddr;
-      context->grouplist[group].Ibytes = siLogAddr;
+      context->grouplist[group].Obytes = soLogAddr - context->grouplist[group].logstartaddr;
+      context->grouplist[group].Ibytes = siLogAddr - context->grouplist[group].logstartaddr;
       context->grouplist[group].outputs = pIOmap;
       context->grouplist[group].inputs = (uint8 *)pIOmap + context->grouplist[group].Obytes;
 
       /* Move calculated inputs with OBytes offset*/
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
-         context->slavelist[slave].inputs += context->grouplist[group].Obytes;
+         if ((!group || (group == context->slavelist[slave].group)) &&
+             context->slavelist[slave].Ibits)
+         {
+            context->slavelist[slave].inputs += context->grouplist[group].Obytes;
+         }
       }
 
       if (!group)
@@ -1413,7 +2170,7 @@ int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 grou
          context->slavelist[0].Ibytes = siLogAddr;
       }
 
-      EC_PRINT("IOmapSize %d\n", context->grouplist[group].Obytes + context->grouplist[group].Ibytes);
+      EC_LOG(context, EC_LOG_DEBUG, EC_LOG_MAP, "IOmapSize %d\n", context->grouplist[group].Obytes + context->grouplist[group].Ibytes);
 
       return (context->grouplist[group].Obytes + context->grouplist[group].Ibytes);
    }
@@ -1422,6 +2179,153 @@ int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 grou
 }
 
 
+/** Declare a slave to slave process data route. Bytes of the producer inputs
+ * are written to the consumer outputs within the same LRW datagram, without
+ * a round trip through the master. The producer must be located before the
+ * consumer on the network, both must be mapped byte oriented in the same
+ * group with ecx_config_map_group and LRW must not be blocked. A consumer
+ * can have one route. The routed bytes must cover a whole output FMMU of
+ * the consumer or be located at its start or end, then the FMMU is split
+ * using a free FMMU. Routed output bytes in the IOmap are not sent to the
+ * consumer. Routes stay valid over ecx_config_init and are applied by
+ * ecx_config_map_group. Routes are not applied on a redundant port, as the
+ * slave order is reversed on the secondary port.
+ *
+ * @param[in] context  = context struct
+ * @param[in] producer = producer slave
+ * @param[in] Ioffset  = byte offset in producer inputs
+ * @param[in] consumer = consumer slave
+ * @param[in] Ooffset  = byte offset in consumer outputs
+ * @param[in] length   = number of bytes routed
+ * @return route number >0 if successful, 0 if list full, ordering not possible
+ * or consumer already routed
+ */
+int ecx_config_route(ecx_contextt *context, uint16 producer, uint16 Ioffset,
+   uint16 consumer, uint16 Ooffset, uint16 length)
+{
+   ec_routet *route;
+   int r;
+
+   if ((context->routelist == NULL) || (*(context->routecount) >= context->maxroute) ||
+       (producer == 0) || (producer >= consumer) || (consumer >= context->maxslave) ||
+       (length == 0))
+   {
+      return 0;
+   }
+   /* one route per consumer */
+   for (r = 0; r < *(context->routecount); r++)
+   {
+      if (context->routelist[r].consumer == consumer)
+      {
+         return 0;
+      }
+   }
+   route = &(context->routelist[*(context->routecount)]);
+   route->producer = producer;
+   route->Ioffset = Ioffset;
+   route->consumer = consumer;
+   route->Ooffset = Ooffset;
+   route->length = length;
+   route->logaddr = 0;
+   return ++(*(context->routecount));
+}
+
+/** Reserve IOmap space for an optional slave. The slave does not need to be
+ * present when the group is mapped, its logical address range and IOmap
+ * space are reserved by ecx_config_map_group and it is excluded from the
+ * expected workcounter while absent. When it connects it is mapped in place
+ * by ecx_config_optional_slaves. Optional slaves must be located behind all
+ * other slaves of the network. Reservations stay valid over ecx_config_init.
+ *
+ * @param[in] context = context struct
+ * @param[in] slave   = expected slave position on the network
+ * @param[in] man     = expected manufacturer from EEprom
+ * @param[in] id      = expected ID from EEprom
+ * @param[in] group   = group the slave belongs to
+ * @param[in] Obits   = output bits to reserve
+ * @param[in] Ibits   = input bits to reserve
+ * @return reservation number >0 if successful, 0 if list full or slave already reserved
+ */
+int ecx_config_reserve_slave(ecx_contextt *context, uint16 slave, uint32 man, uint32 id,
+   uint8 group, uint16 Obits, uint16 Ibits)
+{
+   ec_optslavet *optsl;
+
+   if ((context->optslavelist == NULL) ||
+       (ecx_optslavecount(context) >= context->maxoptslave) ||
+       (slave == 0) || (slave >= context->maxslave) ||
+       (group >= context->maxgroup) ||
+       ecx_find_optslave(context, slave))
+   {
+      return 0;
+   }
+   optsl = &(context->optslavelist[*(context->optslavecount)]);
+   memset(optsl, 0x00, sizeof(ec_optslavet));
+   optsl->slave = slave;
+   optsl->eep_man = man;
+   optsl->eep_id = id;
+   optsl->group = group;
+   optsl->Obits = Obits;
+   optsl->Ibits = Ibits;
+   return ++(*(context->optslavecount));
+}
+
+/** Handle connect and disconnect of optional slaves while the groups are in
+ * operation. Optional slaves that left the end of the network are removed
+ * from their group, newly connected slaves are initialised and mapped into
+ * their reserved IOmap space and brought to SAFE_OP. No other slave is
+ * remapped. The expected workcounter of the groups is updated and must be
+ * recalculated by the application, as well as requesting OP for new slaves.
+ *
+ * @param[in] context  = context struct
+ * @param[in] usetable = TRUE when using configtable to init slaves, FALSE otherwise
+ * @return number of optional slaves mapped or removed, negative if the
+ * network changed in other places
+ */
+int ecx_config_optional_slaves(ecx_contextt *context, uint8 usetable)
+{
+   ec_optslavet *optsl;
+   uint16 slave, w;
+   int wkc, n, changed;
+
+   if (ecx_optslavecount(context) == 0)
+   {
+      return 0;
+   }
+   changed = 0;
+   wkc = ecx_BRD(context->port, 0x0000, ECT_REG_TYPE, sizeof(w), &w, EC_TIMEOUTSAFE);  /* detect number of slaves */
+   /* optional slaves left the network, remove from end of list */
+   while ((wkc > 0) && (wkc < *(context->slavecount)))
+   {
+      optsl = ecx_find_optslave(context, (uint16)*(context->slavecount));
+      if ((optsl == NULL) || !optsl->mapped)
+      {
+         break;
+      }
+      EC_LOG(context, EC_LOG_INFO, EC_LOG_RECOVER, "Optional slave %d removed\n", optsl->slave);
+      ecx_config_unmap_optional(context, optsl);
+      (*(context->slavecount))--;
+      changed++;
+   }
+   n = ecx_config_init_appended(context, usetable);
+   if (n < 0)
+   {
+      return n;
+   }
+   for (slave = *(context->slavecount) - n + 1; slave <= *(context->slavecount); slave++)
+   {
+      optsl = ecx_find_optslave(context, slave);
+      if ((optsl == NULL) || !optsl->reserved || optsl->mapped)
+      {
+         EC_LOG(context, EC_LOG_WARNING, EC_LOG_RECOVER, "Slave %d has no IOmap reservation\n", slave);
+         continue;
+      }
+      EC_LOG(context, EC_LOG_INFO, EC_LOG_RECOVER, "Optional slave %d connected\n", slave);
+      changed += ecx_config_map_optional(context, optsl);
+   }
+   return changed;
+}
+
 /** Recover slave.
  *
  * @param[in] context = context struct
@@ -1485,16 +2389,16 @@ int ecx_recover_slave(ecx_contextt *context, uint16 slave, int timeout)
    return rval;
 }
 
-/** Reconfigure slave.
+/** Reconfigure slave up to PRE-OP.
  *
  * @param[in] context = context struct
  * @param[in] slave   = slave to reconfigure
  * @param[in] timeout = local timeout f.e. EC_TIMEOUTRET3
  * @return Slave state
  */
-int ecx_reconfig_slave(ecx_contextt *context, uint16 slave, int timeout)
+static int ecx_reconfig_slave_preop(ecx_contextt *context, uint16 slave, int timeout)
 {
-   int state, nSM, FMMUc;
+   int state, nSM;
    uint16 configadr;
 
    configadr = context->slavelist[slave].configadr;
@@ -1519,25 +2423,101 @@ int ecx_reconfig_slave(ecx_contextt *context, uint16 slave, int timeout)
       }
       ecx_FPWRw(context->port, configadr, ECT_REG_ALCTL, htoes(EC_STATE_PRE_OP) , timeout);
       state = ecx_statecheck(context, slave, EC_STATE_PRE_OP, EC_TIMEOUTSTATE); /* check state change pre-op */
-      if( state == EC_STATE_PRE_OP)
+   }
+
+   return state;
+}
+
+/** Reconfigure slave from PRE-OP to SAFE-OP.
+ *
+ * @param[in] context = context struct
+ * @param[in] slave   = slave to reconfigure
+ * @param[in] timeout = local timeout f.e. EC_TIMEOUTRET3
+ * @return Slave state
+ */
+static int ecx_reconfig_slave_safeop(ecx_contextt *context, uint16 slave, int timeout)
+{
+   int state, FMMUc;
+   uint16 configadr;
+
+   configadr = context->slavelist[slave].configadr;
+   ecx_FPWRw(context->port, configadr, ECT_REG_ALCTL, htoes(EC_STATE_SAFE_OP) , timeout); /* set safeop status */
+   state = ecx_statecheck(context, slave, EC_STATE_SAFE_OP, EC_TIMEOUTSTATE); /* check state change safe-op */
+   /* program configured FMMU */
+   for( FMMUc = 0 ; FMMUc < context->slavelist[slave].FMMUunused ; FMMUc++ )
+   {
+      ecx_FPWR(context->port, configadr, (uint16)(ECT_REG_FMMU0 + (sizeof(ec_fmmut) * FMMUc)),
+         sizeof(ec_fmmut), &context->slavelist[slave].FMMU[FMMUc], timeout);
+   }
+
+   return state;
+}
+
+/** Reconfigure slave.
+ *
+ * @param[in] context = context struct
+ * @param[in] slave   = slave to reconfigure
+ * @param[in] timeout = local timeout f.e. EC_TIMEOUTRET3
+ * @return Slave state
+ */
+int ecx_reconfig_slave(ecx_contextt *context, uint16 slave, int timeout)
+{
+   int state;
+
+   state = ecx_reconfig_slave_preop(context, slave, timeout);
+   if( state == EC_STATE_PRE_OP)
+   {
+      /* execute special slave configuration hook Pre-Op to Safe-OP */
+      if(context->slavelist[slave].PO2SOconfig) /* only if registered */
       {
-         /* execute special slave configuration hook Pre-Op to Safe-OP */
-         if(context->slavelist[slave].PO2SOconfig) /* only if registered */
-         {
-            context->slavelist[slave].PO2SOconfig(slave);
-         }
-         ecx_FPWRw(context->port, configadr, ECT_REG_ALCTL, htoes(EC_STATE_SAFE_OP) , timeout); /* set safeop status */
-         state = ecx_statecheck(context, slave, EC_STATE_SAFE_OP, EC_TIMEOUTSTATE); /* check state change safe-op */
-         /* program configured FMMU */
-         for( FMMUc = 0 ; FMMUc < context->slavelist[slave].FMMUunused ; FMMUc++ )
+         ecx_exec_PO2SOconfig(context, slave);
+      }
+      state = ecx_reconfig_slave_safeop(context, slave, timeout);
+   }
+
+   return state;
+}
+
+/** Reconfigure a list of slaves. Same as ecx_reconfig_slave() for each
+ * slave, but the PO2SOconfig hooks of the slaves that reached PRE-OP are
+ * executed in parallel, see context->maxhookthreads.
+ *
+ * @param[in] context  = context struct
+ * @param[in] slavelst = list of slaves to reconfigure
+ * @param[in] n        = number of slaves in list
+ * @param[in] timeout  = local timeout f.e. EC_TIMEOUTRET3
+ * @return Number of slaves that reached SAFE-OP
+ */
+int ecx_reconfig_slaves(ecx_contextt *context, uint16 *slavelst, int n, int timeout)
+{
+   uint16 preoplst[EC_MAXSLAVE];
+   uint16 hooklst[EC_MAXSLAVE];
+   int i, npreop, nhook, nsafeop;
+
+   npreop = 0;
+   nhook = 0;
+   for (i = 0; (i < n) && (npreop < EC_MAXSLAVE); i++)
+   {
+      if (ecx_reconfig_slave_preop(context, slavelst[i], timeout) == EC_STATE_PRE_OP)
+      {
+         preoplst[npreop++] = slavelst[i];
+         if (context->slavelist[slavelst[i]].PO2SOconfig)
          {
-            ecx_FPWR(context->port, configadr, (uint16)(ECT_REG_FMMU0 + (sizeof(ec_fmmut) * FMMUc)),
-               sizeof(ec_fmmut), &context->slavelist[slave].FMMU[FMMUc], timeout);
+            hooklst[nhook++] = slavelst[i];
          }
       }
    }
+   ecx_run_PO2SOconfig(context, hooklst, nhook);
+   nsafeop = 0;
+   for (i = 0; i < npreop; i++)
+   {
+      if (ecx_reconfig_slave_safeop(context, preoplst[i], timeout) == EC_STATE_SAFE_OP)
+      {
+         nsafeop++;
+      }
+   }
 
-   return state;
+   return nsafeop;
 }
 
 #ifdef EC_VER1
@@ -1552,6 +2532,18 @@ int ec_config_init(uint8 usetable)
    return ecx_config_init(&ecx_context, usetable);
 }
 
+/** Enumerate and init slaves connected after ec_config_init into a new group.
+ *
+ * @param[in] group        = group to assign the new slaves to, must not be 0
+ * @param[in] usetable     = TRUE when using configtable to init slaves, FALSE otherwise
+ * @return number of new slaves found, <0 on error
+ * @see ecx_config_init_group
+ */
+int ec_config_init_group(uint8 group, uint8 usetable)
+{
+   return ecx_config_init_group(&ecx_context, group, usetable);
+}
+
 /** Map all PDOs in one group of slaves to IOmap with Outputs/Inputs
  * in sequential order (legacy SOEM way).
  *
@@ -1634,6 +2626,49 @@ int ec_config_overlap(uint8 usetable, void *pIOmap)
    return wkc;
 }
 
+/** Declare a slave to slave process data route.
+ *
+ * @param[in] producer = producer slave
+ * @param[in] Ioffset  = byte offset in producer inputs
+ * @param[in] consumer = consumer slave
+ * @param[in] Ooffset  = byte offset in consumer outputs
+ * @param[in] length   = number of bytes routed
+ * @return route number >0 if successful
+ * @see ecx_config_route
+ */
+int ec_config_route(uint16 producer, uint16 Ioffset, uint16 consumer, uint16 Ooffset, uint16 length)
+{
+   return ecx_config_route(&ecx_context, producer, Ioffset, consumer, Ooffset, length);
+}
+
+/** Reserve IOmap space for an optional slave.
+ *
+ * @param[in] slave   = expected slave position on the network
+ * @param[in] man     = expected manufacturer from EEprom
+ * @param[in] id      = expected ID from EEprom
+ * @param[in] group   = group the slave belongs to
+ * @param[in] Obits   = output bits to reserve
+ * @param[in] Ibits   = input bits to reserve
+ * @return reservation number >0 if successful
+ * @see ecx_config_reserve_slave
+ */
+int ec_config_reserve_slave(uint16 slave, uint32 man, uint32 id,
+   uint8 group, uint16 Obits, uint16 Ibits)
+{
+   return ecx_config_reserve_slave(&ecx_context, slave, man, id, group, Obits, Ibits);
+}
+
+/** Handle connect and disconnect of optional slaves.
+ *
+ * @param[in] usetable = TRUE when using configtable to init slaves, FALSE otherwise
+ * @return number of optional slaves mapped or removed
+ * @see ecx_config_optional_slaves
+ */
+int ec_config_optional_slaves(uint8 usetable)
+{
+   return ecx_config_optional_slaves(&ecx_context, usetable);
+}
+
 /** Recover slave.
  *
  * @param[in] slave   = slave to recover
@@ -1657,4 +2692,17 @@ int ec_reconfig_slave(uint16 slave, int timeout)
 {
    return ecx_reconfig_slave(&ecx_context, slave, timeout);
 }
+
+/** Reconfigure a list of slaves.
+ *
+ * @param[in] slavelst = list of slaves to reconfigure
+ * @param[in] n        = number of slaves in list
+ * @param[in] timeout  = local timeout f.e. EC_TIMEOUTRET3
+ * @return Number of slaves that reached SAFE-OP
+ * @see ecx_reconfig_slaves
+ */
+int ec_reconfig_slaves(uint16 *slavelst, int n, int timeout)
+{
+   return ecx_reconfig_slaves(&ecx_context, slavelst, n, timeout);
+}
 #endif
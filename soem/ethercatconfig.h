@@ -18,24 +18,45 @@ extern "C"
 
 #define EC_NODEOFFSET      0x1000
 #define EC_TEMPNODE        0xffff
+/** standard SM0 flags configuration for mailbox slaves */
+#define EC_DEFAULTMBXSM0   0x00010026
+/** standard SM1 flags configuration for mailbox slaves */
+#define EC_DEFAULTMBXSM1   0x00010022
 
 #ifdef EC_VER1
 int ec_config_init(uint8 usetable);
+int ec_config_init_group(uint8 group, uint8 usetable);
 int ec_config_map(void *pIOmap);
 int ec_config_overlap_map(void *pIOmap);
 int ec_config_map_group(void *pIOmap, uint8 group);
 int ec_config_overlap_map_group(void *pIOmap, uint8 group);
 int ec_config(uint8 usetable, void *pIOmap);
 int ec_config_overlap(uint8 usetable, void *pIOmap);
+int ec_config_reserve_slave(uint16 slave, uint32 man, uint32 id,
+   uint8 group, uint16 Obits, uint16 Ibits);
+int ec_config_optional_slaves(uint8 usetable);
+int ec_config_route(uint16 producer, uint16 Ioffset, uint16 consumer, uint16 Ooffset, uint16 length);
 int ec_recover_slave(uint16 slave, int timeout);
 int ec_reconfig_slave(uint16 slave, int timeout);
+int ec_reconfig_slaves(uint16 *slavelst, int n, int timeout);
 #endif
 
 int ecx_config_init(ecx_contextt *context, uint8 usetable);
+int ecx_config_init_group(ecx_contextt *context, uint8 group, uint8 usetable);
 int ecx_config_map_group(ecx_contextt *context, void *pIOmap, uint8 group);
 int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 group);
+int ecx_config_reserve_slave(ecx_contextt *context, uint16 slave, uint32 man, uint32 id,
+   uint8 group, uint16 Obits, uint16 Ibits);
+int ecx_config_optional_slaves(ecx_contextt *context, uint8 usetable);
+int ecx_config_route(ecx_contextt *context, uint16 producer, uint16 Ioffset,
+   uint16 consumer, uint16 Ooffset, uint16 length);
 int ecx_recover_slave(ecx_contextt *context, uint16 slave, int timeout);
 int ecx_reconfig_slave(ecx_contextt *context, uint16 slave, int timeout);
+int ecx_reconfig_slaves(ecx_contextt *context, uint16 *slavelst, int n, int timeout);
+void ecx_init_context(ecx_contextt *context);
+int ecx_detect_slaves(ecx_contextt *context);
+void ecx_set_slaves_to_default(ecx_contextt *context);
+void ecx_config_links(ecx_contextt *context, uint16 slave);
 
 #ifdef __cplusplus
 }
@@ -8,6 +8,7 @@
  * Distributed Clock EtherCAT functions.
  *
  */
+#include <string.h>
 #include "oshw.h"
 #include "osal.h"
 #include "ethercattype.h"
@@ -23,6 +24,9 @@
 /** 1st sync pulse delay in ns here 100ms */
 #define SyncDelay       ((int32)100000000)
 
+/** latch status and latch time registers, 0x09AE to 0x09CF */
+#define LatchBlock      (ECT_REG_DCLATCH1NEG + sizeof(int64) - ECT_REG_DCLATCH0STAT)
+
 /**
  * Set DC of slave to fire sync0 at CyclTime interval with CyclShift offset.
  *
@@ -244,35 +248,58 @@ static uint8 ecx_parentport(ecx_contextt *context, uint16 parent)
 }
 
 /**
- * Locate DC slaves, measure propagation delays.
+ * Locate DC slaves of a group, measure propagation delays and align their
+ * system time. Registers of slaves outside the group are not written, so
+ * those slaves can stay in operation. If such slaves already use DC the
+ * existing reference clock is kept and the new slaves are aligned to it
+ * instead of to the master time.
  *
  * @param[in]  context        = context struct
- * @return boolean if slaves are found with DC
+ * @param[in]  group          = group to configure, 0 = all groups
+ * @return boolean if slaves of the group are found with DC
  */
-boolean ecx_configdc(ecx_contextt *context)
+boolean ecx_configdc_group(ecx_contextt *context, uint8 group)
 {
    uint16 i, slaveh, parent, child;
    uint16 parenthold = 0;
    uint16 prevDCslave = 0;
-   int32 ht, dt1, dt2, dt3;
-   int64 hrt;
+   uint16 refslave;
+   int32 ht, dt1, dt2, dt3, pdelay;
+   int64 hrt, refrt, refofs;
    uint8 entryport;
    int8 nlist;
    int8 plist[4];
    int32 tlist[4];
    ec_timet mastertime;
    uint64 mastertime64;
+   boolean online, config, groupdc;
 
+   /* keep reference clock if it is in operation outside the group */
+   refslave = context->slavelist[0].DCnext;
+   online = group && context->slavelist[0].hasdc &&
+            (context->slavelist[refslave].group != group);
+   groupdc = FALSE;
    context->slavelist[0].hasdc = FALSE;
-   context->grouplist[0].hasdc = FALSE;
+   context->grouplist[group].hasdc = FALSE;
    ht = 0;
+   refrt = 0;
+   refofs = 0;
 
    ecx_BWR(context->port, 0, ECT_REG_DCTIME0, sizeof(ht), &ht, EC_TIMEOUTRET);  /* latch DCrecvTimeA of all slaves */
    mastertime = osal_current_time();
    mastertime.sec -= 946684800UL;  /* EtherCAT uses 2000-01-01 as epoch start instead of 1970-01-01 */
    mastertime64 = (((uint64)mastertime.sec * 1000000) + (uint64)mastertime.usec) * 1000;
+   if (online)
+   {
+      slaveh = context->slavelist[refslave].configadr;
+      (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCSOF, sizeof(refrt), &refrt, EC_TIMEOUTRET);
+      (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCSYSOFFSET, sizeof(refofs), &refofs, EC_TIMEOUTRET);
+      refrt = etohll(refrt);
+      refofs = etohll(refofs);
+   }
    for (i = 1; i <= *(context->slavecount); i++)
    {
+      config = !group || (context->slavelist[i].group == group);
       context->slavelist[i].consumedports = context->slavelist[i].activeports;
       if (context->slavelist[i].hasdc)
       {
@@ -281,14 +308,16 @@ boolean ecx_configdc(ecx_contextt *context)
             context->slavelist[0].hasdc = TRUE;
             context->slavelist[0].DCnext = i;
             context->slavelist[i].DCprevious = 0;
-            context->grouplist[0].hasdc = TRUE;
-            context->grouplist[0].DCnext = i;
          }
          else
          {
             context->slavelist[prevDCslave].DCnext = i;
             context->slavelist[i].DCprevious = prevDCslave;
          }
+         if (config)
+         {
+            groupdc = TRUE;
+         }
          /* this branch has DC slave so remove parenthold */
          parenthold = 0;
          prevDCslave = i;
@@ -296,11 +325,11 @@ boolean ecx_configdc(ecx_contextt *context)
          (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCTIME0, sizeof(ht), &ht, EC_TIMEOUTRET);
          context->slavelist[i].DCrtA = etohl(ht);
          /* 64bit latched DCrecvTimeA of each specific slave */
-         (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCSOF, sizeof(hrt), &hrt, EC_TIMEOUTRET);
-         /* use it as offset in order to set local time around 0 + mastertime */
-         hrt = htoell(-etohll(hrt) + mastertime64);
-         /* save it in the offset register */
-         (void)ecx_FPWR(context->port, slaveh, ECT_REG_DCSYSOFFSET, sizeof(hrt), &hrt, EC_TIMEOUTRET);
+         hrt = 0;
+         if (config)
+         {
+            (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCSOF, sizeof(hrt), &hrt, EC_TIMEOUTRET);
+         }
          (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCTIME1, sizeof(ht), &ht, EC_TIMEOUTRET);
          context->slavelist[i].DCrtB = etohl(ht);
          (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCTIME2, sizeof(ht), &ht, EC_TIMEOUTRET);
@@ -401,11 +430,32 @@ boolean ecx_configdc(ecx_contextt *context)
 
             /* calculate current slave delay from delta times */
             /* assumption : forward delay equals return delay */
-            context->slavelist[i].pdelay = ((dt3 - dt1) / 2) + dt2 +
+            pdelay = ((dt3 - dt1) / 2) + dt2 +
                context->slavelist[parent].pdelay;
-            ht = htoel(context->slavelist[i].pdelay);
-            /* write propagation delay*/
-            (void)ecx_FPWR(context->port, slaveh, ECT_REG_DCSYSDELAY, sizeof(ht), &ht, EC_TIMEOUTRET);
+            /* slaves in operation keep their programmed delay */
+            if (config)
+            {
+               context->slavelist[i].pdelay = pdelay;
+               ht = htoel(pdelay);
+               /* write propagation delay*/
+               (void)ecx_FPWR(context->port, slaveh, ECT_REG_DCSYSDELAY, sizeof(ht), &ht, EC_TIMEOUTRET);
+            }
+         }
+         if (config)
+         {
+            if (online)
+            {
+               /* use it as offset in order to set system time equal to the reference clock */
+               hrt = htoell(refrt + refofs - etohll(hrt) +
+                     context->slavelist[i].pdelay - context->slavelist[refslave].pdelay);
+            }
+            else
+            {
+               /* use it as offset in order to set local time around 0 + mastertime */
+               hrt = htoell(-etohll(hrt) + mastertime64);
+            }
+            /* save it in the offset register */
+            (void)ecx_FPWR(context->port, slaveh, ECT_REG_DCSYSOFFSET, sizeof(hrt), &hrt, EC_TIMEOUTRET);
          }
       }
       else
@@ -427,7 +477,292 @@ boolean ecx_configdc(ecx_contextt *context)
       }
    }
 
-   return context->slavelist[0].hasdc;
+   if (online)
+   {
+      context->slavelist[0].DCnext = refslave;
+   }
+   if (groupdc)
+   {
+      context->grouplist[group].hasdc = TRUE;
+      context->grouplist[group].DCnext = context->slavelist[0].DCnext;
+   }
+
+   return groupdc;
+}
+
+/**
+ * Locate DC slaves, measure propagation delays.
+ *
+ * @param[in]  context        = context struct
+ * @return boolean if slaves are found with DC
+ */
+boolean ecx_configdc(ecx_contextt *context)
+{
+   return ecx_configdc_group(context, 0);
+}
+
+/** Initialise a DC latch service.
+ *
+ * @param[out] latch          = latch service state
+ * @param[in]  group          = group of the slaves that will be armed
+ * @param[in]  useirq         = TRUE = only read latch times when the process
+ *                              data of group shows a DC latch event
+ */
+void ec_latch_init(ec_latcht *latch, uint8 group, boolean useirq)
+{
+   memset(latch, 0x00, sizeof(ec_latcht));
+   latch->group = group;
+   latch->useirq = useirq;
+}
+
+/** Get the latch times from a latch register block.
+ *
+ * @param[in]  block          = latch register block
+ * @param[out] times          = latch 0 rising, falling, latch 1 rising, falling
+ */
+static void ecx_latchtimes(const uint8 *block, int64 *times)
+{
+   int64 le_time;
+   int i;
+
+   for (i = 0; i < 4; i++)
+   {
+      memcpy(&le_time, &block[(ECT_REG_DCLATCH0POS - ECT_REG_DCLATCH0STAT) + (i * sizeof(int64))], sizeof(le_time));
+      times[i] = etohll(le_time);
+   }
+}
+
+/**
+ * Arm the DC latch units of a slave. The current latch times are read so only
+ * new edges are reported by ecx_latch_tick.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  latch          = latch service state
+ * @param [in] slave            Slave number.
+ * @param [in] mode             EC_LATCH0 and/or EC_LATCH1, with EC_LATCH_SINGLE
+ *                              for single event mode. 0 = disarm.
+ * @return workcounter of latch time read, 0 if slave can not be armed
+ */
+int ecx_latch_arm(ecx_contextt *context, ec_latcht *latch, uint16 slave, uint8 mode)
+{
+   uint8 block[LatchBlock];
+   uint16 slaveh, ctrl, w;
+   uint8 cuc;
+   int i, wkc;
+
+   for (i = 0; (i < latch->nslave) && (latch->slave[i] != slave); i++);
+   if (mode == 0)
+   {
+      if (i < latch->nslave)
+      {
+         /* keep order of remaining slaves */
+         latch->nslave--;
+         memmove(&latch->slave[i], &latch->slave[i + 1], (latch->nslave - i) * sizeof(latch->slave[0]));
+         memmove(&latch->mode[i], &latch->mode[i + 1], (latch->nslave - i) * sizeof(latch->mode[0]));
+         memmove(&latch->last[i], &latch->last[i + 1], (latch->nslave - i) * sizeof(latch->last[0]));
+      }
+      return 0;
+   }
+   if ((slave == 0) || (slave > *(context->slavecount)) || !context->slavelist[slave].hasdc ||
+       (context->slavelist[slave].group != latch->group) ||
+       ((i == latch->nslave) && (latch->nslave >= EC_MAXLATCHSLAVE)))
+   {
+      return 0;
+   }
+   slaveh = context->slavelist[slave].configadr;
+   /* latch units controlled by EtherCAT instead of PDI */
+   cuc = 0;
+   ecx_FPRD(context->port, slaveh, ECT_REG_DCCUC, sizeof(cuc), &cuc, EC_TIMEOUTRET);
+   cuc &= ~0x30;
+   ecx_FPWR(context->port, slaveh, ECT_REG_DCCUC, sizeof(cuc), &cuc, EC_TIMEOUTRET);
+   /* both edges of a latch unit in single event or continuous mode */
+   ctrl = 0;
+   if (mode & EC_LATCH_SINGLE)
+   {
+      ctrl = ((mode & EC_LATCH0) ? 0x0003 : 0) | ((mode & EC_LATCH1) ? 0x0300 : 0);
+   }
+   ctrl = htoes(ctrl);
+   ecx_FPWR(context->port, slaveh, ECT_REG_DCLATCH0CTRL, sizeof(ctrl), &ctrl, EC_TIMEOUTRET);
+   if (latch->useirq)
+   {
+      w = 0;
+      ecx_FPRD(context->port, slaveh, ECT_REG_IRQMASK, sizeof(w), &w, EC_TIMEOUTRET);
+      w |= htoes(EC_EVENT_DCLATCH);
+      ecx_FPWR(context->port, slaveh, ECT_REG_IRQMASK, sizeof(w), &w, EC_TIMEOUTRET);
+   }
+   memset(block, 0x00, sizeof(block));
+   wkc = ecx_FPRD(context->port, slaveh, ECT_REG_DCLATCH0STAT, sizeof(block), block, EC_TIMEOUTRET);
+   latch->slave[i] = slave;
+   latch->mode[i] = mode;
+   ecx_latchtimes(block, latch->last[i]);
+   if (i == latch->nslave)
+   {
+      latch->nslave++;
+   }
+   return wkc;
+}
+
+/**
+ * Collect the latch frame of the previous call and send a new frame reading
+ * the latch times of all armed slaves. New edges are added to the event ring
+ * buffer in order of DC time. To be called once per cycle from the cyclic
+ * task, after the process data is received. Does not block.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  latch          = latch service state
+ * @return number of new events
+ */
+int ecx_latch_tick(ecx_contextt *context, ec_latcht *latch)
+{
+   ec_latcheventt found[EC_MAXLATCHSLAVE * 4];
+   ec_latcheventt ev;
+   int64 times[4], host, diff;
+   uint16 le_wkc;
+   uint32 head, next;
+   ec_timet now;
+   int i, j, k, n, idx, wkc;
+
+   /* host time minus DC time of last process data, follows the lowest
+    * observed delay between frame and host clock */
+   now = osal_current_time();
+   host = ((int64)now.sec * 1000000000) + ((int64)now.usec * 1000);
+   if (*(context->DCtime))
+   {
+      diff = host - *(context->DCtime);
+      if (!latch->synced || (diff < latch->offset))
+      {
+         latch->offset = diff;
+         latch->synced = TRUE;
+      }
+      else
+      {
+         latch->offset += (diff - latch->offset) / 1024;
+      }
+   }
+
+   n = 0;
+   /* collect result of frame sent by previous call */
+   if (latch->pending)
+   {
+      idx = latch->idx;
+      wkc = ecx_waitinframe(context->port, idx, 0);
+      if (wkc > EC_NOFRAME)
+      {
+         for (i = 0; i < latch->nslave; i++)
+         {
+            memcpy(&le_wkc, &(context->port->rxbuf[idx][latch->datapos[i] + LatchBlock]), EC_WKCSIZE);
+            if (etohs(le_wkc) == 0)
+            {
+               continue;
+            }
+            ecx_latchtimes(&(context->port->rxbuf[idx][latch->datapos[i]]), times);
+            for (j = 0; j < 4; j++)
+            {
+               if ((latch->mode[i] & ((j < 2) ? EC_LATCH0 : EC_LATCH1)) &&
+                   (times[j] != latch->last[i][j]))
+               {
+                  latch->last[i][j] = times[j];
+                  ev.slave = latch->slave[i];
+                  ev.latch = (uint8)(j / 2);
+                  ev.edge = (j & 1) ? EC_LATCH_FALLING : EC_LATCH_RISING;
+                  ev.dctime = times[j];
+                  ec_latch_dc2host(latch, times[j], &ev.time);
+                  /* insert sorted on DC time */
+                  for (k = n; (k > 0) && (found[k - 1].dctime > ev.dctime); k--)
+                  {
+                     found[k] = found[k - 1];
+                  }
+                  found[k] = ev;
+                  n++;
+               }
+            }
+         }
+      }
+      /* release index also when the frame is lost or late */
+      ecx_setbufstat(context->port, idx, EC_BUF_EMPTY);
+      latch->pending = FALSE;
+   }
+   for (i = 0; i < n; i++)
+   {
+      head = latch->head;
+      next = (head + 1) & (EC_MAXLATCHEVENT - 1);
+      if (next == latch->tail)
+      {
+         latch->lost++;
+         continue;
+      }
+      latch->event[head] = found[i];
+      /* event must be complete before it is visible to reader */
+      OSAL_MEMORY_BARRIER();
+      latch->head = next;
+   }
+
+   /* send new read, with irq only when a slave latched */
+   if (latch->nslave &&
+       (!latch->useirq || (context->grouplist[latch->group].irpt & EC_EVENT_DCLATCH)))
+   {
+      idx = ecx_getindex(context->port);
+      for (i = 0; i < latch->nslave; i++)
+      {
+         if (i == 0)
+         {
+            ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FPRD, idx,
+               context->slavelist[latch->slave[i]].configadr, ECT_REG_DCLATCH0STAT, LatchBlock, NULL);
+            latch->datapos[i] = EC_HEADERSIZE;
+         }
+         else
+         {
+            latch->datapos[i] = (uint16)ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FPRD,
+               idx, (i < (latch->nslave - 1)), context->slavelist[latch->slave[i]].configadr,
+               ECT_REG_DCLATCH0STAT, LatchBlock, NULL);
+         }
+      }
+      ecx_outframe_red(context->port, idx);
+      latch->idx = (uint8)idx;
+      latch->pending = TRUE;
+   }
+   return n;
+}
+
+/** Get the next latch event. Lock free against ecx_latch_tick, but the event
+ * queue has a single consumer: call it from one thread only, which may run
+ * concurrently with ecx_latch_tick.
+ *
+ * @param[in]  latch          = latch service state
+ * @param[out] event          = latch event
+ * @return 1 if an event is returned, 0 if there are no events
+ */
+int ec_latch_read(ec_latcht *latch, ec_latcheventt *event)
+{
+   uint32 tail;
+
+   tail = latch->tail;
+   if (tail == latch->head)
+   {
+      return 0;
+   }
+   /* read event only after head */
+   OSAL_MEMORY_BARRIER();
+   *event = latch->event[tail];
+   OSAL_MEMORY_BARRIER();
+   latch->tail = (tail + 1) & (EC_MAXLATCHEVENT - 1);
+   return 1;
+}
+
+/** Convert DC system time to host time with the offset tracked by
+ * ecx_latch_tick.
+ *
+ * @param[in]  latch          = latch service state
+ * @param[in]  dctime         = DC system time in ns
+ * @param[out] time           = host time
+ */
+void ec_latch_dc2host(ec_latcht *latch, int64 dctime, ec_timet *time)
+{
+   int64 host;
+
+   host = dctime + latch->offset;
+   time->sec = (uint32)(host / 1000000000);
+   time->usec = (uint32)((host % 1000000000) / 1000);
 }
 
 #ifdef EC_VER1
@@ -441,8 +776,23 @@ void ec_dcsync01(uint16 slave, boolean act, uint32 CyclTime0, uint32 CyclTime1,
    ecx_dcsync01(&ecx_context, slave, act, CyclTime0, CyclTime1, CyclShift);
 }
 
+int ec_latch_arm(ec_latcht *latch, uint16 slave, uint8 mode)
+{
+   return ecx_latch_arm(&ecx_context, latch, slave, mode);
+}
+
+int ec_latch_tick(ec_latcht *latch)
+{
+   return ecx_latch_tick(&ecx_context, latch);
+}
+
 boolean ec_configdc(void)
 {
    return ecx_configdc(&ecx_context);
 }
+
+boolean ec_configdc_group(uint8 group)
+{
+   return ecx_configdc_group(&ecx_context, group);
+}
 #endif
@@ -16,15 +16,91 @@ extern "C"
 {
 #endif
 
+/** max. number of slaves with armed latch units per latch service */
+#define EC_MAXLATCHSLAVE     16
+/** size of latch event ring buffer, must be a power of 2 */
+#define EC_MAXLATCHEVENT     256
+/** latch mode, arm latch unit 0 */
+#define EC_LATCH0            0x01
+/** latch mode, arm latch unit 1 */
+#define EC_LATCH1            0x02
+/** latch mode, single event instead of continuous, next edge is latched
+ *  after the time is read */
+#define EC_LATCH_SINGLE      0x04
+/** latch event edge, rising edge */
+#define EC_LATCH_RISING      0x01
+/** latch event edge, falling edge */
+#define EC_LATCH_FALLING     0x02
+
+/** DC latch event */
+typedef struct ec_latchevent
+{
+   /** slave number */
+   uint16           slave;
+   /** latch unit 0 or 1 */
+   uint8            latch;
+   /** EC_LATCH_RISING or EC_LATCH_FALLING */
+   uint8            edge;
+   /** DC system time of edge in ns */
+   int64            dctime;
+   /** host time of edge */
+   ec_timet         time;
+} ec_latcheventt;
+
+/** DC latch service state, owned by the application */
+typedef struct ec_latch
+{
+   /** group of the armed slaves */
+   uint8            group;
+   /** TRUE = only read latch times when the process data shows a DC latch event */
+   boolean          useirq;
+   /** number of slaves with armed latch units */
+   int              nslave;
+   /** slaves with armed latch units */
+   uint16           slave[EC_MAXLATCHSLAVE];
+   /** latch mode per slave */
+   uint8            mode[EC_MAXLATCHSLAVE];
+   /** last latch times per slave, latch 0 rising, falling, latch 1 rising, falling */
+   int64            last[EC_MAXLATCHSLAVE][4];
+   /** host time minus DC time in ns */
+   int64            offset;
+   /** TRUE if offset is valid */
+   boolean          synced;
+   /** internal, TRUE if latch frame is in flight */
+   boolean          pending;
+   /** internal, index of latch frame in flight */
+   uint8            idx;
+   /** internal, position of latch data per slave in frame */
+   uint16           datapos[EC_MAXLATCHSLAVE];
+   /** event ring buffer */
+   ec_latcheventt   event[EC_MAXLATCHEVENT];
+   /** next event to write, only changed by ecx_latch_tick */
+   volatile uint32  head;
+   /** next event to read, only changed by ec_latch_read of the single consumer thread */
+   volatile uint32  tail;
+   /** events lost because ring buffer was full */
+   volatile uint32  lost;
+} ec_latcht;
+
+void ec_latch_init(ec_latcht *latch, uint8 group, boolean useirq);
+int ec_latch_read(ec_latcht *latch, ec_latcheventt *event);
+void ec_latch_dc2host(ec_latcht *latch, int64 dctime, ec_timet *time);
+
 #ifdef EC_VER1
 boolean ec_configdc();
+boolean ec_configdc_group(uint8 group);
 void ec_dcsync0(uint16 slave, boolean act, uint32 CyclTime, int32 CyclShift);
 void ec_dcsync01(uint16 slave, boolean act, uint32 CyclTime0, uint32 CyclTime1, int32 CyclShift);
+int ec_latch_arm(ec_latcht *latch, uint16 slave, uint8 mode);
+int ec_latch_tick(ec_latcht *latch);
 #endif
 
 boolean ecx_configdc(ecx_contextt *context);
+boolean ecx_configdc_group(ecx_contextt *context, uint8 group);
 void ecx_dcsync0(ecx_contextt *context, uint16 slave, boolean act, uint32 CyclTime, int32 CyclShift);
 void ecx_dcsync01(ecx_contextt *context, uint16 slave, boolean act, uint32 CyclTime0, uint32 CyclTime1, int32 CyclShift);
+int ecx_latch_arm(ecx_contextt *context, ec_latcht *latch, uint16 slave, uint8 mode);
+int ecx_latch_tick(ecx_contextt *context, ec_latcht *latch);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,964 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Link error diagnostics module.
+ *
+ * The port error counters 0x0300-0x0313 of all slaves are read and cleared
+ * in one sweep with a single FPRW datagram per slave, chained into as few
+ * frames as possible. Errors are accumulated per link and kept in a short
+ * history. A frame corrupted on a cable is counted as invalid frame or
+ * physical error by the port that receives it, following slaves only count
+ * it as forwarded error. The port with rising local errors therefore points
+ * to the link segment where the errors originate.
+ *
+ * One sweep costs 32 bytes per slave, at 1 sweep per second 100 slaves use
+ * about 0.03% of a 100Mbit link.
+ *
+ * The bus load analyzer computes the frames of the process data of a group as
+ * sent by ecx_send_processdata_group(), the time to transmit them at 100Mbit
+ * and the time they need to pass all slaves. Together this is the minimum
+ * feasible cycle of the group. Measured round trips can be added and groups
+ * can be compared to find groups that should be split or merged.
+ *
+ * Register snapshots read configurable ESC register ranges of all slaves with
+ * FPRD datagrams chained up to the maximum frame size. The result is stored
+ * in a compact little endian binary format that can be saved and decoded
+ * later, also on another machine:
+ *
+ * header   : magic uint32, version uint16, nslaves uint16, nranges uint16, reserved uint16
+ * ranges   : nranges x (start uint16, length uint16)
+ * slaves   : nslaves x (slave uint16, configadr uint16, eep_man uint32, eep_id uint32,
+ *            nranges x (valid uint8, data[length]))
+ */
+
+#include <string.h>
+#include "osal.h"
+#include "oshw.h"
+#include "ethercat.h"
+
+/** size of port error counter block 0x0300-0x0313 */
+#define EC_LINKERRSIZE       20
+/** slaves per sweep frame */
+#define EC_LINKERRSLAVES     (EC_MAXLRWDATA / (EC_HEADERSIZE + EC_LINKERRSIZE + EC_WKCSIZE))
+/** Ethernet preamble, SFD, FCS and inter frame gap in bytes */
+#define EC_WIREOVERHEAD      (8 + 4 + 12)
+/** minimum Ethernet frame size without FCS */
+#define EC_MINFRAME          60
+/** transmit time of one byte at 100Mbit in ns */
+#define EC_BYTETIME          80
+/** size of DC FRMW datagram added to first process data frame */
+#define EC_DCDATAGRAM        (EC_HEADERSIZE + sizeof(int64) + EC_WKCSIZE)
+/** size of register snapshot header */
+#define EC_REGSNAPHDR        12
+/** size of register snapshot slave record header */
+#define EC_REGSNAPSLAVE      12
+/** max register bytes in one snapshot datagram */
+#define EC_REGSNAPDGMAX      (EC_MAXLRWDATA - EC_HEADERSIZE - EC_WKCSIZE)
+/** max datagrams in one snapshot frame */
+#define EC_REGSNAPDGS        (EC_MAXLRWDATA / (EC_HEADERSIZE + 1 + EC_WKCSIZE))
+
+/** Snapshot datagram, read into data and clears valid on failure */
+typedef struct
+{
+   uint16           configadr;
+   uint16           ADO;
+   uint16           length;
+   uint8            *data;
+   uint8            *valid;
+} ec_regsnapdgt;
+
+/** Known ESC registers for the snapshot decoder */
+static const struct
+{
+   uint16           reg;
+   uint16           length;
+   const char       *name;
+} ec_regnames[] = {
+   { ECT_REG_TYPE,         1, "Type" },
+   { ECT_REG_PORTDES,      1, "Port descriptor" },
+   { ECT_REG_ESCSUP,       2, "ESC features" },
+   { ECT_REG_STADR,        2, "Station address" },
+   { ECT_REG_ALIAS,        2, "Station alias" },
+   { ECT_REG_DLCTL,        1, "DL control" },
+   { ECT_REG_DLALIAS,      1, "DL alias" },
+   { ECT_REG_DLSTAT,       2, "DL status" },
+   { ECT_REG_ALCTL,        2, "AL control" },
+   { ECT_REG_ALSTAT,       2, "AL status" },
+   { ECT_REG_ALSTATCODE,   2, "AL status code" },
+   { ECT_REG_PDICTL,       1, "PDI control" },
+   { ECT_REG_IRQMASK,      2, "IRQ mask" },
+   { ECT_REG_RXERR,        8, "RX error counters" },
+   { ECT_REG_FRXERR,       4, "Forwarded RX error counters" },
+   { ECT_REG_EPUECNT,      1, "ECAT processing unit error counter" },
+   { ECT_REG_PECNT,        1, "PDI error counter" },
+   { ECT_REG_PECODE,       1, "PDI error code" },
+   { ECT_REG_LLCNT,        4, "Lost link counters" },
+   { ECT_REG_WDCNT,        1, "Watchdog counter process data" },
+   { ECT_REG_EEPCFG,       2, "EEPROM configuration" },
+   { ECT_REG_EEPCTL,       2, "EEPROM control/status" },
+   { ECT_REG_EEPADR,       4, "EEPROM address" },
+   { ECT_REG_EEPDAT,       8, "EEPROM data" },
+   { ECT_REG_FMMU0,       16, "FMMU0" },
+   { ECT_REG_FMMU1,       16, "FMMU1" },
+   { ECT_REG_FMMU2,       16, "FMMU2" },
+   { ECT_REG_FMMU3,       16, "FMMU3" },
+   { ECT_REG_SM0,          8, "SM0" },
+   { ECT_REG_SM1,          8, "SM1" },
+   { ECT_REG_SM2,          8, "SM2" },
+   { ECT_REG_SM3,          8, "SM3" },
+   { ECT_REG_DCTIME0,      4, "DC receive time port 0" },
+   { ECT_REG_DCTIME1,      4, "DC receive time port 1" },
+   { ECT_REG_DCTIME2,      4, "DC receive time port 2" },
+   { ECT_REG_DCTIME3,      4, "DC receive time port 3" },
+   { ECT_REG_DCSYSTIME,    8, "DC system time" },
+   { ECT_REG_DCSOF,        8, "DC receive time processing unit" },
+   { ECT_REG_DCSYSOFFSET,  8, "DC system time offset" },
+   { ECT_REG_DCSYSDELAY,   4, "DC system time delay" },
+   { ECT_REG_DCSYSDIFF,    4, "DC system time difference" },
+   { ECT_REG_DCSPEEDCNT,   4, "DC speed counter" },
+   { ECT_REG_DCTIMEFILT,   2, "DC time filter depth" },
+   { ECT_REG_DCCUC,        1, "DC cyclic unit control" },
+   { ECT_REG_DCSYNCACT,    1, "DC activation" },
+   { ECT_REG_DCSTART0,     8, "DC start time cyclic operation" },
+   { ECT_REG_DCCYCLE0,     4, "DC SYNC0 cycle time" },
+   { ECT_REG_DCCYCLE1,     4, "DC SYNC1 cycle time" },
+};
+
+static void ec_put16(uint8 *p, uint16 val)
+{
+   p[0] = (uint8)(val & 0xff);
+   p[1] = (uint8)(val >> 8);
+}
+
+static void ec_put32(uint8 *p, uint32 val)
+{
+   ec_put16(p, (uint16)(val & 0xffff));
+   ec_put16(p + 2, (uint16)(val >> 16));
+}
+
+static uint16 ec_get16(const uint8 *p)
+{
+   return (uint16)(p[0] | (p[1] << 8));
+}
+
+static uint32 ec_get32(const uint8 *p)
+{
+   return (uint32)ec_get16(p) | ((uint32)ec_get16(p + 2) << 16);
+}
+
+static void ecx_linkdiag_add(ec_linkdiagt *diag, uint16 slave, uint8 *cnt)
+{
+   ec_linkstatt *link;
+   uint8 port;
+
+   for (port = 0; port < EC_MAXPORT; port++)
+   {
+      link = &(diag->link[slave][port]);
+      link->rxerr += cnt[port * 2];
+      link->phyerr += cnt[(port * 2) + 1];
+      link->fwderr += cnt[8 + port];
+      link->lostlink += cnt[16 + port];
+      link->hist[diag->histpos] = cnt[port * 2] + cnt[(port * 2) + 1];
+   }
+   diag->epuerr[slave] += cnt[12];
+   diag->pdierr[slave] += cnt[13];
+}
+
+/** Read and clear the port error counters of all slaves and add them to the
+ * link statistics. Blocking, to be called periodically from a non cyclic task.
+ *
+ * @param[in]  context = context struct
+ * @param[in,out] diag = link diagnostics state, zero before first sweep
+ * @return number of slaves read
+ */
+int ecx_linkdiag_sweep(ecx_contextt *context, ec_linkdiagt *diag)
+{
+   uint8 zbuf[EC_LINKERRSIZE];
+   int offset[EC_LINKERRSLAVES];
+   uint16 slave, le_wkc, configadr;
+   uint8 port;
+   int i, n, idx, wkc, cnt;
+
+   memset(zbuf, 0x00, sizeof(zbuf));
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      for (port = 0; port < EC_MAXPORT; port++)
+      {
+         diag->link[slave][port].hist[diag->histpos] = 0;
+      }
+   }
+   cnt = 0;
+   slave = 1;
+   while (slave <= *(context->slavecount))
+   {
+      n = *(context->slavecount) - slave + 1;
+      if (n > (int)EC_LINKERRSLAVES)
+      {
+         n = EC_LINKERRSLAVES;
+      }
+      idx = ecx_getindex(context->port);
+      for (i = 0; i < n; i++)
+      {
+         configadr = context->slavelist[slave + i].configadr;
+         /* read counters and write zero to clear them in the same datagram */
+         if (i == 0)
+         {
+            ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FPRW, idx,
+               configadr, ECT_REG_RXERR, EC_LINKERRSIZE, zbuf);
+            offset[i] = EC_HEADERSIZE;
+         }
+         else
+         {
+            offset[i] = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FPRW, idx,
+               (i < (n - 1)), configadr, ECT_REG_RXERR, EC_LINKERRSIZE, zbuf);
+         }
+      }
+      wkc = ecx_srconfirm(context->port, idx, EC_TIMEOUTRET);
+      if (wkc > EC_NOFRAME)
+      {
+         for (i = 0; i < n; i++)
+         {
+            memcpy(&le_wkc, &(context->port->rxbuf[idx][offset[i] + EC_LINKERRSIZE]), EC_WKCSIZE);
+            if (etohs(le_wkc))
+            {
+               ecx_linkdiag_add(diag, slave + i, &(context->port->rxbuf[idx][offset[i]]));
+               cnt++;
+            }
+         }
+      }
+      ecx_setbufstat(context->port, idx, EC_BUF_EMPTY);
+      slave += n;
+   }
+   diag->histpos = (diag->histpos + 1) % EC_LINKHIST;
+   diag->sweeps++;
+   return cnt;
+}
+
+/** Local errors of the link on a slave port over the last sweeps.
+ *
+ * @param[in]  context = context struct
+ * @param[in]  diag    = link diagnostics state
+ * @param[in]  slave   = slave number
+ * @param[in]  port    = port number 0-3
+ * @param[in]  nsweeps = number of sweeps, max EC_LINKHIST
+ * @return invalid frames and physical errors received on port
+ */
+uint32 ecx_linkdiag_errors(ecx_contextt *context, ec_linkdiagt *diag, uint16 slave, uint8 port, int nsweeps)
+{
+   uint32 errors;
+   uint16 pos;
+   int i;
+
+   if ((slave == 0) || (slave > *(context->slavecount)) || (port >= EC_MAXPORT))
+   {
+      return 0;
+   }
+   if (nsweeps > EC_LINKHIST)
+   {
+      nsweeps = EC_LINKHIST;
+   }
+   if ((uint32)nsweeps > diag->sweeps)
+   {
+      nsweeps = diag->sweeps;
+   }
+   errors = 0;
+   pos = diag->histpos;
+   for (i = 0; i < nsweeps; i++)
+   {
+      pos = (pos + EC_LINKHIST - 1) % EC_LINKHIST;
+      errors += diag->link[slave][port].hist[pos];
+   }
+   return errors;
+}
+
+/** Find the link with the most local errors over the last sweeps.
+ *
+ * @param[in]  context = context struct
+ * @param[in]  diag    = link diagnostics state
+ * @param[in]  nsweeps = number of sweeps, max EC_LINKHIST
+ * @param[out] slave   = slave receiving the errors
+ * @param[out] port    = port of slave receiving the errors
+ * @return number of errors of the link, 0 if no errors
+ */
+uint32 ecx_linkdiag_locate(ecx_contextt *context, ec_linkdiagt *diag, int nsweeps, uint16 *slave, uint8 *port)
+{
+   uint32 errors, maxerrors;
+   uint16 s;
+   uint8 p;
+
+   maxerrors = 0;
+   *slave = 0;
+   *port = 0;
+   for (s = 1; s <= *(context->slavecount); s++)
+   {
+      for (p = 0; p < EC_MAXPORT; p++)
+      {
+         errors = ecx_linkdiag_errors(context, diag, s, p, nsweeps);
+         if (errors > maxerrors)
+         {
+            maxerrors = errors;
+            *slave = s;
+            *port = p;
+         }
+      }
+   }
+   return maxerrors;
+}
+
+/** Find the slave on the other side of the link on a slave port, using the
+ * topology found by the configuration. Ports are passed in the order
+ * 0-3-1-2 starting from the entry port, children are connected in that order.
+ *
+ * @param[in]  context = context struct
+ * @param[in]  slave   = slave number
+ * @param[in]  port    = port number 0-3
+ * @return neighbour slave number, 0 if master or port not connected
+ */
+uint16 ecx_linkdiag_neighbor(ecx_contextt *context, uint16 slave, uint8 port)
+{
+   static const uint8 portorder[EC_MAXPORT] = { 0, 3, 1, 2 };
+   uint16 child;
+   uint8 entry, p, i;
+
+   if ((slave == 0) || (slave > *(context->slavecount)) || (port >= EC_MAXPORT) ||
+       !(context->slavelist[slave].activeports & (1 << port)))
+   {
+      return 0;
+   }
+   entry = context->slavelist[slave].entryport;
+   if (port == entry)
+   {
+      return context->slavelist[slave].parent;
+   }
+   /* position of entry port in processing order */
+   for (i = 0; portorder[i] != entry; i++);
+   child = slave + 1;
+   for (p = 1; p < EC_MAXPORT; p++)
+   {
+      if (context->slavelist[slave].activeports & (1 << portorder[(i + p) % EC_MAXPORT]))
+      {
+         /* next direct child of slave */
+         while ((child <= *(context->slavecount)) && (context->slavelist[child].parent != slave))
+         {
+            child++;
+         }
+         if (child > *(context->slavecount))
+         {
+            return 0;
+         }
+         if (portorder[(i + p) % EC_MAXPORT] == port)
+         {
+            return child;
+         }
+         child++;
+      }
+   }
+   return 0;
+}
+
+static void ec_busload_frame(ec_grouploadt *load, int length, boolean dc)
+{
+   int size;
+
+   size = ETH_HEADERSIZE + EC_ELENGTHSIZE + EC_HEADERSIZE + length + EC_WKCSIZE;
+   load->datagrams++;
+   if (dc)
+   {
+      size += EC_DCDATAGRAM;
+      load->datagrams++;
+   }
+   if (size < EC_MINFRAME)
+   {
+      size = EC_MINFRAME;
+   }
+   load->frames++;
+   load->bytes += size + EC_WIREOVERHEAD;
+}
+
+/** Compute the bus load and minimum feasible cycle of a group. The frames are
+ * the ones sent by ecx_send_processdata_group() for the mapping of the group.
+ * The loop delay is taken from the DC propagation delays if these are
+ * measured, otherwise it is estimated from the number of slaves.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  group    = group number
+ * @param[in]  cycle    = requested cycle time in ns
+ * @param[in]  fwddelay = forwarding delay per slave for both directions in ns,
+ *                        0 = EC_FWDDELAY
+ * @param[out] load     = bus load of group, measured round trips are cleared
+ * @return minimum feasible cycle in ns, 0 if group has no process data
+ */
+int ecx_busload(ecx_contextt *context, uint8 group, int32 cycle, int32 fwddelay, ec_grouploadt *load)
+{
+   ec_groupt *grp;
+   int length, sublength, segment;
+   int32 maxdelay;
+   boolean dc;
+   uint16 slave;
+
+   memset(load, 0x00, sizeof(ec_grouploadt));
+   load->group = group;
+   load->cycle = cycle;
+   load->redundant = (context->port->redport != NULL);
+   if (group >= context->maxgroup)
+   {
+      return 0;
+   }
+   grp = &(context->grouplist[group]);
+   dc = grp->hasdc;
+   if (grp->blockLRW)
+   {
+      /* LRD frames for inputs, then LWR frames for outputs */
+      length = grp->Ibytes;
+      segment = grp->Isegment;
+      while ((length > 0) && (segment < grp->nsegments))
+      {
+         sublength = grp->IOsegment[segment];
+         if (segment == grp->Isegment)
+         {
+            sublength -= grp->Ioffset;
+         }
+         segment++;
+         ec_busload_frame(load, sublength, dc);
+         dc = FALSE;
+         length -= sublength;
+      }
+      length = grp->Obytes;
+      segment = 0;
+      while ((length > 0) && (segment < grp->nsegments))
+      {
+         sublength = grp->IOsegment[segment++];
+         if (sublength > length)
+         {
+            sublength = length;
+         }
+         ec_busload_frame(load, sublength, dc);
+         dc = FALSE;
+         length -= sublength;
+      }
+   }
+   else
+   {
+      length = grp->Obytes + grp->Ibytes;
+      segment = 0;
+      while ((length > 0) && (segment < grp->nsegments))
+      {
+         sublength = grp->IOsegment[segment++];
+         ec_busload_frame(load, sublength, dc);
+         dc = FALSE;
+         length -= sublength;
+      }
+   }
+   if (load->frames == 0)
+   {
+      return 0;
+   }
+   load->wiretime = load->bytes * EC_BYTETIME;
+   if (fwddelay <= 0)
+   {
+      fwddelay = EC_FWDDELAY;
+   }
+   /* frames pass all slaves of the segment, not only the slaves of the group */
+   maxdelay = 0;
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      if (context->slavelist[slave].hasdc && (context->slavelist[slave].pdelay > maxdelay))
+      {
+         maxdelay = context->slavelist[slave].pdelay;
+      }
+   }
+   if (maxdelay > 0)
+   {
+      /* propagation delays are one way from the first DC slave */
+      load->loopdelay = (2 * maxdelay) + fwddelay;
+   }
+   else
+   {
+      load->loopdelay = *(context->slavecount) * fwddelay;
+   }
+   /* frames are sent back to back, the last one has to return within the cycle */
+   load->mincycle = load->wiretime + load->loopdelay;
+   if (cycle > 0)
+   {
+      load->load = (int)(((int64)load->wiretime * 1000) / cycle);
+   }
+   return load->mincycle;
+}
+
+/** Measure round trips of the process data of a group. Sends and receives
+ * the process data like the cyclic task, so it must not run at the same
+ * time as a cyclic task using the same group.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  group    = group number
+ * @param[in]  rounds   = number of round trips
+ * @param[in,out] load  = bus load of group from ecx_busload()
+ * @return number of round trips with valid workcounter
+ */
+int ecx_busload_measure(ecx_contextt *context, uint8 group, int rounds, ec_grouploadt *load)
+{
+   ec_timet start, end, diff;
+   int64 sum;
+   int32 rt;
+   int i, wkc, valid;
+
+   load->rounds = 0;
+   load->lost = 0;
+   load->rtmin = 0;
+   load->rtavg = 0;
+   load->rtmax = 0;
+   load->flags &= ~EC_LOAD_LATE;
+   sum = 0;
+   valid = 0;
+   for (i = 0; i < rounds; i++)
+   {
+      start = osal_current_time();
+      ecx_send_processdata_group(context, group);
+      wkc = ecx_receive_processdata_group(context, group, EC_TIMEOUTRET);
+      end = osal_current_time();
+      load->rounds++;
+      if (wkc <= 0)
+      {
+         load->lost++;
+         continue;
+      }
+      osal_time_diff(&start, &end, &diff);
+      rt = (int32)((diff.sec * 1000000000LL) + (diff.usec * 1000LL));
+      if ((valid == 0) || (rt < load->rtmin))
+      {
+         load->rtmin = rt;
+      }
+      if (rt > load->rtmax)
+      {
+         load->rtmax = rt;
+      }
+      sum += rt;
+      valid++;
+   }
+   if (valid)
+   {
+      load->rtavg = (int32)(sum / valid);
+   }
+   if ((load->cycle > 0) && ((load->rtmax > load->cycle) || load->lost))
+   {
+      load->flags |= EC_LOAD_LATE;
+   }
+   return valid;
+}
+
+/** Compare the bus load of groups and flag groups that should be split or
+ * merged. A group is split when its minimum cycle exceeds its cycle or its
+ * measured round trips are late. Two groups with the same cycle are merged
+ * when their process data fits in fewer frames together.
+ *
+ * @param[in,out] load = bus load of groups from ecx_busload()
+ * @param[in]  n       = number of groups
+ * @return total bus load of all groups, per mille
+ */
+int ec_busload_advise(ec_grouploadt *load, int n)
+{
+   int i, j, total, data, frames;
+
+   total = 0;
+   for (i = 0; i < n; i++)
+   {
+      load[i].flags &= ~(EC_LOAD_SPLIT | EC_LOAD_MERGE);
+      total += load[i].load;
+      if (((load[i].cycle > 0) && (load[i].mincycle > load[i].cycle)) ||
+          (load[i].flags & EC_LOAD_LATE))
+      {
+         load[i].flags |= EC_LOAD_SPLIT;
+      }
+   }
+   for (i = 0; i < n; i++)
+   {
+      for (j = i + 1; j < n; j++)
+      {
+         if ((load[i].frames == 0) || (load[j].frames == 0) ||
+             (load[i].cycle != load[j].cycle) ||
+             ((load[i].flags | load[j].flags) & (EC_LOAD_SPLIT | EC_LOAD_MERGE)))
+         {
+            continue;
+         }
+         /* process data bytes of both groups and frames needed together */
+         data = load[i].bytes + load[j].bytes -
+            ((load[i].frames + load[j].frames) *
+             (ETH_HEADERSIZE + EC_ELENGTHSIZE + EC_HEADERSIZE + EC_WKCSIZE + EC_WIREOVERHEAD));
+         frames = (data + EC_MAXLRWDATA - EC_FIRSTDCDATAGRAM - 1) / (EC_MAXLRWDATA - EC_FIRSTDCDATAGRAM);
+         if ((frames < (load[i].frames + load[j].frames)) &&
+             ((load[i].mincycle + load[j].wiretime) <= load[i].cycle))
+         {
+            load[i].flags |= EC_LOAD_MERGE;
+            load[i].mergewith = load[j].group;
+            load[j].flags |= EC_LOAD_MERGE;
+            load[j].mergewith = load[i].group;
+         }
+      }
+   }
+   return total;
+}
+
+/** Size of a register snapshot.
+ *
+ * @param[in]  nslaves = number of slaves
+ * @param[in]  ranges  = register ranges
+ * @param[in]  nranges = number of register ranges
+ * @return size of snapshot in bytes
+ */
+int ec_regsnapshot_size(int nslaves, const ec_regranget *ranges, int nranges)
+{
+   int i, record;
+
+   record = EC_REGSNAPSLAVE;
+   for (i = 0; i < nranges; i++)
+   {
+      record += 1 + ranges[i].length;
+   }
+   return EC_REGSNAPHDR + (nranges * 4) + (nslaves * record);
+}
+
+/* send chained snapshot datagrams in one frame */
+static void ecx_regsnapshot_send(ecx_contextt *context, ec_regsnapdgt *dg, int n)
+{
+   int offset[EC_REGSNAPDGS];
+   uint16 le_wkc;
+   int i, idx, wkc;
+
+   idx = ecx_getindex(context->port);
+   for (i = 0; i < n; i++)
+   {
+      if (i == 0)
+      {
+         ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FPRD, idx,
+            dg[i].configadr, dg[i].ADO, dg[i].length, dg[i].data);
+         offset[i] = EC_HEADERSIZE;
+      }
+      else
+      {
+         offset[i] = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FPRD, idx,
+            (i < (n - 1)), dg[i].configadr, dg[i].ADO, dg[i].length, dg[i].data);
+      }
+   }
+   wkc = ecx_srconfirm(context->port, idx, EC_TIMEOUTRET);
+   for (i = 0; i < n; i++)
+   {
+      le_wkc = 0;
+      if (wkc > EC_NOFRAME)
+      {
+         memcpy(&le_wkc, &(context->port->rxbuf[idx][offset[i] + dg[i].length]), EC_WKCSIZE);
+      }
+      if (etohs(le_wkc))
+      {
+         memcpy(dg[i].data, &(context->port->rxbuf[idx][offset[i]]), dg[i].length);
+      }
+      else
+      {
+         *(dg[i].valid) = 0;
+      }
+   }
+   ecx_setbufstat(context->port, idx, EC_BUF_EMPTY);
+}
+
+/** Read register ranges of all slaves into a register snapshot. Ranges are
+ * split in datagrams of max frame size and datagrams of all slaves are
+ * chained in as few frames as possible. Blocking, to be called from a non
+ * cyclic task. The gap between frames limits the bandwidth used.
+ *
+ * @param[in]  context = context struct
+ * @param[in]  ranges  = register ranges
+ * @param[in]  nranges = number of register ranges
+ * @param[out] buf     = snapshot buffer
+ * @param[in]  size    = size of snapshot buffer
+ * @param[in]  gap     = minimum time between frames in us, 0 = no limit
+ * @return size of snapshot, 0 if buffer too small or invalid ranges
+ */
+int ecx_regsnapshot(ecx_contextt *context, const ec_regranget *ranges, int nranges,
+   uint8 *buf, int size, int gap)
+{
+   ec_regsnapdgt dg[EC_REGSNAPDGS];
+   ec_slavet *slave;
+   uint8 *p;
+   uint16 s, chunk, ofs;
+   int i, n, used, total, frames;
+
+   total = ec_regsnapshot_size(*(context->slavecount), ranges, nranges);
+   if ((nranges <= 0) || (nranges > 0xffff) || (total > size))
+   {
+      return 0;
+   }
+   for (i = 0; i < nranges; i++)
+   {
+      if ((ranges[i].length == 0) || (((uint32)ranges[i].start + ranges[i].length) > 0x10000))
+      {
+         return 0;
+      }
+   }
+   memset(buf, 0x00, total);
+   ec_put32(buf, EC_REGSNAP_MAGIC);
+   ec_put16(buf + 4, EC_REGSNAP_VERSION);
+   ec_put16(buf + 6, *(context->slavecount));
+   ec_put16(buf + 8, (uint16)nranges);
+   p = buf + EC_REGSNAPHDR;
+   for (i = 0; i < nranges; i++)
+   {
+      ec_put16(p, ranges[i].start);
+      ec_put16(p + 2, ranges[i].length);
+      p += 4;
+   }
+   n = 0;
+   used = 0;
+   frames = 0;
+   for (s = 1; s <= *(context->slavecount); s++)
+   {
+      slave = &(context->slavelist[s]);
+      ec_put16(p, s);
+      ec_put16(p + 2, slave->configadr);
+      ec_put32(p + 4, slave->eep_man);
+      ec_put32(p + 8, slave->eep_id);
+      p += EC_REGSNAPSLAVE;
+      for (i = 0; i < nranges; i++)
+      {
+         *p = 1;
+         for (ofs = 0; ofs < ranges[i].length; ofs += chunk)
+         {
+            chunk = ranges[i].length - ofs;
+            if (chunk > EC_REGSNAPDGMAX)
+            {
+               chunk = EC_REGSNAPDGMAX;
+            }
+            /* frame full, send it first */
+            if ((n == EC_REGSNAPDGS) ||
+                ((used + EC_HEADERSIZE + chunk + EC_WKCSIZE) > EC_MAXLRWDATA))
+            {
+               if (frames++ && gap)
+               {
+                  osal_usleep(gap);
+               }
+               ecx_regsnapshot_send(context, dg, n);
+               n = 0;
+               used = 0;
+            }
+            dg[n].configadr = slave->configadr;
+            dg[n].ADO = ranges[i].start + ofs;
+            dg[n].length = chunk;
+            dg[n].data = p + 1 + ofs;
+            dg[n].valid = p;
+            n++;
+            used += EC_HEADERSIZE + chunk + EC_WKCSIZE;
+         }
+         p += 1 + ranges[i].length;
+      }
+   }
+   if (n)
+   {
+      if (frames && gap)
+      {
+         osal_usleep(gap);
+      }
+      ecx_regsnapshot_send(context, dg, n);
+   }
+   return total;
+}
+
+/** Read the header of a register snapshot.
+ *
+ * @param[in]  buf     = snapshot
+ * @param[in]  size    = size of snapshot
+ * @param[out] nslaves = number of slaves in snapshot
+ * @param[out] nranges = number of register ranges in snapshot
+ * @return 1 if snapshot is valid, 0 otherwise
+ */
+int ec_regsnapshot_info(const uint8 *buf, int size, int *nslaves, int *nranges)
+{
+   ec_regranget range;
+   int i, total;
+
+   if ((size < EC_REGSNAPHDR) || (ec_get32(buf) != EC_REGSNAP_MAGIC) ||
+       (ec_get16(buf + 4) != EC_REGSNAP_VERSION))
+   {
+      return 0;
+   }
+   *nslaves = ec_get16(buf + 6);
+   *nranges = ec_get16(buf + 8);
+   if (size < (EC_REGSNAPHDR + (*nranges * 4)))
+   {
+      return 0;
+   }
+   total = EC_REGSNAPHDR + (*nranges * 4) + (*nslaves * EC_REGSNAPSLAVE);
+   for (i = 0; i < *nranges; i++)
+   {
+      range.length = ec_get16(buf + EC_REGSNAPHDR + (i * 4) + 2);
+      total += *nslaves * (1 + range.length);
+   }
+   return (total <= size);
+}
+
+/** Get a register range of a register snapshot.
+ *
+ * @param[in]  buf      = snapshot
+ * @param[in]  size     = size of snapshot
+ * @param[in]  range    = range number, 0 is first
+ * @param[out] regrange = register range
+ * @return 1 if range exists, 0 otherwise
+ */
+int ec_regsnapshot_range(const uint8 *buf, int size, int range, ec_regranget *regrange)
+{
+   int nslaves, nranges;
+
+   if (!ec_regsnapshot_info(buf, size, &nslaves, &nranges) || (range < 0) || (range >= nranges))
+   {
+      return 0;
+   }
+   regrange->start = ec_get16(buf + EC_REGSNAPHDR + (range * 4));
+   regrange->length = ec_get16(buf + EC_REGSNAPHDR + (range * 4) + 2);
+   return 1;
+}
+
+/* pointer to slave record in snapshot, NULL if not present */
+static const uint8 *ec_regsnapshot_record(const uint8 *buf, int size, int index, int *nranges)
+{
+   int i, nslaves, record;
+
+   if (!ec_regsnapshot_info(buf, size, &nslaves, nranges) || (index < 0) || (index >= nslaves))
+   {
+      return NULL;
+   }
+   record = EC_REGSNAPSLAVE;
+   for (i = 0; i < *nranges; i++)
+   {
+      record += 1 + ec_get16(buf + EC_REGSNAPHDR + (i * 4) + 2);
+   }
+   return buf + EC_REGSNAPHDR + (*nranges * 4) + (index * record);
+}
+
+/** Get slave identification of a slave record in a register snapshot.
+ *
+ * @param[in]  buf       = snapshot
+ * @param[in]  size      = size of snapshot
+ * @param[in]  index     = slave record, 0 is first
+ * @param[out] slave     = slave number at time of snapshot
+ * @param[out] configadr = configured station address
+ * @param[out] man       = manufacturer from EEPROM
+ * @param[out] id        = product code from EEPROM
+ * @return 1 if slave record exists, 0 otherwise
+ */
+int ec_regsnapshot_slave(const uint8 *buf, int size, int index, uint16 *slave, uint16 *configadr,
+   uint32 *man, uint32 *id)
+{
+   const uint8 *p;
+   int nranges;
+
+   if ((p = ec_regsnapshot_record(buf, size, index, &nranges)) == NULL)
+   {
+      return 0;
+   }
+   *slave = ec_get16(p);
+   *configadr = ec_get16(p + 2);
+   *man = ec_get32(p + 4);
+   *id = ec_get32(p + 8);
+   return 1;
+}
+
+/** Get register data of a slave from a register snapshot. The registers must
+ * be within one range that was read successfully.
+ *
+ * @param[in]  buf    = snapshot
+ * @param[in]  size   = size of snapshot
+ * @param[in]  index  = slave record, 0 is first
+ * @param[in]  reg    = register address
+ * @param[out] data   = register data
+ * @param[in]  length = number of bytes
+ * @return 1 if register data is available, 0 otherwise
+ */
+int ec_regsnapshot_get(const uint8 *buf, int size, int index, uint16 reg, uint8 *data, int length)
+{
+   const uint8 *p;
+   uint16 start, rlength;
+   int i, nranges;
+
+   if ((p = ec_regsnapshot_record(buf, size, index, &nranges)) == NULL)
+   {
+      return 0;
+   }
+   p += EC_REGSNAPSLAVE;
+   for (i = 0; i < nranges; i++)
+   {
+      start = ec_get16(buf + EC_REGSNAPHDR + (i * 4));
+      rlength = ec_get16(buf + EC_REGSNAPHDR + (i * 4) + 2);
+      if ((reg >= start) && ((reg + length) <= (start + rlength)))
+      {
+         if (*p)
+         {
+            memcpy(data, p + 1 + (reg - start), length);
+            return 1;
+         }
+      }
+      p += 1 + rlength;
+   }
+   return 0;
+}
+
+/** Name of a known ESC register.
+ *
+ * @param[in]  reg    = register address
+ * @param[out] length = register length in bytes, can be NULL
+ * @return register name, NULL if unknown
+ */
+const char *ec_regname(uint16 reg, uint16 *length)
+{
+   unsigned int i;
+
+   for (i = 0; i < (sizeof(ec_regnames) / sizeof(ec_regnames[0])); i++)
+   {
+      if (ec_regnames[i].reg == reg)
+      {
+         if (length)
+         {
+            *length = ec_regnames[i].length;
+         }
+         return ec_regnames[i].name;
+      }
+   }
+   return NULL;
+}
+
+#ifdef EC_VER1
+int ec_busload(uint8 group, int32 cycle, int32 fwddelay, ec_grouploadt *load)
+{
+   return ecx_busload(&ecx_context, group, cycle, fwddelay, load);
+}
+
+int ec_busload_measure(uint8 group, int rounds, ec_grouploadt *load)
+{
+   return ecx_busload_measure(&ecx_context, group, rounds, load);
+}
+
+int ec_regsnapshot(const ec_regranget *ranges, int nranges, uint8 *buf, int size, int gap)
+{
+   return ecx_regsnapshot(&ecx_context, ranges, nranges, buf, size, gap);
+}
+
+int ec_linkdiag_sweep(ec_linkdiagt *diag)
+{
+   return ecx_linkdiag_sweep(&ecx_context, diag);
+}
+
+uint32 ec_linkdiag_errors(ec_linkdiagt *diag, uint16 slave, uint8 port, int nsweeps)
+{
+   return ecx_linkdiag_errors(&ecx_context, diag, slave, port, nsweeps);
+}
+
+uint32 ec_linkdiag_locate(ec_linkdiagt *diag, int nsweeps, uint16 *slave, uint8 *port)
+{
+   return ecx_linkdiag_locate(&ecx_context, diag, nsweeps, slave, port);
+}
+
+uint16 ec_linkdiag_neighbor(uint16 slave, uint8 port)
+{
+   return ecx_linkdiag_neighbor(&ecx_context, slave, port);
+}
+#endif
@@ -0,0 +1,149 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Headerfile for ethercatdiag.c
+ */
+
+#ifndef _ethercatdiag_
+#define _ethercatdiag_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** number of sweeps kept in link error history */
+#define EC_LINKHIST          16
+/** number of ports of a slave */
+#define EC_MAXPORT           4
+
+/** error statistics of the link connected to one slave port */
+typedef struct ec_linkstat
+{
+   /** total invalid frames received on port */
+   uint32           rxerr;
+   /** total physical layer errors received on port */
+   uint32           phyerr;
+   /** total frames received on port already marked as erroneous */
+   uint32           fwderr;
+   /** total lost links of port */
+   uint32           lostlink;
+   /** local errors (invalid frames + physical errors) per sweep, ring buffer */
+   uint16           hist[EC_LINKHIST];
+} ec_linkstatt;
+
+/** link error diagnostics state, owned by the application */
+typedef struct ec_linkdiag
+{
+   /** per slave and port link statistics */
+   ec_linkstatt     link[EC_MAXSLAVE][EC_MAXPORT];
+   /** total processing unit errors per slave */
+   uint32           epuerr[EC_MAXSLAVE];
+   /** total PDI errors per slave */
+   uint32           pdierr[EC_MAXSLAVE];
+   /** number of sweeps done */
+   uint32           sweeps;
+   /** next position in history ring buffer */
+   uint16           histpos;
+} ec_linkdiagt;
+
+/** ESC register range for register snapshots */
+typedef struct ec_regrange
+{
+   /** first register address */
+   uint16           start;
+   /** number of bytes */
+   uint16           length;
+} ec_regranget;
+
+/** register snapshot magic "ESCS" */
+#define EC_REGSNAP_MAGIC     0x53435345
+/** register snapshot format version */
+#define EC_REGSNAP_VERSION   1
+
+/** default forwarding delay per slave for both directions in ns, used when
+ *  no DC propagation delays are measured */
+#define EC_FWDDELAY          1000
+/** bus load flag, group does not fit in its cycle and should be split */
+#define EC_LOAD_SPLIT        0x01
+/** bus load flag, group can be merged with group mergewith */
+#define EC_LOAD_MERGE        0x02
+/** bus load flag, measured round trip exceeds the cycle */
+#define EC_LOAD_LATE         0x04
+
+/** bus load and cycle feasibility of one group */
+typedef struct ec_groupload
+{
+   /** group number */
+   uint8            group;
+   /** requested cycle time in ns */
+   int32            cycle;
+   /** process data frames per cycle */
+   int              frames;
+   /** process data datagrams per cycle */
+   int              datagrams;
+   /** bytes on the wire per cycle, including preamble and inter frame gap */
+   int              bytes;
+   /** time to transmit all frames in ns */
+   int32            wiretime;
+   /** time for a frame to pass all slaves and return in ns */
+   int32            loopdelay;
+   /** minimum feasible cycle time in ns */
+   int32            mincycle;
+   /** wire time as part of cycle time, per mille */
+   int              load;
+   /** TRUE if frames are sent on a redundant port too */
+   boolean          redundant;
+   /** number of measured round trips */
+   int              rounds;
+   /** number of measured round trips without valid workcounter */
+   int              lost;
+   /** measured round trip minimum in ns */
+   int32            rtmin;
+   /** measured round trip average in ns */
+   int32            rtavg;
+   /** measured round trip maximum in ns */
+   int32            rtmax;
+   /** EC_LOAD_SPLIT, EC_LOAD_MERGE and EC_LOAD_LATE flags */
+   uint8            flags;
+   /** group to merge with if EC_LOAD_MERGE is set */
+   uint8            mergewith;
+} ec_grouploadt;
+
+int ec_busload_advise(ec_grouploadt *load, int n);
+int ec_regsnapshot_size(int nslaves, const ec_regranget *ranges, int nranges);
+int ec_regsnapshot_info(const uint8 *buf, int size, int *nslaves, int *nranges);
+int ec_regsnapshot_range(const uint8 *buf, int size, int range, ec_regranget *regrange);
+int ec_regsnapshot_slave(const uint8 *buf, int size, int index, uint16 *slave, uint16 *configadr,
+   uint32 *man, uint32 *id);
+int ec_regsnapshot_get(const uint8 *buf, int size, int index, uint16 reg, uint8 *data, int length);
+const char *ec_regname(uint16 reg, uint16 *length);
+
+#ifdef EC_VER1
+int ec_busload(uint8 group, int32 cycle, int32 fwddelay, ec_grouploadt *load);
+int ec_busload_measure(uint8 group, int rounds, ec_grouploadt *load);
+int ec_regsnapshot(const ec_regranget *ranges, int nranges, uint8 *buf, int size, int gap);
+int ec_linkdiag_sweep(ec_linkdiagt *diag);
+uint32 ec_linkdiag_errors(ec_linkdiagt *diag, uint16 slave, uint8 port, int nsweeps);
+uint32 ec_linkdiag_locate(ec_linkdiagt *diag, int nsweeps, uint16 *slave, uint8 *port);
+uint16 ec_linkdiag_neighbor(uint16 slave, uint8 port);
+#endif
+
+int ecx_busload(ecx_contextt *context, uint8 group, int32 cycle, int32 fwddelay, ec_grouploadt *load);
+int ecx_busload_measure(ecx_contextt *context, uint8 group, int rounds, ec_grouploadt *load);
+int ecx_regsnapshot(ecx_contextt *context, const ec_regranget *ranges, int nranges,
+   uint8 *buf, int size, int gap);
+int ecx_linkdiag_sweep(ecx_contextt *context, ec_linkdiagt *diag);
+uint32 ecx_linkdiag_errors(ecx_contextt *context, ec_linkdiagt *diag, uint16 slave, uint8 port, int nsweeps);
+uint32 ecx_linkdiag_locate(ecx_contextt *context, ec_linkdiagt *diag, int nsweeps, uint16 *slave, uint8 *port);
+uint16 ecx_linkdiag_neighbor(ecx_contextt *context, uint16 slave, uint8 port);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,1943 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * EtherCAT Network Information (ENI) import module.
+ *
+ * An ENI file of an engineering tool is compiled into an ec_enit structure by
+ * ec_eni_parse, without allocating memory. ecx_config_eni then configures the
+ * bus from it instead of ecx_config_init. Only the identity of the slaves is
+ * read from SII, the SM settings, PDO mapping and mailbox settings are taken
+ * from the ENI and no CoE mapping is read. The ESC init commands of the
+ * INIT to PRE-OP transition are executed in batched frames and the CoE init
+ * commands of the PRE-OP to SAFE-OP transition are written when the slaves
+ * reached PRE-OP.
+ *
+ * The process data layout is still made by ecx_config_map_group, the
+ * logical addresses and ESC init commands for SM and FMMU of the ENI are not
+ * used.
+ *
+ * The other way round, ecx_eni_export writes the configuration of a bus
+ * configured by ecx_config_init and ecx_config_map_group as ENI, and
+ * ecx_config_export as compact binary that ec_config_load reads back.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "osal.h"
+#include "oshw.h"
+#include "ethercattype.h"
+#include "ethercatbase.h"
+#include "ethercatmain.h"
+#include "ethercatcoe.h"
+#include "ethercatconfig.h"
+#include "ethercatlog.h"
+#include "ethercatindex.h"
+#include "ethercateni.h"
+
+/** max. number of datagrams in one batched frame */
+#define EC_ENIMAXBATCH       32
+/** max. length of a batched frame */
+#define EC_ENIMAXFRAME       (ETH_HEADERSIZE + EC_HEADERSIZE + EC_WKCSIZE + EC_MAXLRWDATA)
+/** max. number of PDO entries of all PDOs of a slave, assigned or not */
+#define EC_ENIMAXSLAVEENTRY  (EC_MAXSLAVEPDOENTRY * 2)
+
+/** element on the parse stack */
+typedef struct
+{
+   const char       *name;
+   int              namelen;
+   const char       *attr;
+   int              attrlen;
+} ec_enielemt;
+
+/** PDO of a slave during parsing */
+typedef struct
+{
+   uint16           index;
+   uint8            sm;
+   boolean          output;
+   uint16           entry;
+   uint16           nentry;
+} ec_enipdot;
+
+/** parser state */
+typedef struct
+{
+   ec_enit          *eni;
+   const char       *p;
+   const char       *end;
+   int              line;
+   int              error;
+   int              depth;
+   ec_enielemt      elem[EC_ENIMAXDEPTH];
+   /** current slave, NULL outside Slave */
+   ec_enislavet     *slave;
+   /** current ESC init command */
+   ec_eniinitcmdt   *initcmd;
+   /** current CoE init command */
+   ec_enicoecmdt    *coecmd;
+   /** current process data SM, -1 outside Sm */
+   int              sm;
+   /** bits of process data of the slave as given by the ENI */
+   uint16           sendbits;
+   uint16           recvbits;
+   int              npdo;
+   ec_enipdot       pdo[EC_ENIMAXSLAVEPDO];
+   int              nentry;
+   ec_pdoentryt     entry[EC_ENIMAXSLAVEENTRY];
+   uint8            nsmpdo[EC_MAXSM];
+   uint16           smpdo[EC_MAXSM][EC_ENIMAXSMPDO];
+} ec_eniparsert;
+
+/** datagrams of a batched frame */
+typedef struct
+{
+   int              idx;
+   int              n;
+   int              offset[EC_ENIMAXBATCH];
+   uint16           length[EC_ENIMAXBATCH];
+   uint16           cnt[EC_ENIMAXBATCH];
+   void             *rdata[EC_ENIMAXBATCH];
+} ec_enibatcht;
+
+static const char *ec_eni_transname[] =
+   { "IP", "PS", "PI", "SP", "SO", "SI", "OS", "OP", "OI", "IB", "BI", "II", "PP", "SS" };
+
+static boolean ec_eni_eq(const char *s, int len, const char *name)
+{
+   return ((int)strlen(name) == len) && (strncmp(s, name, len) == 0);
+}
+
+/** Check name of element on the stack.
+ * @param[in]  ps    = parser state
+ * @param[in]  up    = 0 = current element, 1 = parent etc.
+ * @param[in]  name  = element name
+ * @return TRUE if name matches
+ */
+static boolean ec_eni_is(ec_eniparsert *ps, int up, const char *name)
+{
+   ec_enielemt *e;
+
+   if (up >= ps->depth)
+   {
+      return FALSE;
+   }
+   e = &ps->elem[ps->depth - 1 - up];
+   return ec_eni_eq(e->name, e->namelen, name);
+}
+
+static void ec_eni_trim(const char **s, int *len)
+{
+   while ((*len > 0) && ((**s == ' ') || (**s == '\t') || (**s == '\r') || (**s == '\n')))
+   {
+      (*s)++;
+      (*len)--;
+   }
+   while ((*len > 0) && (((*s)[*len - 1] == ' ') || ((*s)[*len - 1] == '\t') ||
+                         ((*s)[*len - 1] == '\r') || ((*s)[*len - 1] == '\n')))
+   {
+      (*len)--;
+   }
+   if ((*len >= 12) && (strncmp(*s, "<![CDATA[", 9) == 0) && (strncmp(*s + *len - 3, "]]>", 3) == 0))
+   {
+      *s += 9;
+      *len -= 12;
+   }
+}
+
+static int ec_eni_hexdigit(char c)
+{
+   if ((c >= '0') && (c <= '9')) return c - '0';
+   if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+   if ((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+   return -1;
+}
+
+/** Convert ENI number, decimal or hexadecimal with #x prefix.
+ * @param[in]  s     = text
+ * @param[in]  len   = length of text
+ * @return value
+ */
+static int64 ec_eni_number(const char *s, int len)
+{
+   int64 val = 0;
+   boolean neg = FALSE;
+   int d;
+
+   ec_eni_trim(&s, &len);
+   if ((len > 0) && (*s == '-'))
+   {
+      neg = TRUE;
+      s++;
+      len--;
+   }
+   if ((len > 2) && ((s[0] == '#') || (s[0] == '0')) && ((s[1] == 'x') || (s[1] == 'X')))
+   {
+      s += 2;
+      len -= 2;
+      while ((len > 0) && ((d = ec_eni_hexdigit(*s)) >= 0))
+      {
+         val = (val << 4) + d;
+         s++;
+         len--;
+      }
+   }
+   else
+   {
+      while ((len > 0) && (*s >= '0') && (*s <= '9'))
+      {
+         val = (val * 10) + (*s - '0');
+         s++;
+         len--;
+      }
+   }
+   return neg ? -val : val;
+}
+
+static boolean ec_eni_bool(const char *s, int len)
+{
+   ec_eni_trim(&s, &len);
+   return ec_eni_eq(s, len, "true") || ec_eni_eq(s, len, "1");
+}
+
+/** Find attribute of element.
+ * @param[in]  e      = element
+ * @param[in]  name   = attribute name
+ * @param[out] val    = attribute value
+ * @param[out] vlen   = length of attribute value
+ * @return TRUE if found
+ */
+static boolean ec_eni_attr(ec_enielemt *e, const char *name, const char **val, int *vlen)
+{
+   const char *p = e->attr, *end = e->attr + e->attrlen, *n;
+   char q;
+   int nlen;
+
+   while (p < end)
+   {
+      while ((p < end) && ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n')))
+      {
+         p++;
+      }
+      n = p;
+      while ((p < end) && (*p != '=') && (*p != ' '))
+      {
+         p++;
+      }
+      nlen = (int)(p - n);
+      while ((p < end) && (*p != '"') && (*p != '\''))
+      {
+         p++;
+      }
+      if (p >= end)
+      {
+         break;
+      }
+      q = *p++;
+      *val = p;
+      while ((p < end) && (*p != q))
+      {
+         p++;
+      }
+      *vlen = (int)(p - *val);
+      p++;
+      if (ec_eni_eq(n, nlen, name))
+      {
+         return TRUE;
+      }
+   }
+   return FALSE;
+}
+
+/** Store hex data of ENI in eni data.
+ * @param[in]  ps     = parser state
+ * @param[in]  s      = hex text
+ * @param[in]  len    = length of text
+ * @param[out] length = number of bytes
+ * @return offset in eni data, EC_ENI_NODATA if full
+ */
+static uint32 ec_eni_data(ec_eniparsert *ps, const char *s, int len, uint16 *length)
+{
+   ec_enit *eni = ps->eni;
+   uint32 offset = eni->datasize;
+   int hi, lo;
+
+   ec_eni_trim(&s, &len);
+   *length = 0;
+   while (len >= 2)
+   {
+      hi = ec_eni_hexdigit(s[0]);
+      lo = ec_eni_hexdigit(s[1]);
+      if ((hi < 0) || (lo < 0))
+      {
+         break;
+      }
+      if (eni->datasize >= EC_ENIMAXDATA)
+      {
+         ps->error = -2;
+         return EC_ENI_NODATA;
+      }
+      eni->data[eni->datasize++] = (uint8)((hi << 4) + lo);
+      (*length)++;
+      s += 2;
+      len -= 2;
+   }
+   return offset;
+}
+
+/** Reserve zeroed eni data for a command given by length only.
+ * @param[in]  ps     = parser state
+ * @param[in]  length = number of bytes
+ * @return offset in eni data, EC_ENI_NODATA if full
+ */
+static uint32 ec_eni_zerodata(ec_eniparsert *ps, uint16 length)
+{
+   ec_enit *eni = ps->eni;
+   uint32 offset = eni->datasize;
+
+   if ((eni->datasize + length) > EC_ENIMAXDATA)
+   {
+      ps->error = -2;
+      return EC_ENI_NODATA;
+   }
+   memset(&eni->data[offset], 0x00, length);
+   eni->datasize += length;
+   return offset;
+}
+
+static uint16 ec_eni_transition(const char *s, int len)
+{
+   int i;
+
+   ec_eni_trim(&s, &len);
+   for (i = 0; i < (int)(sizeof(ec_eni_transname) / sizeof(ec_eni_transname[0])); i++)
+   {
+      if (ec_eni_eq(s, len, ec_eni_transname[i]))
+      {
+         return (uint16)(1 << i);
+      }
+   }
+   return 0;
+}
+
+static void ec_eni_start(ec_eniparsert *ps)
+{
+   ec_enit *eni = ps->eni;
+   ec_enielemt *e = &ps->elem[ps->depth - 1];
+   const char *val;
+   int vlen;
+
+   if (ec_eni_is(ps, 0, "Slave") && ec_eni_is(ps, 1, "Config"))
+   {
+      if (eni->slavecount >= (EC_MAXSLAVE - 1))
+      {
+         ps->error = -2;
+         return;
+      }
+      ps->slave = &eni->slave[eni->slavecount++];
+      memset(ps->slave, 0x00, sizeof(ec_enislavet));
+      ps->slave->initcmd = (uint16)eni->initcmdcount;
+      ps->slave->coecmd = (uint16)eni->coecmdcount;
+      ps->sm = -1;
+      ps->sendbits = 0;
+      ps->recvbits = 0;
+      ps->npdo = 0;
+      ps->nentry = 0;
+      memset(ps->nsmpdo, 0x00, sizeof(ps->nsmpdo));
+   }
+   else if (ec_eni_is(ps, 0, "Master") && ec_eni_is(ps, 1, "Config"))
+   {
+      eni->masterinitcmd = (uint16)eni->initcmdcount;
+   }
+   else if (ec_eni_is(ps, 0, "InitCmd") && ec_eni_is(ps, 1, "InitCmds"))
+   {
+      ps->initcmd = NULL;
+      ps->coecmd = NULL;
+      if (ec_eni_is(ps, 2, "CoE") && ps->slave)
+      {
+         if (eni->coecmdcount >= EC_ENIMAXCOECMD)
+         {
+            ps->error = -2;
+            return;
+         }
+         ps->coecmd = &eni->coecmd[eni->coecmdcount++];
+         memset(ps->coecmd, 0x00, sizeof(ec_enicoecmdt));
+         ps->coecmd->ccs = 1;
+         ps->coecmd->data = EC_ENI_NODATA;
+         if (ec_eni_attr(e, "CompleteAccess", &val, &vlen))
+         {
+            ps->coecmd->ca = ec_eni_bool(val, vlen);
+         }
+      }
+      else if (ec_eni_is(ps, 2, "Slave") || ec_eni_is(ps, 2, "Master"))
+      {
+         if (eni->initcmdcount >= EC_ENIMAXINITCMD)
+         {
+            ps->error = -2;
+            return;
+         }
+         ps->initcmd = &eni->initcmd[eni->initcmdcount++];
+         memset(ps->initcmd, 0x00, sizeof(ec_eniinitcmdt));
+         ps->initcmd->cnt = EC_ENI_NOCNT;
+         ps->initcmd->data = EC_ENI_NODATA;
+         ps->initcmd->validate = EC_ENI_NODATA;
+         ps->initcmd->validatemask = EC_ENI_NODATA;
+      }
+   }
+   else if (ps->slave && ec_eni_is(ps, 1, "ProcessData") &&
+            (ec_eni_is(ps, 0, "RxPdo") || ec_eni_is(ps, 0, "TxPdo")))
+   {
+      if (ps->npdo >= EC_ENIMAXSLAVEPDO)
+      {
+         ps->error = -2;
+         return;
+      }
+      ps->pdo[ps->npdo].index = 0;
+      ps->pdo[ps->npdo].output = ec_eni_is(ps, 0, "RxPdo");
+      ps->pdo[ps->npdo].sm = 0xff;
+      ps->pdo[ps->npdo].entry = (uint16)ps->nentry;
+      ps->pdo[ps->npdo].nentry = 0;
+      if (ec_eni_attr(e, "Sm", &val, &vlen))
+      {
+         ps->pdo[ps->npdo].sm = (uint8)ec_eni_number(val, vlen);
+      }
+      ps->npdo++;
+   }
+   else if (ps->slave && (ps->npdo > 0) && ec_eni_is(ps, 0, "Entry") &&
+            (ec_eni_is(ps, 1, "RxPdo") || ec_eni_is(ps, 1, "TxPdo")))
+   {
+      if (ps->nentry >= EC_ENIMAXSLAVEENTRY)
+      {
+         ps->error = -2;
+         return;
+      }
+      memset(&ps->entry[ps->nentry], 0x00, sizeof(ec_pdoentryt));
+      ps->nentry++;
+      ps->pdo[ps->npdo - 1].nentry++;
+   }
+   else if (ps->slave && ec_eni_is(ps, 1, "ProcessData") && (e->namelen == 3) &&
+            (strncmp(e->name, "Sm", 2) == 0) && (e->name[2] >= '0') && (e->name[2] < ('0' + EC_MAXSM)))
+   {
+      ps->sm = e->name[2] - '0';
+   }
+   else if (ps->slave && ec_eni_is(ps, 0, "CoE") && ec_eni_is(ps, 1, "Mailbox"))
+   {
+      ps->slave->CoEdetails |= ECT_COEDET_SDO;
+      if (ec_eni_attr(e, "SdoInfo", &val, &vlen) && ec_eni_bool(val, vlen))
+      {
+         ps->slave->CoEdetails |= ECT_COEDET_SDOINFO;
+      }
+      if (ec_eni_attr(e, "PdoAssign", &val, &vlen) && ec_eni_bool(val, vlen))
+      {
+         ps->slave->CoEdetails |= ECT_COEDET_PDOASSIGN;
+      }
+      if (ec_eni_attr(e, "PdoConfig", &val, &vlen) && ec_eni_bool(val, vlen))
+      {
+         ps->slave->CoEdetails |= ECT_COEDET_PDOCONFIG;
+      }
+      if (ec_eni_attr(e, "CompleteAccess", &val, &vlen) && ec_eni_bool(val, vlen))
+      {
+         ps->slave->CoEdetails |= ECT_COEDET_SDOCA;
+      }
+   }
+   else if (ps->slave && ec_eni_is(ps, 0, "DC") && ec_eni_is(ps, 1, "Slave"))
+   {
+      ps->slave->hasdc = TRUE;
+   }
+}
+
+static void ec_eni_initcmd_text(ec_eniparsert *ps, const char *s, int len)
+{
+   ec_eniinitcmdt *cmd = ps->initcmd;
+   uint16 length;
+   int64 val;
+
+   if (ec_eni_is(ps, 1, "Validate"))
+   {
+      if (ec_eni_is(ps, 0, "Data"))
+      {
+         cmd->validate = ec_eni_data(ps, s, len, &cmd->validatelength);
+      }
+      else if (ec_eni_is(ps, 0, "DataMask"))
+      {
+         cmd->validatemask = ec_eni_data(ps, s, len, &cmd->masklength);
+      }
+      else if (ec_eni_is(ps, 0, "Timeout"))
+      {
+         cmd->timeout = (uint32)ec_eni_number(s, len);
+      }
+      return;
+   }
+   if (!ec_eni_is(ps, 1, "InitCmd"))
+   {
+      return;
+   }
+   if (ec_eni_is(ps, 0, "Transition"))
+   {
+      cmd->transition |= ec_eni_transition(s, len);
+   }
+   else if (ec_eni_is(ps, 0, "Cmd"))
+   {
+      cmd->cmd = (uint8)ec_eni_number(s, len);
+   }
+   else if (ec_eni_is(ps, 0, "Adp"))
+   {
+      cmd->adp = (uint16)ec_eni_number(s, len);
+   }
+   else if (ec_eni_is(ps, 0, "Ado"))
+   {
+      cmd->ado = (uint16)ec_eni_number(s, len);
+   }
+   else if (ec_eni_is(ps, 0, "Addr"))
+   {
+      val = ec_eni_number(s, len);
+      cmd->adp = LO_WORD((uint32)val);
+      cmd->ado = HI_WORD((uint32)val);
+   }
+   else if (ec_eni_is(ps, 0, "Data"))
+   {
+      cmd->data = ec_eni_data(ps, s, len, &length);
+      /* DataLength given before must match */
+      if (cmd->length && (length != cmd->length))
+      {
+         ps->error = -1;
+      }
+      cmd->length = length;
+   }
+   else if (ec_eni_is(ps, 0, "DataLength"))
+   {
+      length = (uint16)ec_eni_number(s, len);
+      /* Data given before must match */
+      if ((cmd->data != EC_ENI_NODATA) && (length != cmd->length))
+      {
+         ps->error = -1;
+      }
+      cmd->length = length;
+   }
+   else if (ec_eni_is(ps, 0, "Cnt"))
+   {
+      cmd->cnt = (uint16)ec_eni_number(s, len);
+   }
+   else if (ec_eni_is(ps, 0, "Disabled") && ec_eni_bool(s, len))
+   {
+      cmd->transition = 0;
+   }
+}
+
+static void ec_eni_coecmd_text(ec_eniparsert *ps, const char *s, int len)
+{
+   ec_enicoecmdt *cmd = ps->coecmd;
+
+   if (!ec_eni_is(ps, 1, "InitCmd"))
+   {
+      return;
+   }
+   if (ec_eni_is(ps, 0, "Transition"))
+   {
+      cmd->transition |= ec_eni_transition(s, len);
+   }
+   else if (ec_eni_is(ps, 0, "Ccs"))
+   {
+      cmd->ccs = (uint8)ec_eni_number(s, len);
+   }
+   else if (ec_eni_is(ps, 0, "Index"))
+   {
+      cmd->index = (uint16)ec_eni_number(s, len);
+   }
+   else if (ec_eni_is(ps, 0, "SubIndex"))
+   {
+      cmd->subindex = (uint8)ec_eni_number(s, len);
+   }
+   else if (ec_eni_is(ps, 0, "Data"))
+   {
+      cmd->data = ec_eni_data(ps, s, len, &cmd->length);
+   }
+   else if (ec_eni_is(ps, 0, "Timeout"))
+   {
+      cmd->timeout = (uint32)ec_eni_number(s, len);
+   }
+   else if (ec_eni_is(ps, 0, "Disabled") && ec_eni_bool(s, len))
+   {
+      cmd->transition = 0;
+   }
+}
+
+static void ec_eni_slave_text(ec_eniparsert *ps, const char *s, int len)
+{
+   ec_enislavet *sl = ps->slave;
+   ec_pdoentryt *entry;
+   ec_enipdot *pdo;
+   uint32 val;
+
+   val = (uint32)ec_eni_number(s, len);
+   if (ec_eni_is(ps, 1, "Info"))
+   {
+      if (ec_eni_is(ps, 0, "Name"))
+      {
+         ec_eni_trim(&s, &len);
+         if (len > EC_MAXNAME)
+         {
+            len = EC_MAXNAME;
+         }
+         memcpy(sl->name, s, len);
+         sl->name[len] = '\0';
+      }
+      else if (ec_eni_is(ps, 0, "PhysAddr"))
+      {
+         sl->physaddr = (uint16)val;
+      }
+      else if (ec_eni_is(ps, 0, "VendorId"))
+      {
+         sl->eep_man = val;
+      }
+      else if (ec_eni_is(ps, 0, "ProductCode"))
+      {
+         sl->eep_id = val;
+      }
+      else if (ec_eni_is(ps, 0, "RevisionNo"))
+      {
+         sl->eep_rev = val;
+      }
+      else if (ec_eni_is(ps, 0, "SerialNo"))
+      {
+         sl->eep_ser = val;
+      }
+   }
+   else if (ec_eni_is(ps, 2, "Mailbox") && (ec_eni_is(ps, 1, "Send") || ec_eni_is(ps, 1, "Recv")))
+   {
+      if (ec_eni_is(ps, 1, "Send") && ec_eni_is(ps, 0, "Start"))
+      {
+         sl->mbx_wo = (uint16)val;
+      }
+      else if (ec_eni_is(ps, 1, "Send") && ec_eni_is(ps, 0, "Length"))
+      {
+         sl->mbx_l = (uint16)val;
+      }
+      else if (ec_eni_is(ps, 1, "Recv") && ec_eni_is(ps, 0, "Start"))
+      {
+         sl->mbx_ro = (uint16)val;
+      }
+      else if (ec_eni_is(ps, 1, "Recv") && ec_eni_is(ps, 0, "Length"))
+      {
+         sl->mbx_rl = (uint16)val;
+      }
+   }
+   else if (ec_eni_is(ps, 1, "Mailbox") && ec_eni_is(ps, 0, "Protocol"))
+   {
+      ec_eni_trim(&s, &len);
+      if (ec_eni_eq(s, len, "AoE")) sl->mbx_proto |= ECT_MBXPROT_AOE;
+      if (ec_eni_eq(s, len, "EoE")) sl->mbx_proto |= ECT_MBXPROT_EOE;
+      if (ec_eni_eq(s, len, "CoE")) sl->mbx_proto |= ECT_MBXPROT_COE;
+      if (ec_eni_eq(s, len, "FoE")) sl->mbx_proto |= ECT_MBXPROT_FOE;
+      if (ec_eni_eq(s, len, "SoE")) sl->mbx_proto |= ECT_MBXPROT_SOE;
+      if (ec_eni_eq(s, len, "VoE")) sl->mbx_proto |= ECT_MBXPROT_VOE;
+   }
+   else if (ec_eni_is(ps, 2, "ProcessData") && ec_eni_is(ps, 0, "BitLength"))
+   {
+      if (ec_eni_is(ps, 1, "Send"))
+      {
+         ps->sendbits += (uint16)val;
+      }
+      else if (ec_eni_is(ps, 1, "Recv"))
+      {
+         ps->recvbits += (uint16)val;
+      }
+   }
+   else if ((ps->sm >= 0) && ec_eni_is(ps, 2, "ProcessData"))
+   {
+      if (ec_eni_is(ps, 0, "Type"))
+      {
+         ec_eni_trim(&s, &len);
+         if (ec_eni_eq(s, len, "Outputs"))
+         {
+            sl->SMtype[ps->sm] = 3;
+         }
+         else if (ec_eni_eq(s, len, "Inputs"))
+         {
+            sl->SMtype[ps->sm] = 4;
+         }
+      }
+      else if (ec_eni_is(ps, 0, "StartAddress"))
+      {
+         sl->SM[ps->sm].StartAddr = htoes((uint16)val);
+      }
+      else if (ec_eni_is(ps, 0, "ControlByte"))
+      {
+         sl->SM[ps->sm].SMflags = htoel((etohl(sl->SM[ps->sm].SMflags) & 0xffff0000) | (val & 0xff));
+      }
+      else if (ec_eni_is(ps, 0, "Enable") && ec_eni_bool(s, len))
+      {
+         sl->SM[ps->sm].SMflags = htoel(etohl(sl->SM[ps->sm].SMflags) | 0x00010000);
+      }
+      else if (ec_eni_is(ps, 0, "Pdo") && (ps->nsmpdo[ps->sm] < EC_ENIMAXSMPDO))
+      {
+         ps->smpdo[ps->sm][ps->nsmpdo[ps->sm]++] = (uint16)val;
+      }
+   }
+   else if ((ps->npdo > 0) && ec_eni_is(ps, 2, "ProcessData") && ec_eni_is(ps, 0, "Index"))
+   {
+      pdo = &ps->pdo[ps->npdo - 1];
+      pdo->index = (uint16)val;
+   }
+   else if ((ps->nentry > 0) && ec_eni_is(ps, 1, "Entry") && ec_eni_is(ps, 3, "ProcessData"))
+   {
+      entry = &ps->entry[ps->nentry - 1];
+      if (ec_eni_is(ps, 0, "Index"))
+      {
+         entry->index = (uint16)val;
+      }
+      else if (ec_eni_is(ps, 0, "SubIndex"))
+      {
+         entry->subindex = (uint8)val;
+      }
+      else if (ec_eni_is(ps, 0, "BitLen"))
+      {
+         entry->bitlen = (uint8)val;
+      }
+   }
+   else if (ec_eni_is(ps, 1, "DC"))
+   {
+      if (ec_eni_is(ps, 0, "CycleTime0"))
+      {
+         sl->DCcycle = (int32)val;
+      }
+      else if (ec_eni_is(ps, 0, "ShiftTime0") || ec_eni_is(ps, 0, "ShiftTime"))
+      {
+         sl->DCshift = (int32)val;
+      }
+   }
+}
+
+/** PDO of a slave is assigned to SM.
+ * @param[in]  ps     = parser state
+ * @param[in]  pdo    = PDO
+ * @param[in]  sm     = SM number
+ * @return TRUE if assigned
+ */
+static boolean ec_eni_pdoassigned(ec_eniparsert *ps, ec_enipdot *pdo, int sm)
+{
+   int i;
+
+   /* PDO list of SM takes precedence over Sm attribute of PDO */
+   if (ps->nsmpdo[sm])
+   {
+      for (i = 0; i < ps->nsmpdo[sm]; i++)
+      {
+         if (ps->smpdo[sm][i] == pdo->index)
+         {
+            return TRUE;
+         }
+      }
+      return FALSE;
+   }
+   return (pdo->sm == sm);
+}
+
+/** Lay out the assigned PDOs of the slave in its SMs, like ecx_readPDOmap
+ * does, and store their entries.
+ * @param[in]  ps     = parser state
+ */
+static void ec_eni_slave_end(ec_eniparsert *ps)
+{
+   ec_enit *eni = ps->eni;
+   ec_enislavet *sl = ps->slave;
+   ec_pdoentryt *entry;
+   ec_enipdot *pdo;
+   int sm, i, j, bits, out;
+   int bitoffset[2] = { 0, 0 };
+
+   sl->pdoentry = (uint16)eni->pdoentrycount;
+   for (sm = 2; sm < EC_MAXSM; sm++)
+   {
+      /* SM without type gets the direction of its PDOs */
+      if (!sl->SMtype[sm])
+      {
+         for (i = 0; i < ps->npdo; i++)
+         {
+            if (ec_eni_pdoassigned(ps, &ps->pdo[i], sm))
+            {
+               sl->SMtype[sm] = ps->pdo[i].output ? 3 : 4;
+               break;
+            }
+         }
+      }
+      if ((sl->SMtype[sm] != 3) && (sl->SMtype[sm] != 4))
+      {
+         continue;
+      }
+      out = (sl->SMtype[sm] == 3) ? 1 : 0;
+      bits = 0;
+      for (i = 0; i < ps->npdo; i++)
+      {
+         pdo = &ps->pdo[i];
+         if ((pdo->output != out) || !ec_eni_pdoassigned(ps, pdo, sm))
+         {
+            continue;
+         }
+         for (j = 0; j < pdo->nentry; j++)
+         {
+            if (eni->pdoentrycount >= EC_MAXPDOENTRY)
+            {
+               ps->error = -2;
+               return;
+            }
+            entry = &eni->pdoentry[eni->pdoentrycount++];
+            *entry = ps->entry[pdo->entry + j];
+            entry->slave = (uint16)eni->slavecount;
+            entry->output = (boolean)out;
+            entry->bitoffset = (uint16)(bitoffset[out] + bits);
+            entry->next = EC_PDOENTRY_NONE;
+            bits += entry->bitlen;
+         }
+      }
+      sl->SM[sm].SMlength = htoes((uint16)((bits + 7) / 8));
+      /* next SM starts at a byte boundary in the process data */
+      bitoffset[out] += ((bits + 7) / 8) * 8;
+      if (out)
+      {
+         sl->Obits += bits;
+      }
+      else
+      {
+         sl->Ibits += bits;
+      }
+   }
+   sl->npdoentry = (uint16)(eni->pdoentrycount - sl->pdoentry);
+   /* no PDO description, size of first SM from process data length */
+   for (sm = 2; sm < EC_MAXSM; sm++)
+   {
+      if ((sl->SMtype[sm] == 3) && !sl->Obits && ps->sendbits)
+      {
+         sl->Obits = ps->sendbits;
+         sl->SM[sm].SMlength = htoes((ps->sendbits + 7) / 8);
+      }
+      else if ((sl->SMtype[sm] == 4) && !sl->Ibits && ps->recvbits)
+      {
+         sl->Ibits = ps->recvbits;
+         sl->SM[sm].SMlength = htoes((ps->recvbits + 7) / 8);
+      }
+   }
+   if (sl->mbx_l)
+   {
+      sl->SMtype[0] = 1;
+      sl->SMtype[1] = 2;
+      sl->SM[0].StartAddr = htoes(sl->mbx_wo);
+      sl->SM[0].SMlength = htoes(sl->mbx_l);
+      sl->SM[0].SMflags = htoel(EC_DEFAULTMBXSM0);
+      sl->SM[1].StartAddr = htoes(sl->mbx_ro);
+      sl->SM[1].SMlength = htoes(sl->mbx_rl);
+      sl->SM[1].SMflags = htoel(EC_DEFAULTMBXSM1);
+   }
+   sl->ninitcmd = (uint16)(eni->initcmdcount - sl->initcmd);
+   sl->ncoecmd = (uint16)(eni->coecmdcount - sl->coecmd);
+   ps->slave = NULL;
+}
+
+static void ec_eni_end(ec_eniparsert *ps, const char *text, int textlen)
+{
+   ec_enit *eni = ps->eni;
+
+   if (text)
+   {
+      if (ps->initcmd)
+      {
+         ec_eni_initcmd_text(ps, text, textlen);
+      }
+      else if (ps->coecmd)
+      {
+         ec_eni_coecmd_text(ps, text, textlen);
+      }
+      else if (ps->slave)
+      {
+         ec_eni_slave_text(ps, text, textlen);
+      }
+      return;
+   }
+   if (ec_eni_is(ps, 0, "InitCmd") && ec_eni_is(ps, 1, "InitCmds"))
+   {
+      /* validate data and mask are compared with all read data */
+      if (ps->initcmd &&
+          (((ps->initcmd->validate != EC_ENI_NODATA) &&
+            (ps->initcmd->validatelength != ps->initcmd->length)) ||
+           ((ps->initcmd->validatemask != EC_ENI_NODATA) &&
+            (ps->initcmd->masklength != ps->initcmd->length))))
+      {
+         ps->error = -1;
+      }
+      /* write commands given by length only write zeros */
+      if (ps->initcmd && (ps->initcmd->data == EC_ENI_NODATA) && ps->initcmd->length)
+      {
+         ps->initcmd->data = ec_eni_zerodata(ps, ps->initcmd->length);
+      }
+      ps->initcmd = NULL;
+      ps->coecmd = NULL;
+   }
+   else if (ps->slave && ec_eni_is(ps, 0, "Slave") && ec_eni_is(ps, 1, "Config"))
+   {
+      ec_eni_slave_end(ps);
+   }
+   else if (ec_eni_is(ps, 0, "Master") && ec_eni_is(ps, 1, "Config"))
+   {
+      eni->nmasterinitcmd = (uint16)(eni->initcmdcount - eni->masterinitcmd);
+   }
+   else if ((ps->sm >= 0) && ec_eni_is(ps, 1, "ProcessData") && (ps->elem[ps->depth - 1].namelen == 3))
+   {
+      ps->sm = -1;
+   }
+}
+
+/** Skip to the end of a string in the XML text and count lines.
+ * @param[in]  ps     = parser state
+ * @param[in]  s      = string to find
+ * @return TRUE if found, parser is after the string
+ */
+static boolean ec_eni_skip(ec_eniparsert *ps, const char *s)
+{
+   int len = (int)strlen(s);
+
+   while ((ps->p + len) <= ps->end)
+   {
+      if (strncmp(ps->p, s, len) == 0)
+      {
+         ps->p += len;
+         return TRUE;
+      }
+      if (*ps->p == '\n')
+      {
+         ps->line++;
+      }
+      ps->p++;
+   }
+   ps->p = ps->end;
+   return FALSE;
+}
+
+/** Compile ENI file into eni structure. The XML text does not have to be
+ * kept after parsing.
+ *
+ * @param[out] eni    = compiled ENI
+ * @param[in]  xml    = XML text of ENI file
+ * @param[in]  size   = size of XML text
+ * @return number of slaves, -1 if XML error or the data, DataLength and
+ * Validate lengths of an InitCmd disagree, -2 if ENI exceeds eni structure
+ */
+int ec_eni_parse(ec_enit *eni, const char *xml, int size)
+{
+   ec_eniparsert ps;
+   ec_enielemt *e;
+   const char *text, *tag;
+   boolean selfclose, leaf;
+
+   memset(eni, 0x00, sizeof(ec_enit));
+   memset(&ps, 0x00, sizeof(ps));
+   ps.eni = eni;
+   ps.p = xml;
+   ps.end = xml + size;
+   ps.line = 1;
+   ps.sm = -1;
+   text = NULL;
+   leaf = FALSE;
+   while ((ps.error == 0) && ec_eni_skip(&ps, "<"))
+   {
+      tag = ps.p;
+      if (ps.p >= ps.end)
+      {
+         ps.error = -1;
+      }
+      /* declaration, processing instruction, comment, CDATA or DOCTYPE */
+      else if (*tag == '?')
+      {
+         ec_eni_skip(&ps, "?>");
+      }
+      else if ((ps.end - tag >= 3) && (strncmp(tag, "!--", 3) == 0))
+      {
+         ec_eni_skip(&ps, "-->");
+      }
+      else if ((ps.end - tag >= 8) && (strncmp(tag, "![CDATA[", 8) == 0))
+      {
+         ec_eni_skip(&ps, "]]>");
+      }
+      else if (*tag == '!')
+      {
+         ec_eni_skip(&ps, ">");
+      }
+      /* end tag */
+      else if (*tag == '/')
+      {
+         if ((ps.depth == 0) || !ec_eni_skip(&ps, ">"))
+         {
+            ps.error = -1;
+            break;
+         }
+         e = &ps.elem[ps.depth - 1];
+         if (((int)(ps.p - tag - 2) < e->namelen) || strncmp(tag + 1, e->name, e->namelen))
+         {
+            ps.error = -1;
+            break;
+         }
+         /* only elements without child elements have text */
+         if (leaf)
+         {
+            ec_eni_end(&ps, text, (int)(tag - 1 - text));
+         }
+         ec_eni_end(&ps, NULL, 0);
+         ps.depth--;
+         leaf = FALSE;
+      }
+      /* start tag */
+      else
+      {
+         if (ps.depth >= EC_ENIMAXDEPTH)
+         {
+            ps.error = -2;
+            break;
+         }
+         e = &ps.elem[ps.depth++];
+         e->name = tag;
+         while ((ps.p < ps.end) && (*ps.p != '>') && (*ps.p != '/') && (*ps.p != ' ') &&
+                (*ps.p != '\t') && (*ps.p != '\r') && (*ps.p != '\n'))
+         {
+            ps.p++;
+         }
+         e->namelen = (int)(ps.p - tag);
+         e->attr = ps.p;
+         if (!ec_eni_skip(&ps, ">"))
+         {
+            ps.error = -1;
+            break;
+         }
+         selfclose = (ps.p[-2] == '/');
+         e->attrlen = (int)(ps.p - e->attr - (selfclose ? 2 : 1));
+         ec_eni_start(&ps);
+         if (selfclose)
+         {
+            ec_eni_end(&ps, NULL, 0);
+            ps.depth--;
+            leaf = FALSE;
+         }
+         else
+         {
+            text = ps.p;
+            leaf = TRUE;
+         }
+      }
+   }
+   if ((ps.error == 0) && (ps.depth != 0))
+   {
+      ps.error = -1;
+   }
+   if (ps.error)
+   {
+      eni->errorline = ps.line;
+      return ps.error;
+   }
+   return eni->slavecount;
+}
+
+static void ecx_eni_batch_flush(ecx_contextt *context, ec_enibatcht *b, int *failed)
+{
+   uint8 *frame;
+   ec_comt *datagram;
+   uint16 wkc;
+   int i, rval;
+
+   if (b->n == 0)
+   {
+      return;
+   }
+   frame = (uint8 *)&(context->port->txbuf[b->idx]);
+   /* last datagram ends the frame */
+   datagram = (ec_comt *)&frame[ETH_HEADERSIZE + b->offset[b->n - 1] - EC_HEADERSIZE];
+   datagram->dlength = htoes(etohs(datagram->dlength) & ~EC_DATAGRAMFOLLOWS);
+   rval = ecx_srconfirm(context->port, (uint8)b->idx, EC_TIMEOUTRET3);
+   for (i = 0; i < b->n; i++)
+   {
+      wkc = 0;
+      if (rval > EC_NOFRAME)
+      {
+         memcpy(&wkc, &(context->port->rxbuf[b->idx][b->offset[i] + b->length[i]]), EC_WKCSIZE);
+         wkc = etohs(wkc);
+         if (b->rdata[i])
+         {
+            memcpy(b->rdata[i], &(context->port->rxbuf[b->idx][b->offset[i]]), b->length[i]);
+         }
+      }
+      if ((rval <= EC_NOFRAME) || ((b->cnt[i] != EC_ENI_NOCNT) && (wkc != b->cnt[i])))
+      {
+         EC_LOG(context, EC_LOG_WARNING, EC_LOG_CONFIG, "ENI datagram %d of batch wkc %d expected %d\n",
+                i, wkc, b->cnt[i]);
+         (*failed)++;
+      }
+   }
+   ecx_setbufstat(context->port, (uint8)b->idx, EC_BUF_EMPTY);
+   b->n = 0;
+}
+
+/** Add datagram to batched frame, a full frame is sent first.
+ * @param[in]  context = context struct
+ * @param[in]  b       = batch
+ * @param[in]  cmd     = datagram command
+ * @param[in]  adp     = address position
+ * @param[in]  ado     = address offset
+ * @param[in]  length  = data length
+ * @param[in]  data    = data to write
+ * @param[out] rdata   = received data, NULL if not needed
+ * @param[in]  cnt     = expected working counter, EC_ENI_NOCNT = not checked
+ * @param[in,out] failed = count of failed datagrams
+ */
+static void ecx_eni_batch_add(ecx_contextt *context, ec_enibatcht *b, uint8 cmd, uint16 adp,
+   uint16 ado, uint16 length, void *data, void *rdata, uint16 cnt, int *failed)
+{
+   if ((b->n >= EC_ENIMAXBATCH) ||
+       ((b->n > 0) && ((context->port->txbuflength[b->idx] + EC_HEADERSIZE - EC_ELENGTHSIZE +
+                        length + EC_WKCSIZE) > EC_ENIMAXFRAME)))
+   {
+      ecx_eni_batch_flush(context, b, failed);
+   }
+   if (b->n == 0)
+   {
+      b->idx = ecx_getindex(context->port);
+      ecx_setupdatagram(context->port, &(context->port->txbuf[b->idx]), cmd, (uint8)b->idx,
+         adp, ado, length, data);
+      b->offset[0] = EC_HEADERSIZE;
+   }
+   else
+   {
+      b->offset[b->n] = ecx_adddatagram(context->port, &(context->port->txbuf[b->idx]), cmd,
+         (uint8)b->idx, TRUE, adp, ado, length, data);
+   }
+   b->length[b->n] = length;
+   b->cnt[b->n] = cnt;
+   b->rdata[b->n] = rdata;
+   b->n++;
+}
+
+/** Execute ESC init command with validation, repeated until the read data
+ * matches or the timeout expires.
+ * @return TRUE if validated
+ */
+static boolean ecx_eni_validate(ecx_contextt *context, ec_enit *eni, ec_eniinitcmdt *cmd)
+{
+   uint8 rdata[EC_MAXLRWDATA];
+   ec_enibatcht b;
+   osal_timert timer;
+   boolean ok;
+   int nframe, i;
+   uint8 mask;
+
+   if (cmd->length > EC_MAXLRWDATA)
+   {
+      return FALSE;
+   }
+   osal_timer_start(&timer, (cmd->timeout ? cmd->timeout : 1) * 1000);
+   do
+   {
+      b.n = 0;
+      nframe = 0;
+      ecx_eni_batch_add(context, &b, cmd->cmd, cmd->adp, cmd->ado, cmd->length,
+         (cmd->data != EC_ENI_NODATA) ? &eni->data[cmd->data] : NULL, rdata, cmd->cnt, &nframe);
+      ecx_eni_batch_flush(context, &b, &nframe);
+      ok = (nframe == 0);
+      for (i = 0; ok && (i < cmd->length); i++)
+      {
+         mask = (cmd->validatemask != EC_ENI_NODATA) ? eni->data[cmd->validatemask + i] : 0xff;
+         ok = ((rdata[i] & mask) == (eni->data[cmd->validate + i] & mask));
+      }
+      if (!ok)
+      {
+         osal_usleep(1000);
+      }
+   } while (!ok && !osal_timer_is_expired(&timer));
+   return ok;
+}
+
+/** Execute the ESC init commands of master and slaves of a state transition
+ * in batched frames, in ENI order. Commands with validation are sent alone.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  eni        = compiled ENI
+ * @param[in]  transition = transition, EC_ENI_IP etc.
+ * @return number of commands that failed
+ */
+int ecx_eni_initcmds(ecx_contextt *context, ec_enit *eni, uint16 transition)
+{
+   ec_enibatcht b;
+   ec_eniinitcmdt *cmd;
+   int i, slave, first, n, failed = 0;
+
+   b.n = 0;
+   for (slave = 0; slave <= eni->slavecount; slave++)
+   {
+      first = slave ? eni->slave[slave - 1].initcmd : eni->masterinitcmd;
+      n = slave ? eni->slave[slave - 1].ninitcmd : eni->nmasterinitcmd;
+      for (i = first; i < (first + n); i++)
+      {
+         cmd = &eni->initcmd[i];
+         if (!(cmd->transition & transition) || (cmd->length > EC_MAXLRWDATA))
+         {
+            continue;
+         }
+         if (cmd->validate != EC_ENI_NODATA)
+         {
+            ecx_eni_batch_flush(context, &b, &failed);
+            if (!ecx_eni_validate(context, eni, cmd))
+            {
+               EC_LOG(context, EC_LOG_WARNING, EC_LOG_CONFIG, "ENI init command %d of slave %d not validated\n",
+                      i - first, slave);
+               failed++;
+            }
+         }
+         else
+         {
+            ecx_eni_batch_add(context, &b, cmd->cmd, cmd->adp, cmd->ado, cmd->length,
+               (cmd->data != EC_ENI_NODATA) ? &eni->data[cmd->data] : NULL, NULL, cmd->cnt, &failed);
+         }
+      }
+   }
+   ecx_eni_batch_flush(context, &b, &failed);
+   return failed;
+}
+
+/** Execute the CoE init commands of a slave of a state transition as SDO
+ * downloads. Upload commands are skipped.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  eni        = compiled ENI
+ * @param[in]  slave      = slave number
+ * @param[in]  transition = transition, EC_ENI_PS etc.
+ * @return number of commands that failed
+ */
+int ecx_eni_coecmds(ecx_contextt *context, ec_enit *eni, uint16 slave, uint16 transition)
+{
+   ec_enislavet *es = &eni->slave[slave - 1];
+   ec_enicoecmdt *cmd;
+   int i, wkc, failed = 0;
+
+   for (i = es->coecmd; i < (es->coecmd + es->ncoecmd); i++)
+   {
+      cmd = &eni->coecmd[i];
+      if (!(cmd->transition & transition) || (cmd->ccs != 1) || (cmd->data == EC_ENI_NODATA))
+      {
+         continue;
+      }
+      wkc = ecx_SDOwrite(context, slave, cmd->index, cmd->subindex, cmd->ca, cmd->length,
+         &eni->data[cmd->data], cmd->timeout ? (int)(cmd->timeout * 1000) : EC_TIMEOUTRXM);
+      if (wkc <= 0)
+      {
+         EC_LOG(context, EC_LOG_WARNING, EC_LOG_CONFIG, "ENI CoE init command %4.4x:%2.2x of slave %d failed\n",
+                cmd->index, cmd->subindex, slave);
+         failed++;
+      }
+   }
+   return failed;
+}
+
+/** Copy ENI settings of a slave into the slave list. */
+static void ecx_eni_slave(ecx_contextt *context, ec_enit *eni, uint16 slave)
+{
+   ec_enislavet *es = &eni->slave[slave - 1];
+   ec_slavet *sl = &context->slavelist[slave];
+   int nSM;
+
+   sl->eniindex = slave;
+   memcpy(sl->name, es->name, EC_MAXNAME + 1);
+   sl->eep_rev = es->eep_rev;
+   sl->eep_ser = es->eep_ser;
+   sl->mbx_l = es->mbx_l;
+   sl->mbx_wo = es->mbx_wo;
+   sl->mbx_rl = es->mbx_rl ? es->mbx_rl : es->mbx_l;
+   sl->mbx_ro = es->mbx_ro;
+   sl->mbx_proto = es->mbx_proto;
+   sl->CoEdetails = es->CoEdetails;
+   for (nSM = 0; nSM < EC_MAXSM; nSM++)
+   {
+      sl->SM[nSM] = es->SM[nSM];
+      sl->SMtype[nSM] = es->SMtype[nSM];
+   }
+   sl->Obits = es->Obits;
+   sl->Ibits = es->Ibits;
+   if (sl->Obits)
+   {
+      sl->FMMU0func = 1;
+   }
+   if (sl->Ibits)
+   {
+      sl->FMMU1func = 2;
+   }
+   sl->DCcycle = es->DCcycle;
+   sl->DCshift = es->DCshift;
+   sl->group = es->group;
+}
+
+/** Enumerate and init all slaves from a compiled ENI instead of discovering
+ * them. The slaves on the bus must match the ENI in number and identity, then
+ * the ESC init commands INIT to PRE-OP are executed, the slaves are requested
+ * to PRE-OP and the CoE init commands PRE-OP to SAFE-OP are written. Continue
+ * with ecx_config_map_group as after ecx_config_init.
+ *
+ * @param[in]  context = context struct
+ * @param[in]  eni     = compiled ENI
+ * @return number of slaves found, -1 if the number of slaves does not match,
+ * -2 if the identity of a slave does not match
+ */
+int ecx_config_eni(ecx_contextt *context, ec_enit *eni)
+{
+   ec_enibatcht b;
+   ec_enislavet *es;
+   ec_slavet *sl;
+   uint16 slave, stadr[EC_MAXSLAVE], alctl, dlctl[2];
+   uint32 eedat;
+   int wkc, failed, mismatch;
+
+   EC_LOG(context, EC_LOG_DEBUG, EC_LOG_CONFIG, "ec_config_eni %d\n", eni->slavecount);
+   ecx_init_context(context);
+   wkc = ecx_detect_slaves(context);
+   if (wkc <= 0)
+   {
+      return wkc;
+   }
+   if (wkc != eni->slavecount)
+   {
+      EC_LOG(context, EC_LOG_ERROR, EC_LOG_CONFIG, "Error: ENI has %d slaves, %d found\n", eni->slavecount, wkc);
+      return -1;
+   }
+   ecx_set_slaves_to_default(context);
+   dlctl[0] = htoes(0);
+   dlctl[1] = htoes(1);
+   /* set station addresses and read aliases in one batch */
+   b.n = 0;
+   failed = 0;
+   for (slave = 1; slave <= wkc; slave++)
+   {
+      es = &eni->slave[slave - 1];
+      sl = &context->slavelist[slave];
+      sl->configadr = es->physaddr ? es->physaddr : (uint16)(slave + EC_NODEOFFSET);
+      stadr[slave] = htoes(sl->configadr);
+      ecx_eni_batch_add(context, &b, EC_CMD_APWR, (uint16)(1 - slave), ECT_REG_STADR,
+         sizeof(stadr[slave]), &stadr[slave], NULL, 1, &failed);
+      ecx_eni_batch_add(context, &b, EC_CMD_APRD, (uint16)(1 - slave), ECT_REG_ALIAS,
+         sizeof(sl->aliasadr), NULL, &sl->aliasadr, 1, &failed);
+      ecx_eni_batch_add(context, &b, EC_CMD_APRD, (uint16)(1 - slave), ECT_REG_PDICTL,
+         sizeof(sl->Itype), NULL, &sl->Itype, 1, &failed);
+      /* kill non ecat frames for first slave, pass them for following slaves */
+      ecx_eni_batch_add(context, &b, EC_CMD_APWR, (uint16)(1 - slave), ECT_REG_DLCTL,
+         sizeof(dlctl[0]), &dlctl[(slave == 1) ? 1 : 0], NULL, 1, &failed);
+   }
+   ecx_eni_batch_flush(context, &b, &failed);
+   /* quick identity check instead of SII discovery */
+   for (slave = 1; slave <= wkc; slave++)
+   {
+      context->slavelist[slave].aliasadr = etohs(context->slavelist[slave].aliasadr);
+      context->slavelist[slave].Itype = etohs(context->slavelist[slave].Itype);
+      ecx_readeeprom1(context, slave, ECT_SII_MANUF);
+   }
+   for (slave = 1; slave <= wkc; slave++)
+   {
+      eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP);
+      context->slavelist[slave].eep_man = etohl(eedat);
+      ecx_readeeprom1(context, slave, ECT_SII_ID);
+   }
+   mismatch = 0;
+   for (slave = 1; slave <= wkc; slave++)
+   {
+      es = &eni->slave[slave - 1];
+      sl = &context->slavelist[slave];
+      eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP);
+      sl->eep_id = etohl(eedat);
+      if ((es->eep_man && (es->eep_man != sl->eep_man)) || (es->eep_id && (es->eep_id != sl->eep_id)))
+      {
+         EC_LOG(context, EC_LOG_ERROR, EC_LOG_CONFIG, "Error: slave %d is M:%8.8x I:%8.8x, ENI M:%8.8x I:%8.8x\n",
+                slave, sl->eep_man, sl->eep_id, es->eep_man, es->eep_id);
+         mismatch++;
+      }
+   }
+   if (mismatch)
+   {
+      return -2;
+   }
+   failed += ecx_eni_initcmds(context, eni, EC_ENI_IP);
+   for (slave = 1; slave <= wkc; slave++)
+   {
+      ecx_eni_slave(context, eni, slave);
+      ecx_config_links(context, slave);
+      ecx_eeprom2pdi(context, slave);
+   }
+   /* program mailbox SMs and request PRE-OP in one batch */
+   alctl = htoes(EC_STATE_PRE_OP | EC_STATE_ACK);
+   for (slave = 1; slave <= wkc; slave++)
+   {
+      sl = &context->slavelist[slave];
+      if (sl->mbx_l)
+      {
+         ecx_eni_batch_add(context, &b, EC_CMD_FPWR, sl->configadr, ECT_REG_SM0,
+            sizeof(ec_smt) * 2, &(sl->SM[0]), NULL, 1, &failed);
+      }
+      ecx_eni_batch_add(context, &b, EC_CMD_FPWR, sl->configadr, ECT_REG_ALCTL,
+         sizeof(alctl), &alctl, NULL, 1, &failed);
+   }
+   ecx_eni_batch_flush(context, &b, &failed);
+   ecx_statecheck(context, 0, EC_STATE_PRE_OP, EC_TIMEOUTSTATE);
+   for (slave = 1; slave <= wkc; slave++)
+   {
+      failed += ecx_eni_coecmds(context, eni, slave, EC_ENI_PS);
+      es = &eni->slave[slave - 1];
+      (void)ecx_pdoentry_store(context, slave, &eni->pdoentry[es->pdoentry], es->npdoentry);
+   }
+   ecx_slaveindex_update(context);
+   if (failed)
+   {
+      EC_LOG(context, EC_LOG_WARNING, EC_LOG_CONFIG, "ENI %d init commands failed\n", failed);
+   }
+   return wkc;
+}
+
+/** output buffer of ENI export */
+typedef struct
+{
+   char             *buf;
+   int              size;
+   int              len;
+} ec_eniwritert;
+
+static void ec_eni_printf(ec_eniwritert *w, const char *fmt, ...)
+{
+   va_list ap;
+   int n;
+
+   va_start(ap, fmt);
+   if (w->len < w->size)
+   {
+      n = vsnprintf(w->buf + w->len, (size_t)(w->size - w->len), fmt, ap);
+   }
+   else
+   {
+      n = vsnprintf(NULL, 0, fmt, ap);
+   }
+   va_end(ap);
+   if (n > 0)
+   {
+      w->len += n;
+   }
+}
+
+static void ec_eni_hex(ec_eniwritert *w, const void *data, int length)
+{
+   const uint8 *p = (const uint8 *)data;
+   int i;
+
+   for (i = 0; i < length; i++)
+   {
+      ec_eni_printf(w, "%2.2x", p[i]);
+   }
+}
+
+/** Write ESC init command of ENI export, used for SM and FMMU programming. */
+static void ec_eni_writecmd(ec_eniwritert *w, const char *comment, uint16 transition,
+   uint16 configadr, uint16 ado, const void *data, int length)
+{
+   int i;
+
+   ec_eni_printf(w, "        <InitCmd>\n");
+   ec_eni_printf(w, "          <Comment><![CDATA[%s]]></Comment>\n", comment);
+   for (i = 0; i < (int)(sizeof(ec_eni_transname) / sizeof(ec_eni_transname[0])); i++)
+   {
+      if (transition & (1 << i))
+      {
+         ec_eni_printf(w, "          <Transition>%s</Transition>\n", ec_eni_transname[i]);
+      }
+   }
+   ec_eni_printf(w, "          <Cmd>%d</Cmd>\n", EC_CMD_FPWR);
+   ec_eni_printf(w, "          <Adp>%d</Adp>\n", configadr);
+   ec_eni_printf(w, "          <Ado>%d</Ado>\n", ado);
+   ec_eni_printf(w, "          <Data>");
+   ec_eni_hex(w, data, length);
+   ec_eni_printf(w, "</Data>\n");
+   ec_eni_printf(w, "          <Cnt>1</Cnt>\n");
+   ec_eni_printf(w, "        </InitCmd>\n");
+}
+
+/** Write process data of a slave in ENI export. PDO indices are not kept in
+ * the PDO entry map, the entries of each SM are exported as one PDO. */
+static void ecx_eni_writepd(ecx_contextt *context, ec_eniwritert *w, uint16 slave)
+{
+   ec_slavet *sl = &context->slavelist[slave];
+   const ec_pdoentryt *entry;
+   ec_fmmut *fmmu;
+   int sm, out, n, i, length;
+   int bitoffset[2] = { 0, 0 };
+   uint16 pdoindex[2] = { 0x1600, 0x1a00 };
+
+   ec_eni_printf(w, "      <ProcessData>\n");
+   /* logical start of process data from the FMMUs of the slave */
+   for (out = 1; out >= 0; out--)
+   {
+      if (!(out ? sl->Obits : sl->Ibits))
+      {
+         continue;
+      }
+      fmmu = NULL;
+      for (i = 0; i < EC_MAXFMMU; i++)
+      {
+         if (sl->FMMU[i].FMMUactive && (sl->FMMU[i].FMMUtype == (out ? 2 : 1)))
+         {
+            fmmu = &sl->FMMU[i];
+            break;
+         }
+      }
+      ec_eni_printf(w, "        <%s>\n", out ? "Send" : "Recv");
+      if (fmmu)
+      {
+         ec_eni_printf(w, "          <BitStart>%u</BitStart>\n",
+                       (etohl(fmmu->LogStart) * 8) + fmmu->LogStartbit);
+      }
+      ec_eni_printf(w, "          <BitLength>%d</BitLength>\n", out ? sl->Obits : sl->Ibits);
+      ec_eni_printf(w, "        </%s>\n", out ? "Send" : "Recv");
+   }
+   for (sm = 2; sm < EC_MAXSM; sm++)
+   {
+      if ((sl->SMtype[sm] != 3) && (sl->SMtype[sm] != 4))
+      {
+         continue;
+      }
+      out = (sl->SMtype[sm] == 3) ? 1 : 0;
+      length = etohs(sl->SM[sm].SMlength);
+      ec_eni_printf(w, "        <Sm%d>\n", sm);
+      ec_eni_printf(w, "          <Type>%s</Type>\n", out ? "Outputs" : "Inputs");
+      ec_eni_printf(w, "          <StartAddress>%d</StartAddress>\n", etohs(sl->SM[sm].StartAddr));
+      ec_eni_printf(w, "          <ControlByte>%d</ControlByte>\n", etohl(sl->SM[sm].SMflags) & 0xff);
+      ec_eni_printf(w, "          <Enable>%s</Enable>\n",
+                    ((etohl(sl->SM[sm].SMflags) & 0x00010000) && length) ? "true" : "false");
+      /* entries of this SM in the PDO entry map */
+      n = 0;
+      for (i = 0; i < sl->npdoentry; i++)
+      {
+         entry = ecx_pdoentry_get(context, slave, (uint16)i);
+         if (entry && (entry->output == out) && (entry->bitoffset >= bitoffset[out]) &&
+             (entry->bitoffset < (bitoffset[out] + (length * 8))))
+         {
+            n++;
+         }
+      }
+      if (n)
+      {
+         ec_eni_printf(w, "          <Pdo>%d</Pdo>\n", pdoindex[!out]);
+      }
+      ec_eni_printf(w, "        </Sm%d>\n", sm);
+      if (n)
+      {
+         ec_eni_printf(w, "        <%s Sm=\"%d\">\n", out ? "RxPdo" : "TxPdo", sm);
+         ec_eni_printf(w, "          <Index>%d</Index>\n", pdoindex[!out]++);
+         for (i = 0; i < sl->npdoentry; i++)
+         {
+            entry = ecx_pdoentry_get(context, slave, (uint16)i);
+            if (entry && (entry->output == out) && (entry->bitoffset >= bitoffset[out]) &&
+                (entry->bitoffset < (bitoffset[out] + (length * 8))))
+            {
+               ec_eni_printf(w, "          <Entry><Index>%d</Index><SubIndex>%d</SubIndex><BitLen>%d</BitLen></Entry>\n",
+                             entry->index, entry->subindex, entry->bitlen);
+            }
+         }
+         ec_eni_printf(w, "        </%s>\n", out ? "RxPdo" : "TxPdo");
+      }
+      bitoffset[out] += length * 8;
+   }
+   ec_eni_printf(w, "      </ProcessData>\n");
+}
+
+/** Export the configuration of the bus as ENI XML, after ecx_config_init and
+ * ecx_config_map_group. Per slave the identity, station address, mailbox,
+ * process data with logical start, SMs, PDO entries, the SM and FMMU
+ * programming as init commands, the parent port and the DC settings are
+ * written. The XML can be read back by ec_eni_parse.
+ *
+ * @param[in]  context = context struct
+ * @param[out] xml     = buffer for XML text, terminated by zero
+ * @param[in]  size    = size of buffer
+ * @return length of XML text, if >= size the text was truncated
+ */
+int ecx_eni_export(ecx_contextt *context, char *xml, int size)
+{
+   ec_eniwritert w;
+   ec_slavet *sl;
+   uint16 slave, nSM, nFMMU;
+   char comment[32];
+
+   w.buf = xml;
+   w.size = size;
+   w.len = 0;
+   ec_eni_printf(&w, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n");
+   ec_eni_printf(&w, "<EtherCATConfig Version=\"1.3\">\n");
+   ec_eni_printf(&w, "  <Config>\n");
+   ec_eni_printf(&w, "    <Master>\n");
+   ec_eni_printf(&w, "      <Info><Name>SOEM</Name></Info>\n");
+   ec_eni_printf(&w, "    </Master>\n");
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      sl = &context->slavelist[slave];
+      ec_eni_printf(&w, "    <Slave>\n");
+      ec_eni_printf(&w, "      <Info>\n");
+      ec_eni_printf(&w, "        <Name><![CDATA[%s]]></Name>\n", sl->name);
+      ec_eni_printf(&w, "        <PhysAddr>%d</PhysAddr>\n", sl->configadr);
+      ec_eni_printf(&w, "        <AutoIncAddr>%d</AutoIncAddr>\n", (int16)(1 - slave));
+      ec_eni_printf(&w, "        <VendorId>%u</VendorId>\n", sl->eep_man);
+      ec_eni_printf(&w, "        <ProductCode>%u</ProductCode>\n", sl->eep_id);
+      ec_eni_printf(&w, "        <RevisionNo>%u</RevisionNo>\n", sl->eep_rev);
+      ec_eni_printf(&w, "        <SerialNo>%u</SerialNo>\n", sl->eep_ser);
+      ec_eni_printf(&w, "      </Info>\n");
+      ecx_eni_writepd(context, &w, slave);
+      if (sl->mbx_l)
+      {
+         ec_eni_printf(&w, "      <Mailbox DataLinkLayer=\"true\">\n");
+         ec_eni_printf(&w, "        <Send><Start>%d</Start><Length>%d</Length></Send>\n", sl->mbx_wo, sl->mbx_l);
+         ec_eni_printf(&w, "        <Recv><Start>%d</Start><Length>%d</Length></Recv>\n", sl->mbx_ro, sl->mbx_rl);
+         if (sl->mbx_proto & ECT_MBXPROT_AOE) ec_eni_printf(&w, "        <Protocol>AoE</Protocol>\n");
+         if (sl->mbx_proto & ECT_MBXPROT_EOE) ec_eni_printf(&w, "        <Protocol>EoE</Protocol>\n");
+         if (sl->mbx_proto & ECT_MBXPROT_COE) ec_eni_printf(&w, "        <Protocol>CoE</Protocol>\n");
+         if (sl->mbx_proto & ECT_MBXPROT_FOE) ec_eni_printf(&w, "        <Protocol>FoE</Protocol>\n");
+         if (sl->mbx_proto & ECT_MBXPROT_SOE) ec_eni_printf(&w, "        <Protocol>SoE</Protocol>\n");
+         if (sl->mbx_proto & ECT_MBXPROT_VOE) ec_eni_printf(&w, "        <Protocol>VoE</Protocol>\n");
+         if (sl->CoEdetails & ECT_COEDET_SDO)
+         {
+            ec_eni_printf(&w, "        <CoE SdoInfo=\"%s\" PdoAssign=\"%s\" PdoConfig=\"%s\" CompleteAccess=\"%s\"/>\n",
+                          (sl->CoEdetails & ECT_COEDET_SDOINFO) ? "true" : "false",
+                          (sl->CoEdetails & ECT_COEDET_PDOASSIGN) ? "true" : "false",
+                          (sl->CoEdetails & ECT_COEDET_PDOCONFIG) ? "true" : "false",
+                          (sl->CoEdetails & ECT_COEDET_SDOCA) ? "true" : "false");
+         }
+         ec_eni_printf(&w, "      </Mailbox>\n");
+      }
+      ec_eni_printf(&w, "      <InitCmds>\n");
+      for (nSM = 0; nSM < EC_MAXSM; nSM++)
+      {
+         if (sl->SM[nSM].StartAddr)
+         {
+            snprintf(comment, sizeof(comment), "set SM%d", nSM);
+            ec_eni_writecmd(&w, comment, (nSM < 2) ? EC_ENI_IP : EC_ENI_PS, sl->configadr,
+               (uint16)(ECT_REG_SM0 + (nSM * sizeof(ec_smt))), &sl->SM[nSM], sizeof(ec_smt));
+         }
+      }
+      for (nFMMU = 0; nFMMU < EC_MAXFMMU; nFMMU++)
+      {
+         if (sl->FMMU[nFMMU].FMMUactive)
+         {
+            snprintf(comment, sizeof(comment), "set FMMU%d", nFMMU);
+            ec_eni_writecmd(&w, comment, EC_ENI_PS, sl->configadr,
+               (uint16)(ECT_REG_FMMU0 + (nFMMU * sizeof(ec_fmmut))), &sl->FMMU[nFMMU], sizeof(ec_fmmut));
+         }
+      }
+      ec_eni_printf(&w, "      </InitCmds>\n");
+      if (sl->parent)
+      {
+         ec_eni_printf(&w, "      <PreviousPort Selected=\"1\"><Port>%c</Port><PhysAddr>%d</PhysAddr></PreviousPort>\n",
+                       'A' + sl->parentport, context->slavelist[sl->parent].configadr);
+      }
+      if (sl->hasdc)
+      {
+         ec_eni_printf(&w, "      <DC>\n");
+         ec_eni_printf(&w, "        <CycleTime0>%d</CycleTime0>\n", sl->DCcycle);
+         ec_eni_printf(&w, "        <ShiftTime0>%d</ShiftTime0>\n", sl->DCshift);
+         ec_eni_printf(&w, "      </DC>\n");
+      }
+      ec_eni_printf(&w, "    </Slave>\n");
+   }
+   ec_eni_printf(&w, "  </Config>\n");
+   ec_eni_printf(&w, "</EtherCATConfig>\n");
+   return w.len;
+}
+
+static void ec_eni_put16(uint8 *p, uint16 val)
+{
+   p[0] = (uint8)(val & 0xff);
+   p[1] = (uint8)(val >> 8);
+}
+
+static void ec_eni_put32(uint8 *p, uint32 val)
+{
+   ec_eni_put16(p, (uint16)(val & 0xffff));
+   ec_eni_put16(p + 2, (uint16)(val >> 16));
+}
+
+static uint16 ec_eni_get16(const uint8 *p)
+{
+   return (uint16)(p[0] | (p[1] << 8));
+}
+
+static uint32 ec_eni_get32(const uint8 *p)
+{
+   return (uint32)ec_eni_get16(p) | ((uint32)ec_eni_get16(p + 2) << 16);
+}
+
+/* number of PDO entries of a slave that are present in the entry table */
+static int ecx_config_npdoentry(ecx_contextt *context, uint16 slave)
+{
+   int i, n = 0;
+
+   for (i = 0; i < context->slavelist[slave].npdoentry; i++)
+   {
+      if (ecx_pdoentry_get(context, slave, (uint16)i))
+      {
+         n++;
+      }
+   }
+   return n;
+}
+
+/** Size of the compact configuration of the bus.
+ *
+ * @param[in]  context = context struct
+ * @return size in bytes
+ */
+int ecx_config_export_size(ecx_contextt *context)
+{
+   int slave, nentry = 0;
+
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      nentry += ecx_config_npdoentry(context, (uint16)slave);
+   }
+   return EC_CONFIG_HEADSIZE + (*(context->slavecount) * EC_CONFIG_SLAVESIZE) +
+          (nentry * EC_CONFIG_ENTRYSIZE);
+}
+
+/** Export the configuration of the bus as compact binary, after
+ * ecx_config_init and ecx_config_map_group. All values are little endian. The
+ * header holds magic, version, number of slaves, number of PDO entries and
+ * the record sizes, followed by one record per slave with identity, station
+ * and alias address, mailbox, group, DC topology and settings, process data
+ * size, SMs, FMMUs and name, and the PDO entry records of all slaves. It can
+ * be read back by ec_config_load.
+ *
+ * @param[in]  context = context struct
+ * @param[out] buf     = buffer for compact configuration
+ * @param[in]  size    = size of buffer
+ * @return size of compact configuration, 0 if buffer too small
+ */
+int ecx_config_export(ecx_contextt *context, uint8 *buf, int size)
+{
+   const ec_pdoentryt *entry;
+   ec_slavet *sl;
+   uint8 *p;
+   int total, slave, i, nentry;
+
+   total = ecx_config_export_size(context);
+   if (total > size)
+   {
+      return 0;
+   }
+   memset(buf, 0x00, total);
+   nentry = (total - EC_CONFIG_HEADSIZE - (*(context->slavecount) * EC_CONFIG_SLAVESIZE)) /
+            EC_CONFIG_ENTRYSIZE;
+   ec_eni_put32(buf, EC_CONFIG_MAGIC);
+   ec_eni_put16(buf + 4, EC_CONFIG_VERSION);
+   ec_eni_put16(buf + 6, (uint16)*(context->slavecount));
+   ec_eni_put16(buf + 8, (uint16)nentry);
+   ec_eni_put16(buf + 10, EC_CONFIG_SLAVESIZE);
+   ec_eni_put16(buf + 12, EC_CONFIG_ENTRYSIZE);
+   p = buf + EC_CONFIG_HEADSIZE;
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      sl = &context->slavelist[slave];
+      ec_eni_put16(p, sl->configadr);
+      ec_eni_put16(p + 2, sl->aliasadr);
+      ec_eni_put32(p + 4, sl->eep_man);
+      ec_eni_put32(p + 8, sl->eep_id);
+      ec_eni_put32(p + 12, sl->eep_rev);
+      ec_eni_put32(p + 16, sl->eep_ser);
+      ec_eni_put16(p + 20, sl->mbx_l);
+      ec_eni_put16(p + 22, sl->mbx_wo);
+      ec_eni_put16(p + 24, sl->mbx_rl);
+      ec_eni_put16(p + 26, sl->mbx_ro);
+      ec_eni_put16(p + 28, sl->mbx_proto);
+      p[30] = sl->CoEdetails;
+      p[31] = sl->group;
+      p[32] = sl->hasdc;
+      p[33] = sl->topology;
+      ec_eni_put16(p + 34, sl->parent);
+      p[36] = sl->parentport;
+      p[37] = sl->entryport;
+      ec_eni_put32(p + 38, (uint32)sl->pdelay);
+      ec_eni_put32(p + 42, (uint32)sl->DCcycle);
+      ec_eni_put32(p + 46, (uint32)sl->DCshift);
+      ec_eni_put16(p + 50, sl->Obits);
+      ec_eni_put16(p + 52, sl->Ibits);
+      p[54] = sl->Ostartbit;
+      p[55] = sl->Istartbit;
+      ec_eni_put16(p + 56, (uint16)ecx_config_npdoentry(context, (uint16)slave));
+      p[58] = sl->DCactive;
+      p[59] = sl->activeports;
+      for (i = 0; i < EC_MAXSM; i++)
+      {
+         ec_eni_put16(p + 60 + (i * 9), etohs(sl->SM[i].StartAddr));
+         ec_eni_put16(p + 62 + (i * 9), etohs(sl->SM[i].SMlength));
+         ec_eni_put32(p + 64 + (i * 9), etohl(sl->SM[i].SMflags));
+         p[68 + (i * 9)] = sl->SMtype[i];
+      }
+      for (i = 0; i < EC_MAXFMMU; i++)
+      {
+         ec_eni_put32(p + 132 + (i * 16), etohl(sl->FMMU[i].LogStart));
+         ec_eni_put16(p + 136 + (i * 16), etohs(sl->FMMU[i].LogLength));
+         p[138 + (i * 16)] = sl->FMMU[i].LogStartbit;
+         p[139 + (i * 16)] = sl->FMMU[i].LogEndbit;
+         ec_eni_put16(p + 140 + (i * 16), etohs(sl->FMMU[i].PhysStart));
+         p[142 + (i * 16)] = sl->FMMU[i].PhysStartBit;
+         p[143 + (i * 16)] = sl->FMMU[i].FMMUtype;
+         p[144 + (i * 16)] = sl->FMMU[i].FMMUactive;
+      }
+      memcpy(p + 196, sl->name, EC_MAXNAME);
+      p += EC_CONFIG_SLAVESIZE;
+   }
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      for (i = 0; i < context->slavelist[slave].npdoentry; i++)
+      {
+         entry = ecx_pdoentry_get(context, (uint16)slave, (uint16)i);
+         if (entry)
+         {
+            ec_eni_put16(p, (uint16)slave);
+            ec_eni_put16(p + 2, entry->index);
+            p[4] = entry->subindex;
+            p[5] = entry->bitlen;
+            p[6] = entry->output;
+            ec_eni_put16(p + 8, entry->bitoffset);
+            p += EC_CONFIG_ENTRYSIZE;
+         }
+      }
+   }
+   return total;
+}
+
+/** Load a compact configuration into an eni structure, to configure the
+ * bus with ecx_config_eni. A compact configuration has no init commands.
+ *
+ * @param[out] eni     = compiled ENI
+ * @param[in]  buf     = compact configuration from ecx_config_export
+ * @param[in]  size    = size of compact configuration
+ * @return number of slaves, -1 if not a valid compact configuration, -2 if it
+ * exceeds the eni structure
+ */
+int ec_config_load(ec_enit *eni, const uint8 *buf, int size)
+{
+   const uint8 *p;
+   ec_enislavet *es;
+   ec_pdoentryt *entry;
+   int i, slave, prev, nslaves, nentry, slavesize, entrysize;
+
+   memset(eni, 0x00, sizeof(ec_enit));
+   if ((size < EC_CONFIG_HEADSIZE) || (ec_eni_get32(buf) != EC_CONFIG_MAGIC) ||
+       (ec_eni_get16(buf + 4) != EC_CONFIG_VERSION))
+   {
+      return -1;
+   }
+   nslaves = ec_eni_get16(buf + 6);
+   nentry = ec_eni_get16(buf + 8);
+   slavesize = ec_eni_get16(buf + 10);
+   entrysize = ec_eni_get16(buf + 12);
+   if ((slavesize < EC_CONFIG_SLAVESIZE) || (entrysize < EC_CONFIG_ENTRYSIZE) ||
+       ((EC_CONFIG_HEADSIZE + (nslaves * slavesize) + (nentry * entrysize)) > size))
+   {
+      return -1;
+   }
+   if ((nslaves >= EC_MAXSLAVE) || (nentry > EC_MAXPDOENTRY))
+   {
+      return -2;
+   }
+   eni->slavecount = nslaves;
+   p = buf + EC_CONFIG_HEADSIZE;
+   for (slave = 1; slave <= nslaves; slave++)
+   {
+      es = &eni->slave[slave - 1];
+      es->physaddr = ec_eni_get16(p);
+      es->eep_man = ec_eni_get32(p + 4);
+      es->eep_id = ec_eni_get32(p + 8);
+      es->eep_rev = ec_eni_get32(p + 12);
+      es->eep_ser = ec_eni_get32(p + 16);
+      es->mbx_l = ec_eni_get16(p + 20);
+      es->mbx_wo = ec_eni_get16(p + 22);
+      es->mbx_rl = ec_eni_get16(p + 24);
+      es->mbx_ro = ec_eni_get16(p + 26);
+      es->mbx_proto = ec_eni_get16(p + 28);
+      es->CoEdetails = p[30];
+      es->group = p[31];
+      es->hasdc = p[32];
+      es->DCcycle = (int32)ec_eni_get32(p + 42);
+      es->DCshift = (int32)ec_eni_get32(p + 46);
+      es->Obits = ec_eni_get16(p + 50);
+      es->Ibits = ec_eni_get16(p + 52);
+      for (i = 0; i < EC_MAXSM; i++)
+      {
+         es->SM[i].StartAddr = htoes(ec_eni_get16(p + 60 + (i * 9)));
+         es->SM[i].SMlength = htoes(ec_eni_get16(p + 62 + (i * 9)));
+         es->SM[i].SMflags = htoel(ec_eni_get32(p + 64 + (i * 9)));
+         es->SMtype[i] = p[68 + (i * 9)];
+      }
+      memcpy(es->name, p + 196, EC_MAXNAME);
+      es->name[EC_MAXNAME] = '\0';
+      p += slavesize;
+   }
+   prev = 0;
+   for (i = 0; i < nentry; i++)
+   {
+      slave = ec_eni_get16(p);
+      if ((slave < 1) || (slave > nslaves))
+      {
+         return -1;
+      }
+      es = &eni->slave[slave - 1];
+      /* entries of a slave must be consecutive */
+      if (es->npdoentry && (slave != prev))
+      {
+         return -1;
+      }
+      prev = slave;
+      if (es->npdoentry == 0)
+      {
+         es->pdoentry = (uint16)i;
+      }
+      es->npdoentry++;
+      entry = &eni->pdoentry[i];
+      entry->slave = (uint16)slave;
+      entry->index = ec_eni_get16(p + 2);
+      entry->subindex = p[4];
+      entry->bitlen = p[5];
+      entry->output = p[6];
+      entry->bitoffset = ec_eni_get16(p + 8);
+      entry->next = EC_PDOENTRY_NONE;
+      p += entrysize;
+   }
+   eni->pdoentrycount = nentry;
+   return nslaves;
+}
+
+#ifdef EC_VER1
+/** Enumerate and init all slaves from a compiled ENI.
+ *
+ * @param[in]  eni     = compiled ENI
+ * @return number of slaves found, -1 if the number of slaves does not match,
+ * -2 if the identity of a slave does not match
+ * @see ecx_config_eni
+ */
+int ec_config_eni(ec_enit *eni)
+{
+   return ecx_config_eni(&ecx_context, eni);
+}
+
+int ec_eni_export(char *xml, int size)
+{
+   return ecx_eni_export(&ecx_context, xml, size);
+}
+
+int ec_config_export_size(void)
+{
+   return ecx_config_export_size(&ecx_context);
+}
+
+int ec_config_export(uint8 *buf, int size)
+{
+   return ecx_config_export(&ecx_context, buf, size);
+}
+#endif
@@ -0,0 +1,222 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Headerfile for ethercateni.c
+ */
+
+#ifndef _ethercateni_
+#define _ethercateni_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** max. number of ESC init commands of master and slaves */
+#define EC_ENIMAXINITCMD     2048
+/** max. number of CoE init commands of all slaves */
+#define EC_ENIMAXCOECMD      1024
+/** max. size of init command data of all slaves */
+#define EC_ENIMAXDATA        65536
+/** max. number of PDOs of one slave, assigned or not */
+#define EC_ENIMAXSLAVEPDO    128
+/** max. number of PDOs assigned to one SM */
+#define EC_ENIMAXSMPDO       32
+/** max. nesting depth of ENI elements */
+#define EC_ENIMAXDEPTH       16
+/** no expected working counter in init command */
+#define EC_ENI_NOCNT         0xffff
+/** no data reference in init command */
+#define EC_ENI_NODATA        0xffffffff
+
+/** compact configuration magic "ECFG" */
+#define EC_CONFIG_MAGIC      0x47464345
+/** compact configuration format version */
+#define EC_CONFIG_VERSION    1
+/** size of compact configuration header */
+#define EC_CONFIG_HEADSIZE   16
+/** size of slave record in compact configuration */
+#define EC_CONFIG_SLAVESIZE  240
+/** size of PDO entry record in compact configuration */
+#define EC_CONFIG_ENTRYSIZE  10
+
+/** state transitions of init commands */
+#define EC_ENI_IP            0x0001
+#define EC_ENI_PS            0x0002
+#define EC_ENI_PI            0x0004
+#define EC_ENI_SP            0x0008
+#define EC_ENI_SO            0x0010
+#define EC_ENI_SI            0x0020
+#define EC_ENI_OS            0x0040
+#define EC_ENI_OP            0x0080
+#define EC_ENI_OI            0x0100
+#define EC_ENI_IB            0x0200
+#define EC_ENI_BI            0x0400
+#define EC_ENI_II            0x0800
+#define EC_ENI_PP            0x1000
+#define EC_ENI_SS            0x2000
+
+/** ESC register init command, executed as datagram */
+typedef struct ec_eniinitcmd
+{
+   /** transitions the command is executed in, EC_ENI_IP etc. */
+   uint16           transition;
+   /** datagram command, EC_CMD_APWR etc. */
+   uint8            cmd;
+   /** address position */
+   uint16           adp;
+   /** address offset */
+   uint16           ado;
+   /** data length */
+   uint16           length;
+   /** expected working counter, EC_ENI_NOCNT = not checked */
+   uint16           cnt;
+   /** data in eni data, EC_ENI_NODATA = zero data */
+   uint32           data;
+   /** validate data in eni data, EC_ENI_NODATA = no validation */
+   uint32           validate;
+   /** validate mask in eni data, EC_ENI_NODATA = all bits */
+   uint32           validatemask;
+   /** validate data length, equal to length after parsing */
+   uint16           validatelength;
+   /** validate mask length, equal to length after parsing */
+   uint16           masklength;
+   /** validate timeout in ms */
+   uint32           timeout;
+} ec_eniinitcmdt;
+
+/** CoE init command, executed as SDO download */
+typedef struct ec_enicoecmd
+{
+   /** transitions the command is executed in, EC_ENI_PS etc. */
+   uint16           transition;
+   /** TRUE if complete access */
+   boolean          ca;
+   /** client command specifier, 1 = download */
+   uint8            ccs;
+   /** object index */
+   uint16           index;
+   /** object subindex */
+   uint8            subindex;
+   /** data length */
+   uint16           length;
+   /** data in eni data */
+   uint32           data;
+   /** timeout in ms, 0 = default */
+   uint32           timeout;
+} ec_enicoecmdt;
+
+/** slave of ENI */
+typedef struct ec_enislave
+{
+   /** readable name */
+   char             name[EC_MAXNAME + 1];
+   /** Manufacturer, 0 = not checked */
+   uint32           eep_man;
+   /** ID, 0 = not checked */
+   uint32           eep_id;
+   /** revision */
+   uint32           eep_rev;
+   /** serial number */
+   uint32           eep_ser;
+   /** configured station address */
+   uint16           physaddr;
+   /** length of write mailbox in bytes, if no mailbox then 0 */
+   uint16           mbx_l;
+   /** mailbox write offset */
+   uint16           mbx_wo;
+   /** length of read mailbox in bytes */
+   uint16           mbx_rl;
+   /** mailbox read offset */
+   uint16           mbx_ro;
+   /** mailbox supported protocols */
+   uint16           mbx_proto;
+   /** CoE details */
+   uint8            CoEdetails;
+   /** SM structure, as in slave list */
+   ec_smt           SM[EC_MAXSM];
+   /** SM type 0=unused 1=MbxWr 2=MbxRd 3=Outputs 4=Inputs */
+   uint8            SMtype[EC_MAXSM];
+   /** output bits */
+   uint16           Obits;
+   /** input bits */
+   uint16           Ibits;
+   /** group, only set from a compact configuration */
+   uint8            group;
+   /** has DC settings */
+   boolean          hasdc;
+   /** DC sync0 cycle time in ns */
+   int32            DCcycle;
+   /** DC sync0 shift in ns */
+   int32            DCshift;
+   /** first PDO entry in eni pdoentry */
+   uint16           pdoentry;
+   /** number of PDO entries */
+   uint16           npdoentry;
+   /** first ESC init command in eni initcmd */
+   uint16           initcmd;
+   /** number of ESC init commands */
+   uint16           ninitcmd;
+   /** first CoE init command in eni coecmd */
+   uint16           coecmd;
+   /** number of CoE init commands */
+   uint16           ncoecmd;
+} ec_enislavet;
+
+/** EtherCAT Network Information compiled from an ENI file, filled by
+ *  ec_eni_parse and used by ecx_config_eni */
+typedef struct ec_eni
+{
+   /** number of slaves */
+   int              slavecount;
+   /** slaves in bus order, slave n is entry n - 1 */
+   ec_enislavet     slave[EC_MAXSLAVE];
+   /** first ESC init command of master */
+   uint16           masterinitcmd;
+   /** number of ESC init commands of master */
+   uint16           nmasterinitcmd;
+   /** number of ESC init commands */
+   int              initcmdcount;
+   /** ESC init commands */
+   ec_eniinitcmdt   initcmd[EC_ENIMAXINITCMD];
+   /** number of CoE init commands */
+   int              coecmdcount;
+   /** CoE init commands */
+   ec_enicoecmdt    coecmd[EC_ENIMAXCOECMD];
+   /** number of PDO entries */
+   int              pdoentrycount;
+   /** PDO entries of assigned PDOs, bit offsets relative to slave */
+   ec_pdoentryt     pdoentry[EC_MAXPDOENTRY];
+   /** used size of data */
+   uint32           datasize;
+   /** data of init commands */
+   uint8            data[EC_ENIMAXDATA];
+   /** line of first parse error, 0 = none */
+   int              errorline;
+} ec_enit;
+
+#ifdef EC_VER1
+int ec_config_eni(ec_enit *eni);
+int ec_eni_export(char *xml, int size);
+int ec_config_export_size(void);
+int ec_config_export(uint8 *buf, int size);
+#endif
+
+int ec_eni_parse(ec_enit *eni, const char *xml, int size);
+int ec_config_load(ec_enit *eni, const uint8 *buf, int size);
+int ecx_eni_initcmds(ecx_contextt *context, ec_enit *eni, uint16 transition);
+int ecx_eni_coecmds(ecx_contextt *context, ec_enit *eni, uint16 slave, uint16 transition);
+int ecx_config_eni(ecx_contextt *context, ec_enit *eni);
+int ecx_eni_export(ecx_contextt *context, char *xml, int size);
+int ecx_config_export_size(ecx_contextt *context);
+int ecx_config_export(ecx_contextt *context, uint8 *buf, int size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
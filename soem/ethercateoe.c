@@ -73,6 +73,7 @@ int ecx_EOEsetIp(ecx_contextt *context, uint16 slave, uint8 port, eoe_param_t *
    uint8 flags = 0;
    int wkc;
 
+   ecx_mbxlock(context, slave);
    ec_clearmbx(&MbxIn);
    /* Empty slave out mailbox if something is in. Timout set to 0 */
    wkc = ecx_mbxreceive(context,  slave, (ec_mbxbuft *)&MbxIn, 0);
@@ -166,6 +167,7 @@ int ecx_EOEsetIp(ecx_contextt *context, uint16 slave, uint8 port, eoe_param_t *
          }
       }
    }
+   ecx_mbxunlock(context, slave);
    return wkc;
 }
 
@@ -187,6 +189,7 @@ int ecx_EOEgetIp(ecx_contextt *context, uint16 slave, uint8 port, eoe_param_t *
    uint8 flags = 0;
    int wkc;
 
+   ecx_mbxlock(context, slave);
    /* Empty slave out mailbox if something is in. Timout set to 0 */
    wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
    ec_clearmbx(&MbxOut);
@@ -302,6 +305,7 @@ int ecx_EOEgetIp(ecx_contextt *context, uint16 slave, uint8 port, eoe_param_t *
          }
       }
    }
+   ecx_mbxunlock(context, slave);
    return wkc;
 }
 
@@ -329,8 +333,8 @@ int ecx_EOEsend(ecx_contextt *context, uint16 slave, uint8 port, int psize, void
    boolean  NotLast;
    int wkc, maxdata;
    const uint8 * buf = p;
-   static uint8_t txframeno = 0;
 
+   ecx_mbxlock(context, slave);
    ec_clearmbx(&MbxOut);
    EOEp = (ec_EOEt *)&MbxOut;
    EOEp->mbxheader.address = htoes(0x0000);
@@ -369,9 +373,9 @@ int ecx_EOEsend(ecx_contextt *context, uint16 slave, uint8 port, int psize, void
       else
       {
          frameinfo2 = frameinfo2 | (EOE_HDR_FRAME_OFFSET_SET(((psize + 31) >> 5)));
-         txframeno++;
+         context->slavelist[slave].eoe_txframeno++;
       }
-      frameinfo2 = frameinfo2 | EOE_HDR_FRAME_NO_SET(txframeno);
+      frameinfo2 = frameinfo2 | EOE_HDR_FRAME_NO_SET(context->slavelist[slave].eoe_txframeno);
 
       /* get new mailbox count value, used as session handle */
       cnt = ec_nextmbxcnt(context->slavelist[slave].mbx_cnt);
@@ -394,6 +398,7 @@ int ecx_EOEsend(ecx_contextt *context, uint16 slave, uint8 port, int psize, void
       }
    } while ((NotLast == TRUE) && (wkc > 0));
    
+   ecx_mbxunlock(context, slave);
    return wkc;
 }
 
@@ -422,6 +427,7 @@ int ecx_EOErecv(ecx_contextt *context, uint16 slave, uint8 port, int * psize, vo
    int wkc, buffersize;
    uint8 * buf = p;
    
+   ecx_mbxlock(context, slave);
    ec_clearmbx(&MbxIn);
    aEOEp = (ec_EOEt *)&MbxIn;
    NotLast = TRUE;
@@ -514,6 +520,7 @@ int ecx_EOErecv(ecx_contextt *context, uint16 slave, uint8 port, int * psize, vo
          wkc = -EC_ERR_TYPE_PACKET_ERROR;
       }
    }
+   ecx_mbxunlock(context, slave);
    return wkc;
 }
 
@@ -80,6 +80,7 @@ int ecx_FOEread(ecx_contextt *context, uint16 slave, char *filename, uint32 pass
    boolean worktodo;
 
    buffersize = *psize;
+   ecx_mbxlock(context, slave);
    ec_clearmbx(&MbxIn);
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
    wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
@@ -181,6 +182,7 @@ int ecx_FOEread(ecx_contextt *context, uint16 slave, char *filename, uint32 pass
          }
       } while (worktodo);
    }
+   ecx_mbxunlock(context, slave);
 
    return wkc;
 }
@@ -208,6 +210,7 @@ int ecx_FOEwrite(ecx_contextt *context, uint16 slave, char *filename, uint32 pas
    boolean worktodo, dofinalzero;
    int tsize;
 
+   ecx_mbxlock(context, slave);
    ec_clearmbx(&MbxIn);
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
    wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
@@ -348,6 +351,7 @@ int ecx_FOEwrite(ecx_contextt *context, uint16 slave, char *filename, uint32 pas
          }
       } while (worktodo);
    }
+   ecx_mbxunlock(context, slave);
 
    return wkc;
 }
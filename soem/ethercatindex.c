@@ -0,0 +1,343 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Slave index module.
+ *
+ * The slave list is indexed by alias, configured address, identity and name
+ * at each configuration, so slaves are found without scanning the list.
+ *
+ * Each slave also gets a stable handle. A handle identifies a slave by
+ * manufacturer, ID and serial number, or by alias if the serial number is not
+ * set, or else by being the n-th slave with that identity on the bus. When
+ * the bus is configured again or slaves are appended, the handle is bound to
+ * the new slave number of the same slave. A handle of a slave that left the
+ * bus resolves to 0 until the slave is back.
+ */
+
+#include <string.h>
+#include "osal.h"
+#include "oshw.h"
+#include "ethercattype.h"
+#include "ethercatbase.h"
+#include "ethercatmain.h"
+#include "ethercatindex.h"
+
+/** hash tables of slave index */
+enum
+{
+   EC_INDEX_ALIAS = 0,
+   EC_INDEX_CONFIGADR,
+   EC_INDEX_IDENTITY,
+   EC_INDEX_NAME
+};
+
+static uint16 ec_index_hash(uint32 key)
+{
+   key *= 0x9e3779b1;
+   return (uint16)((key >> 16) & (EC_SLAVEHASHSIZE - 1));
+}
+
+static uint16 ec_index_hashidentity(uint32 man, uint32 id, uint32 serial)
+{
+   return ec_index_hash(man ^ (id * 0x01000193) ^ (serial * 0x2c1b3c6d));
+}
+
+static uint16 ec_index_hashname(const char *name)
+{
+   uint32 key = 0x811c9dc5;
+
+   while (*name)
+   {
+      key = (key ^ (uint8)*name++) * 0x01000193;
+   }
+   return ec_index_hash(key);
+}
+
+static void ec_index_insert(ec_slaveindext *idx, int table, uint16 h, uint16 slave)
+{
+   idx->next[table][slave] = idx->hash[table][h];
+   idx->hash[table][h] = slave;
+}
+
+/** Bind a slave to its handle, a new handle is made for an unknown slave.
+ * @param[in]  context  = context struct
+ * @param[in]  slave    = slave number
+ * @param[in]  instance = n-th slave with same identity without serial and alias
+ * @return handle, 0 if no handle is available
+ */
+static uint16 ecx_slavehandle_bind(ecx_contextt *context, uint16 slave, uint16 instance)
+{
+   ec_slaveindext *idx = context->slaveindex;
+   ec_slavet *sl = &context->slavelist[slave];
+   ec_slavehandlet *hd;
+   uint16 alias, h, handle, found;
+
+   alias = 0;
+   if (!sl->eep_ser)
+   {
+      alias = sl->aliasadr;
+   }
+   if (sl->eep_ser || alias)
+   {
+      instance = 0;
+   }
+   h = ec_index_hash(ec_index_hashidentity(sl->eep_man, sl->eep_id, sl->eep_ser) ^ alias ^
+                     ((uint32)instance << 16));
+   /* lowest free handle, slaves with equal serial keep their order */
+   found = 0;
+   handle = idx->handlehash[h];
+   while (handle)
+   {
+      hd = &idx->handle[handle - 1];
+      if ((hd->slave == 0) && (hd->eep_man == sl->eep_man) && (hd->eep_id == sl->eep_id) &&
+          (hd->eep_ser == sl->eep_ser) && (hd->aliasadr == alias) && (hd->instance == instance) &&
+          ((found == 0) || (handle < found)))
+      {
+         found = handle;
+      }
+      handle = hd->next;
+   }
+   if (!found)
+   {
+      if (idx->handlecount >= EC_MAXHANDLE)
+      {
+         return 0;
+      }
+      found = ++idx->handlecount;
+      hd = &idx->handle[found - 1];
+      hd->eep_man = sl->eep_man;
+      hd->eep_id = sl->eep_id;
+      hd->eep_ser = sl->eep_ser;
+      hd->aliasadr = alias;
+      hd->instance = instance;
+      hd->next = idx->handlehash[h];
+      idx->handlehash[h] = found;
+   }
+   idx->handle[found - 1].slave = slave;
+   return found;
+}
+
+/** Rebuild the slave index after the slave list changed. Called by
+ * ecx_config_init and ecx_config_init_group, handles are kept.
+ *
+ * @param[in]  context = context struct
+ */
+void ecx_slaveindex_update(ecx_contextt *context)
+{
+   ec_slaveindext *idx = context->slaveindex;
+   ec_slavet *sl;
+   uint16 slave, count, other, instance;
+   int i;
+
+   if (idx == NULL)
+   {
+      return;
+   }
+   count = (uint16)*(context->slavecount);
+   if (count >= EC_MAXSLAVE)
+   {
+      count = EC_MAXSLAVE - 1;
+   }
+   /* slave 0 is the master, 0 ends a chain */
+   memset(idx->hash, 0x00, sizeof(idx->hash));
+   memset(idx->slavehandle, 0x00, sizeof(idx->slavehandle));
+   for (i = 0; i < idx->handlecount; i++)
+   {
+      idx->handle[i].slave = 0;
+   }
+   /* insert backwards so chains start at the lowest slave number */
+   for (slave = count; slave > 0; slave--)
+   {
+      sl = &context->slavelist[slave];
+      if (sl->aliasadr)
+      {
+         ec_index_insert(idx, EC_INDEX_ALIAS, ec_index_hash(sl->aliasadr), slave);
+      }
+      ec_index_insert(idx, EC_INDEX_CONFIGADR, ec_index_hash(sl->configadr), slave);
+      ec_index_insert(idx, EC_INDEX_IDENTITY,
+                      ec_index_hashidentity(sl->eep_man, sl->eep_id, sl->eep_ser), slave);
+      ec_index_insert(idx, EC_INDEX_NAME, ec_index_hashname(sl->name), slave);
+   }
+   for (slave = 1; slave <= count; slave++)
+   {
+      sl = &context->slavelist[slave];
+      instance = 0;
+      if (!sl->eep_ser && !sl->aliasadr)
+      {
+         other = idx->hash[EC_INDEX_IDENTITY][ec_index_hashidentity(sl->eep_man, sl->eep_id, 0)];
+         while (other && (other < slave))
+         {
+            if ((context->slavelist[other].eep_man == sl->eep_man) &&
+                (context->slavelist[other].eep_id == sl->eep_id) &&
+                !context->slavelist[other].eep_ser && !context->slavelist[other].aliasadr)
+            {
+               instance++;
+            }
+            other = idx->next[EC_INDEX_IDENTITY][other];
+         }
+      }
+      idx->slavehandle[slave] = ecx_slavehandle_bind(context, slave, instance);
+   }
+}
+
+/** Find slave by alias address.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  aliasadr = alias address, not 0
+ * @return slave number, 0 if not found
+ */
+uint16 ecx_slave_byalias(ecx_contextt *context, uint16 aliasadr)
+{
+   uint16 slave;
+
+   if ((context->slaveindex == NULL) || (aliasadr == 0))
+   {
+      return 0;
+   }
+   slave = context->slaveindex->hash[EC_INDEX_ALIAS][ec_index_hash(aliasadr)];
+   while (slave && (context->slavelist[slave].aliasadr != aliasadr))
+   {
+      slave = context->slaveindex->next[EC_INDEX_ALIAS][slave];
+   }
+   return slave;
+}
+
+/** Find slave by configured station address.
+ *
+ * @param[in]  context   = context struct
+ * @param[in]  configadr = configured station address
+ * @return slave number, 0 if not found
+ */
+uint16 ecx_slave_byconfigadr(ecx_contextt *context, uint16 configadr)
+{
+   uint16 slave;
+
+   if (context->slaveindex == NULL)
+   {
+      return 0;
+   }
+   slave = context->slaveindex->hash[EC_INDEX_CONFIGADR][ec_index_hash(configadr)];
+   while (slave && (context->slavelist[slave].configadr != configadr))
+   {
+      slave = context->slaveindex->next[EC_INDEX_CONFIGADR][slave];
+   }
+   return slave;
+}
+
+/** Find slave by identity. With more slaves of the same identity the first
+ * one on the bus is returned, use handles to tell them apart.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  man      = manufacturer
+ * @param[in]  id       = product ID
+ * @param[in]  serial   = serial number, 0 if not set in the slave
+ * @return slave number, 0 if not found
+ */
+uint16 ecx_slave_byidentity(ecx_contextt *context, uint32 man, uint32 id, uint32 serial)
+{
+   uint16 slave;
+
+   if (context->slaveindex == NULL)
+   {
+      return 0;
+   }
+   slave = context->slaveindex->hash[EC_INDEX_IDENTITY][ec_index_hashidentity(man, id, serial)];
+   while (slave && ((context->slavelist[slave].eep_man != man) ||
+                    (context->slavelist[slave].eep_id != id) ||
+                    (context->slavelist[slave].eep_ser != serial)))
+   {
+      slave = context->slaveindex->next[EC_INDEX_IDENTITY][slave];
+   }
+   return slave;
+}
+
+/** Find slave by name. With more slaves of the same name the first one on
+ * the bus is returned.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  name     = slave name
+ * @return slave number, 0 if not found
+ */
+uint16 ecx_slave_byname(ecx_contextt *context, const char *name)
+{
+   uint16 slave;
+
+   if (context->slaveindex == NULL)
+   {
+      return 0;
+   }
+   slave = context->slaveindex->hash[EC_INDEX_NAME][ec_index_hashname(name)];
+   while (slave && strcmp(context->slavelist[slave].name, name))
+   {
+      slave = context->slaveindex->next[EC_INDEX_NAME][slave];
+   }
+   return slave;
+}
+
+/** Get stable handle of a slave.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  slave    = slave number
+ * @return handle, 0 if slave has no handle
+ */
+uint16 ecx_slavehandle(ecx_contextt *context, uint16 slave)
+{
+   if ((context->slaveindex == NULL) || (slave == 0) || (slave >= EC_MAXSLAVE) ||
+       (slave > *(context->slavecount)))
+   {
+      return 0;
+   }
+   return context->slaveindex->slavehandle[slave];
+}
+
+/** Get current slave number of a handle.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  handle   = handle from ecx_slavehandle
+ * @return slave number, 0 if the slave is not on the bus
+ */
+uint16 ecx_slavehandle_resolve(ecx_contextt *context, uint16 handle)
+{
+   if ((context->slaveindex == NULL) || (handle == 0) ||
+       (handle > context->slaveindex->handlecount))
+   {
+      return 0;
+   }
+   return context->slaveindex->handle[handle - 1].slave;
+}
+
+#ifdef EC_VER1
+uint16 ec_slave_byalias(uint16 aliasadr)
+{
+   return ecx_slave_byalias(&ecx_context, aliasadr);
+}
+
+uint16 ec_slave_byconfigadr(uint16 configadr)
+{
+   return ecx_slave_byconfigadr(&ecx_context, configadr);
+}
+
+uint16 ec_slave_byidentity(uint32 man, uint32 id, uint32 serial)
+{
+   return ecx_slave_byidentity(&ecx_context, man, id, serial);
+}
+
+uint16 ec_slave_byname(const char *name)
+{
+   return ecx_slave_byname(&ecx_context, name);
+}
+
+uint16 ec_slavehandle(uint16 slave)
+{
+   return ecx_slavehandle(&ecx_context, slave);
+}
+
+uint16 ec_slavehandle_resolve(uint16 handle)
+{
+   return ecx_slavehandle_resolve(&ecx_context, handle);
+}
+#endif
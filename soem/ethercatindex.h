@@ -0,0 +1,40 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Headerfile for ethercatindex.c
+ */
+
+#ifndef _ethercatindex_
+#define _ethercatindex_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef EC_VER1
+uint16 ec_slave_byalias(uint16 aliasadr);
+uint16 ec_slave_byconfigadr(uint16 configadr);
+uint16 ec_slave_byidentity(uint32 man, uint32 id, uint32 serial);
+uint16 ec_slave_byname(const char *name);
+uint16 ec_slavehandle(uint16 slave);
+uint16 ec_slavehandle_resolve(uint16 handle);
+#endif
+
+void ecx_slaveindex_update(ecx_contextt *context);
+uint16 ecx_slave_byalias(ecx_contextt *context, uint16 aliasadr);
+uint16 ecx_slave_byconfigadr(ecx_contextt *context, uint16 configadr);
+uint16 ecx_slave_byidentity(ecx_contextt *context, uint32 man, uint32 id, uint32 serial);
+uint16 ecx_slave_byname(ecx_contextt *context, const char *name);
+uint16 ecx_slavehandle(ecx_contextt *context, uint16 slave);
+uint16 ecx_slavehandle_resolve(ecx_contextt *context, uint16 handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,469 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Library log module.
+ *
+ * Messages of the library are stored in a preallocated ring of entries that
+ * any thread can fill without locks, system calls or formatting. Only the
+ * format string reference and the binary arguments are captured, a drainer
+ * thread formats the entries and passes the lines to an output function of
+ * the application. If the ring is full the message is dropped and counted as
+ * lost, the logging thread never waits.
+ *
+ * Because formatting is deferred, %s arguments and the format string itself
+ * must stay valid until the entry is drained, string literals are fine. At
+ * most EC_LOGMAXARG arguments are captured, * width and precision and long
+ * double are not supported.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "osal.h"
+#include "oshw.h"
+#include "ethercat.h"
+
+/** sleep time of drainer thread when the ring is empty, in us */
+#define EC_LOG_IDLE          1000
+
+static const char *ec_log_levelname[] = { "ERROR", "WARNING", "INFO", "DEBUG" };
+
+/** Parse a conversion specification of a format string.
+ * @param[in]  p       = format string after '%'
+ * @param[out] lenmod  = length modifier, 0 = int, 1 = long, 2 = long long, 3 = size_t
+ * @param[out] conv    = conversion character
+ * @return format string after conversion specification
+ */
+static const char *ec_log_spec(const char *p, int *lenmod, char *conv)
+{
+   *lenmod = 0;
+   while (*p && strchr("-+ #0123456789.", *p))
+   {
+      p++;
+   }
+   for (;; p++)
+   {
+      if (*p == 'l')
+      {
+         (*lenmod)++;
+      }
+      else if (*p == 'j')
+      {
+         *lenmod = 2;
+      }
+      else if ((*p == 'z') || (*p == 't'))
+      {
+         *lenmod = 3;
+      }
+      else if (*p != 'h')
+      {
+         break;
+      }
+   }
+   *conv = *p;
+   if (*p)
+   {
+      p++;
+   }
+   return p;
+}
+
+/** Capture the arguments of a format string in binary form.
+ * @param[in]  fmt     = format string
+ * @param[out] arg     = captured arguments
+ * @param[in]  ap      = argument list
+ * @return number of captured arguments
+ */
+static uint8 ec_log_capture(const char *fmt, uint64 *arg, va_list ap)
+{
+   uint8 n = 0;
+   int lenmod;
+   char conv;
+   double d;
+
+   while (*fmt && (n < EC_LOGMAXARG))
+   {
+      if (*fmt++ != '%')
+      {
+         continue;
+      }
+      if (*fmt == '%')
+      {
+         fmt++;
+         continue;
+      }
+      fmt = ec_log_spec(fmt, &lenmod, &conv);
+      switch (conv)
+      {
+         case 'd':
+         case 'i':
+            if (lenmod == 1)
+               arg[n++] = (uint64)(int64)va_arg(ap, long);
+            else if (lenmod == 2)
+               arg[n++] = (uint64)(int64)va_arg(ap, long long);
+            else if (lenmod == 3)
+               arg[n++] = (uint64)va_arg(ap, size_t);
+            else
+               arg[n++] = (uint64)(int64)va_arg(ap, int);
+            break;
+         case 'u':
+         case 'o':
+         case 'x':
+         case 'X':
+         case 'c':
+            if (lenmod == 1)
+               arg[n++] = (uint64)va_arg(ap, unsigned long);
+            else if (lenmod == 2)
+               arg[n++] = (uint64)va_arg(ap, unsigned long long);
+            else if (lenmod == 3)
+               arg[n++] = (uint64)va_arg(ap, size_t);
+            else
+               arg[n++] = (uint64)va_arg(ap, unsigned int);
+            break;
+         case 'p':
+         case 's':
+         case 'n':
+            arg[n++] = (uint64)(uintptr_t)va_arg(ap, void *);
+            break;
+         case 'e':
+         case 'E':
+         case 'f':
+         case 'F':
+         case 'g':
+         case 'G':
+         case 'a':
+         case 'A':
+            d = va_arg(ap, double);
+            memcpy(&arg[n++], &d, sizeof(d));
+            break;
+         default:
+            /* unknown conversion, rest of arguments can not be found */
+            return n;
+      }
+   }
+   return n;
+}
+
+/** Format one captured argument.
+ * @param[out] line    = output buffer
+ * @param[in]  size    = size of output buffer
+ * @param[in]  spec    = conversion specification including '%'
+ * @param[in]  conv    = conversion character
+ * @param[in]  lenmod  = length modifier, see ec_log_spec
+ * @param[in]  a       = captured argument
+ * @return result of snprintf
+ */
+static int ec_log_arg(char *line, int size, const char *spec, char conv, int lenmod, uint64 a)
+{
+   boolean sign = (conv == 'd') || (conv == 'i');
+   double d;
+
+   switch (conv)
+   {
+      case 'd':
+      case 'i':
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+      case 'c':
+         if (lenmod == 1)
+            return sign ? snprintf(line, size, spec, (long)a) : snprintf(line, size, spec, (unsigned long)a);
+         if (lenmod == 2)
+            return sign ? snprintf(line, size, spec, (long long)a) :
+                          snprintf(line, size, spec, (unsigned long long)a);
+         if (lenmod == 3)
+            return snprintf(line, size, spec, (size_t)a);
+         return sign ? snprintf(line, size, spec, (int)a) : snprintf(line, size, spec, (unsigned int)a);
+      case 'p':
+         return snprintf(line, size, spec, (void *)(uintptr_t)a);
+      case 's':
+         return snprintf(line, size, spec, (const char *)(uintptr_t)a);
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+         memcpy(&d, &a, sizeof(d));
+         return snprintf(line, size, spec, d);
+      default:
+         return 0;
+   }
+}
+
+/** Format a log entry.
+ * @param[in]  entry   = log entry
+ * @param[out] line    = output buffer
+ * @param[in]  size    = size of output buffer
+ * @return length of formatted entry
+ */
+static int ec_log_format(ec_logentryt *entry, char *line, int size)
+{
+   const char *fmt, *start;
+   char spec[16];
+   char conv;
+   int n, r, k, lenmod;
+
+   n = snprintf(line, size, "%u.%06u %s ", entry->time.sec, entry->time.usec,
+                ec_log_levelname[entry->level & 3]);
+   if ((n < 0) || (n >= size))
+   {
+      return 0;
+   }
+   fmt = entry->fmt;
+   k = 0;
+   while (*fmt && (n < (size - 1)))
+   {
+      if (*fmt != '%')
+      {
+         line[n++] = *fmt++;
+         continue;
+      }
+      start = fmt++;
+      if (*fmt == '%')
+      {
+         line[n++] = *fmt++;
+         continue;
+      }
+      fmt = ec_log_spec(fmt, &lenmod, &conv);
+      if ((k >= entry->nargs) || ((fmt - start) >= (int)sizeof(spec)))
+      {
+         break;
+      }
+      memcpy(spec, start, fmt - start);
+      spec[fmt - start] = '\0';
+      r = ec_log_arg(&line[n], size - n, spec, conv, lenmod, entry->arg[k++]);
+      if (r > 0)
+      {
+         n += r;
+      }
+      if (n >= size)
+      {
+         n = size - 1;
+      }
+   }
+   line[n] = '\0';
+   return n;
+}
+
+/** Drainer thread of a log, runs until stopped and ring is empty.
+ * @param[in]  param  = log struct
+ */
+OSAL_THREAD_FUNC ec_log_thread(void *param)
+{
+   ec_logt *log = (ec_logt *)param;
+   char line[EC_LOGMAXLINE];
+
+   for (;;)
+   {
+      if (ec_log_drain(log, line, sizeof(line)))
+      {
+         if (log->output)
+         {
+            log->output(log->arg, line);
+         }
+         else
+         {
+            fputs(line, stdout);
+         }
+         continue;
+      }
+      if (log->stop)
+      {
+         break;
+      }
+      osal_usleep(EC_LOG_IDLE);
+   }
+   log->running = 0;
+}
+
+/** Initialise a log.
+ * @param[out] log     = log struct
+ * @param[in]  entry   = ring of entries
+ * @param[in]  size    = number of entries in ring, power of 2
+ * @return 1 if initialised, 0 otherwise
+ */
+int ec_log_init(ec_logt *log, ec_logentryt *entry, uint32 size)
+{
+   uint32 i;
+
+   if ((entry == NULL) || (size < 2) || (size & (size - 1)))
+   {
+      return 0;
+   }
+   memset(log, 0x00, sizeof(ec_logt));
+   log->entry = entry;
+   log->size = size;
+   for (i = 0; i < size; i++)
+   {
+      entry[i].seq = i;
+   }
+   log->level = EC_LOG_INFO;
+   log->subsys = EC_LOG_ALL;
+   return 1;
+}
+
+/** Set the severity level and subsystems that are logged.
+ * @param[in]  log     = log struct
+ * @param[in]  level   = highest severity level logged, f.e. EC_LOG_WARNING
+ * @param[in]  subsys  = subsystems logged, f.e. EC_LOG_CONFIG | EC_LOG_MAP
+ */
+void ec_log_filter(ec_logt *log, uint8 level, uint16 subsys)
+{
+   log->level = level;
+   log->subsys = subsys;
+}
+
+/** Log a message. Safe to call from any thread, including the cyclic task.
+ * @param[in]  log     = log struct
+ * @param[in]  level   = severity level
+ * @param[in]  subsys  = subsystem
+ * @param[in]  fmt     = printf format string, kept by reference
+ */
+void ec_log(ec_logt *log, uint8 level, uint16 subsys, const char *fmt, ...)
+{
+   ec_logentryt *entry;
+   uint32 pos, seq, lost;
+   va_list ap;
+
+   if ((level > log->level) || !(subsys & log->subsys))
+   {
+      return;
+   }
+   /* reserve entry, an entry is free when its sequence equals the position */
+   for (;;)
+   {
+      pos = log->head;
+      entry = &(log->entry[pos & (log->size - 1)]);
+      seq = entry->seq;
+      OSAL_MEMORY_BARRIER();
+      if (seq == pos)
+      {
+         if (OSAL_CAS32(&(log->head), pos, pos + 1))
+         {
+            break;
+         }
+      }
+      else if ((int32)(seq - pos) < 0)
+      {
+         /* ring is full */
+         do
+         {
+            lost = log->lost;
+         } while (!OSAL_CAS32(&(log->lost), lost, lost + 1));
+         return;
+      }
+   }
+   entry->level = level;
+   entry->subsys = subsys;
+   entry->time = osal_current_time();
+   entry->fmt = fmt;
+   va_start(ap, fmt);
+   entry->nargs = ec_log_capture(fmt, entry->arg, ap);
+   va_end(ap);
+   /* entry must be complete before it is published to the drainer */
+   OSAL_MEMORY_BARRIER();
+   entry->seq = pos + 1;
+}
+
+/** Format the next entry of a log. Used by the drainer thread, or called
+ * by the application when it drains the log itself. Only one thread may drain.
+ * @param[in]  log     = log struct
+ * @param[out] line    = output buffer
+ * @param[in]  size    = size of output buffer
+ * @return length of line, 0 if log is empty
+ */
+int ec_log_drain(ec_logt *log, char *line, int size)
+{
+   ec_logentryt *entry;
+   uint32 tail;
+   int n;
+
+   tail = log->tail;
+   entry = &(log->entry[tail & (log->size - 1)]);
+   if (entry->seq != (tail + 1))
+   {
+      return 0;
+   }
+   /* read entry only after its sequence */
+   OSAL_MEMORY_BARRIER();
+   n = ec_log_format(entry, line, size);
+   OSAL_MEMORY_BARRIER();
+   entry->seq = tail + log->size;
+   log->tail = tail + 1;
+   return n;
+}
+
+/** Start the drainer thread of a log and attach the log to the context.
+ * @param[in]  context = context struct
+ * @param[in]  log     = log struct
+ * @param[in]  output  = output function, void output(void *arg, const char *line),
+ *                       NULL = stdout
+ * @param[in]  arg     = argument of output function
+ * @return 1 if log is started, 0 otherwise
+ */
+int ecx_log_start(ecx_contextt *context, ec_logt *log, void *output, void *arg)
+{
+   if (log->running || (context->log != NULL))
+   {
+      return 0;
+   }
+   log->output = output;
+   log->arg = arg;
+   log->stop = 0;
+   log->running = 1;
+   if (!osal_thread_create(&(log->thread), 128000, &ec_log_thread, log))
+   {
+      log->running = 0;
+      log->thread = 0;
+      return 0;
+   }
+   context->log = log;
+   return 1;
+}
+
+/** Detach the log from the context and stop its drainer thread after the
+ * remaining entries are drained, then the thread is joined.
+ * @param[in]  context = context struct
+ * @return number of lost entries
+ */
+uint32 ecx_log_stop(ecx_contextt *context)
+{
+   ec_logt *log = context->log;
+
+   if (log == NULL)
+   {
+      return 0;
+   }
+   context->log = NULL;
+   log->stop = 1;
+   while (log->running)
+   {
+      osal_usleep(EC_LOG_IDLE);
+   }
+   if (log->thread)
+   {
+      osal_thread_join(&(log->thread));
+      log->thread = 0;
+   }
+   return log->lost;
+}
+
+#ifdef EC_VER1
+int ec_log_start(ec_logt *log, void *output, void *arg)
+{
+   return ecx_log_start(&ecx_context, log, output, arg);
+}
+
+uint32 ec_log_stop(void)
+{
+   return ecx_log_stop(&ecx_context);
+}
+#endif
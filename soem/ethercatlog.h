@@ -0,0 +1,53 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Headerfile for ethercatlog.c
+ */
+
+#ifndef _ethercatlog_
+#define _ethercatlog_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** max. length of a formatted log line */
+#define EC_LOGMAXLINE      256
+
+/** Log a message of the library. Without a log attached to the context the
+ *  message goes to EC_PRINT, as before. */
+#define EC_LOG(context, level, subsys, ...) \
+   do \
+   { \
+      if ((context)->log) \
+      { \
+         ec_log((context)->log, (level), (subsys), __VA_ARGS__); \
+      } \
+      else \
+      { \
+         EC_PRINT(__VA_ARGS__); \
+      } \
+   } while (0)
+
+#ifdef EC_VER1
+int ec_log_start(ec_logt *log, void *output, void *arg);
+uint32 ec_log_stop(void);
+#endif
+
+int ec_log_init(ec_logt *log, ec_logentryt *entry, uint32 size);
+void ec_log_filter(ec_logt *log, uint8 level, uint16 subsys);
+void ec_log(ec_logt *log, uint8 level, uint16 subsys, const char *fmt, ...);
+int ec_log_drain(ec_logt *log, char *line, int size);
+int ecx_log_start(ecx_contextt *context, ec_logt *log, void *output, void *arg);
+uint32 ecx_log_stop(ecx_contextt *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
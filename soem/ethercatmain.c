@@ -69,6 +69,26 @@ ec_slavet               ec_slave[EC_MAXSLAVE];
 int                     ec_slavecount;
 /** slave group structure */
 ec_groupt               ec_group[EC_MAXGROUP];
+/** optional slave reservations */
+ec_optslavet            ec_optslave[EC_MAXOPTSLAVE];
+/** number of optional slave reservations */
+int                     ec_optslavecount;
+/** slave to slave routes */
+ec_routet               ec_route[EC_MAXROUTE];
+/** number of slave to slave routes */
+int                     ec_routecount;
+/** register subscriptions */
+ec_subt                 ec_sub[EC_MAXSUB];
+/** number of register subscriptions */
+int                     ec_subcount;
+/** retained PDO entries */
+ec_pdoentryt            ec_pdoentry[EC_MAXPDOENTRY];
+/** number of retained PDO entries */
+int                     ec_pdoentrycount;
+/** hash table of retained PDO entries */
+static uint16           ec_pdohash[EC_PDOHASHSIZE];
+/** slave index */
+ec_slaveindext          ec_slaveindex;
 
 /** cache for EEPROM read functions */
 static uint8            ec_esibuf[EC_MAXEEPBUF];
@@ -78,17 +98,6 @@ static uint32           ec_esimap[EC_MAXEEPBITMAP];
 static ec_eringt        ec_elist;
 static ec_idxstackT     ec_idxstack;
 
-/** SyncManager Communication Type struct to store data of one slave */
-static ec_SMcommtypet   ec_SMcommtype[EC_MAX_MAPT];
-/** PDO assign struct to store data of one slave */
-static ec_PDOassignt    ec_PDOassign[EC_MAX_MAPT];
-/** PDO description struct to store data of one slave */
-static ec_PDOdesct      ec_PDOdesc[EC_MAX_MAPT];
-
-/** buffer for EEPROM SM data */
-static ec_eepromSMt     ec_SM;
-/** buffer for EEPROM FMMU data */
-static ec_eepromFMMUt   ec_FMMU;
 /** Global variable TRUE if error available in error stack */
 boolean                 EcatError = FALSE;
 
@@ -113,13 +122,35 @@ ecx_contextt  ecx_context = {
     0,                  // .DCtO          =
     0,                  // .DCl           =
     &ec_DCtime,         // .DCtime        =
-    &ec_SMcommtype[0],  // .SMcommtype    =
-    &ec_PDOassign[0],   // .PDOassign     =
-    &ec_PDOdesc[0],     // .PDOdesc       =
-    &ec_SM,             // .eepSM         =
-    &ec_FMMU,           // .eepFMMU       =
+    NULL,               // .SMcommtype    =
+    NULL,               // .PDOassign     =
+    NULL,               // .PDOdesc       =
+    NULL,               // .eepSM         =
+    NULL,               // .eepFMMU       =
     NULL,               // .FOEhook()
-    NULL                // .EOEhook()
+    NULL,               // .EOEhook()
+    NULL,               // .elistlock     =
+    NULL,               // .esilock       =
+    {NULL},             // .mbxlock       =
+    1,                  // .maxhookthreads =
+    &ec_optslave[0],    // .optslavelist  =
+    &ec_optslavecount,  // .optslavecount =
+    EC_MAXOPTSLAVE,     // .maxoptslave   =
+    &ec_route[0],       // .routelist     =
+    &ec_routecount,     // .routecount    =
+    EC_MAXROUTE,        // .maxroute      =
+    &ec_sub[0],         // .sublist       =
+    &ec_subcount,       // .subcount      =
+    EC_MAXSUB,          // .maxsub        =
+    FALSE,              // .subpending    =
+    0,                  // .subidx        =
+    NULL,               // .log           =
+    &ec_pdoentry[0],    // .pdoentrylist  =
+    &ec_pdoentrycount,  // .pdoentrycount =
+    EC_MAXPDOENTRY,     // .maxpdoentry   =
+    &ec_pdohash[0],     // .pdohash       =
+    NULL,               // .pdolock       =
+    &ec_slaveindex      // .slaveindex    =
 };
 #endif
 
@@ -152,6 +183,10 @@ void ec_free_adapters (ec_adaptert * adapter)
  */
 void ecx_pusherror(ecx_contextt *context, const ec_errort *Ec)
 {
+   if (context->elistlock)
+   {
+      osal_mtx_lock(context->elistlock);
+   }
    context->elist->Error[context->elist->head] = *Ec;
    context->elist->Error[context->elist->head].Signal = TRUE;
    context->elist->head++;
@@ -168,6 +203,10 @@ void ecx_pusherror(ecx_contextt *context, const ec_errort *Ec)
       context->elist->tail = 0;
    }
    *(context->ecaterror) = TRUE;
+   if (context->elistlock)
+   {
+      osal_mtx_unlock(context->elistlock);
+   }
 }
 
 /** Pops an error from the list.
@@ -178,8 +217,13 @@ void ecx_pusherror(ecx_contextt *context, const ec_errort *Ec)
  */
 boolean ecx_poperror(ecx_contextt *context, ec_errort *Ec)
 {
-   boolean notEmpty = (context->elist->head != context->elist->tail);
+   boolean notEmpty;
 
+   if (context->elistlock)
+   {
+      osal_mtx_lock(context->elistlock);
+   }
+   notEmpty = (context->elist->head != context->elist->tail);
    *Ec = context->elist->Error[context->elist->tail];
    context->elist->Error[context->elist->tail].Signal = FALSE;
    if (notEmpty)
@@ -194,6 +238,10 @@ boolean ecx_poperror(ecx_contextt *context, ec_errort *Ec)
    {
       *(context->ecaterror) = FALSE;
    }
+   if (context->elistlock)
+   {
+      osal_mtx_unlock(context->elistlock);
+   }
    return notEmpty;
 }
 
@@ -204,7 +252,18 @@ boolean ecx_poperror(ecx_contextt *context, ec_errort *Ec)
  */
 boolean ecx_iserror(ecx_contextt *context)
 {
-   return (context->elist->head != context->elist->tail);
+   boolean notEmpty;
+
+   if (context->elistlock)
+   {
+      osal_mtx_lock(context->elistlock);
+   }
+   notEmpty = (context->elist->head != context->elist->tail);
+   if (context->elistlock)
+   {
+      osal_mtx_unlock(context->elistlock);
+   }
+   return notEmpty;
 }
 
 /** Report packet error
@@ -279,6 +338,60 @@ static void ecx_mbxemergencyerror(ecx_contextt *context, uint16 Slave,uint16 Err
    ecx_pusherror(context, &Ec);
 }
 
+/** Create the locks that make the context safe for concurrent acyclic
+ * access to different slaves. Mailbox locks are created per slave by
+ * ecx_mbxlock_init. Locks that can not be created stay NULL and are then
+ * skipped.
+ * @param[in]  context = context struct
+ */
+static void ecx_initlocks(ecx_contextt *context)
+{
+   if (context->elistlock == NULL)
+   {
+      context->elistlock = osal_mtx_create();
+   }
+   if (context->esilock == NULL)
+   {
+      context->esilock = osal_mtx_create();
+   }
+   if (context->pdolock == NULL)
+   {
+      context->pdolock = osal_mtx_create();
+   }
+}
+
+/** Destroy the locks created by ecx_initlocks and ecx_mbxlock_init.
+ * @param[in]  context = context struct
+ */
+static void ecx_freelocks(ecx_contextt *context)
+{
+   int slave;
+
+   if (context->elistlock)
+   {
+      osal_mtx_destroy(context->elistlock);
+      context->elistlock = NULL;
+   }
+   if (context->esilock)
+   {
+      osal_mtx_destroy(context->esilock);
+      context->esilock = NULL;
+   }
+   if (context->pdolock)
+   {
+      osal_mtx_destroy(context->pdolock);
+      context->pdolock = NULL;
+   }
+   for (slave = 0; slave < EC_MAXSLAVE; slave++)
+   {
+      if (context->mbxlock[slave])
+      {
+         osal_mtx_destroy(context->mbxlock[slave]);
+         context->mbxlock[slave] = NULL;
+      }
+   }
+}
+
 /** Initialise lib in single NIC mode
  * @param[in]  context = context struct
  * @param[in] ifname   = Dev name, f.e. "eth0"
@@ -286,6 +399,7 @@ static void ecx_mbxemergencyerror(ecx_contextt *context, uint16 Slave,uint16 Err
  */
 int ecx_init(ecx_contextt *context, const char * ifname)
 {
+   ecx_initlocks(context);
    return ecx_setupnic(context->port, ifname, FALSE);
 }
 
@@ -301,6 +415,7 @@ int ecx_init_redundant(ecx_contextt *context, ecx_redportt *redport, const char
    int rval, zbuf;
    ec_etherheadert *ehp;
 
+   ecx_initlocks(context);
    context->port->redport = redport;
    ecx_setupnic(context->port, ifname, FALSE);
    rval = ecx_setupnic(context->port, if2name, TRUE);
@@ -320,8 +435,31 @@ int ecx_init_redundant(ecx_contextt *context, ecx_redportt *redport, const char
 void ecx_close(ecx_contextt *context)
 {
    ecx_closenic(context->port);
+   ecx_freelocks(context);
 };
 
+/** Lock the EEPROM cache, the cache holds data of one slave at a time.
+ * @param[in] context = context struct
+ */
+static void ecx_esilock(ecx_contextt *context)
+{
+   if (context->esilock)
+   {
+      osal_mtx_lock(context->esilock);
+   }
+}
+
+/** Unlock the EEPROM cache.
+ * @param[in] context = context struct
+ */
+static void ecx_esiunlock(ecx_contextt *context)
+{
+   if (context->esilock)
+   {
+      osal_mtx_unlock(context->esilock);
+   }
+}
+
 /** Read one byte from slave EEPROM via cache.
  *  If the cache location is empty then a read request is made to the slave.
  *  Depending on the slave capabilities the request is 4 or 8 bytes.
@@ -339,6 +477,7 @@ uint8 ecx_siigetbyte(ecx_contextt *context, uint16 slave, uint16 address)
    int lp,cnt;
    uint8 retval;
 
+   ecx_esilock(context);
    retval = 0xff;
    if (slave != context->esislave) /* not the same slave? */
    {
@@ -391,6 +530,7 @@ uint8 ecx_siigetbyte(ecx_contextt *context, uint16 slave, uint16 address)
          retval = context->esibuf[address];
       }
    }
+   ecx_esiunlock(context);
 
    return retval;
 }
@@ -407,6 +547,7 @@ int16 ecx_siifind(ecx_contextt *context, uint16 slave, uint16 cat)
    uint16 p;
    uint8 eectl = context->slavelist[slave].eep_pdi;
 
+   ecx_esilock(context);
    a = ECT_SII_START << 1;
    /* read first SII section category */
    p = ecx_siigetbyte(context, slave, a++);
@@ -431,6 +572,7 @@ int16 ecx_siifind(ecx_contextt *context, uint16 slave, uint16 cat)
    {
       ecx_eeprom2pdi(context, slave); /* if eeprom control was previously pdi then restore */
    }
+   ecx_esiunlock(context);
 
    return a;
 }
@@ -447,6 +589,7 @@ void ecx_siistring(ecx_contextt *context, char *str, uint16 slave, uint16 Sn)
    char *ptr;
    uint8 eectl = context->slavelist[slave].eep_pdi;
 
+   ecx_esilock(context);
    ptr = str;
    a = ecx_siifind (context, slave, ECT_SII_STRING); /* find string section */
    if (a > 0)
@@ -491,6 +634,7 @@ void ecx_siistring(ecx_contextt *context, char *str, uint16 slave, uint16 Sn)
    {
       ecx_eeprom2pdi(context, slave); /* if eeprom control was previously pdi then restore */
    }
+   ecx_esiunlock(context);
 }
 
 /** Get FMMU data from SII FMMU section in slave EEPROM.
@@ -504,6 +648,7 @@ uint16 ecx_siiFMMU(ecx_contextt *context, uint16 slave, ec_eepromFMMUt* FMMU)
    uint16  a;
    uint8 eectl = context->slavelist[slave].eep_pdi;
 
+   ecx_esilock(context);
    FMMU->nFMMU = 0;
    FMMU->FMMU0 = 0;
    FMMU->FMMU1 = 0;
@@ -529,6 +674,7 @@ uint16 ecx_siiFMMU(ecx_contextt *context, uint16 slave, ec_eepromFMMUt* FMMU)
    {
       ecx_eeprom2pdi(context, slave); /* if eeprom control was previously pdi then restore */
    }
+   ecx_esiunlock(context);
 
    return FMMU->nFMMU;
 }
@@ -544,6 +690,7 @@ uint16 ecx_siiSM(ecx_contextt *context, uint16 slave, ec_eepromSMt* SM)
    uint16 a,w;
    uint8 eectl = context->slavelist[slave].eep_pdi;
 
+   ecx_esilock(context);
    SM->nSM = 0;
    SM->Startpos = ecx_siifind(context, slave, ECT_SII_SM);
    if (SM->Startpos > 0)
@@ -565,6 +712,7 @@ uint16 ecx_siiSM(ecx_contextt *context, uint16 slave, ec_eepromSMt* SM)
    {
       ecx_eeprom2pdi(context, slave); /* if eeprom control was previously pdi then restore */
    }
+   ecx_esiunlock(context);
 
    return SM->nSM;
 }
@@ -582,6 +730,7 @@ uint16 ecx_siiSMnext(ecx_contextt *context, uint16 slave, ec_eepromSMt* SM, uint
    uint16 retVal = 0;
    uint8 eectl = context->slavelist[slave].eep_pdi;
 
+   ecx_esilock(context);
    if (n < SM->nSM)
    {
       a = SM->Startpos + 2 + (n * 8);
@@ -599,6 +748,7 @@ uint16 ecx_siiSMnext(ecx_contextt *context, uint16 slave, ec_eepromSMt* SM, uint
    {
       ecx_eeprom2pdi(context, slave); /* if eeprom control was previously pdi then restore */
    }
+   ecx_esiunlock(context);
 
    return retVal;
 }
@@ -615,6 +765,7 @@ int ecx_siiPDO(ecx_contextt *context, uint16 slave, ec_eepromPDOt* PDO, uint8 t)
    uint16 a , w, c, e, er, Size;
    uint8 eectl = context->slavelist[slave].eep_pdi;
 
+   ecx_esilock(context);
    Size = 0;
    PDO->nPDO = 0;
    PDO->Length = 0;
@@ -673,6 +824,7 @@ int ecx_siiPDO(ecx_contextt *context, uint16 slave, ec_eepromPDOt* PDO, uint8 t)
    {
       ecx_eeprom2pdi(context, slave); /* if eeprom control was previously pdi then restore */
    }
+   ecx_esiunlock(context);
 
    return (Size);
 }
@@ -822,6 +974,111 @@ int ecx_readstate(ecx_contextt *context)
    return lowest;
 }
 
+/** Write the ECAT event mask of a slave. Events enabled in the mask are
+ * reported in the irpt field of every datagram passing the slave, so the
+ * process data receive notices them without extra frames.
+ * @param[in]  context = context struct
+ * @param[in]  slave   = slave number, 0 = all slaves
+ * @param[in]  mask    = event mask, EC_EVENT_ bits
+ * @return Workcounter or EC_NOFRAME
+ */
+int ecx_eventmask(ecx_contextt *context, uint16 slave, uint16 mask)
+{
+   uint16 w;
+
+   w = htoes(mask);
+   if (slave == 0)
+   {
+      return ecx_BWR(context->port, 0, ECT_REG_IRQMASK, sizeof(w), &w, EC_TIMEOUTRET3);
+   }
+   return ecx_FPWR(context->port, context->slavelist[slave].configadr, ECT_REG_IRQMASK,
+      sizeof(w), &w, EC_TIMEOUTRET3);
+}
+
+/** Get and clear the ECAT events seen by the process data receive of a
+ * group since the last call.
+ * @param[in]  context = context struct
+ * @param[in]  group   = group number
+ * @return ECAT event request bits, OR of all slaves
+ */
+uint16 ecx_events(ecx_contextt *context, uint8 group)
+{
+   uint16 events;
+
+   events = context->grouplist[group].events;
+   context->grouplist[group].events &= ~events;
+   return events;
+}
+
+/** Read the ECAT event request register of the slaves of a group into
+ * ec_slave.eventreq, to find the slaves behind events seen in irpt.
+ * @param[in]  context = context struct
+ * @param[in]  group   = group number, 0 = all slaves
+ * @return number of slaves with events, or EC_NOFRAME
+ */
+int ecx_readevents(ecx_contextt *context, uint8 group)
+{
+   ecx_portt *port;
+   uint16 slavelst[MAX_FPRD_MULTI];
+   int datapos[MAX_FPRD_MULTI];
+   uint16 slave, le_w;
+   int i, n, idx, wkc, cnt;
+
+   port = context->port;
+   cnt = 0;
+   slave = 1;
+   le_w = 0;
+   while (slave <= *(context->slavecount))
+   {
+      n = 0;
+      while ((slave <= *(context->slavecount)) && (n < MAX_FPRD_MULTI))
+      {
+         if (!group || (context->slavelist[slave].group == group))
+         {
+            slavelst[n++] = slave;
+         }
+         slave++;
+      }
+      if (n == 0)
+      {
+         break;
+      }
+      idx = ecx_getindex(port);
+      for (i = 0; i < n; i++)
+      {
+         context->slavelist[slavelst[i]].eventreq = 0;
+         if (i == 0)
+         {
+            ecx_setupdatagram(port, &(port->txbuf[idx]), EC_CMD_FPRD, idx,
+               context->slavelist[slavelst[i]].configadr, ECT_REG_EVENTREQ, sizeof(le_w), &le_w);
+            datapos[i] = EC_HEADERSIZE;
+         }
+         else
+         {
+            datapos[i] = ecx_adddatagram(port, &(port->txbuf[idx]), EC_CMD_FPRD, idx, (i < (n - 1)),
+               context->slavelist[slavelst[i]].configadr, ECT_REG_EVENTREQ, sizeof(le_w), &le_w);
+         }
+      }
+      wkc = ecx_srconfirm(port, idx, EC_TIMEOUTRET);
+      if (wkc <= EC_NOFRAME)
+      {
+         ecx_setbufstat(port, idx, EC_BUF_EMPTY);
+         return EC_NOFRAME;
+      }
+      for (i = 0; i < n; i++)
+      {
+         memcpy(&le_w, &(port->rxbuf[idx][datapos[i]]), sizeof(le_w));
+         context->slavelist[slavelst[i]].eventreq = etohs(le_w);
+         if (context->slavelist[slavelst[i]].eventreq)
+         {
+            cnt++;
+         }
+      }
+      ecx_setbufstat(port, idx, EC_BUF_EMPTY);
+   }
+   return cnt;
+}
+
 /** Write slave state, if slave = 0 then write to all slaves.
  * The function does not check if the actual state is changed.
  * @param[in]  context        = context struct
@@ -833,6 +1090,7 @@ int ecx_writestate(ecx_contextt *context, uint16 slave)
    int ret;
    uint16 configadr, slstate;
 
+   OSAL_TRACE2(state_write, slave, context->slavelist[slave].state);
    if (slave == 0)
    {
       slstate = htoes(context->slavelist[slave].state);
@@ -894,6 +1152,7 @@ uint16 ecx_statecheck(ecx_contextt *context, uint16 slave, uint16 reqstate, int
    }
    while ((state != reqstate) && (osal_timer_is_expired(&timer) == FALSE));
    context->slavelist[slave].state = rval;
+   OSAL_TRACE3(state_check, slave, reqstate, rval);
 
    return state;
 }
@@ -922,6 +1181,47 @@ void ec_clearmbx(ec_mbxbuft *Mbx)
     memset(Mbx, 0x00, EC_MAXMBX);
 }
 
+/** Create the mailbox lock of a slave if it does not exist yet. Called by
+ * ecx_config_init for each slave found, before mailbox access to slaves
+ * can run concurrently. Without a lock mailbox access is not serialised.
+ * @param[in] context  = context struct
+ * @param[in] slave    = Slave number
+ */
+void ecx_mbxlock_init(ecx_contextt *context, uint16 slave)
+{
+   if ((slave < EC_MAXSLAVE) && (context->mbxlock[slave] == NULL))
+   {
+      context->mbxlock[slave] = osal_mtx_create();
+   }
+}
+
+/** Lock the mailbox of a slave.
+ * Serialises mailbox transactions and the mailbox counter of one slave,
+ * mailbox access to different slaves can run concurrently. The lock is
+ * recursive so a protocol function may call other locked functions.
+ * @param[in] context  = context struct
+ * @param[in] slave    = Slave number
+ */
+void ecx_mbxlock(ecx_contextt *context, uint16 slave)
+{
+   if ((slave < EC_MAXSLAVE) && context->mbxlock[slave])
+   {
+      osal_mtx_lock(context->mbxlock[slave]);
+   }
+}
+
+/** Unlock the mailbox of a slave.
+ * @param[in] context  = context struct
+ * @param[in] slave    = Slave number
+ */
+void ecx_mbxunlock(ecx_contextt *context, uint16 slave)
+{
+   if ((slave < EC_MAXSLAVE) && context->mbxlock[slave])
+   {
+      osal_mtx_unlock(context->mbxlock[slave]);
+   }
+}
+
 /** Check if IN mailbox of slave is empty.
  * @param[in] context  = context struct
  * @param[in] slave    = Slave number
@@ -970,6 +1270,8 @@ int ecx_mbxsend(ecx_contextt *context, uint16 slave,ec_mbxbuft *mbx, int timeout
    int wkc;
 
    wkc = 0;
+   OSAL_TRACE1(mbx_send_start, slave);
+   ecx_mbxlock(context, slave);
    configadr = context->slavelist[slave].configadr;
    mbxl = context->slavelist[slave].mbx_l;
    if ((mbxl > 0) && (mbxl <= EC_MAXMBX))
@@ -985,6 +1287,8 @@ int ecx_mbxsend(ecx_contextt *context, uint16 slave,ec_mbxbuft *mbx, int timeout
          wkc = 0;
       }
    }
+   ecx_mbxunlock(context, slave);
+   OSAL_TRACE2(mbx_send_end, slave, wkc);
 
    return wkc;
 }
@@ -1008,6 +1312,8 @@ int ecx_mbxreceive(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx, int tim
    ec_emcyt *EMp;
    ec_mbxerrort *MBXEp;
 
+   OSAL_TRACE1(mbx_receive_start, slave);
+   ecx_mbxlock(context, slave);
    configadr = context->slavelist[slave].configadr;
    mbxl = context->slavelist[slave].mbx_rl;
    if ((mbxl > 0) && (mbxl <= EC_MAXMBX))
@@ -1100,6 +1406,8 @@ int ecx_mbxreceive(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx, int tim
           wkc = 0;
       }
    }
+   ecx_mbxunlock(context, slave);
+   OSAL_TRACE2(mbx_receive_end, slave, wkc);
 
    return wkc;
 }
@@ -1280,6 +1588,7 @@ uint64 ecx_readeepromAP(ecx_contextt *context, uint16 aiadr, uint16 eeproma, int
 
    edat64 = 0;
    edat32 = 0;
+   OSAL_TRACE2(eeprom_read_start, aiadr, eeproma);
    if (ecx_eeprom_waitnotbusyAP(context, aiadr, &estat, timeout))
    {
       if (estat & EC_ESTAT_EMASK) /* error bits are set */
@@ -1338,6 +1647,7 @@ uint64 ecx_readeepromAP(ecx_contextt *context, uint16 aiadr, uint16 eeproma, int
       }
       while ((nackcnt > 0) && (nackcnt < 3));
    }
+   OSAL_TRACE3(eeprom_read_end, aiadr, eeproma, edat64);
 
    return edat64;
 }
@@ -1356,6 +1666,7 @@ int ecx_writeeepromAP(ecx_contextt *context, uint16 aiadr, uint16 eeproma, uint1
    ec_eepromt ed;
    int wkc, rval = 0, cnt = 0, nackcnt = 0;
 
+   OSAL_TRACE2(eeprom_write_start, aiadr, eeproma);
    if (ecx_eeprom_waitnotbusyAP(context, aiadr, &estat, timeout))
    {
       if (estat & EC_ESTAT_EMASK) /* error bits are set */
@@ -1403,10 +1714,250 @@ int ecx_writeeepromAP(ecx_contextt *context, uint16 aiadr, uint16 eeproma, uint1
       }
       while ((nackcnt > 0) && (nackcnt < 3));
    }
+   OSAL_TRACE3(eeprom_write_end, aiadr, eeproma, rval);
 
    return rval;
 }
 
+/* states of incremental EEPROM write job */
+#define EC_EEPW_NEXT     0
+#define EC_EEPW_WRITE    1
+#define EC_EEPW_CLEAR    2
+#define EC_EEPW_BUSY     3
+#define EC_EEPW_DONE     4
+
+/** Find the next word of an EEPROM write job that differs from the current
+ * EEPROM contents.
+ * @param[in] job        = EEPROM write job
+ * @param[in] timeout    = Timeout per word in us.
+ */
+static void ecx_eepw_next(ec_eepromwritet *job, int timeout)
+{
+   while ((job->pos < (job->start + job->length)) &&
+          (job->image[job->pos] == job->current[job->pos]) &&
+          (job->image[job->pos + 1] == job->current[job->pos + 1]))
+   {
+      job->pos += 2;
+   }
+   job->state = (job->pos < (job->start + job->length)) ? EC_EEPW_WRITE : EC_EEPW_DONE;
+   osal_timer_start(&(job->timer), timeout);
+}
+
+/** Update SII CRC with one byte, polynomial x^8 + x^2 + x + 1.
+ * @param[in] crc        = CRC so far
+ * @param[in] b          = next byte
+ * @return updated CRC
+ */
+static uint8 ecx_siicrcbyte(uint8 crc, uint8 b)
+{
+   int j;
+
+   crc ^= b;
+   for (j = 0; j < 8; j++)
+   {
+      crc = (crc & 0x80) ? (uint8)((crc << 1) ^ 0x07) : (uint8)(crc << 1);
+   }
+   return crc;
+}
+
+/** Write only the changed words of the EEPROM of several slaves in parallel.
+ * Each frame holds the next write or busy poll of every slave, so the
+ * programming time of the EEPROMs overlaps. Slaves are addressed by position,
+ * the slaves need not be configured. The EEPROM must be assigned to the master.
+ * If a job covers the first 8 words the configuration CRC in word 7 is
+ * recomputed from image and written if it changed.
+ * @param[in] context     = context struct
+ * @param[in,out] job     = list of jobs, one per slave
+ * @param[in] n           = number of jobs
+ * @param[in] timeout     = Timeout per word in us.
+ * @return number of jobs completed without error
+ */
+int ecx_writeeeprom_changed(ecx_contextt *context, ec_eepromwritet *job, int n, int timeout)
+{
+   ec_eepromt ed;
+   uint16 aiadr, estat, nop, le_wkc;
+   uint8 crc;
+   int i, j, first, last, active, size, dg, ndg, idx, wkc, done;
+
+   for (i = 0; i < n; i++)
+   {
+      job[i].written = 0;
+      job[i].nack = 0;
+      job[i].pos = job[i].start & ~1;
+      if ((job[i].start == 0) && (job[i].length >= 16))
+      {
+         crc = 0xff;
+         for (j = 0; j < 14; j++)
+         {
+            crc = ecx_siicrcbyte(crc, job[i].image[j]);
+         }
+         job[i].image[14] = crc;
+      }
+      ecx_eepw_next(&job[i], timeout);
+      /* clear error bits before first write */
+      if (job[i].state == EC_EEPW_WRITE)
+      {
+         job[i].state = EC_EEPW_CLEAR;
+      }
+   }
+   nop = htoes(EC_ECMD_NOP);
+   do
+   {
+      active = 0;
+      first = 0;
+      while (first < n)
+      {
+         /* select jobs for one frame, write needs data and command datagrams */
+         size = 0;
+         ndg = 0;
+         for (last = first; last < n; last++)
+         {
+            j = (job[last].state == EC_EEPW_CLEAR) ? 3 :
+                (job[last].state == EC_EEPW_WRITE) ? 2 :
+                (job[last].state == EC_EEPW_BUSY) ? 1 : 0;
+            if ((size + (j * (EC_HEADERSIZE + sizeof(ed) + EC_WKCSIZE))) > EC_MAXLRWDATA)
+            {
+               break;
+            }
+            size += j * (EC_HEADERSIZE + sizeof(ed) + EC_WKCSIZE);
+            ndg += j;
+         }
+         if (ndg == 0)
+         {
+            first = last;
+            continue;
+         }
+         idx = ecx_getindex(context->port);
+         dg = 0;
+         for (i = first; i < last; i++)
+         {
+            aiadr = (uint16)(1 - job[i].slave);
+            if (job[i].state == EC_EEPW_BUSY)
+            {
+               if (dg == 0)
+               {
+                  ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_APRD, idx, aiadr,
+                     ECT_REG_EEPSTAT, sizeof(estat), NULL);
+                  job[i].datapos = EC_HEADERSIZE;
+               }
+               else
+               {
+                  job[i].datapos = (uint16)ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_APRD,
+                     idx, (dg < (ndg - 1)), aiadr, ECT_REG_EEPSTAT, sizeof(estat), NULL);
+               }
+               dg++;
+            }
+            else if ((job[i].state == EC_EEPW_WRITE) || (job[i].state == EC_EEPW_CLEAR))
+            {
+               if (job[i].state == EC_EEPW_CLEAR)
+               {
+                  /* clear error bits */
+                  if (dg == 0)
+                  {
+                     ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_APWR, idx, aiadr,
+                        ECT_REG_EEPCTL, sizeof(nop), &nop);
+                  }
+                  else
+                  {
+                     ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_APWR, idx, TRUE,
+                        aiadr, ECT_REG_EEPCTL, sizeof(nop), &nop);
+                  }
+                  dg++;
+               }
+               if (dg == 0)
+               {
+                  ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_APWR, idx, aiadr,
+                     ECT_REG_EEPDAT, 2, &(job[i].image[job[i].pos]));
+               }
+               else
+               {
+                  ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_APWR, idx, TRUE,
+                     aiadr, ECT_REG_EEPDAT, 2, &(job[i].image[job[i].pos]));
+               }
+               dg++;
+               ed.comm = htoes(EC_ECMD_WRITE);
+               ed.addr = htoes(job[i].pos >> 1);
+               ed.d2 = 0x0000;
+               job[i].datapos = (uint16)ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_APWR,
+                  idx, (dg < (ndg - 1)), aiadr, ECT_REG_EEPCTL, sizeof(ed), &ed);
+               dg++;
+            }
+         }
+         wkc = ecx_srconfirm(context->port, idx, EC_TIMEOUTRET);
+         for (i = first; i < last; i++)
+         {
+            le_wkc = 0;
+            if (wkc > EC_NOFRAME)
+            {
+               memcpy(&le_wkc, &(context->port->rxbuf[idx][job[i].datapos +
+                  ((job[i].state == EC_EEPW_BUSY) ? sizeof(estat) : sizeof(ed))]), EC_WKCSIZE);
+            }
+            if ((job[i].state == EC_EEPW_WRITE) || (job[i].state == EC_EEPW_CLEAR))
+            {
+               /* command accepted, poll busy in next frame, else write again */
+               if (etohs(le_wkc))
+               {
+                  job[i].state = EC_EEPW_BUSY;
+               }
+            }
+            else if ((job[i].state == EC_EEPW_BUSY) && etohs(le_wkc))
+            {
+               memcpy(&estat, &(context->port->rxbuf[idx][job[i].datapos]), sizeof(estat));
+               estat = etohs(estat);
+               if ((estat & EC_ESTAT_BUSY) == 0)
+               {
+                  if (estat & EC_ESTAT_NACK)
+                  {
+                     job[i].state = (++job[i].nack < 3) ? EC_EEPW_CLEAR : EC_EEPW_DONE;
+                     osal_timer_start(&(job[i].timer), timeout);
+                     if (job[i].state == EC_EEPW_DONE)
+                     {
+                        job[i].written = -1;
+                     }
+                  }
+                  else
+                  {
+                     job[i].nack = 0;
+                     job[i].written++;
+                     job[i].pos += 2;
+                     ecx_eepw_next(&job[i], timeout);
+                  }
+               }
+            }
+            if ((job[i].state != EC_EEPW_DONE) && osal_timer_is_expired(&(job[i].timer)))
+            {
+               job[i].state = EC_EEPW_DONE;
+               job[i].written = -1;
+            }
+         }
+         ecx_setbufstat(context->port, idx, EC_BUF_EMPTY);
+         first = last;
+      }
+      for (i = 0; i < n; i++)
+      {
+         if (job[i].state != EC_EEPW_DONE)
+         {
+            active++;
+         }
+      }
+      if (active)
+      {
+         osal_usleep(EC_LOCALDELAY);
+      }
+   }
+   while (active);
+
+   done = 0;
+   for (i = 0; i < n; i++)
+   {
+      if (job[i].written >= 0)
+      {
+         done++;
+      }
+   }
+   return done;
+}
+
 uint16 ecx_eeprom_waitnotbusyFP(ecx_contextt *context, uint16 configadr,uint16 *estat, int timeout)
 {
    int wkc, cnt = 0, retval = 0;
@@ -1449,6 +2000,7 @@ uint64 ecx_readeepromFP(ecx_contextt *context, uint16 configadr, uint16 eeproma,
 
    edat64 = 0;
    edat32 = 0;
+   OSAL_TRACE2(eeprom_read_start, configadr, eeproma);
    if (ecx_eeprom_waitnotbusyFP(context, configadr, &estat, timeout))
    {
       if (estat & EC_ESTAT_EMASK) /* error bits are set */
@@ -1507,6 +2059,7 @@ uint64 ecx_readeepromFP(ecx_contextt *context, uint16 configadr, uint16 eeproma,
       }
       while ((nackcnt > 0) && (nackcnt < 3));
    }
+   OSAL_TRACE3(eeprom_read_end, configadr, eeproma, edat64);
 
    return edat64;
 }
@@ -1525,6 +2078,7 @@ int ecx_writeeepromFP(ecx_contextt *context, uint16 configadr, uint16 eeproma, u
    ec_eepromt ed;
    int wkc, rval = 0, cnt = 0, nackcnt = 0;
 
+   OSAL_TRACE2(eeprom_write_start, configadr, eeproma);
    if (ecx_eeprom_waitnotbusyFP(context, configadr, &estat, timeout))
    {
       if (estat & EC_ESTAT_EMASK) /* error bits are set */
@@ -1570,6 +2124,7 @@ int ecx_writeeepromFP(ecx_contextt *context, uint16 configadr, uint16 eeproma, u
       }
       while ((nackcnt > 0) && (nackcnt < 3));
    }
+   OSAL_TRACE3(eeprom_write_end, configadr, eeproma, rval);
 
    return rval;
 }
@@ -1640,13 +2195,14 @@ uint32 ecx_readeeprom2(ecx_contextt *context, uint16 slave, int timeout)
  * @param[in] data        = Pointer to process data segment.
  * @param[in] length      = Length of data segment in bytes.
  */
-static void ecx_pushindex(ecx_contextt *context, uint8 idx, void *data, uint16 length)
+static void ecx_pushindex(ecx_contextt *context, uint8 idx, void *data, uint16 length, uint16 segment)
 {
    if(context->idxstack->pushed < EC_MAXBUF)
    {
       context->idxstack->idx[context->idxstack->pushed] = idx;
       context->idxstack->data[context->idxstack->pushed] = data;
       context->idxstack->length[context->idxstack->pushed] = length;
+      context->idxstack->segment[context->idxstack->pushed] = segment;
       context->idxstack->pushed++;
    }
 }
@@ -1679,6 +2235,228 @@ static void ecx_clearindex(ecx_contextt *context)  {
 
 }
 
+/** Set the send order of the IO segments of a group. Segments with time
+ * critical inputs can be sent first, so their inputs are back first. Only
+ * used when the group uses LRW, must be set again after the group is mapped.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  order          = segment numbers in send order
+ * @param[in]  n              = number of segments in order, 0 = IOmap order
+ * @return 1 if order is valid and set, 0 otherwise
+ */
+int ecx_segmentorder(ecx_contextt *context, uint8 group, const uint16 *order, int n)
+{
+   uint64 used[(EC_MAXIOSEGMENTS + 63) / 64];
+   int i;
+
+   if (n == 0)
+   {
+      context->grouplist[group].nsegorder = 0;
+      return 1;
+   }
+   if (n != context->grouplist[group].nsegments)
+   {
+      return 0;
+   }
+   /* order must hold every segment exactly once */
+   memset(used, 0x00, sizeof(used));
+   for (i = 0; i < n; i++)
+   {
+      if ((order[i] >= n) || (used[order[i] / 64] & ((uint64)1 << (order[i] % 64))))
+      {
+         return 0;
+      }
+      used[order[i] / 64] |= (uint64)1 << (order[i] % 64);
+   }
+   for (i = 0; i < n; i++)
+   {
+      context->grouplist[group].segorder[i] = (uint8)order[i];
+   }
+   context->grouplist[group].nsegorder = (uint16)n;
+   return 1;
+}
+
+/** Define a hook called by ecx_receive_processdata_group as soon as the
+ * inputs of an IO segment are copied to the IOmap. Computation on these
+ * inputs can start while later segments are still on the wire.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  hook           = pointer to hook function, NULL = no hook
+ * @return 1
+ */
+int ecx_segmentdefinehook(ecx_contextt *context, uint8 group, void *hook)
+{
+   context->grouplist[group].segmenthook = hook;
+   return 1;
+}
+
+/** Find the IO segment that holds the inputs of a slave.
+ * @param[in]  context        = context struct
+ * @param[in]  slave          = slave number
+ * @return segment number, -1 if slave has no inputs
+ */
+int ecx_inputsegment(ecx_contextt *context, uint16 slave)
+{
+   ec_groupt *grp;
+   uint8 *base;
+   uint32 offset, end;
+   int segment;
+
+   if ((slave == 0) || (slave > *(context->slavecount)) || (context->slavelist[slave].Ibits == 0))
+   {
+      return -1;
+   }
+   grp = &(context->grouplist[context->slavelist[slave].group]);
+   /* overlapped inputs are moved by Obytes in the IOmap but not on the wire */
+   base = (grp->Obytes && !grp->overlap) ? grp->outputs : grp->inputs;
+   offset = (uint32)(context->slavelist[slave].inputs - base);
+   end = 0;
+   for (segment = 0; segment < grp->nsegments; segment++)
+   {
+      end += grp->IOsegment[segment];
+      if (offset < end)
+      {
+         return segment;
+      }
+   }
+   return -1;
+}
+
+/** Attach a timed output queue to a group. Output data is put in the queue
+ * ahead of time by a producer thread and copied to the IOmap by the send
+ * processdata functions at the cycle it is due.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  queue          = queue struct, NULL = detach queue
+ * @param[in]  entry          = entry array of queue
+ * @param[in]  size           = number of entries, must be a power of 2
+ * @param[in]  dctime         = TRUE if due is DC time, FALSE if due is group cycle number
+ * @return 1 if queue is attached, 0 otherwise
+ */
+int ecx_outqueue_init(ecx_contextt *context, uint8 group, ec_outqueuet *queue, ec_outqentryt *entry,
+   uint32 size, boolean dctime)
+{
+   if (queue == NULL)
+   {
+      context->grouplist[group].outqueue = NULL;
+      return 1;
+   }
+   if ((entry == NULL) || (size == 0) || (size & (size - 1)))
+   {
+      return 0;
+   }
+   queue->size = size;
+   queue->dctime = dctime;
+   queue->head = 0;
+   queue->tail = 0;
+   queue->entry = entry;
+   context->grouplist[group].outqueue = queue;
+   return 1;
+}
+
+/** Put output data in the timed output queue of a group. Only one thread may
+ * put data in a queue and entries must be put in order of due. Entries that
+ * are already due are applied at the next send processdata.
+ * With group cycle numbers the first send after ecx_config_map_group is
+ * cycle 0, with DC time the entry is applied at the first send after the
+ * last received DC time reached due.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  due            = cycle number or DC time the data is applied at
+ * @param[in]  slave          = slave number, 0 = offset is relative to group outputs
+ * @param[in]  offset         = offset in outputs of slave
+ * @param[in]  data           = output data
+ * @param[in]  length         = length of data
+ * @return 1 if entry is queued, 0 if queue is full or entry is invalid
+ */
+int ecx_outqueue_put(ecx_contextt *context, uint8 group, uint64 due, uint16 slave, uint16 offset,
+   const void *data, uint16 length)
+{
+   ec_outqueuet *queue = context->grouplist[group].outqueue;
+   ec_outqentryt *entry;
+   uint32 head, obytes;
+
+   if ((queue == NULL) || (length == 0) || (length > EC_MAXOUTQDATA))
+   {
+      return 0;
+   }
+   /* check range here so send processdata does not have to */
+   if (slave)
+   {
+      if ((slave > *(context->slavecount)) || (context->slavelist[slave].group != group))
+      {
+         return 0;
+      }
+      obytes = context->slavelist[slave].Obytes;
+      if ((obytes == 0) && context->slavelist[slave].Obits)
+      {
+         obytes = 1;
+      }
+   }
+   else
+   {
+      obytes = context->grouplist[group].Obytes;
+   }
+   if ((uint32)(offset + length) > obytes)
+   {
+      return 0;
+   }
+   head = queue->head;
+   if ((head - queue->tail) >= queue->size)
+   {
+      return 0;
+   }
+   entry = &(queue->entry[head & (queue->size - 1)]);
+   entry->due = due;
+   entry->slave = slave;
+   entry->offset = offset;
+   entry->length = length;
+   memcpy(entry->data, data, length);
+   /* entry must be complete before it is visible to send processdata */
+   OSAL_MEMORY_BARRIER();
+   queue->head = head + 1;
+   return 1;
+}
+
+/** Copy due entries of the timed output queue of a group to the IOmap and
+ * count the group cycle.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ */
+static void ecx_outqueue_apply(ecx_contextt *context, uint8 group)
+{
+   ec_groupt *grp = &(context->grouplist[group]);
+   ec_outqueuet *queue = grp->outqueue;
+   ec_outqentryt *entry;
+   uint32 head, tail;
+   uint64 now;
+   uint8 *outputs;
+
+   if (queue)
+   {
+      now = queue->dctime ? (uint64)*(context->DCtime) : grp->cycle;
+      head = queue->head;
+      /* read entries only after head */
+      OSAL_MEMORY_BARRIER();
+      tail = queue->tail;
+      while (tail != head)
+      {
+         entry = &(queue->entry[tail & (queue->size - 1)]);
+         if (entry->due > now)
+         {
+            break;
+         }
+         outputs = entry->slave ? context->slavelist[entry->slave].outputs : grp->outputs;
+         memcpy(outputs + entry->offset, entry->data, entry->length);
+         tail++;
+      }
+      /* entries must be read before they can be reused by producer */
+      OSAL_MEMORY_BARRIER();
+      queue->tail = tail;
+   }
+   grp->cycle++;
+}
+
 /** Transmit processdata to slaves.
  * Uses LRW, or LRD/LWR if LRW is not allowed (blockLRW).
  * Both the input and output processdata are transmitted.
@@ -1702,13 +2480,18 @@ static int ecx_main_send_processdata(ecx_contextt *context, uint8 group, boolean
    boolean first=FALSE;
    uint16 currentsegment = 0;
    uint32 iomapinputoffset;
+   uint32 offset;
+   int i, j;
 
+   OSAL_TRACE2(group_send_start, group, use_overlap_io);
    wkc = 0;
    if(context->grouplist[group].hasdc)
    {
       first = TRUE;
    }
 
+   ecx_outqueue_apply(context, group);
+
    /* For overlapping IO map use the biggest */
    if(use_overlap_io == TRUE)
    {
@@ -1767,7 +2550,7 @@ static int ecx_main_send_processdata(ecx_contextt *context, uint8 group, boolean
                /* send frame */
                ecx_outframe_red(context->port, idx);
                /* push index and data pointer on stack */
-               ecx_pushindex(context, idx, data, sublength);
+               ecx_pushindex(context, idx, data, sublength, currentsegment - 1);
                length -= sublength;
                LogAdr += sublength;
                data += sublength;
@@ -1805,7 +2588,7 @@ static int ecx_main_send_processdata(ecx_contextt *context, uint8 group, boolean
                /* send frame */
                ecx_outframe_red(context->port, idx);
                /* push index and data pointer on stack */
-               ecx_pushindex(context, idx, data, sublength);
+               ecx_pushindex(context, idx, data, sublength, currentsegment - 1);
                length -= sublength;
                LogAdr += sublength;
                data += sublength;
@@ -1825,38 +2608,74 @@ static int ecx_main_send_processdata(ecx_contextt *context, uint8 group, boolean
             /* Clear offset, don't compensate for overlapping IOmap if we only got inputs */
             iomapinputoffset = 0;
          }
-         /* segment transfer if needed */
-         do
+         /* segments in user defined order, see ecx_segmentorder */
+         if (context->grouplist[group].nsegorder &&
+             (context->grouplist[group].nsegorder == context->grouplist[group].nsegments))
          {
-            sublength = context->grouplist[group].IOsegment[currentsegment++];
-            /* get new index */
-            idx = ecx_getindex(context->port);
-            w1 = LO_WORD(LogAdr);
-            w2 = HI_WORD(LogAdr);
-            ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_LRW, idx, w1, w2, sublength, data);
-            if(first)
+            for (i = 0; i < context->grouplist[group].nsegments; i++)
             {
-               context->DCl = sublength;
-               /* FPRMW in second datagram */
-               context->DCtO = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW, idx, FALSE,
-                                        context->slavelist[context->grouplist[group].DCnext].configadr,
-                                        ECT_REG_DCSYSTIME, sizeof(int64), context->DCtime);
-               first = FALSE;
+               currentsegment = context->grouplist[group].segorder[i];
+               offset = 0;
+               for (j = 0; j < currentsegment; j++)
+               {
+                  offset += context->grouplist[group].IOsegment[j];
+               }
+               sublength = context->grouplist[group].IOsegment[currentsegment];
+               /* get new index */
+               idx = ecx_getindex(context->port);
+               w1 = LO_WORD(LogAdr + offset);
+               w2 = HI_WORD(LogAdr + offset);
+               ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_LRW, idx, w1, w2, sublength, data + offset);
+               if(first)
+               {
+                  context->DCl = sublength;
+                  /* FPRMW in second datagram */
+                  context->DCtO = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW, idx, FALSE,
+                                           context->slavelist[context->grouplist[group].DCnext].configadr,
+                                           ECT_REG_DCSYSTIME, sizeof(int64), context->DCtime);
+                  first = FALSE;
+               }
+               /* send frame */
+               ecx_outframe_red(context->port, idx);
+               ecx_pushindex(context, idx, (data + offset + iomapinputoffset), sublength, currentsegment);
             }
-            /* send frame */
-            ecx_outframe_red(context->port, idx);
-            /* push index and data pointer on stack.
-             * the iomapinputoffset compensate for where the inputs are stored 
-             * in the IOmap if we use an overlapping IOmap. If a regular IOmap
-             * is used it should always be 0.
-             */
-            ecx_pushindex(context, idx, (data + iomapinputoffset), sublength);      
-            length -= sublength;
-            LogAdr += sublength;
-            data += sublength;
-         } while (length && (currentsegment < context->grouplist[group].nsegments));
+         }
+         else
+         {
+            /* segment transfer if needed */
+            do
+            {
+               sublength = context->grouplist[group].IOsegment[currentsegment++];
+               /* get new index */
+               idx = ecx_getindex(context->port);
+               w1 = LO_WORD(LogAdr);
+               w2 = HI_WORD(LogAdr);
+               ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_LRW, idx, w1, w2, sublength, data);
+               if(first)
+               {
+                  context->DCl = sublength;
+                  /* FPRMW in second datagram */
+                  context->DCtO = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW, idx, FALSE,
+                                           context->slavelist[context->grouplist[group].DCnext].configadr,
+                                           ECT_REG_DCSYSTIME, sizeof(int64), context->DCtime);
+                  first = FALSE;
+               }
+               /* send frame */
+               ecx_outframe_red(context->port, idx);
+               /* push index and data pointer on stack.
+                * the iomapinputoffset compensate for where the inputs are stored 
+                * in the IOmap if we use an overlapping IOmap. If a regular IOmap
+                * is used it should always be 0.
+                */
+               ecx_pushindex(context, idx, (data + iomapinputoffset), sublength, currentsegment - 1);
+               length -= sublength;
+               LogAdr += sublength;
+               data += sublength;
+            } while (length && (currentsegment < context->grouplist[group].nsegments));
+         }
       }
    }
+   OSAL_TRACE2(group_send_end, group, wkc);
 
    return wkc;
 }
@@ -1913,10 +2732,12 @@ int ecx_receive_processdata_group(ecx_contextt *context, uint8 group, int timeou
    int64 le_DCtime;
    boolean first = FALSE;
 
+   OSAL_TRACE1(group_receive_start, group);
    if(context->grouplist[group].hasdc)
    {
       first = TRUE;
    }
+   context->grouplist[group].irpt = 0;
    /* get first index */
    pos = ecx_pullindex(context);
    /* read the same number of frames as send */
@@ -1927,6 +2748,9 @@ int ecx_receive_processdata_group(ecx_contextt *context, uint8 group, int timeou
       /* check if there is input data in frame */
       if (wkc2 > EC_NOFRAME)
       {
+         /* slaves OR their events into every datagram, collect them from all
+          * received frames so a lost frame does not hide an event */
+         context->grouplist[group].irpt |= etohs(((ec_comt *)context->port->rxbuf[idx])->irpt);
          if((context->port->rxbuf[idx][EC_CMDOFFSET]==EC_CMD_LRD) || (context->port->rxbuf[idx][EC_CMDOFFSET]==EC_CMD_LRW))
          {
             if(first)
@@ -1945,6 +2769,11 @@ int ecx_receive_processdata_group(ecx_contextt *context, uint8 group, int timeou
                wkc += wkc2;
             }
             valid_wkc = 1;
+            /* inputs of segment are complete, other segments can still be on the wire */
+            if(context->grouplist[group].segmenthook)
+            {
+               context->grouplist[group].segmenthook(group, context->idxstack->segment[pos]);
+            }
          }
          else if(context->port->rxbuf[idx][EC_CMDOFFSET]==EC_CMD_LWR)
          {
@@ -1972,6 +2801,12 @@ int ecx_receive_processdata_group(ecx_contextt *context, uint8 group, int timeou
    }
 
    ecx_clearindex(context);
+   context->grouplist[group].events |= context->grouplist[group].irpt;
+   if (context->grouplist[group].capture && valid_wkc)
+   {
+      ecx_capture_push(context, group);
+   }
+   OSAL_TRACE3(group_receive_end, group, wkc, valid_wkc);
 
    /* if no frames has arrived */
    if (valid_wkc == 0)
@@ -2137,6 +2972,21 @@ int ec_readstate(void)
    return ecx_readstate (&ecx_context);
 }
 
+int ec_eventmask(uint16 slave, uint16 mask)
+{
+   return ecx_eventmask(&ecx_context, slave, mask);
+}
+
+uint16 ec_events(uint8 group)
+{
+   return ecx_events(&ecx_context, group);
+}
+
+int ec_readevents(uint8 group)
+{
+   return ecx_readevents(&ecx_context, group);
+}
+
 /** Write slave state, if slave = 0 then write to all slaves.
  * The function does not check if the actual state is changed.
  * @param[in] slave = Slave number, 0 = master
@@ -2276,6 +3126,11 @@ int ec_writeeepromAP(uint16 aiadr, uint16 eeproma, uint16 data, int timeout)
    return ecx_writeeepromAP (&ecx_context, aiadr, eeproma, data, timeout);
 }
 
+int ec_writeeeprom_changed(ec_eepromwritet *job, int n, int timeout)
+{
+   return ecx_writeeeprom_changed(&ecx_context, job, n, timeout);
+}
+
 uint16 ec_eeprom_waitnotbusyFP(uint16 configadr,uint16 *estat, int timeout)
 {
    return ecx_eeprom_waitnotbusyFP (&ecx_context, configadr, estat, timeout);
@@ -2329,6 +3184,31 @@ uint32 ec_readeeprom2(uint16 slave, int timeout)
    return ecx_readeeprom2 (&ecx_context, slave, timeout);
 }
 
+int ec_segmentorder(uint8 group, const uint16 *order, int n)
+{
+   return ecx_segmentorder(&ecx_context, group, order, n);
+}
+
+int ec_segmentdefinehook(uint8 group, void *hook)
+{
+   return ecx_segmentdefinehook(&ecx_context, group, hook);
+}
+
+int ec_inputsegment(uint16 slave)
+{
+   return ecx_inputsegment(&ecx_context, slave);
+}
+
+int ec_outqueue_init(uint8 group, ec_outqueuet *queue, ec_outqentryt *entry, uint32 size, boolean dctime)
+{
+   return ecx_outqueue_init(&ecx_context, group, queue, entry, size, dctime);
+}
+
+int ec_outqueue_put(uint8 group, uint64 due, uint16 slave, uint16 offset, const void *data, uint16 length)
+{
+   return ecx_outqueue_put(&ecx_context, group, due, slave, offset, data, length);
+}
+
 /** Transmit processdata to slaves.
  * Uses LRW, or LRD/LWR if LRW is not allowed (blockLRW).
  * Both the input and output processdata are transmitted.
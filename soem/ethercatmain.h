@@ -27,6 +27,10 @@ extern "C"
 #define EC_MAXGROUP       2
 /** max. number of IO segments per group */
 #define EC_MAXIOSEGMENTS  64
+/** max. data length of one timed output queue entry */
+#define EC_MAXOUTQDATA    32
+/** max. number of captured byte ranges of a process data capture */
+#define EC_MAXCAPTURECHAN 16
 /** max. mailbox size */
 #define EC_MAXMBX         1486
 /** max. eeprom PDO entries */
@@ -39,6 +43,28 @@ extern "C"
 #define EC_MAXLEN_ADAPTERNAME    128
 /** define maximum number of concurrent threads in mapping */
 #define EC_MAX_MAPT           1
+/** define maximum number of concurrent threads for PO2SOconfig hooks */
+#define EC_MAX_HOOKT          8
+/** max. number of optional slave reservations */
+#define EC_MAXOPTSLAVE        16
+/** max. number of slave to slave process data routes */
+#define EC_MAXROUTE           16
+/** max. number of register subscriptions */
+#define EC_MAXSUB             64
+/** max. data length of one register subscription */
+#define EC_MAXSUBDATA         32
+/** max. number of retained PDO entries of all slaves */
+#define EC_MAXPDOENTRY        2048
+/** size of PDO entry hash table, power of 2 */
+#define EC_PDOHASHSIZE        4096
+/** max. number of PDO entries of one slave */
+#define EC_MAXSLAVEPDOENTRY   256
+/** end of PDO entry hash chain */
+#define EC_PDOENTRY_NONE      0xffff
+/** max. number of slave handles, handles are kept for slaves that left */
+#define EC_MAXHANDLE          (EC_MAXSLAVE * 2)
+/** size of slave index hash tables, power of 2 */
+#define EC_SLAVEHASHSIZE      256
 
 typedef struct ec_adapter ec_adaptert;
 struct ec_adapter
@@ -117,6 +143,8 @@ typedef struct ec_slave
    uint32           eep_id;
    /** revision from EEprom */
    uint32           eep_rev;
+   /** serial number from EEprom, 0 if not set */
+   uint32           eep_ser;
    /** Interface type */
    uint16           Itype;
    /** Device type */
@@ -163,6 +191,8 @@ typedef struct ec_slave
    uint16           mbx_proto;
    /** Counter value of mailbox link layer protocol 1..7 */
    uint8            mbx_cnt;
+   /** Frame number of last EoE frame sent to slave */
+   uint8            eoe_txframeno;
    /** has DC capability */
    boolean          hasdc;
    /** Physical type; Ebus, EtherNet combinations */
@@ -203,6 +233,8 @@ typedef struct ec_slave
    uint16           configindex;
    /** link to SII config */
    uint16           SIIindex;
+   /** link to ENI slave, 0 if not configured from ENI */
+   uint16           eniindex;
    /** 1 = 8 bytes per read, 0 = 4 bytes per read */
    uint8            eep_8byte;
    /** 0 = eeprom to master , 1 = eeprom to PDI */
@@ -227,10 +259,209 @@ typedef struct ec_slave
    boolean          islost;
    /** registered configuration function PO->SO */
    int              (*PO2SOconfig)(uint16 slave);
+   /** execution time of last PO2SOconfig call in us */
+   uint32           PO2SOconfigtime;
+   /** ECAT event request register, read by ecx_readevents */
+   uint16           eventreq;
+   /** first retained PDO entry in pdoentrylist */
+   uint16           pdoentry;
+   /** number of retained PDO entries */
+   uint16           npdoentry;
    /** readable name */
    char             name[EC_MAXNAME + 1];
 } ec_slavet;
 
+/** entry of timed output queue */
+typedef struct ec_outqentry
+{
+   /** cycle number or DC time the data is applied at */
+   uint64           due;
+   /** slave number, 0 = offset is relative to group outputs */
+   uint16           slave;
+   /** offset in outputs of slave */
+   uint16           offset;
+   /** length of data */
+   uint16           length;
+   /** output data */
+   uint8            data[EC_MAXOUTQDATA];
+} ec_outqentryt;
+
+/** timed output queue of a group, single producer and single consumer */
+typedef struct ec_outqueue
+{
+   /** size of entry array, must be a power of 2 */
+   uint32           size;
+   /** TRUE if due is DC time in ns, FALSE if due is group cycle number */
+   boolean          dctime;
+   /** next entry to write, only changed by producer */
+   volatile uint32  head;
+   /** next entry to apply, only changed by send processdata */
+   volatile uint32  tail;
+   /** entry array */
+   ec_outqentryt    *entry;
+} ec_outqueuet;
+
+/** byte range in the inputs of a slave */
+typedef struct ec_capturechan
+{
+   /** slave number */
+   uint16           slave;
+   /** offset in inputs of slave */
+   uint16           offset;
+   /** length in bytes */
+   uint16           length;
+} ec_capturechant;
+
+/** process data capture of a group, filled by ecx_receive_processdata_group
+ *  and emptied by a writer thread, see ethercatcapture.c */
+typedef struct ec_capture
+{
+   /** group the inputs are captured from */
+   uint8            group;
+   /** number of captured byte ranges */
+   int              nchan;
+   /** captured byte ranges */
+   ec_capturechant  chan[EC_MAXCAPTURECHAN];
+   /** record is only captured when trigger range changed, length 0 = every cycle */
+   ec_capturechant  trigger;
+   /** internal, last value of trigger range */
+   uint8            lasttrigger[8];
+   /** size of one record in bytes */
+   uint32           recordsize;
+   /** ring buffer of records */
+   uint8            *ring;
+   /** size of ring buffer in bytes */
+   uint32           ringsize;
+   /** number of records in ring buffer */
+   uint32           records;
+   /** next record to fill, only changed by receive processdata */
+   volatile uint32  head;
+   /** next record to write, only changed by writer thread */
+   volatile uint32  tail;
+   /** sequence number of next record, counts lost records too */
+   uint32           seq;
+   /** records lost because ring buffer was full */
+   volatile uint32  lost;
+   /** records written */
+   volatile uint32  written;
+   /** minimum number of bytes per write */
+   uint32           batch;
+   /** write function, returns number of bytes written */
+   int              (*write)(void *arg, const void *data, uint32 length);
+   /** argument of write function */
+   void             *arg;
+   /** TRUE if write function failed */
+   volatile boolean error;
+   /** internal, writer thread should stop after ring buffer is empty */
+   volatile int     stop;
+   /** internal, writer thread is running */
+   volatile int     running;
+   /** internal, writer thread handle */
+   OSAL_THREAD_HANDLE thread;
+} ec_capturet;
+
+/** max. number of captured arguments of a log entry */
+#define EC_LOGMAXARG       8
+/** log severity levels */
+#define EC_LOG_ERROR       0
+#define EC_LOG_WARNING     1
+#define EC_LOG_INFO        2
+#define EC_LOG_DEBUG       3
+/** log subsystems, bit mask */
+#define EC_LOG_CONFIG      0x0001
+#define EC_LOG_MAP         0x0002
+#define EC_LOG_MBX         0x0004
+#define EC_LOG_RECOVER     0x0008
+#define EC_LOG_DC          0x0010
+#define EC_LOG_APP         0x8000
+#define EC_LOG_ALL         0xffff
+
+/** log entry, the format string is kept by reference and formatted by the
+ *  drainer, see ethercatlog.c */
+typedef struct ec_logentry
+{
+   /** internal, sequence of entry in ring */
+   volatile uint32  seq;
+   /** severity level */
+   uint8            level;
+   /** number of captured arguments */
+   uint8            nargs;
+   /** subsystem */
+   uint16           subsys;
+   /** time of entry */
+   ec_timet         time;
+   /** format string, must stay valid until drained */
+   const char       *fmt;
+   /** captured arguments */
+   uint64           arg[EC_LOGMAXARG];
+} ec_logentryt;
+
+/** library log, filled lock-free by any thread and emptied by a drainer thread */
+typedef struct ec_log
+{
+   /** ring of entries */
+   ec_logentryt     *entry;
+   /** number of entries in ring, power of 2 */
+   uint32           size;
+   /** next entry to fill */
+   volatile uint32  head;
+   /** next entry to drain, only changed by drainer */
+   uint32           tail;
+   /** highest severity level logged */
+   uint8            level;
+   /** subsystems logged */
+   uint16           subsys;
+   /** entries lost because ring was full */
+   volatile uint32  lost;
+   /** output function of drainer, NULL = stdout */
+   void             (*output)(void *arg, const char *line);
+   /** argument of output function */
+   void             *arg;
+   /** internal, drainer thread should stop after ring is empty */
+   volatile int     stop;
+   /** internal, drainer thread is running */
+   volatile int     running;
+   /** internal, drainer thread handle */
+   OSAL_THREAD_HANDLE thread;
+} ec_logt;
+
+/** stable handle of a slave, identified by identity and serial, alias or
+ *  instance of identity on the bus */
+typedef struct ec_slavehandle
+{
+   /** Manufacturer from EEprom */
+   uint32           eep_man;
+   /** ID from EEprom */
+   uint32           eep_id;
+   /** serial number from EEprom, 0 if not set */
+   uint32           eep_ser;
+   /** alias address, only used if serial is not set */
+   uint16           aliasadr;
+   /** n-th slave with same identity, only used if serial and alias are not set */
+   uint16           instance;
+   /** current slave number, 0 = slave not on the bus */
+   uint16           slave;
+   /** internal, next handle in hash chain */
+   uint16           next;
+} ec_slavehandlet;
+
+/** index of the slave list, rebuilt at each configuration */
+typedef struct ec_slaveindex
+{
+   /** number of handles */
+   uint16           handlecount;
+   /** handles, handle n is entry n - 1 */
+   ec_slavehandlet  handle[EC_MAXHANDLE];
+   /** internal, hash table of handles */
+   uint16           handlehash[EC_SLAVEHASHSIZE];
+   /** handle of slave */
+   uint16           slavehandle[EC_MAXSLAVE];
+   /** internal, hash tables of slaves by alias, configured address, identity and name */
+   uint16           hash[4][EC_SLAVEHASHSIZE];
+   /** internal, next slave in hash chains */
+   uint16           next[4][EC_MAXSLAVE];
+} ec_slaveindext;
+
 /** for list of ethercat slave groups */
 typedef struct ec_group
 {
@@ -266,8 +497,101 @@ typedef struct ec_group
    boolean          docheckstate;
    /** IO segmentation list. Datagrams must not break SM in two. */
    uint32           IOsegment[EC_MAXIOSEGMENTS];
+   /** ECAT event requests of last process data receive, OR of all slaves */
+   uint16           irpt;
+   /** ECAT event requests accumulated since last ecx_events call */
+   uint16           events;
+   /** number of IO segments in segorder, 0 = send segments in IOmap order */
+   uint16           nsegorder;
+   /** send order of IO segments when LRW is used */
+   uint8            segorder[EC_MAXIOSEGMENTS];
+   /** registered hook called when the inputs of a segment are in the IOmap */
+   void             (*segmenthook)(uint8 group, uint16 segment);
+   /** timed output queue, NULL = none */
+   ec_outqueuet     *outqueue;
+   /** number of processdata sends of this group */
+   uint64           cycle;
+   /** process data capture, NULL = none */
+   ec_capturet      *capture;
+   /** inputs overlap the outputs in logical address space, the IOmap holds
+    * them behind the outputs. Set by ecx_config_overlap_map_group */
+   boolean          overlap;
 } ec_groupt;
 
+/** IOmap reservation for an optional slave */
+typedef struct ec_optslave
+{
+   /** expected slave position on the network */
+   uint16           slave;
+   /** expected manufacturer from EEprom */
+   uint32           eep_man;
+   /** expected ID from EEprom */
+   uint32           eep_id;
+   /** group the slave belongs to */
+   uint8            group;
+   /** reserved output bits */
+   uint16           Obits;
+   /** reserved input bits */
+   uint16           Ibits;
+   /** group of the IOmap holding the reservation, set by mapping */
+   uint8            mapgroup;
+   /** logical start address of reserved outputs, set by mapping */
+   uint32           Ologaddr;
+   /** startbit of reserved outputs, set by mapping */
+   uint8            Ostartbit;
+   /** logical start address of reserved inputs, set by mapping */
+   uint32           Ilogaddr;
+   /** startbit of reserved inputs, set by mapping */
+   uint8            Istartbit;
+   /** TRUE if space is reserved in the group mapping */
+   boolean          reserved;
+   /** TRUE if slave is present and mapped in the reserved space */
+   boolean          mapped;
+} ec_optslavet;
+
+/** slave to slave process data route, producer inputs are written to
+ *  consumer outputs within the same LRW datagram */
+typedef struct ec_route
+{
+   /** producer slave, must be located before the consumer */
+   uint16           producer;
+   /** byte offset in producer inputs */
+   uint16           Ioffset;
+   /** consumer slave */
+   uint16           consumer;
+   /** byte offset in consumer outputs */
+   uint16           Ooffset;
+   /** number of bytes routed */
+   uint16           length;
+   /** logical address of route, set by mapping, 0 if not active */
+   uint32           logaddr;
+} ec_routet;
+
+/** periodic ESC register subscription of one slave */
+typedef struct ec_sub
+{
+   /** slave number */
+   uint16           slave;
+   /** register address */
+   uint16           ADO;
+   /** register length */
+   uint16           length;
+   /** read period in us */
+   uint32           period;
+   /** internal, time until next read */
+   osal_timert      due;
+   /** internal, offset of data in frame in flight, 0 = not in frame */
+   int              offset;
+   /** snapshot sequence, odd while snapshot is updated */
+   volatile uint32  seq;
+   /** snapshot workcounter of read */
+   volatile uint16  wkc;
+   /** snapshot time of read */
+   ec_timet         time;
+   /** snapshot register data */
+   uint8            data[EC_MAXSUBDATA];
+} ec_subt;
+
 /** SII FMMU structure */
 typedef struct ec_eepromFMMU
 {
@@ -304,6 +628,53 @@ typedef struct ec_eepromPDO
    uint16  SMbitsize[EC_MAXSM];
 } ec_eepromPDOt;
 
+/** job of incremental EEPROM write, see ecx_writeeeprom_changed */
+typedef struct ec_eepromwrite
+{
+   /** slave position in EtherCAT order, 1..n */
+   uint16           slave;
+   /** first byte address to write, must be even */
+   uint16           start;
+   /** number of bytes to write, must be even */
+   uint16           length;
+   /** new EEPROM contents, indexed by byte address */
+   uint8            *image;
+   /** current EEPROM contents, indexed by byte address */
+   const uint8      *current;
+   /** number of words written, -1 on error */
+   int              written;
+   /** internal, state of job */
+   uint8            state;
+   /** internal, number of NACKs of current word */
+   uint8            nack;
+   /** internal, current byte address */
+   uint16           pos;
+   /** internal, position of result in frame */
+   uint16           datapos;
+   /** internal, timeout of current word */
+   osal_timert      timer;
+} ec_eepromwritet;
+
+/** PDO entry mapped in the process data of a slave, retained from the CoE
+ *  mapping read during configuration */
+typedef struct ec_pdoentry
+{
+   /** slave number */
+   uint16           slave;
+   /** object index, 0 = padding */
+   uint16           index;
+   /** object subindex */
+   uint8            subindex;
+   /** bit length */
+   uint8            bitlen;
+   /** TRUE if entry is in outputs (RxPDO), FALSE if in inputs (TxPDO) */
+   boolean          output;
+   /** bit offset in outputs or inputs of slave */
+   uint16           bitoffset;
+   /** internal, next entry in hash chain */
+   uint16           next;
+} ec_pdoentryt;
+
 /** mailbox buffer array */
 typedef uint8 ec_mbxbuft[EC_MAXMBX + 1];
 
@@ -336,6 +707,7 @@ typedef struct ec_idxstack
    uint8   idx[EC_MAXBUF];
    void    *data[EC_MAXBUF];
    uint16  length[EC_MAXBUF];
+   uint16  segment[EC_MAXBUF];
 } ec_idxstackT;
 
 /** ringbuf for error storage */
@@ -410,20 +782,66 @@ struct ecx_context
    uint16         DCl;
    /** reference to last DC time from slaves */
    int64          *DCtime;
-   /** internal, SM buffer */
+   /** deprecated, unused, kept for positional initializers */
    ec_SMcommtypet *SMcommtype;
-   /** internal, PDO assign list */
+   /** deprecated, unused, kept for positional initializers */
    ec_PDOassignt  *PDOassign;
-   /** internal, PDO description list */
+   /** deprecated, unused, kept for positional initializers */
    ec_PDOdesct    *PDOdesc;
-   /** internal, SM list from eeprom */
+   /** deprecated, unused, kept for positional initializers */
    ec_eepromSMt   *eepSM;
-   /** internal, FMMU list from eeprom */
+   /** deprecated, unused, kept for positional initializers */
    ec_eepromFMMUt *eepFMMU;
    /** registered FoE hook */
    int            (*FOEhook)(uint16 slave, int packetnumber, int datasize);
    /** registered EoE hook */
    int            (*EOEhook)(ecx_contextt * context, uint16 slave, void * eoembx);
+   /** internal, lock for error list, created by ecx_init */
+   osal_mutex_t   *elistlock;
+   /** internal, lock for eeprom cache, created by ecx_init */
+   osal_mutex_t   *esilock;
+   /** internal, mailbox lock per slave, created for each slave found by
+    *  ecx_config_init */
+   osal_mutex_t   *mbxlock[EC_MAXSLAVE];
+   /** max. number of PO2SOconfig hooks executed in parallel, 0 or 1 = serial,
+    *  limited to EC_MAX_HOOKT */
+   int            maxhookthreads;
+   /** optional slave reservation list reference */
+   ec_optslavet   *optslavelist;
+   /** number of optional slave reservations */
+   int            *optslavecount;
+   /** maximum number of optional slave reservations */
+   int            maxoptslave;
+   /** slave to slave route list reference */
+   ec_routet      *routelist;
+   /** number of slave to slave routes */
+   int            *routecount;
+   /** maximum number of slave to slave routes */
+   int            maxroute;
+   /** register subscription list reference */
+   ec_subt        *sublist;
+   /** number of register subscriptions */
+   int            *subcount;
+   /** maximum number of register subscriptions */
+   int            maxsub;
+   /** internal, TRUE if subscription frame is in flight */
+   boolean        subpending;
+   /** internal, index of subscription frame in flight */
+   uint8          subidx;
+   /** library log, NULL = EC_PRINT */
+   ec_logt        *log;
+   /** retained PDO entry list reference, NULL = not retained */
+   ec_pdoentryt   *pdoentrylist;
+   /** number of retained PDO entries */
+   int            *pdoentrycount;
+   /** maximum number of retained PDO entries */
+   int            maxpdoentry;
+   /** PDO entry hash table reference, EC_PDOHASHSIZE entries */
+   uint16         *pdohash;
+   /** internal, lock for PDO entry list, created by ecx_init */
+   osal_mutex_t   *pdolock;
+   /** slave index reference, NULL = no index */
+   ec_slaveindext *slaveindex;
 };
 
 #ifdef EC_VER1
@@ -435,6 +853,24 @@ extern ec_slavet   ec_slave[EC_MAXSLAVE];
 extern int         ec_slavecount;
 /** slave group structure */
 extern ec_groupt   ec_group[EC_MAXGROUP];
+/** optional slave reservations */
+extern ec_optslavet ec_optslave[EC_MAXOPTSLAVE];
+/** number of optional slave reservations */
+extern int         ec_optslavecount;
+/** slave to slave routes */
+extern ec_routet   ec_route[EC_MAXROUTE];
+/** number of slave to slave routes */
+extern int         ec_routecount;
+/** register subscriptions */
+extern ec_subt     ec_sub[EC_MAXSUB];
+/** number of register subscriptions */
+extern int         ec_subcount;
+/** retained PDO entries */
+extern ec_pdoentryt ec_pdoentry[EC_MAXPDOENTRY];
+/** number of retained PDO entries */
+extern int         ec_pdoentrycount;
+/** slave index */
+extern ec_slaveindext ec_slaveindex;
 extern boolean     EcatError;
 extern int64       ec_DCtime;
 
@@ -453,6 +889,9 @@ uint16 ec_siiSM(uint16 slave, ec_eepromSMt* SM);
 uint16 ec_siiSMnext(uint16 slave, ec_eepromSMt* SM, uint16 n);
 int ec_siiPDO(uint16 slave, ec_eepromPDOt* PDO, uint8 t);
 int ec_readstate(void);
+int ec_eventmask(uint16 slave, uint16 mask);
+uint16 ec_events(uint8 group);
+int ec_readevents(uint8 group);
 int ec_writestate(uint16 slave);
 uint16 ec_statecheck(uint16 slave, uint16 reqstate, int timeout);
 int ec_mbxempty(uint16 slave, int timeout);
@@ -465,10 +904,16 @@ int ec_eeprom2master(uint16 slave);
 int ec_eeprom2pdi(uint16 slave);
 uint64 ec_readeepromAP(uint16 aiadr, uint16 eeproma, int timeout);
 int ec_writeeepromAP(uint16 aiadr, uint16 eeproma, uint16 data, int timeout);
+int ec_writeeeprom_changed(ec_eepromwritet *job, int n, int timeout);
 uint64 ec_readeepromFP(uint16 configadr, uint16 eeproma, int timeout);
 int ec_writeeepromFP(uint16 configadr, uint16 eeproma, uint16 data, int timeout);
 void ec_readeeprom1(uint16 slave, uint16 eeproma);
 uint32 ec_readeeprom2(uint16 slave, int timeout);
+int ec_segmentorder(uint8 group, const uint16 *order, int n);
+int ec_segmentdefinehook(uint8 group, void *hook);
+int ec_inputsegment(uint16 slave);
+int ec_outqueue_init(uint8 group, ec_outqueuet *queue, ec_outqentryt *entry, uint32 size, boolean dctime);
+int ec_outqueue_put(uint8 group, uint64 due, uint16 slave, uint16 offset, const void *data, uint16 length);
 int ec_send_processdata_group(uint8 group);
 int ec_send_overlap_processdata_group(uint8 group);
 int ec_receive_processdata_group(uint8 group, int timeout);
@@ -496,11 +941,17 @@ uint16 ecx_siiSM(ecx_contextt *context, uint16 slave, ec_eepromSMt* SM);
 uint16 ecx_siiSMnext(ecx_contextt *context, uint16 slave, ec_eepromSMt* SM, uint16 n);
 int ecx_siiPDO(ecx_contextt *context, uint16 slave, ec_eepromPDOt* PDO, uint8 t);
 int ecx_readstate(ecx_contextt *context);
+int ecx_eventmask(ecx_contextt *context, uint16 slave, uint16 mask);
+uint16 ecx_events(ecx_contextt *context, uint8 group);
+int ecx_readevents(ecx_contextt *context, uint8 group);
 int ecx_writestate(ecx_contextt *context, uint16 slave);
 uint16 ecx_statecheck(ecx_contextt *context, uint16 slave, uint16 reqstate, int timeout);
 int ecx_mbxempty(ecx_contextt *context, uint16 slave, int timeout);
 int ecx_mbxsend(ecx_contextt *context, uint16 slave,ec_mbxbuft *mbx, int timeout);
 int ecx_mbxreceive(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx, int timeout);
+void ecx_mbxlock_init(ecx_contextt *context, uint16 slave);
+void ecx_mbxlock(ecx_contextt *context, uint16 slave);
+void ecx_mbxunlock(ecx_contextt *context, uint16 slave);
 void ecx_esidump(ecx_contextt *context, uint16 slave, uint8 *esibuf);
 uint32 ecx_readeeprom(ecx_contextt *context, uint16 slave, uint16 eeproma, int timeout);
 int ecx_writeeeprom(ecx_contextt *context, uint16 slave, uint16 eeproma, uint16 data, int timeout);
@@ -508,10 +959,19 @@ int ecx_eeprom2master(ecx_contextt *context, uint16 slave);
 int ecx_eeprom2pdi(ecx_contextt *context, uint16 slave);
 uint64 ecx_readeepromAP(ecx_contextt *context, uint16 aiadr, uint16 eeproma, int timeout);
 int ecx_writeeepromAP(ecx_contextt *context, uint16 aiadr, uint16 eeproma, uint16 data, int timeout);
+int ecx_writeeeprom_changed(ecx_contextt *context, ec_eepromwritet *job, int n, int timeout);
 uint64 ecx_readeepromFP(ecx_contextt *context, uint16 configadr, uint16 eeproma, int timeout);
 int ecx_writeeepromFP(ecx_contextt *context, uint16 configadr, uint16 eeproma, uint16 data, int timeout);
 void ecx_readeeprom1(ecx_contextt *context, uint16 slave, uint16 eeproma);
 uint32 ecx_readeeprom2(ecx_contextt *context, uint16 slave, int timeout);
+int ecx_segmentorder(ecx_contextt *context, uint8 group, const uint16 *order, int n);
+int ecx_segmentdefinehook(ecx_contextt *context, uint8 group, void *hook);
+int ecx_inputsegment(ecx_contextt *context, uint16 slave);
+int ecx_outqueue_init(ecx_contextt *context, uint8 group, ec_outqueuet *queue, ec_outqentryt *entry,
+   uint32 size, boolean dctime);
+int ecx_outqueue_put(ecx_contextt *context, uint8 group, uint64 due, uint16 slave, uint16 offset,
+   const void *data, uint16 length);
+int ecx_send_processdata_group(ecx_contextt *context, uint8 group);
 int ecx_send_overlap_processdata_group(ecx_contextt *context, uint8 group);
 int ecx_receive_processdata_group(ecx_contextt *context, uint8 group, int timeout);
 int ecx_send_processdata(ecx_contextt *context);
@@ -87,6 +87,7 @@ int ecx_SoEread(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 elemen
    uint8 cnt;
    boolean NotLast;
 
+   ecx_mbxlock(context, slave);
    ec_clearmbx(&MbxIn);
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
    wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
@@ -179,6 +180,7 @@ int ecx_SoEread(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 elemen
          }
       }
    }
+   ecx_mbxunlock(context, slave);
    return wkc;
 }
 
@@ -209,6 +211,7 @@ int ecx_SoEwrite(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 eleme
    uint8 cnt;
    boolean NotLast;
 
+   ecx_mbxlock(context, slave);
    ec_clearmbx(&MbxIn);
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
    wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
@@ -294,6 +297,7 @@ int ecx_SoEwrite(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 eleme
          }
       }
    }
+   ecx_mbxunlock(context, slave);
    return wkc;
 }
 
@@ -0,0 +1,286 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Periodic ESC register subscription module.
+ *
+ * Registers like error counters, DL status or AL status are read periodically
+ * with FPRD datagrams packed into one frame per cycle. The frame is sent by
+ * ecx_subscription_tick() from the cyclic task next to the process data and
+ * collected in the following cycle, so the cyclic task is never blocked. The
+ * bytes per cycle are bounded by the caller. Results are stored in a snapshot
+ * per subscription that can be read from any thread without locking.
+ */
+
+#include <string.h>
+#include "osal.h"
+#include "oshw.h"
+#include "ethercat.h"
+
+static ec_subt *ecx_findsub(ecx_contextt *context, uint16 slave, uint16 ADO)
+{
+   int i;
+
+   for (i = 0; i < *(context->subcount); i++)
+   {
+      if (context->sublist[i].period &&
+          (context->sublist[i].slave == slave) &&
+          (context->sublist[i].ADO == ADO))
+      {
+         return &(context->sublist[i]);
+      }
+   }
+   return NULL;
+}
+
+/** Subscribe to periodic reads of an ESC register of a set of slaves.
+ * An existing subscription of the same slave and register is updated.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  slavelst = list of slave numbers
+ * @param[in]  n        = number of slaves in list
+ * @param[in]  ADO      = register address
+ * @param[in]  length   = register length, max EC_MAXSUBDATA
+ * @param[in]  rate     = read rate in Hz
+ * @return number of slaves subscribed, -1 on invalid arguments
+ */
+int ecx_subscribe(ecx_contextt *context, uint16 *slavelst, int n, uint16 ADO, uint16 length, uint32 rate)
+{
+   ec_subt *sub;
+   int i, j, cnt;
+
+   if ((context->sublist == NULL) || (length == 0) || (length > EC_MAXSUBDATA) ||
+       (rate == 0) || (rate > 1000000))
+   {
+      return -1;
+   }
+   cnt = 0;
+   for (i = 0; i < n; i++)
+   {
+      if ((slavelst[i] == 0) || (slavelst[i] > *(context->slavecount)))
+      {
+         continue;
+      }
+      sub = ecx_findsub(context, slavelst[i], ADO);
+      /* reuse unsubscribed entry or append a new one */
+      for (j = 0; (sub == NULL) && (j < *(context->subcount)); j++)
+      {
+         if (context->sublist[j].period == 0)
+         {
+            sub = &(context->sublist[j]);
+         }
+      }
+      if ((sub == NULL) && (*(context->subcount) < context->maxsub))
+      {
+         sub = &(context->sublist[*(context->subcount)]);
+         memset(sub, 0x00, sizeof(ec_subt));
+         (*(context->subcount))++;
+      }
+      if (sub == NULL)
+      {
+         break;
+      }
+      sub->slave = slavelst[i];
+      sub->ADO = ADO;
+      sub->length = length;
+      osal_timer_start(&(sub->due), 0);
+      /* setting the period activates the subscription */
+      sub->period = 1000000 / rate;
+      cnt++;
+   }
+   return cnt;
+}
+
+/** Stop periodic reads of an ESC register.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  slave    = slave number, 0 = all slaves
+ * @param[in]  ADO      = register address
+ * @return number of subscriptions removed
+ */
+int ecx_unsubscribe(ecx_contextt *context, uint16 slave, uint16 ADO)
+{
+   int i, cnt;
+
+   cnt = 0;
+   for (i = 0; (context->sublist != NULL) && (i < *(context->subcount)); i++)
+   {
+      if (context->sublist[i].period &&
+          (!slave || (context->sublist[i].slave == slave)) &&
+          (context->sublist[i].ADO == ADO))
+      {
+         context->sublist[i].period = 0;
+         cnt++;
+      }
+   }
+   return cnt;
+}
+
+/** Read the last snapshot of a subscribed register. Lock free, can be called
+ * from any thread while ecx_subscription_tick is running.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  slave    = slave number
+ * @param[in]  ADO      = register address
+ * @param[out] data     = register data
+ * @param[in]  length   = size of data buffer
+ * @param[out] time     = time of read, can be NULL
+ * @return workcounter of read, EC_NOFRAME if not subscribed or not read yet
+ */
+int ecx_subscription_read(ecx_contextt *context, uint16 slave, uint16 ADO, void *data, int length, ec_timet *time)
+{
+   ec_subt *sub;
+   uint32 seq;
+   int wkc;
+
+   if ((context->sublist == NULL) || ((sub = ecx_findsub(context, slave, ADO)) == NULL))
+   {
+      return EC_NOFRAME;
+   }
+   if (length > sub->length)
+   {
+      length = sub->length;
+   }
+   do
+   {
+      seq = sub->seq;
+      OSAL_MEMORY_BARRIER();
+      memcpy(data, sub->data, length);
+      wkc = sub->wkc;
+      if (time)
+      {
+         *time = sub->time;
+      }
+      OSAL_MEMORY_BARRIER();
+   } while ((seq & 1) || (seq != sub->seq));
+   if (seq == 0)
+   {
+      return EC_NOFRAME;
+   }
+   return wkc;
+}
+
+/** Collect the subscription frame of the previous call and send a new frame
+ * with the reads that are due. To be called once per cycle from the cyclic
+ * task, after the process data is received. Does not block.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  budget   = max. bytes of datagrams sent per call
+ * @return number of reads sent
+ */
+int ecx_subscription_tick(ecx_contextt *context, int budget)
+{
+   ec_subt *sub;
+   uint16 duelst[EC_MAXSUB];
+   uint16 le_wkc, configadr;
+   int i, n, size, idx, wkc;
+   ec_timet now;
+
+   if (context->sublist == NULL)
+   {
+      return 0;
+   }
+   /* collect result of frame sent by previous call */
+   if (context->subpending)
+   {
+      idx = context->subidx;
+      wkc = ecx_waitinframe(context->port, idx, 0);
+      now = osal_current_time();
+      for (i = 0; i < *(context->subcount); i++)
+      {
+         sub = &(context->sublist[i]);
+         if (sub->offset)
+         {
+            if (wkc > EC_NOFRAME)
+            {
+               memcpy(&le_wkc, &(context->port->rxbuf[idx][sub->offset + sub->length]), EC_WKCSIZE);
+               /* seq is odd while the snapshot is written */
+               sub->seq++;
+               OSAL_MEMORY_BARRIER();
+               memcpy(sub->data, &(context->port->rxbuf[idx][sub->offset]), sub->length);
+               sub->wkc = etohs(le_wkc);
+               sub->time = now;
+               OSAL_MEMORY_BARRIER();
+               sub->seq++;
+            }
+            else
+            {
+               /* frame lost, read again */
+               osal_timer_start(&(sub->due), 0);
+            }
+            sub->offset = 0;
+         }
+      }
+      /* release index also when the frame is lost or late */
+      ecx_setbufstat(context->port, idx, EC_BUF_EMPTY);
+      context->subpending = FALSE;
+   }
+   /* select due reads that fit in budget */
+   if (budget > EC_MAXLRWDATA)
+   {
+      budget = EC_MAXLRWDATA;
+   }
+   n = 0;
+   size = 0;
+   for (i = 0; i < *(context->subcount); i++)
+   {
+      sub = &(context->sublist[i]);
+      if (sub->period && osal_timer_is_expired(&(sub->due)) &&
+          ((int)(size + EC_HEADERSIZE + sub->length + EC_WKCSIZE) <= budget))
+      {
+         size += EC_HEADERSIZE + sub->length + EC_WKCSIZE;
+         duelst[n++] = (uint16)i;
+      }
+   }
+   if (n == 0)
+   {
+      return 0;
+   }
+   idx = ecx_getindex(context->port);
+   for (i = 0; i < n; i++)
+   {
+      sub = &(context->sublist[duelst[i]]);
+      configadr = context->slavelist[sub->slave].configadr;
+      if (i == 0)
+      {
+         ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FPRD, idx,
+            configadr, sub->ADO, sub->length, sub->data);
+         sub->offset = EC_HEADERSIZE;
+      }
+      else
+      {
+         sub->offset = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FPRD, idx,
+            (i < (n - 1)), configadr, sub->ADO, sub->length, sub->data);
+      }
+      osal_timer_start(&(sub->due), sub->period);
+   }
+   ecx_outframe_red(context->port, idx);
+   context->subidx = (uint8)idx;
+   context->subpending = TRUE;
+   return n;
+}
+
+#ifdef EC_VER1
+int ec_subscribe(uint16 *slavelst, int n, uint16 ADO, uint16 length, uint32 rate)
+{
+   return ecx_subscribe(&ecx_context, slavelst, n, ADO, length, rate);
+}
+
+int ec_unsubscribe(uint16 slave, uint16 ADO)
+{
+   return ecx_unsubscribe(&ecx_context, slave, ADO);
+}
+
+int ec_subscription_read(uint16 slave, uint16 ADO, void *data, int length, ec_timet *time)
+{
+   return ecx_subscription_read(&ecx_context, slave, ADO, data, length, time);
+}
+
+int ec_subscription_tick(int budget)
+{
+   return ecx_subscription_tick(&ecx_context, budget);
+}
+#endif
@@ -0,0 +1,35 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Headerfile for ethercatsub.c
+ */
+
+#ifndef _ethercatsub_
+#define _ethercatsub_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef EC_VER1
+int ec_subscribe(uint16 *slavelst, int n, uint16 ADO, uint16 length, uint32 rate);
+int ec_unsubscribe(uint16 slave, uint16 ADO);
+int ec_subscription_read(uint16 slave, uint16 ADO, void *data, int length, ec_timet *time);
+int ec_subscription_tick(int budget);
+#endif
+
+int ecx_subscribe(ecx_contextt *context, uint16 *slavelst, int n, uint16 ADO, uint16 length, uint32 rate);
+int ecx_unsubscribe(ecx_contextt *context, uint16 slave, uint16 ADO);
+int ecx_subscription_read(ecx_contextt *context, uint16 slave, uint16 ADO, void *data, int length, ec_timet *time);
+int ecx_subscription_tick(ecx_contextt *context, int budget);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
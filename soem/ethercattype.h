@@ -107,7 +107,8 @@ typedef struct PACKED
    uint16  ADO;
    /** length of data portion in datagram */
    uint16  dlength;
-   /** interrupt, currently unused */
+   /** ECAT event requests of all slaves masked with their ECAT event mask,
+    *  combined with logical OR */
    uint16  irpt;
 } ec_comt;
 PACKED_END
@@ -123,6 +124,15 @@ PACKED_END
 /** definition of datagram follows bit in ec_comt.dlength */
 #define EC_DATAGRAMFOLLOWS  (1 << 15)
 
+/** ECAT event request DC latch event */
+#define EC_EVENT_DCLATCH    0x0001
+/** ECAT event request DL status change */
+#define EC_EVENT_DLSTATUS   0x0004
+/** ECAT event request AL status change */
+#define EC_EVENT_ALSTATUS   0x0008
+/** ECAT event request of SyncManager n, f.e. mailbox received in SM1 */
+#define EC_EVENT_SM(n)      (0x0010 << (n))
+
 /** Possible error codes returned. */
 typedef enum
 {
@@ -290,6 +300,7 @@ enum
    ECT_SII_MANUF       = 0x0008,
    ECT_SII_ID          = 0x000a,
    ECT_SII_REV         = 0x000c,
+   ECT_SII_SERIAL      = 0x000e,
    ECT_SII_BOOTRXMBX   = 0x0014,
    ECT_SII_BOOTTXMBX   = 0x0016,
    ECT_SII_MBXSIZE     = 0x0019,
@@ -393,6 +404,7 @@ enum
    ECT_REG_ALSTATCODE  = 0x0134,
    ECT_REG_PDICTL      = 0x0140,
    ECT_REG_IRQMASK     = 0x0200,
+   ECT_REG_EVENTREQ    = 0x0210,
    ECT_REG_RXERR       = 0x0300,
    ECT_REG_FRXERR      = 0x0308,
    ECT_REG_EPUECNT     = 0x030C,
@@ -432,7 +444,15 @@ enum
    ECT_REG_DCSYNCACT   = 0x0981,
    ECT_REG_DCSTART0    = 0x0990,
    ECT_REG_DCCYCLE0    = 0x09A0,
-   ECT_REG_DCCYCLE1    = 0x09A4
+   ECT_REG_DCCYCLE1    = 0x09A4,
+   ECT_REG_DCLATCH0CTRL = 0x09A8,
+   ECT_REG_DCLATCH1CTRL = 0x09A9,
+   ECT_REG_DCLATCH0STAT = 0x09AE,
+   ECT_REG_DCLATCH1STAT = 0x09AF,
+   ECT_REG_DCLATCH0POS = 0x09B0,
+   ECT_REG_DCLATCH0NEG = 0x09B8,
+   ECT_REG_DCLATCH1POS = 0x09C0,
+   ECT_REG_DCLATCH1NEG = 0x09C8
 };
 
 /** standard SDO Sync Manager Communication Type */
@@ -0,0 +1,176 @@
+/** \file
+ * \brief Example code for Simple Open EtherCAT master
+ *
+ * Usage : busload ifname [-cycle us] [-group g:us] [-assign first-last:g]
+ *         [-fwd ns] [-measure n]
+ * Ifname is NIC interface, f.e. eth0.
+ * -cycle sets the cycle time of all groups, default 1000us.
+ * -group sets the cycle time of group g.
+ * -assign puts slaves first to last in group g before mapping. Group 0 holds
+ *  all slaves, so with -assign only groups 1 and up are mapped and analyzed.
+ * -fwd sets the forwarding delay per slave if DC delays are not available.
+ * -measure measures n round trips per group on the bus.
+ *
+ * This computes the bus load and minimum cycle time of each group and
+ * advises which groups should be split or merged.
+ *
+ * (c)Arthur Ketels 2010 - 2011
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ethercat.h"
+
+char IOmap[EC_MAXGROUP][4096];
+int32 cycle[EC_MAXGROUP];
+int32 fwddelay = 0;
+int rounds = 0;
+ec_grouploadt load[EC_MAXGROUP];
+
+void busload(char *ifname, int nassign, int *assign)
+{
+   int i, s, ngroups, total;
+   uint8 group, first;
+
+   printf("Starting busload\n");
+
+   /* initialise SOEM, bind socket to ifname */
+   if (ec_init(ifname))
+   {
+      printf("ec_init on %s succeeded.\n", ifname);
+      if (ec_config_init(FALSE) > 0)
+      {
+         printf("%d slaves found.\n", ec_slavecount);
+         for (i = 0; i < nassign; i++)
+         {
+            for (s = assign[i * 3]; (s <= assign[(i * 3) + 1]) && (s <= ec_slavecount); s++)
+            {
+               ec_slave[s].group = (uint8)assign[(i * 3) + 2];
+            }
+         }
+         ngroups = 1;
+         for (s = 1; s <= ec_slavecount; s++)
+         {
+            if (ec_slave[s].group >= ngroups)
+            {
+               ngroups = ec_slave[s].group + 1;
+            }
+         }
+         /* group 0 maps all slaves, use it only when nothing is assigned */
+         first = (ngroups > 1) ? 1 : 0;
+         for (group = first; group < ngroups; group++)
+         {
+            ec_config_map_group(&IOmap[group], group);
+         }
+         ec_configdc();
+         ec_statecheck(0, EC_STATE_SAFE_OP, EC_TIMEOUTSTATE * 4);
+         while (EcatError) printf("%s", ec_elist2string());
+         for (group = first; group < ngroups; group++)
+         {
+            ec_busload(group, cycle[group], fwddelay, &load[group]);
+            if (rounds && load[group].frames)
+            {
+               ec_busload_measure(group, rounds, &load[group]);
+            }
+         }
+         total = ec_busload_advise(&load[first], ngroups - first);
+         printf("\nGroup Cycle[us] Frames Dgrams  Bytes Wire[us] Loop[us]  Min[us] Load[%%]");
+         if (rounds) printf(" RTmin[us] RTavg[us] RTmax[us] Lost");
+         printf(" Advice\n");
+         for (group = first; group < ngroups; group++)
+         {
+            printf("%5d %9.1f %6d %6d %6d %8.1f %8.1f %8.1f %7.1f", group, load[group].cycle / 1000.0,
+                   load[group].frames, load[group].datagrams, load[group].bytes,
+                   load[group].wiretime / 1000.0, load[group].loopdelay / 1000.0,
+                   load[group].mincycle / 1000.0, load[group].load / 10.0);
+            if (rounds)
+            {
+               printf(" %9.1f %9.1f %9.1f %4d", load[group].rtmin / 1000.0, load[group].rtavg / 1000.0,
+                      load[group].rtmax / 1000.0, load[group].lost);
+            }
+            if (load[group].flags & EC_LOAD_SPLIT) printf(" split");
+            if (load[group].flags & EC_LOAD_LATE) printf(" late");
+            if (load[group].flags & EC_LOAD_MERGE) printf(" merge with %d", load[group].mergewith);
+            if (load[group].redundant) printf(" redundant");
+            printf("\n");
+         }
+         printf("Total bus load %.1f%%%s\n", total / 10.0, (total > 1000) ? ", bus overloaded" : "");
+         ec_slave[0].state = EC_STATE_INIT;
+         ec_writestate(0);
+      }
+      else
+      {
+         printf("No slaves found!\n");
+      }
+      printf("End busload, close socket\n");
+      /* stop SOEM, close socket */
+      ec_close();
+   }
+   else
+   {
+      printf("No socket connection on %s\nExcecute as root\n", ifname);
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   int assign[EC_MAXGROUP * 8 * 3];
+   int nassign = 0;
+   int i, g, first, last, us;
+
+   printf("SOEM (Simple Open EtherCAT Master)\nBusload\n");
+
+   for (g = 0; g < EC_MAXGROUP; g++)
+   {
+      cycle[g] = 1000000;
+   }
+   if (argc > 1)
+   {
+      for (i = 2; i < argc - 1; i++)
+      {
+         if (strcmp(argv[i], "-cycle") == 0)
+         {
+            us = atoi(argv[++i]);
+            for (g = 0; g < EC_MAXGROUP; g++) cycle[g] = us * 1000;
+         }
+         else if ((strcmp(argv[i], "-group") == 0) &&
+                  (sscanf(argv[i + 1], "%d:%d", &g, &us) == 2) && (g >= 0) && (g < EC_MAXGROUP))
+         {
+            cycle[g] = us * 1000;
+            i++;
+         }
+         else if ((strcmp(argv[i], "-assign") == 0) && (nassign < EC_MAXGROUP * 8) &&
+                  (sscanf(argv[i + 1], "%d-%d:%d", &first, &last, &g) == 3) && (g >= 0) && (g < EC_MAXGROUP))
+         {
+            assign[nassign * 3] = first;
+            assign[(nassign * 3) + 1] = last;
+            assign[(nassign * 3) + 2] = g;
+            nassign++;
+            i++;
+         }
+         else if (strcmp(argv[i], "-fwd") == 0)
+         {
+            fwddelay = atoi(argv[++i]);
+         }
+         else if (strcmp(argv[i], "-measure") == 0)
+         {
+            rounds = atoi(argv[++i]);
+         }
+      }
+      busload(argv[1], nassign, assign);
+   }
+   else
+   {
+      printf("Usage: busload ifname [options]\nifname = eth0 for example\nOptions :\n"
+             " -cycle us : cycle time of all groups, default 1000\n"
+             " -group g:us : cycle time of group g\n"
+             " -assign first-last:g : put slaves first to last in group g\n"
+             " -fwd ns : forwarding delay per slave without DC, default %d\n"
+             " -measure n : measure n round trips per group\n", EC_FWDDELAY);
+   }
+
+   printf("End program\n");
+   return (0);
+}
@@ -1,11 +1,14 @@
 /** \file
  * \brief Example code for Simple Open EtherCAT master
  *
- * Usage : ebox [ifname] [cycletime]
+ * Usage : ebox [ifname] [cycletime] [capturefile]
  * ifname is NIC interface, f.e. eth0
  * cycletime in us, f.e. 500
+ * capturefile to store the stream, default stream.cap
  *
  * This test is specifically build for the E/BOX.
+ * The oversampled stream is captured to file by a writer thread, see
+ * ethercatcapture.c for the file format.
  *
  * (c)Arthur Ketels 2011
  */
@@ -20,6 +23,7 @@
 #include <time.h>
 #include <pthread.h>
 #include <math.h>
+#include <fcntl.h>
 
 #include "ethercat.h"
 
@@ -54,8 +58,10 @@ typedef struct PACKED
    uint8         control;
 } out_EBOX_streamt;
 
-// total samples to capture
-#define MAXSTREAM 200000
+// capture ring buffer size, holds about 1s of stream records at 1ms cycle time
+#define CAPTURERING (1024 * 1024)
+// minimum bytes per write to capture file
+#define CAPTUREBATCH (256 * 1024)
 // sample interval in ns, here 8us -> 125kHz
 // maximum data rate for E/BOX v1.0.1 is around 150kHz
 #define SYNC0TIME 8000
@@ -80,28 +86,53 @@ in_EBOX_streamt  *in_EBOX;
 out_EBOX_streamt *out_EBOX;
 double     ain[2];
 int        ainc;
-int        streampos;
-int16      stream1[MAXSTREAM];
-int16      stream2[MAXSTREAM];
+char       *capturefile = "stream.cap";
+ec_capturet capture;
+uint8      capturering[CAPTURERING];
+int        capturefd = -1;
 
-int output_cvs(char *fname, int length)
+/* write function of capture, called from capture writer thread */
+int capture_write(void *arg, const void *data, uint32 length)
 {
-   FILE *fp;
-
-   int  i;
+   return (int)write(*(int *)arg, data, length);
+}
 
-   fp = fopen(fname, "w");
-   if(fp == NULL)
+/* capture complete stream struct every time the E/BOX counter changes */
+int capture_begin(void)
+{
+   capturefd = open(capturefile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+   if (capturefd < 0)
+   {
+      printf("Can not open capture file %s\n", capturefile);
       return 0;
-   for (i = 0; i < length; i++)
+   }
+   if (!ec_capture_init(&capture, 0, capturering, sizeof(capturering)) ||
+       (ec_capture_add(&capture, 1, 0, sizeof(in_EBOX_streamt)) < 0) ||
+       !ec_capture_trigger(&capture, 1, 0, sizeof(in_EBOX->counter)) ||
+       !ec_capture_start(&capture, &capture_write, &capturefd, CAPTUREBATCH))
    {
-      fprintf(fp, "%d %d %d\n", i, stream1[i], stream2[i]);
+      printf("Can not start capture\n");
+      close(capturefd);
+      capturefd = -1;
+      return 0;
    }
-   fclose(fp);
-
    return 1;
 }
 
+void capture_end(void)
+{
+   uint32 written;
+
+   if (capturefd >= 0)
+   {
+      written = ec_capture_stop(&capture);
+      printf("Captured %u records to %s, lost %u%s\n", written, capturefile, capture.lost,
+             capture.error ? ", write error" : "");
+      close(capturefd);
+      capturefd = -1;
+   }
+}
+
 void eboxtest(char *ifname)
 {
    int cnt, i;
@@ -175,6 +206,7 @@ void eboxtest(char *ifname)
                ain[0] = 0;
                ain[1] = 0;
                ainc = 0;
+               capture_begin();
                dorun = 1;
                usleep(100000); // wait for linux to sync on DC
                ec_dcsync0(1, TRUE, SYNC0TIME, 0); // SYNC0 on slave 1
@@ -191,6 +223,8 @@ void eboxtest(char *ifname)
                   usleep(20000);
                }
                dorun = 0;
+               usleep(10000); // wait for last cycle to finish
+               capture_end();
    //            printf("\nCnt %d : Ain0 = %f  Ain2 = %f\n", ainc, ain[0] / ainc, ain[1] / ainc);
             }
             else
@@ -224,8 +258,6 @@ void eboxtest(char *ifname)
             os=sizeof(ob2); ob2 = 0x1a00;
             ec_SDOwrite(1,0x1c13,01,FALSE,os,&ob2,EC_TIMEOUTRXM);
          }
-         printf("Streampos %d\n", streampos);
-         output_cvs("stream.txt", streampos);
       }
       else
       {
@@ -276,8 +308,6 @@ void ecatthread( void *ptr )
    struct timespec   ts;
    struct timeval    tp;
    int ht;
-   int i;
-   int pcounter = 0;
    int64 cycletime;
 
    pthread_mutex_lock(&mutex);
@@ -304,32 +334,9 @@ void ecatthread( void *ptr )
 
          ec_receive_processdata(EC_TIMEOUTRET);
 
+         /* stream is captured by ec_receive_processdata */
          cyclecount++;
 
-
-         if((in_EBOX->counter != pcounter) && (streampos < (MAXSTREAM - 1)))
-         {
-            // check if we have timing problems in master
-            // if so, overwrite stream data so it shows up clearly in plots.
-            if(in_EBOX->counter > (pcounter + 1))
-            {
-               for(i = 0 ; i < 50 ; i++)
-               {
-                  stream1[streampos]   = 20000;
-                  stream2[streampos++] = -20000;
-               }
-            }
-            else
-            {
-               for(i = 0 ; i < 50 ; i++)
-               {
-                  stream1[streampos]   = in_EBOX->stream[i * 2];
-                  stream2[streampos++] = in_EBOX->stream[(i * 2) + 1];
-               }
-            }
-            pcounter = in_EBOX->counter;
-         }
-
          /* calulate toff to get linux time and DC synced */
          ec_sync(ec_DCtime, cycletime, &toff);
       }
@@ -362,6 +369,8 @@ int main(int argc, char *argv[])
          ctime = atoi(argv[2]);
       else
          ctime = 1000; // 1ms cycle time
+      if( argc > 3)
+         capturefile = argv[3];
       /* create RT thread */
       pthread_create( &thread1, NULL, (void *) &ecatthread, (void*) &ctime);
       memset(&param, 0, sizeof(param));
@@ -374,7 +383,8 @@ int main(int argc, char *argv[])
    }
    else
    {
-      printf("Usage: ebox ifname [cycletime]\nifname = eth0 for example\ncycletime in us\n");
+      printf("Usage: ebox ifname [cycletime] [capturefile]\nifname = eth0 for example\ncycletime in us\n"
+             "capturefile default stream.cap\n");
    }
 
    schedp.sched_priority = 0;
@@ -0,0 +1,273 @@
+/** \file
+ * \brief Example code for Simple Open EtherCAT master
+ *
+ * Usage : ecmux ifname [-guard us] [-group name]
+ * Ifname is NIC interface, f.e. eth0.
+ * -guard sets the time kept free before the next real-time cycle, default 200us.
+ * -group lets members of the group attach, by default only the owner of the
+ * multiplexer can.
+ *
+ * This is a frame multiplexer. It owns the NIC and lets several SOEM programs
+ * share the EtherCAT segment. Programs attach with ifname "mux:eth0", the
+ * real-time program with "muxrt:eth0". Frames of the real-time program are
+ * sent at once, frames of the other programs only in the idle time between
+ * real-time cycles. Each client uses its own range of frame indexes on the
+ * wire, so returning frames can be routed back to their owner.
+ *
+ * (c)Arthur Ketels 2010 - 2011
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <grp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+#include "ethercat.h"
+
+ecx_portt port;
+ec_muxshmt *mux;
+volatile int running = 1;
+int32 guard = 200;
+char *group = NULL;
+
+void mux_signal(int sig)
+{
+   (void)sig;
+   running = 0;
+}
+
+/* time since start in us */
+int64 mux_us(ec_timet *start)
+{
+   ec_timet now, diff;
+
+   now = osal_current_time();
+   osal_time_diff(start, &now, &diff);
+   return ((int64)diff.sec * 1000000) + diff.usec;
+}
+
+/* first datagram of frame */
+ec_comt *mux_datagram(uint8 *frame, int length)
+{
+   ec_etherheadert *ehp;
+
+   ehp = (ec_etherheadert *)frame;
+   if ((length < (int)(ETH_HEADERSIZE + EC_HEADERSIZE)) || (ehp->etype != htons(ETH_P_ECAT)))
+   {
+      return NULL;
+   }
+   return (ec_comt *)&frame[ETH_HEADERSIZE];
+}
+
+/* free slots of terminated clients */
+void mux_reap(void)
+{
+   int slot, pid;
+
+   for (slot = 0; slot < EC_MUX_CLIENTS; slot++)
+   {
+      pid = mux->client[slot].pid;
+      if (pid && (kill(pid, 0) < 0) && (errno == ESRCH))
+      {
+         printf("Client %d (pid %d) gone\n", slot, pid);
+         mux->client[slot].tx.tail = mux->client[slot].tx.head;
+         mux->client[slot].pid = 0;
+      }
+   }
+}
+
+void ecmux(char *ifname)
+{
+   char name[64];
+   ec_bufT frame;
+   ec_comt *ecp;
+   ec_timet start;
+   int fd, n, k, slot, next, idle;
+   struct group *gr;
+   gid_t gid;
+   mode_t mode;
+   int outstanding = 0;
+   int64 now, lastrt = 0, burst = 0, period = 0, lastreap = 0;
+   int rtframes = 0, frames = 0, dropped = 0;
+
+   printf("Starting ecmux\n");
+
+   /* bind socket to ifname */
+   if (!ecx_setupnic(&port, ifname, FALSE))
+   {
+      printf("No socket connection on %s\nExcecute as root\n", ifname);
+      return;
+   }
+   gid = -1;
+   if (group)
+   {
+      gr = getgrnam(group);
+      if (gr == NULL)
+      {
+         printf("Unknown group %s\n", group);
+         ecx_closenic(&port);
+         return;
+      }
+      gid = gr->gr_gid;
+   }
+   snprintf(name, sizeof(name), EC_MUX_SHMNAME, ifname);
+   /* clients can inject any frame, only the owner or the group may attach */
+   mode = group ? 0660 : 0600;
+   fd = shm_open(name, O_CREAT | O_RDWR, mode);
+   /* mode is set again as the segment may exist and umask applies */
+   if ((fd < 0) || (fchown(fd, -1, gid) < 0) || (fchmod(fd, mode) < 0) ||
+       (ftruncate(fd, sizeof(ec_muxshmt)) < 0))
+   {
+      printf("Can not create shared memory %s\n", name);
+      if (fd >= 0)
+      {
+         close(fd);
+         shm_unlink(name);
+      }
+      ecx_closenic(&port);
+      return;
+   }
+   mux = mmap(NULL, sizeof(ec_muxshmt), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   if (mux == MAP_FAILED)
+   {
+      printf("Can not map shared memory %s\n", name);
+      shm_unlink(name);
+      ecx_closenic(&port);
+      return;
+   }
+   memset(mux, 0, sizeof(ec_muxshmt));
+   mux->magic = EC_MUX_MAGIC;
+   OSAL_MEMORY_BARRIER();
+   mux->running = 1;
+   printf("Multiplexing %s, clients attach with %s%s or %s%s\n", ifname,
+          EC_MUX_PREFIXRT, ifname, EC_MUX_PREFIX, ifname);
+
+   start = osal_current_time();
+   next = 1;
+   while (running)
+   {
+      /* route returning frames to their client by index range */
+      while ((n = recv(port.sockhandle, frame, sizeof(frame), 0)) > 0)
+      {
+         ecp = mux_datagram(frame, n);
+         if (ecp == NULL)
+         {
+            continue;
+         }
+         slot = ecp->index / EC_MAXBUF;
+         ecp->index = ecp->index % EC_MAXBUF;
+         if ((slot == 0) && (outstanding > 0))
+         {
+            outstanding--;
+         }
+         if (!mux->client[slot].pid || !ecx_mux_put(&(mux->client[slot].rx), frame, n))
+         {
+            dropped++;
+         }
+      }
+      now = mux_us(&start);
+      /* real-time client first, without delay */
+      while ((n = ecx_mux_get(&(mux->client[0].tx), frame, sizeof(frame))) > 0)
+      {
+         if ((ecp = mux_datagram(frame, n)) == NULL)
+         {
+            continue;
+         }
+         /* first frame after an idle bus starts a new cycle */
+         if (outstanding == 0)
+         {
+            if (burst)
+            {
+               period = now - burst;
+            }
+            burst = now;
+         }
+         if (send(port.sockhandle, frame, n, 0) == n)
+         {
+            outstanding++;
+            rtframes++;
+         }
+         lastrt = now;
+      }
+      /* lost real-time frames do not block the bus forever */
+      if (outstanding && ((now - lastrt) > EC_TIMEOUTRET))
+      {
+         outstanding = 0;
+      }
+      /* other clients round robin in the gap before the next cycle */
+      idle = (outstanding == 0) && ((period == 0) || ((now - burst) + guard < period));
+      for (k = 1; idle && (k < EC_MUX_CLIENTS); k++)
+      {
+         slot = next;
+         next = (next % (EC_MUX_CLIENTS - 1)) + 1;
+         if (mux->client[slot].pid &&
+             ((n = ecx_mux_get(&(mux->client[slot].tx), frame, sizeof(frame))) > 0))
+         {
+            if ((ecp = mux_datagram(frame, n)) != NULL)
+            {
+               ecp->index = (uint8)((slot * EC_MAXBUF) + ecp->index);
+               send(port.sockhandle, frame, n, 0);
+               frames++;
+            }
+            /* one frame per gap check */
+            break;
+         }
+      }
+      if ((now - lastreap) > 1000000)
+      {
+         mux_reap();
+         lastreap = now;
+      }
+   }
+   printf("Real-time frames %d, other frames %d, dropped %d, cycle %dus\n",
+          rtframes, frames, dropped, (int)period);
+   mux->running = 0;
+   munmap(mux, sizeof(ec_muxshmt));
+   shm_unlink(name);
+   printf("End ecmux, close socket\n");
+   ecx_closenic(&port);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+
+   printf("SOEM (Simple Open EtherCAT Master)\nEcmux\n");
+
+   if (argc > 1)
+   {
+      for (i = 2; i < argc - 1; i++)
+      {
+         if (strcmp(argv[i], "-guard") == 0)
+         {
+            guard = atoi(argv[++i]);
+         }
+         else if (strcmp(argv[i], "-group") == 0)
+         {
+            group = argv[++i];
+         }
+      }
+      signal(SIGINT, mux_signal);
+      signal(SIGTERM, mux_signal);
+      ecmux(argv[1]);
+   }
+   else
+   {
+      printf("Usage: ecmux ifname [options]\nifname = eth0 for example\nOptions :\n"
+             " -guard us : time kept free before the next real-time cycle, default 200\n"
+             " -group name : let members of group attach, default owner only\n"
+             "Clients use ifname mux:eth0, the real-time client muxrt:eth0\n");
+   }
+
+   printf("End program\n");
+   return (0);
+}
@@ -3,11 +3,13 @@
  *
  * Usage : eepromtool ifname slave OPTION fname|alias
  * ifname is NIC interface, f.e. eth0
- * slave = slave number in EtherCAT order 1..n
+ * slave = slave number in EtherCAT order 1..n, or first-last for write
  * -r      read EEPROM, output binary format
  * -ri     read EEPROM, output Intel Hex format
  * -w      write EEPROM, input binary format
  * -wi     write EEPROM, input Intel Hex format
+ *         only words that differ are written, to all slaves in parallel,
+ *         the configuration CRC is recomputed
  * -i      display EEPROM information
  * -walias write slave alias in EEPROM
  *
@@ -40,6 +42,7 @@ uint8 ob;
 uint16 ow;
 int os;
 int slave;
+int lastslave;
 int alias;
 ec_timet tstart,tend, tdif;
 int wkc;
@@ -199,7 +202,7 @@ int output_intelhex(char *fname, int length)
    return 1;
 }
 
-int eeprom_read(int slave, int start, int length)
+int eeprom_read(int slave, int start, int length, uint8 *buf)
 {
    int i, ainc = 4;
    uint16 estat, aiadr;
@@ -225,14 +228,14 @@ int eeprom_read(int slave, int start, int length)
          for (i = start ; i < (start + length) ; i+=ainc)
          {
             b8 = ec_readeepromAP(aiadr, i >> 1 , EC_TIMEOUTEEP);
-            ebuf[i] = b8 & 0xFF;
-            ebuf[i+1] = (b8 >> 8) & 0xFF;
-            ebuf[i+2] = (b8 >> 16) & 0xFF;
-            ebuf[i+3] = (b8 >> 24) & 0xFF;
-            ebuf[i+4] = (b8 >> 32) & 0xFF;
-            ebuf[i+5] = (b8 >> 40) & 0xFF;
-            ebuf[i+6] = (b8 >> 48) & 0xFF;
-            ebuf[i+7] = (b8 >> 56) & 0xFF;
+            buf[i] = b8 & 0xFF;
+            buf[i+1] = (b8 >> 8) & 0xFF;
+            buf[i+2] = (b8 >> 16) & 0xFF;
+            buf[i+3] = (b8 >> 24) & 0xFF;
+            buf[i+4] = (b8 >> 32) & 0xFF;
+            buf[i+5] = (b8 >> 40) & 0xFF;
+            buf[i+6] = (b8 >> 48) & 0xFF;
+            buf[i+7] = (b8 >> 56) & 0xFF;
          }
       }
       else
@@ -240,10 +243,10 @@ int eeprom_read(int slave, int start, int length)
          for (i = start ; i < (start + length) ; i+=ainc)
          {
             b4 = ec_readeepromAP(aiadr, i >> 1 , EC_TIMEOUTEEP) & 0xFFFFFFFF;
-            ebuf[i] = b4 & 0xFF;
-            ebuf[i+1] = (b4 >> 8) & 0xFF;
-            ebuf[i+2] = (b4 >> 16) & 0xFF;
-            ebuf[i+3] = (b4 >> 24) & 0xFF;
+            buf[i] = b4 & 0xFF;
+            buf[i+1] = (b4 >> 8) & 0xFF;
+            buf[i+2] = (b4 >> 16) & 0xFF;
+            buf[i+3] = (b4 >> 24) & 0xFF;
          }
       }
 
@@ -253,37 +256,58 @@ int eeprom_read(int slave, int start, int length)
    return 0;
 }
 
-int eeprom_write(int slave, int start, int length)
+int eeprom_writechanged(int first, int last, int start, int length)
 {
-   int i, dc = 0;
-   uint16 aiadr, *wbuf;
-   uint8 eepctl;
+   ec_eepromwritet *job;
+   uint8 *cur;
+   int i, j, n, size, done;
 
-   if((ec_slavecount >= slave) && (slave > 0) && ((start + length) <= MAXBUF))
+   if ((first < 1) || (last > ec_slavecount) || (first > last) || ((start + length) > MAXBUF))
+      return 0;
+   n = last - first + 1;
+   /* room for reads of 8 bytes past the end */
+   size = start + length + 8;
+   job = calloc(n, sizeof(ec_eepromwritet));
+   cur = malloc(n * size);
+   if ((job == NULL) || (cur == NULL))
    {
-      aiadr = 1 - slave;
-      eepctl = 2;
-      ec_APWR(aiadr, ECT_REG_EEPCFG, sizeof(eepctl), &eepctl , EC_TIMEOUTRET); /* force Eeprom from PDI */
-      eepctl = 0;
-      ec_APWR(aiadr, ECT_REG_EEPCFG, sizeof(eepctl), &eepctl , EC_TIMEOUTRET); /* set Eeprom to master */
-
-      aiadr = 1 - slave;
-      wbuf = (uint16 *)&ebuf[0];
-      for (i = start ; i < (start + length) ; i+=2)
+      free(job);
+      free(cur);
+      return 0;
+   }
+   printf("Reading current contents");
+   fflush(stdout);
+   for (i = 0; i < n; i++)
+   {
+      /* eeprom_read also sets Eeprom to master */
+      if (!eeprom_read(first + i, start & ~1, length, &cur[i * size]))
       {
-         ec_writeeepromAP(aiadr, i >> 1 , *(wbuf + (i >> 1)), EC_TIMEOUTEEP);
-         if (++dc >= 100)
-         {
-            dc = 0;
-            printf(".");
-            fflush(stdout);
-         }
+         /* current contents unknown, make every word differ to write all */
+         printf(" Slave %d : read error, writing all words\n", first + i);
+         for (j = start & ~1; (j < size) && (j < MAXBUF); j++)
+            cur[(i * size) + j] = ~ebuf[j];
       }
-
-      return 1;
+      job[i].slave = (uint16)(first + i);
+      job[i].start = (uint16)(start & ~1);
+      job[i].length = (uint16)((length + 1) & ~1);
+      job[i].image = ebuf;
+      job[i].current = &cur[i * size];
+      printf(".");
+      fflush(stdout);
    }
+   printf("\nWriting changed words\n");
+   done = ec_writeeeprom_changed(job, n, EC_TIMEOUTEEP);
+   for (i = 0; i < n; i++)
+   {
+      if (job[i].written < 0)
+         printf(" Slave %d : write error\n", job[i].slave);
+      else
+         printf(" Slave %d : %d words written\n", job[i].slave, job[i].written);
+   }
+   free(job);
+   free(cur);
 
-   return 0;
+   return (done == n);
 }
 
 int eeprom_writealias(int slave, int alias, uint16 crc)
@@ -332,7 +356,7 @@ void eepromtool(char *ifname, int slave, int mode, char *fname)
             if ((mode == MODE_INFO) || (mode == MODE_READBIN) || (mode == MODE_READINTEL))
             {
                tstart = osal_current_time();
-               eeprom_read(slave, 0x0000, MINBUF); // read first 128 bytes
+               eeprom_read(slave, 0x0000, MINBUF, ebuf); // read first 128 bytes
 
                wbuf = (uint16 *)&ebuf[0];
                printf("Slave %d data\n", slave);
@@ -354,7 +378,7 @@ void eepromtool(char *ifname, int slave, int mode, char *fname)
             if ((mode == MODE_READBIN) || (mode == MODE_READINTEL))
             {
                if (esize > MINBUF)
-                  eeprom_read(slave, MINBUF, esize - MINBUF); // read reminder
+                  eeprom_read(slave, MINBUF, esize - MINBUF, ebuf); // read reminder
 
                tend = osal_current_time();
                osal_time_diff(&tstart, &tend, &tdif);
@@ -378,10 +402,9 @@ void eepromtool(char *ifname, int slave, int mode, char *fname)
                   printf(" Revision Number  : %8.8X\n",*(uint32 *)(wbuf + 0x0C));
                   printf(" Serial Number    : %8.8X\n",*(uint32 *)(wbuf + 0x0E));
 
-                  printf("Busy");
-                  fflush(stdout);
                   tstart = osal_current_time();
-                  eeprom_write(slave, estart, esize);
+                  if (!eeprom_writechanged(slave, lastslave, estart, esize))
+                     printf("EEPROM write failed\n");
                   tend = osal_current_time();
                   osal_time_diff(&tstart, &tend, &tdif);
 
@@ -392,7 +415,7 @@ void eepromtool(char *ifname, int slave, int mode, char *fname)
             }
             if (mode == MODE_WRITEALIAS)
             {
-               if( eeprom_read(slave, 0x0000, CRCBUF) ) // read first 14 bytes
+               if( eeprom_read(slave, 0x0000, CRCBUF, ebuf) ) // read first 14 bytes
                {
                   wbuf = (uint16 *)&ebuf[0];
                   *(wbuf + 0x04) = alias;
@@ -437,7 +460,8 @@ int main(int argc, char *argv[])
    mode = MODE_NONE;
    if (argc > 3)
    {
-      slave = atoi(argv[2]);
+      if (sscanf(argv[2], "%d-%d", &slave, &lastslave) < 2)
+         lastslave = slave;
       if ((strncmp(argv[3], "-i", sizeof("-i")) == 0))   mode = MODE_INFO;
       if (argc > 4)
       {
@@ -458,13 +482,14 @@ int main(int argc, char *argv[])
    {
       printf("Usage: eepromtool ifname slave OPTION fname|alias\n");
       printf("ifname = eth0 for example\n");
-      printf("slave = slave number in EtherCAT order 1..n\n");
+      printf("slave = slave number in EtherCAT order 1..n, first-last for -w and -wi\n");
       printf("    -i      display EEPROM information\n");
       printf("    -walias write slave alias\n");
       printf("    -r      read EEPROM, output binary format\n");
       printf("    -ri     read EEPROM, output Intel Hex format\n");
       printf("    -w      write EEPROM, input binary format\n");
       printf("    -wi     write EEPROM, input Intel Hex format\n");
+      printf("            -w and -wi only write changed words\n");
    }
 
    printf("End program\n");
@@ -0,0 +1,192 @@
+/** \file
+ * \brief Example code for Simple Open EtherCAT master
+ *
+ * Usage : enitool ifname [-eni file] [-bin file] [-load file]
+ * Ifname is NIC interface, f.e. eth0.
+ * -eni writes the discovered configuration as ENI XML.
+ * -bin writes the discovered configuration as compact binary.
+ * -load configures the bus from an ENI or compact binary file instead of
+ *  discovering it.
+ *
+ * The bus is configured and mapped, and the time for the configuration is
+ * shown, so discovery and a configuration file can be compared.
+ *
+ * (c)Arthur Ketels 2010 - 2011
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ethercat.h"
+
+#define ENI_MAXFILE  (4 * 1024 * 1024)
+
+char IOmap[4096];
+ec_enit eni;
+char filebuf[ENI_MAXFILE];
+
+int eni_readfile(const char *name)
+{
+   FILE *fp;
+   int size;
+
+   fp = fopen(name, "rb");
+   if (fp == NULL)
+   {
+      printf("Can not open %s\n", name);
+      return 0;
+   }
+   size = (int)fread(filebuf, 1, sizeof(filebuf), fp);
+   fclose(fp);
+   return size;
+}
+
+int eni_writefile(const char *name, const void *data, int size)
+{
+   FILE *fp;
+
+   fp = fopen(name, "wb");
+   if ((fp == NULL) || (fwrite(data, 1, size, fp) != (size_t)size))
+   {
+      printf("Can not write %s\n", name);
+      if (fp)
+      {
+         fclose(fp);
+      }
+      return 1;
+   }
+   fclose(fp);
+   printf("Written %s, %d bytes\n", name, size);
+   return 0;
+}
+
+int eni_load(const char *name)
+{
+   int size, rval;
+
+   size = eni_readfile(name);
+   if (size <= 0)
+   {
+      return -1;
+   }
+   if ((size >= 4) && (memcmp(filebuf, "ECFG", 4) == 0))
+   {
+      rval = ec_config_load(&eni, (uint8 *)filebuf, size);
+   }
+   else
+   {
+      rval = ec_eni_parse(&eni, filebuf, size);
+   }
+   if (rval < 0)
+   {
+      printf("Error %d loading %s, line %d\n", rval, name, eni.errorline);
+   }
+   else
+   {
+      printf("%s: %d slaves, %d init commands, %d CoE init commands, %d PDO entries\n",
+             name, eni.slavecount, eni.initcmdcount, eni.coecmdcount, eni.pdoentrycount);
+   }
+   return rval;
+}
+
+int enitool(char *ifname, char *enifile, char *binfile, char *loadfile)
+{
+   ec_timet tstart, tend, tdiff;
+   int cnt, size, rval = 0;
+
+   printf("Starting enitool\n");
+
+   /* initialise SOEM, bind socket to ifname */
+   if (!ec_init(ifname))
+   {
+      printf("No socket connection on %s\nExecute as root\n", ifname);
+      return 1;
+   }
+   printf("ec_init on %s succeeded.\n", ifname);
+   if (loadfile && (eni_load(loadfile) < 0))
+   {
+      ec_close();
+      return 1;
+   }
+   tstart = osal_current_time();
+   if (loadfile)
+   {
+      cnt = ec_config_eni(&eni);
+   }
+   else
+   {
+      cnt = ec_config_init(FALSE);
+   }
+   if (cnt > 0)
+   {
+      ec_config_map(&IOmap);
+      tend = osal_current_time();
+      osal_time_diff(&tstart, &tend, &tdiff);
+      printf("%d slaves configured and mapped in %d us by %s\n", cnt,
+             (int)((tdiff.sec * 1000000) + tdiff.usec), loadfile ? "configuration file" : "discovery");
+      for (cnt = 1; cnt <= ec_slavecount; cnt++)
+      {
+         printf("Slave %d %s, configadr %4.4x, O:%d I:%d, %d PDO entries\n", cnt, ec_slave[cnt].name,
+                ec_slave[cnt].configadr, ec_slave[cnt].Obits, ec_slave[cnt].Ibits, ec_slave[cnt].npdoentry);
+      }
+      if (enifile)
+      {
+         size = ec_eni_export(filebuf, sizeof(filebuf));
+         rval |= (size < (int)sizeof(filebuf)) ? eni_writefile(enifile, filebuf, size) : 1;
+      }
+      if (binfile)
+      {
+         size = ec_config_export((uint8 *)filebuf, sizeof(filebuf));
+         rval |= size ? eni_writefile(binfile, filebuf, size) : 1;
+      }
+      ec_slave[0].state = EC_STATE_INIT;
+      ec_writestate(0);
+   }
+   else
+   {
+      printf("Configuration failed: %d\n", cnt);
+      rval = 1;
+   }
+   printf("End enitool, close socket\n");
+   ec_close();
+   return rval;
+}
+
+int main(int argc, char *argv[])
+{
+   char *enifile = NULL, *binfile = NULL, *loadfile = NULL;
+   int i, rval = 0;
+
+   printf("SOEM (Simple Open EtherCAT Master)\nENI tool\n");
+
+   if (argc > 1)
+   {
+      for (i = 2; i < argc - 1; i++)
+      {
+         if (strcmp(argv[i], "-eni") == 0)
+         {
+            enifile = argv[++i];
+         }
+         else if (strcmp(argv[i], "-bin") == 0)
+         {
+            binfile = argv[++i];
+         }
+         else if (strcmp(argv[i], "-load") == 0)
+         {
+            loadfile = argv[++i];
+         }
+      }
+      rval = enitool(argv[1], enifile, binfile, loadfile);
+   }
+   else
+   {
+      printf("Usage: enitool ifname [options]\nifname = eth0 for example\nOptions :\n"
+             " -eni file : write configuration as ENI XML\n"
+             " -bin file : write configuration as compact binary\n"
+             " -load file : configure from ENI or compact binary file instead of discovery\n");
+   }
+
+   printf("End program\n");
+   return (rval);
+}
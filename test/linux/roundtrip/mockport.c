@@ -0,0 +1,589 @@
+/** \file
+ * \brief Scripted EtherCAT bus for the roundtrip test
+ *
+ * Simulates a fixed reference topology of three slaves on one end of a
+ * socket pair:
+ * 1 MockCoupler, DC, no mailbox and no process data.
+ * 2 MockDI8, 8 inputs on SM0, mapping from SII.
+ * 3 MockDrive, DC, CoE with PDO assign and mapping in the object dictionary,
+ *   control word and target position out, status word and actual position in.
+ *
+ * Each slave holds its ESC registers and process memory in one array. Frames
+ * are handled datagram by datagram like an ESC would on the wire: register
+ * access, auto increment, configured and broadcast addressing, byte granular
+ * FMMU mapping for logical commands and the working counter rules. Side
+ * effects are limited to what SOEM needs: AL control to AL status, EEPROM
+ * read commands, and a CoE mailbox that answers expedited SDO requests.
+ *
+ * Anything not simulated just reads back what was written.
+ *
+ * (c)Arthur Ketels 2010 - 2011
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "ethercat.h"
+#include "mockport.h"
+
+#define MOCK_NSLAVE    3
+#define MOCK_MEMSIZE   0x2000
+#define MOCK_SIISIZE   512
+#define MOCK_MAXOBJ    32
+
+typedef struct
+{
+   uint16 index;
+   uint8 sub;
+   uint8 size;
+   boolean writable;
+   uint32 value;
+} mock_objectt;
+
+typedef struct
+{
+   const char *name;
+   uint32 man;
+   uint32 id;
+   uint32 rev;
+   boolean hasdc;
+   uint16 mbxproto;
+   uint8 coedetails;
+   /* SII SM category, 8 bytes per SM */
+   const uint8 *sm;
+   int lsm;
+   /* SII FMMU category, one function per FMMU */
+   const uint8 *fmmu;
+   int lfmmu;
+   /* SII TxPDO category */
+   const uint8 *txpdo;
+   int ltxpdo;
+   const mock_objectt *od;
+   int nod;
+} mock_scriptt;
+
+typedef struct
+{
+   const mock_scriptt *script;
+   uint8 mem[MOCK_MEMSIZE];
+   uint8 sii[MOCK_SIISIZE];
+   uint8 mbxcnt;
+   mock_objectt od[MOCK_MAXOBJ];
+} mock_slavet;
+
+static const uint8 di8_sm[] =
+{
+   0x00, 0x10, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00
+};
+static const uint8 di8_fmmu[] = { 0x02, 0xff };
+static const uint8 di8_txpdo[] =
+{
+   0x00, 0x1a, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+   0x00, 0x60, 0x01, 0x00, 0x07, 0x08, 0x00, 0x00
+};
+
+static const uint8 drive_sm[] =
+{
+   0x00, 0x10, 0x80, 0x00, 0x26, 0x00, 0x01, 0x00,
+   0x80, 0x10, 0x80, 0x00, 0x22, 0x00, 0x01, 0x00,
+   0x00, 0x11, 0x00, 0x00, 0x64, 0x00, 0x01, 0x00,
+   0x80, 0x11, 0x00, 0x00, 0x20, 0x00, 0x01, 0x00
+};
+static const uint8 drive_fmmu[] = { 0x01, 0x02, 0x03, 0xff };
+static const mock_objectt drive_od[] =
+{
+   { 0x1000, 0, 4, FALSE, 0x00020192 },
+   { 0x1c00, 0, 1, FALSE, 4 },
+   { 0x1c00, 1, 1, FALSE, 1 },
+   { 0x1c00, 2, 1, FALSE, 2 },
+   { 0x1c00, 3, 1, FALSE, 3 },
+   { 0x1c00, 4, 1, FALSE, 4 },
+   { 0x1c12, 0, 1, FALSE, 1 },
+   { 0x1c12, 1, 2, FALSE, 0x1600 },
+   { 0x1c13, 0, 1, FALSE, 1 },
+   { 0x1c13, 1, 2, FALSE, 0x1a00 },
+   { 0x1600, 0, 1, FALSE, 2 },
+   { 0x1600, 1, 4, FALSE, 0x60400010 },
+   { 0x1600, 2, 4, FALSE, 0x607a0020 },
+   { 0x1a00, 0, 1, FALSE, 2 },
+   { 0x1a00, 1, 4, FALSE, 0x60410010 },
+   { 0x1a00, 2, 4, FALSE, 0x60640020 },
+   { 0x6060, 0, 1, TRUE, 8 }
+};
+
+static const mock_scriptt mock_bus[MOCK_NSLAVE] =
+{
+   { "MockCoupler", 0x00000002, 0x044c2c52, 0x00110000, TRUE, 0, 0,
+     NULL, 0, NULL, 0, NULL, 0, NULL, 0 },
+   { "MockDI8", 0x00000002, 0x03ec3052, 0x00100000, FALSE, 0, 0,
+     di8_sm, sizeof(di8_sm), di8_fmmu, sizeof(di8_fmmu),
+     di8_txpdo, sizeof(di8_txpdo), NULL, 0 },
+   { "MockDrive", 0x00000539, 0x02200001, 0x00000001, TRUE, ECT_MBXPROT_COE, ECT_COEDET_SDO,
+     drive_sm, sizeof(drive_sm), drive_fmmu, sizeof(drive_fmmu),
+     NULL, 0, drive_od, sizeof(drive_od) / sizeof(drive_od[0]) }
+};
+
+static mock_slavet mock_slave[MOCK_NSLAVE];
+static OSAL_THREAD_HANDLE mock_thread;
+static int mock_fd[2] = { -1, -1 };
+
+static uint16 mock_get16(const uint8 *p)
+{
+   return (uint16)(p[0] | (p[1] << 8));
+}
+
+static void mock_put16(uint8 *p, uint16 v)
+{
+   p[0] = LO_BYTE(v);
+   p[1] = HI_BYTE(v);
+}
+
+static uint32 mock_get32(const uint8 *p)
+{
+   return (uint32)mock_get16(p) | ((uint32)mock_get16(p + 2) << 16);
+}
+
+static void mock_put32(uint8 *p, uint32 v)
+{
+   mock_put16(p, LO_WORD(v));
+   mock_put16(p + 2, HI_WORD(v));
+}
+
+/** Append one category to the SII image.
+ * @param[in]  sii   = SII image
+ * @param[in]  a     = byte address of the category, updated to the next one
+ * @param[in]  type  = category type
+ * @param[in]  data  = category data
+ * @param[in]  len   = length of data in bytes
+ */
+static void mock_siicat(uint8 *sii, int *a, uint16 type, const uint8 *data, int len)
+{
+   mock_put16(sii + *a, type);
+   mock_put16(sii + *a + 2, (uint16)((len + 1) / 2));
+   memcpy(sii + *a + 4, data, len);
+   *a += 4 + ((len + 1) & ~1);
+}
+
+static void mock_siibuild(mock_slavet *s, uint16 position)
+{
+   const mock_scriptt *sc = s->script;
+   uint8 cat[32];
+   int a, l;
+
+   memset(s->sii, 0, sizeof(s->sii));
+   mock_put32(s->sii + (ECT_SII_MANUF << 1), sc->man);
+   mock_put32(s->sii + (ECT_SII_ID << 1), sc->id);
+   mock_put32(s->sii + (ECT_SII_REV << 1), sc->rev);
+   mock_put32(s->sii + (ECT_SII_SERIAL << 1), position);
+   if (sc->mbxproto)
+   {
+      /* SM0 and SM1 from the SM category are the mailboxes */
+      memcpy(s->sii + (ECT_SII_RXMBXADR << 1), sc->sm, 4);
+      memcpy(s->sii + (ECT_SII_TXMBXADR << 1), sc->sm + 8, 4);
+      mock_put16(s->sii + (ECT_SII_MBXPROTO << 1), sc->mbxproto);
+   }
+   a = ECT_SII_START << 1;
+   l = (int)strlen(sc->name);
+   cat[0] = 1;
+   cat[1] = (uint8)l;
+   memcpy(cat + 2, sc->name, l);
+   mock_siicat(s->sii, &a, ECT_SII_STRING, cat, l + 2);
+   memset(cat, 0, sizeof(cat));
+   cat[3] = 1; /* name string */
+   cat[5] = sc->coedetails;
+   mock_siicat(s->sii, &a, ECT_SII_GENERAL, cat, sizeof(cat));
+   if (sc->fmmu)
+   {
+      mock_siicat(s->sii, &a, ECT_SII_FMMU, sc->fmmu, sc->lfmmu);
+   }
+   if (sc->sm)
+   {
+      mock_siicat(s->sii, &a, ECT_SII_SM, sc->sm, sc->lsm);
+   }
+   if (sc->txpdo)
+   {
+      mock_siicat(s->sii, &a, ECT_SII_PDO, sc->txpdo, sc->ltxpdo);
+   }
+   mock_put16(s->sii + a, 0xffff);
+}
+
+static void mock_reset(void)
+{
+   mock_slavet *s;
+   const mock_scriptt *sc;
+   int i;
+
+   for (i = 0; i < MOCK_NSLAVE; i++)
+   {
+      s = &mock_slave[i];
+      sc = &mock_bus[i];
+      memset(s, 0, sizeof(*s));
+      s->script = sc;
+      mock_siibuild(s, (uint16)(i + 1));
+      if (sc->od)
+      {
+         memcpy(s->od, sc->od, sc->nod * sizeof(mock_objectt));
+      }
+      s->mem[ECT_REG_TYPE] = 0x11;
+      mock_put16(s->mem + ECT_REG_ESCSUP, sc->hasdc ? 0x0004 : 0x0000);
+      /* port 0 towards the master, port 1 open unless last */
+      mock_put16(s->mem + ECT_REG_DLSTAT,
+                 (i < (MOCK_NSLAVE - 1)) ? 0x0a00 : 0x0200);
+      mock_put16(s->mem + ECT_REG_ALSTAT, EC_STATE_INIT);
+      mock_put16(s->mem + ECT_REG_PDICTL, 0x0005);
+   }
+}
+
+static mock_objectt *mock_object(mock_slavet *s, uint16 index, uint8 sub)
+{
+   int i;
+
+   for (i = 0; i < MOCK_MAXOBJ; i++)
+   {
+      if ((s->od[i].size) && (s->od[i].index == index) && (s->od[i].sub == sub))
+      {
+         return &s->od[i];
+      }
+   }
+   return NULL;
+}
+
+/** Answer the request in the SM0 mailbox in SM1 and mark SM1 full. Only
+ * expedited SDO upload and download are supported, the rest is aborted.
+ */
+static void mock_mailbox(mock_slavet *s)
+{
+   uint8 *req, *rsp;
+   mock_objectt *obj;
+   uint16 index;
+   uint8 cmd, sub, size;
+   uint32 abort = 0;
+
+   req = s->mem + mock_get16(s->mem + ECT_REG_SM0);
+   rsp = s->mem + mock_get16(s->mem + ECT_REG_SM1);
+   if (((req[5] & 0x0f) != ECT_MBXT_COE) ||
+       ((mock_get16(req + 6) >> 12) != ECT_COES_SDOREQ))
+   {
+      return;
+   }
+   cmd = req[8];
+   index = mock_get16(req + 9);
+   sub = req[11];
+   memset(rsp, 0, mock_get16(s->mem + ECT_REG_SM1 + 2));
+   mock_put16(rsp, 10);
+   s->mbxcnt = (uint8)((s->mbxcnt % 7) + 1);
+   rsp[5] = (uint8)(ECT_MBXT_COE + (s->mbxcnt << 4));
+   mock_put16(rsp + 6, ECT_COES_SDORES << 12);
+   mock_put16(rsp + 9, index);
+   rsp[11] = sub;
+   obj = mock_object(s, index, sub);
+   if (obj == NULL)
+   {
+      abort = 0x06020000; /* object does not exist */
+   }
+   else if ((cmd & 0xe0) == ECT_SDO_UP_REQ)
+   {
+      rsp[8] = (uint8)(0x43 | ((4 - obj->size) << 2));
+      mock_put32(rsp + 12, obj->value);
+   }
+   else if ((cmd & 0xe3) == ECT_SDO_DOWN_EXP)
+   {
+      size = (uint8)(4 - ((cmd >> 2) & 0x03));
+      if (!obj->writable)
+      {
+         abort = 0x06010002; /* attempt to write a read only object */
+      }
+      else if (size != obj->size)
+      {
+         abort = 0x06070010; /* data type does not match */
+      }
+      else
+      {
+         obj->value = mock_get32(req + 12) & (0xffffffffU >> ((4 - size) * 8));
+         rsp[8] = 0x60;
+      }
+   }
+   else
+   {
+      abort = 0x05040001; /* command specifier not valid */
+   }
+   if (abort)
+   {
+      mock_put16(rsp + 6, ECT_COES_SDOREQ << 12);
+      rsp[8] = ECT_SDO_ABORT;
+      mock_put32(rsp + 12, abort);
+   }
+   s->mem[ECT_REG_SM1STAT] |= 0x08;
+}
+
+static int mock_covers(uint16 ado, uint16 len, uint16 reg)
+{
+   return (reg >= ado) && (reg < (ado + len));
+}
+
+static void mock_written(mock_slavet *s, uint16 ado, uint16 len)
+{
+   uint16 eaddr;
+
+   if (mock_covers(ado, len, ECT_REG_ALCTL))
+   {
+      mock_put16(s->mem + ECT_REG_ALSTAT, mock_get16(s->mem + ECT_REG_ALCTL) & 0x0f);
+      mock_put16(s->mem + ECT_REG_ALSTATCODE, 0);
+   }
+   if (mock_covers(ado, len, ECT_REG_EEPCTL) &&
+       ((mock_get16(s->mem + ECT_REG_EEPCTL) & 0x0700) == EC_ECMD_READ))
+   {
+      eaddr = (uint16)(mock_get16(s->mem + ECT_REG_EEPADR) << 1);
+      memset(s->mem + ECT_REG_EEPDAT, 0, 8);
+      if (eaddr < (MOCK_SIISIZE - 8))
+      {
+         memcpy(s->mem + ECT_REG_EEPDAT, s->sii + eaddr, 8);
+      }
+      mock_put16(s->mem + ECT_REG_EEPSTAT, 0);
+   }
+   if (s->script->mbxproto && (ado == mock_get16(s->mem + ECT_REG_SM0)))
+   {
+      mock_mailbox(s);
+   }
+}
+
+static void mock_read(mock_slavet *s, uint16 ado, uint16 len)
+{
+   if (s->script->mbxproto && len && (ado == mock_get16(s->mem + ECT_REG_SM1)))
+   {
+      s->mem[ECT_REG_SM1STAT] &= ~0x08;
+   }
+}
+
+/** Physical register access of one slave.
+ * @param[in]  s     = slave
+ * @param[in]  cmd   = datagram command
+ * @param[in]  ado   = register address
+ * @param[in]  data  = datagram data
+ * @param[in]  len   = datagram data length
+ * @param[in]  wkc   = working counter, updated
+ */
+static void mock_access(mock_slavet *s, uint8 cmd, uint16 ado, uint8 *data, uint16 len, uint16 *wkc)
+{
+   uint8 old[EC_MAXECATFRAME];
+   int i;
+
+   if ((ado + len) > MOCK_MEMSIZE)
+   {
+      return;
+   }
+   switch (cmd)
+   {
+      case EC_CMD_APRD:
+      case EC_CMD_FPRD:
+      case EC_CMD_ARMW:
+      case EC_CMD_FRMW:
+         memcpy(data, s->mem + ado, len);
+         mock_read(s, ado, len);
+         *wkc += 1;
+         break;
+      case EC_CMD_BRD:
+         for (i = 0; i < len; i++)
+         {
+            data[i] |= s->mem[ado + i];
+         }
+         mock_read(s, ado, len);
+         *wkc += 1;
+         break;
+      case EC_CMD_APWR:
+      case EC_CMD_FPWR:
+      case EC_CMD_BWR:
+         memcpy(s->mem + ado, data, len);
+         mock_written(s, ado, len);
+         *wkc += 1;
+         break;
+      case EC_CMD_APRW:
+      case EC_CMD_FPRW:
+      case EC_CMD_BRW:
+         memcpy(old, s->mem + ado, len);
+         memcpy(s->mem + ado, data, len);
+         memcpy(data, old, len);
+         mock_read(s, ado, len);
+         mock_written(s, ado, len);
+         *wkc += 3;
+         break;
+      default:
+         break;
+   }
+}
+
+/** Logical access of one slave through its FMMUs, byte granular. */
+static void mock_logical(mock_slavet *s, uint8 cmd, uint32 lad, uint8 *data, uint16 len, uint16 *wkc)
+{
+   uint8 *fmmu;
+   uint32 logstart, l;
+   uint16 loglength, phys;
+   int i, rd = 0, wr = 0;
+
+   for (i = 0; i < 16; i++)
+   {
+      fmmu = s->mem + ECT_REG_FMMU0 + (i * sizeof(ec_fmmut));
+      logstart = mock_get32(fmmu);
+      loglength = mock_get16(fmmu + 4);
+      phys = mock_get16(fmmu + 8);
+      if (!fmmu[12] || !loglength)
+      {
+         continue;
+      }
+      for (l = lad; l < (lad + len); l++)
+      {
+         if ((l < logstart) || (l >= (logstart + loglength)) ||
+             ((phys + (l - logstart)) >= MOCK_MEMSIZE))
+         {
+            continue;
+         }
+         if ((fmmu[11] == 1) && (cmd != EC_CMD_LWR))
+         {
+            data[l - lad] = s->mem[phys + (l - logstart)];
+            rd = 1;
+         }
+         if ((fmmu[11] == 2) && (cmd != EC_CMD_LRD))
+         {
+            s->mem[phys + (l - logstart)] = data[l - lad];
+            wr = 1;
+         }
+      }
+   }
+   if (cmd == EC_CMD_LRW)
+   {
+      *wkc += (uint16)(rd + (wr * 2));
+   }
+   else
+   {
+      *wkc += (uint16)(rd | wr);
+   }
+}
+
+/** Pass one frame through all slaves.
+ * @param[in]  frame = ethernet frame, updated in place
+ * @param[in]  n     = frame length
+ */
+static void mock_frame(uint8 *frame, int n)
+{
+   mock_slavet *s;
+   uint8 *dg, *data, cmd;
+   uint16 adp, ado, dlength, len, wkc;
+   int p, i;
+
+   p = ETH_HEADERSIZE + sizeof(uint16);
+   do
+   {
+      dg = frame + p;
+      cmd = dg[0];
+      adp = mock_get16(dg + 2);
+      ado = mock_get16(dg + 4);
+      dlength = mock_get16(dg + 6);
+      len = dlength & 0x07ff;
+      data = dg + EC_HEADERSIZE - sizeof(uint16);
+      if ((data + len + EC_WKCSIZE) > (frame + n))
+      {
+         return;
+      }
+      wkc = mock_get16(data + len);
+      for (i = 0; i < MOCK_NSLAVE; i++)
+      {
+         s = &mock_slave[i];
+         switch (cmd)
+         {
+            case EC_CMD_APRD:
+            case EC_CMD_APWR:
+            case EC_CMD_APRW:
+               if (adp == 0)
+               {
+                  mock_access(s, cmd, ado, data, len, &wkc);
+               }
+               adp++;
+               break;
+            case EC_CMD_FPRD:
+            case EC_CMD_FPWR:
+            case EC_CMD_FPRW:
+               if (adp == mock_get16(s->mem + ECT_REG_STADR))
+               {
+                  mock_access(s, cmd, ado, data, len, &wkc);
+               }
+               break;
+            case EC_CMD_BRD:
+            case EC_CMD_BWR:
+            case EC_CMD_BRW:
+               mock_access(s, cmd, ado, data, len, &wkc);
+               adp++;
+               break;
+            case EC_CMD_LRD:
+            case EC_CMD_LWR:
+            case EC_CMD_LRW:
+               mock_logical(s, cmd, (uint32)adp | ((uint32)ado << 16), data, len, &wkc);
+               break;
+            case EC_CMD_ARMW:
+               /* addressed slave reads, all others write */
+               mock_access(s, (adp == 0) ? EC_CMD_APRD : EC_CMD_APWR, ado, data, len, &wkc);
+               adp++;
+               break;
+            case EC_CMD_FRMW:
+               mock_access(s, (adp == mock_get16(s->mem + ECT_REG_STADR)) ? EC_CMD_FPRD : EC_CMD_FPWR,
+                           ado, data, len, &wkc);
+               break;
+            default:
+               break;
+         }
+      }
+      mock_put16(dg + 2, adp);
+      mock_put16(data + len, wkc);
+      p += EC_HEADERSIZE - sizeof(uint16) + len + EC_WKCSIZE;
+   }
+   while ((dlength & 0x8000) && (p < n));
+}
+
+OSAL_THREAD_FUNC mock_serve(void *param)
+{
+   uint8 frame[EC_BUFSIZE];
+   int n;
+
+   (void)param;
+   while ((n = (int)recv(mock_fd[1], frame, sizeof(frame), 0)) > 0)
+   {
+      mock_frame(frame, n);
+      if (send(mock_fd[1], frame, n, 0) != n)
+      {
+         break;
+      }
+   }
+}
+
+/** Start the bus.
+ * @return socket for the master side, use as "sock:<fd>", -1 on error
+ */
+int mock_start(void)
+{
+   mock_reset();
+   if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, mock_fd) < 0)
+   {
+      return -1;
+   }
+   if (!osal_thread_create(&mock_thread, 128000, &mock_serve, NULL))
+   {
+      close(mock_fd[0]);
+      close(mock_fd[1]);
+      mock_fd[0] = -1;
+      return -1;
+   }
+   return mock_fd[0];
+}
+
+/** Stop the bus, call after ec_close. */
+void mock_stop(void)
+{
+   if (mock_fd[0] >= 0)
+   {
+      shutdown(mock_fd[1], SHUT_RDWR);
+      osal_thread_join(&mock_thread);
+      close(mock_fd[1]);
+      mock_fd[0] = -1;
+   }
+}
@@ -0,0 +1,25 @@
+/** \file
+ * \brief Scripted EtherCAT bus for the roundtrip test
+ *
+ * The bus answers EtherCAT frames on one end of a socket pair, the other
+ * end is handed to SOEM with the "sock:" ifname prefix.
+ *
+ * (c)Arthur Ketels 2010 - 2011
+ */
+
+#ifndef _mockport_
+#define _mockport_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+int mock_start(void);
+void mock_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,280 @@
+/** \file
+ * \brief Example code for Simple Open EtherCAT master
+ *
+ * Usage : roundtrip ifname [-slave n] [-sdo index:sub] [-save file] [-check file]
+ * Ifname is NIC interface, f.e. eth0, or mock for the scripted reference bus
+ * in mockport.c.
+ * -slave sets the slave used for SDO access and recovery, default 1.
+ * -sdo sets the object read and written back by the SDO steps, default 0x1000:0
+ *  read only. Give a writable object to include ecx_SDOwrite.
+ * -save writes the measured frames and datagrams as budget file.
+ * -check compares the measured frames and datagrams with a budget file.
+ *
+ * This counts the frames and datagrams each library call puts on the bus.
+ * Run it on a reference topology and save the result as budget, later runs
+ * with -check fail when a change to SOEM needs more round trips. The budget
+ * of the mock bus, reference.budget, is checked by ctest.
+ *
+ * (c)Arthur Ketels 2010 - 2011
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ethercat.h"
+#include "mockport.h"
+
+#define RT_MAXSTEP   16
+#define RT_CYCLES    100
+
+typedef struct
+{
+   const char *name;
+   uint32 frames;
+   uint32 datagrams;
+   int32 us;
+} rt_stept;
+
+char IOmap[4096];
+rt_stept step[RT_MAXSTEP];
+int nstep = 0;
+ec_timet tstart;
+
+void rt_begin(void)
+{
+   ecx_port.txframes = 0;
+   ecx_port.txdatagrams = 0;
+   tstart = osal_current_time();
+}
+
+void rt_end(const char *name, uint32 calls)
+{
+   ec_timet tend, tdiff;
+
+   if (nstep >= RT_MAXSTEP)
+   {
+      return;
+   }
+   tend = osal_current_time();
+   osal_time_diff(&tstart, &tend, &tdiff);
+   if (calls == 0)
+   {
+      calls = 1;
+   }
+   step[nstep].name = name;
+   step[nstep].frames = ecx_port.txframes / calls;
+   step[nstep].datagrams = ecx_port.txdatagrams / calls;
+   step[nstep].us = (int32)(((tdiff.sec * 1000000) + tdiff.usec) / calls);
+   nstep++;
+}
+
+void roundtrip(char *ifname, uint16 slave, uint16 index, uint8 sub)
+{
+   uint8 sdo[64];
+   int size, wkc, i;
+
+   printf("Starting roundtrip\n");
+
+   /* initialise SOEM, bind socket to ifname */
+   if (ec_init(ifname))
+   {
+      printf("ec_init on %s succeeded.\n", ifname);
+      rt_begin();
+      if (ec_config_init(FALSE) > 0)
+      {
+         rt_end("config_init", 1);
+         printf("%d slaves found.\n", ec_slavecount);
+         rt_begin();
+         ec_config_map(&IOmap);
+         rt_end("config_map_group", 1);
+         rt_begin();
+         ec_configdc();
+         rt_end("configdc", 1);
+         ec_statecheck(0, EC_STATE_SAFE_OP, EC_TIMEOUTSTATE * 4);
+         rt_begin();
+         ec_readstate();
+         rt_end("readstate", 1);
+         if ((slave <= ec_slavecount) && (ec_slave[slave].mbx_proto & ECT_MBXPROT_COE))
+         {
+            size = sizeof(sdo);
+            rt_begin();
+            wkc = ec_SDOread(slave, index, sub, FALSE, &size, sdo, EC_TIMEOUTRXM);
+            rt_end("SDOread", 1);
+            /* default object is read only, write back only what is asked for */
+            if ((wkc > 0) && (index != 0x1000))
+            {
+               rt_begin();
+               ec_SDOwrite(slave, index, sub, FALSE, size, sdo, EC_TIMEOUTRXM);
+               rt_end("SDOwrite", 1);
+            }
+         }
+         if (slave <= ec_slavecount)
+         {
+            rt_begin();
+            ec_recover_slave(slave, EC_TIMEOUTRET3);
+            rt_end("recover_slave", 1);
+         }
+         rt_begin();
+         for (i = 0; i < RT_CYCLES; i++)
+         {
+            ec_send_processdata();
+            ec_receive_processdata(EC_TIMEOUTRET);
+         }
+         rt_end("processdata", RT_CYCLES);
+         while (EcatError) printf("%s", ec_elist2string());
+         ec_slave[0].state = EC_STATE_INIT;
+         ec_writestate(0);
+      }
+      else
+      {
+         printf("No slaves found!\n");
+      }
+      printf("End roundtrip, close socket\n");
+      /* stop SOEM, close socket */
+      ec_close();
+   }
+   else
+   {
+      printf("No socket connection on %s\nExcecute as root\n", ifname);
+   }
+}
+
+int rt_save(const char *file)
+{
+   FILE *fp;
+   int i;
+
+   fp = fopen(file, "w");
+   if (fp == NULL)
+   {
+      printf("Can not write %s\n", file);
+      return 1;
+   }
+   fprintf(fp, "# step frames datagrams\n");
+   for (i = 0; i < nstep; i++)
+   {
+      fprintf(fp, "%s %u %u\n", step[i].name, step[i].frames, step[i].datagrams);
+   }
+   fclose(fp);
+   return 0;
+}
+
+int rt_check(const char *file)
+{
+   FILE *fp;
+   char line[256], name[64];
+   unsigned int frames, datagrams;
+   int i, fail = 0;
+
+   fp = fopen(file, "r");
+   if (fp == NULL)
+   {
+      printf("Can not read %s\n", file);
+      return 1;
+   }
+   while (fgets(line, sizeof(line), fp))
+   {
+      if ((line[0] == '#') || (sscanf(line, "%63s %u %u", name, &frames, &datagrams) != 3))
+      {
+         continue;
+      }
+      i = 0;
+      while ((i < nstep) && strcmp(step[i].name, name))
+      {
+         i++;
+      }
+      if (i == nstep)
+      {
+         printf("%-16s not measured\n", name);
+         fail = 1;
+      }
+      else if ((step[i].frames > frames) || (step[i].datagrams > datagrams))
+      {
+         printf("%-16s over budget, frames %u/%u datagrams %u/%u\n", name,
+                step[i].frames, frames, step[i].datagrams, datagrams);
+         fail = 1;
+      }
+   }
+   fclose(fp);
+   printf("Budget %s\n", fail ? "exceeded" : "met");
+   return fail;
+}
+
+int main(int argc, char *argv[])
+{
+   char *save = NULL, *check = NULL;
+   char sockname[32];
+   char *ifname;
+   int i, fd, rval = 0;
+   unsigned int index = 0x1000, sub = 0;
+   uint16 slave = 1;
+
+   printf("SOEM (Simple Open EtherCAT Master)\nRoundtrip\n");
+
+   if (argc > 1)
+   {
+      for (i = 2; i < argc - 1; i++)
+      {
+         if (strcmp(argv[i], "-slave") == 0)
+         {
+            slave = (uint16)atoi(argv[++i]);
+         }
+         else if ((strcmp(argv[i], "-sdo") == 0) &&
+                  (sscanf(argv[i + 1], "%x:%u", &index, &sub) == 2))
+         {
+            i++;
+         }
+         else if (strcmp(argv[i], "-save") == 0)
+         {
+            save = argv[++i];
+         }
+         else if (strcmp(argv[i], "-check") == 0)
+         {
+            check = argv[++i];
+         }
+      }
+      ifname = argv[1];
+      fd = -1;
+      if (strcmp(ifname, "mock") == 0)
+      {
+         fd = mock_start();
+         if (fd < 0)
+         {
+            printf("Can not start mock bus\n");
+            return 1;
+         }
+         sprintf(sockname, "%s%d", EC_SOCK_PREFIX, fd);
+         ifname = sockname;
+      }
+      roundtrip(ifname, slave, (uint16)index, (uint8)sub);
+      if (fd >= 0)
+      {
+         mock_stop();
+      }
+      printf("\nStep             Frames Dgrams   Time[us]\n");
+      for (i = 0; i < nstep; i++)
+      {
+         printf("%-16s %6u %6u %10d\n", step[i].name, step[i].frames, step[i].datagrams, step[i].us);
+      }
+      if (save)
+      {
+         rval |= rt_save(save);
+      }
+      if (check)
+      {
+         rval |= rt_check(check);
+      }
+   }
+   else
+   {
+      printf("Usage: roundtrip ifname [options]\nifname = eth0 for example, mock for the reference bus\nOptions :\n"
+             " -slave n : slave for SDO access and recovery, default 1\n"
+             " -sdo index:sub : object for SDO read and write back, hex index, default 1000:0 read only\n"
+             " -save file : save measured frames and datagrams as budget\n"
+             " -check file : compare measured frames and datagrams with budget\n");
+   }
+
+   printf("End program\n");
+   return (rval);
+}
@@ -1,10 +1,16 @@
 /** \file
  * \brief Example code for Simple Open EtherCAT master
  *
- * Usage : slaveinfo [ifname] [-sdo] [-map]
+ * Usage : slaveinfo [ifname] [-sdo] [-map] [-fast] [-json file] [-regdump file]
+ *         slaveinfo -regdecode file
  * Ifname is NIC interface, f.e. eth0.
  * Optional -sdo to display CoE object dictionary.
  * Optional -map to display slave PDO mapping
+ * Optional -fast to read mailbox data of slaves in parallel, the object
+ * dictionary of slaves with the same identity is read only once.
+ * Optional -json to also save the report in JSON format to file
+ * Optional -regdump to save ESC register snapshot of all slaves to file
+ * -regdecode displays a saved ESC register snapshot
  *
  * This shows the configured slave data.
  *
@@ -12,20 +18,216 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
 #include <string.h>
 #include <inttypes.h>
 
 #include "ethercat.h"
 
+/* number of mailbox threads in fast mode */
+#define SI_THREADS 8
+
+/* report text, printed directly when fp is set, otherwise collected */
+typedef struct
+{
+   FILE *fp;
+   char *buf;
+   size_t len;
+   size_t size;
+} si_outt;
+
+/* cached description of an object entry */
+typedef struct
+{
+   uint16 index;
+   uint8 subidx;
+   uint16 datatype;
+   uint16 bitlength;
+   uint16 access;
+   char name[EC_MAXNAME + 1];
+} si_entryt;
+
+/* cached description of an object, entries are first..first+n-1 */
+typedef struct
+{
+   uint16 index;
+   uint16 datatype;
+   uint8 objectcode;
+   char name[EC_MAXNAME + 1];
+   int first;
+   int n;
+} si_objectt;
+
+/* object dictionary of a slave identity, filled by the owner slave and only
+ * read by other slaves of the same identity after the owner is finished */
+typedef struct
+{
+   uint32 man, id, rev;
+   uint16 owner;
+   boolean filled;
+   int nobj;
+   int maxobj;
+   si_objectt *obj;
+   int nentry;
+   int maxentry;
+   si_entryt *entry;
+} si_typet;
+
+/* report of one slave */
+typedef struct
+{
+   uint16 slave;
+   si_outt txt;
+   si_outt json;
+   si_outt jsdo;
+   si_outt jpdo;
+   si_outt err;
+   si_typet *type;
+   uint8 sm;
+   const char *dir;
+   ec_timet mbxtime;
+} si_reportt;
+
+/* mailbox scratch data, one per thread */
+typedef struct
+{
+   ec_ODlistt ODlist;
+   ec_OElistt OElist;
+   char usdo[128];
+   char hstr[1024];
+} si_workt;
+
+/* mailbox thread in fast mode */
+typedef struct
+{
+   si_workt work;
+   volatile int running;
+} si_threadt;
+
 char IOmap[4096];
-ec_ODlistt ODlist;
-ec_OElistt OElist;
 boolean printSDO = FALSE;
 boolean printMAP = FALSE;
-char usdo[128];
-char hstr[1024];
+boolean fastmode = FALSE;
+char *regdumpfile = NULL;
+char *jsonfile = NULL;
+si_workt work;
+si_reportt report[EC_MAXSLAVE];
+si_typet *types = NULL;
+int ntypes = 0;
+/* fast mode job list of mailbox threads */
+osal_mutex_t *si_lock = NULL;
+uint16 joblist[EC_MAXSLAVE];
+int njobs, nextjob;
+
+void si_printf(si_outt *out, const char *fmt, ...)
+{
+   va_list ap, ap2;
+   char *buf;
+   size_t size;
+   int n;
+
+   va_start(ap, fmt);
+   if (out->fp)
+   {
+      vfprintf(out->fp, fmt, ap);
+   }
+   else
+   {
+      va_copy(ap2, ap);
+      n = vsnprintf(NULL, 0, fmt, ap2);
+      va_end(ap2);
+      if (n > 0)
+      {
+         if ((out->len + n + 1) > out->size)
+         {
+            size = out->size ? out->size : 256;
+            while ((out->len + n + 1) > size) size *= 2;
+            buf = realloc(out->buf, size);
+            if (buf == NULL)
+            {
+               va_end(ap);
+               return;
+            }
+            out->buf = buf;
+            out->size = size;
+         }
+         vsnprintf(out->buf + out->len, n + 1, fmt, ap);
+         out->len += n;
+      }
+   }
+   va_end(ap);
+}
+
+void si_outfree(si_outt *out)
+{
+   free(out->buf);
+   out->buf = NULL;
+   out->len = 0;
+   out->size = 0;
+}
+
+/* write JSON string with escapes */
+void si_jsonstr(si_outt *out, const char *str)
+{
+   si_printf(out, "\"");
+   for (; *str; str++)
+   {
+      if ((*str == '"') || (*str == '\\'))
+         si_printf(out, "\\%c", *str);
+      else if ((uint8)*str < 0x20)
+         si_printf(out, "\\u%4.4x", (uint8)*str);
+      else
+         si_printf(out, "%c", *str);
+   }
+   si_printf(out, "\"");
+}
+
+/* separator of JSON array elements */
+void si_jsonsep(si_outt *out)
+{
+   if (out->len) si_printf(out, ",");
+}
+
+/* copy of pending errors of the report slave. The error list is shared by
+ * all threads, so every error popped is queued at the report of the slave it
+ * belongs to and only the own queue is taken. */
+char* si_errorstring(si_workt *w, si_reportt *r)
+{
+   ec_errort Ec;
+   si_reportt *owner;
+
+   if (si_lock) osal_mtx_lock(si_lock);
+   while (ec_poperror(&Ec))
+   {
+      owner = ((Ec.Slave > 0) && (Ec.Slave <= ec_slavecount)) ? &report[Ec.Slave] : r;
+      si_printf(&owner->err, "%s", ec_err2string(Ec));
+   }
+   w->hstr[0] = 0;
+   if (r->err.buf)
+   {
+      strncpy(w->hstr, r->err.buf, sizeof(w->hstr) - 1);
+      w->hstr[sizeof(w->hstr) - 1] = 0;
+      si_outfree(&r->err);
+   }
+   if (si_lock) osal_mtx_unlock(si_lock);
+   return w->hstr;
+}
+
+double si_tms(ec_timet *t)
+{
+   return (t->sec * 1000.0) + (t->usec / 1000.0);
+}
 
-char* dtype2string(uint16 dtype)
+double si_ms(ec_timet *start, ec_timet *end)
+{
+   ec_timet diff;
+
+   osal_time_diff(start, end, &diff);
+   return si_tms(&diff);
+}
+
+char* dtype2string(uint16 dtype, char *hstr)
 {
     switch(dtype)
     {
@@ -104,9 +306,10 @@ char* dtype2string(uint16 dtype)
     return hstr;
 }
 
-char* SDO2string(uint16 slave, uint16 index, uint8 subidx, uint16 dtype)
+char* SDO2string(si_workt *w, si_reportt *r, uint16 index, uint8 subidx, uint16 dtype)
 {
-   int l = sizeof(usdo) - 1, i;
+   uint16 slave = r->slave;
+   int l = sizeof(w->usdo) - 1, i;
    uint8 *u8;
    int8 *i8;
    uint16 *u16;
@@ -119,62 +322,61 @@ char* SDO2string(uint16 slave, uint16 index, uint8 subidx, uint16 dtype)
    double *dr;
    char es[32];
 
-   memset(&usdo, 0, 128);
-   ec_SDOread(slave, index, subidx, FALSE, &l, &usdo, EC_TIMEOUTRXM);
-   if (EcatError)
+   memset(w->usdo, 0, sizeof(w->usdo));
+   if (ec_SDOread(slave, index, subidx, FALSE, &l, w->usdo, EC_TIMEOUTRXM) <= 0)
    {
-      return ec_elist2string();
+      return si_errorstring(w, r);
    }
    else
    {
       switch(dtype)
       {
          case ECT_BOOLEAN:
-            u8 = (uint8*) &usdo[0];
-            if (*u8) sprintf(hstr, "TRUE");
-             else sprintf(hstr, "FALSE");
+            u8 = (uint8*) &w->usdo[0];
+            if (*u8) sprintf(w->hstr, "TRUE");
+             else sprintf(w->hstr, "FALSE");
             break;
          case ECT_INTEGER8:
-            i8 = (int8*) &usdo[0];
-            sprintf(hstr, "0x%2.2x %d", *i8, *i8);
+            i8 = (int8*) &w->usdo[0];
+            sprintf(w->hstr, "0x%2.2x %d", *i8, *i8);
             break;
          case ECT_INTEGER16:
-            i16 = (int16*) &usdo[0];
-            sprintf(hstr, "0x%4.4x %d", *i16, *i16);
+            i16 = (int16*) &w->usdo[0];
+            sprintf(w->hstr, "0x%4.4x %d", *i16, *i16);
             break;
          case ECT_INTEGER32:
          case ECT_INTEGER24:
-            i32 = (int32*) &usdo[0];
-            sprintf(hstr, "0x%8.8x %d", *i32, *i32);
+            i32 = (int32*) &w->usdo[0];
+            sprintf(w->hstr, "0x%8.8x %d", *i32, *i32);
             break;
          case ECT_INTEGER64:
-            i64 = (int64*) &usdo[0];
-            sprintf(hstr, "0x%16.16"PRIx64" %"PRId64, *i64, *i64);
+            i64 = (int64*) &w->usdo[0];
+            sprintf(w->hstr, "0x%16.16"PRIx64" %"PRId64, *i64, *i64);
             break;
          case ECT_UNSIGNED8:
-            u8 = (uint8*) &usdo[0];
-            sprintf(hstr, "0x%2.2x %u", *u8, *u8);
+            u8 = (uint8*) &w->usdo[0];
+            sprintf(w->hstr, "0x%2.2x %u", *u8, *u8);
             break;
          case ECT_UNSIGNED16:
-            u16 = (uint16*) &usdo[0];
-            sprintf(hstr, "0x%4.4x %u", *u16, *u16);
+            u16 = (uint16*) &w->usdo[0];
+            sprintf(w->hstr, "0x%4.4x %u", *u16, *u16);
             break;
          case ECT_UNSIGNED32:
          case ECT_UNSIGNED24:
-            u32 = (uint32*) &usdo[0];
-            sprintf(hstr, "0x%8.8x %u", *u32, *u32);
+            u32 = (uint32*) &w->usdo[0];
+            sprintf(w->hstr, "0x%8.8x %u", *u32, *u32);
             break;
          case ECT_UNSIGNED64:
-            u64 = (uint64*) &usdo[0];
-            sprintf(hstr, "0x%16.16"PRIx64" %"PRIu64, *u64, *u64);
+            u64 = (uint64*) &w->usdo[0];
+            sprintf(w->hstr, "0x%16.16"PRIx64" %"PRIu64, *u64, *u64);
             break;
          case ECT_REAL32:
-            sr = (float*) &usdo[0];
-            sprintf(hstr, "%f", *sr);
+            sr = (float*) &w->usdo[0];
+            sprintf(w->hstr, "%f", *sr);
             break;
          case ECT_REAL64:
-            dr = (double*) &usdo[0];
-            sprintf(hstr, "%f", *dr);
+            dr = (double*) &w->usdo[0];
+            sprintf(w->hstr, "%f", *dr);
             break;
          case ECT_BIT1:
          case ECT_BIT2:
@@ -184,30 +386,120 @@ char* SDO2string(uint16 slave, uint16 index, uint8 subidx, uint16 dtype)
          case ECT_BIT6:
          case ECT_BIT7:
          case ECT_BIT8:
-            u8 = (uint8*) &usdo[0];
-            sprintf(hstr, "0x%x", *u8);
+            u8 = (uint8*) &w->usdo[0];
+            sprintf(w->hstr, "0x%x", *u8);
             break;
          case ECT_VISIBLE_STRING:
-            strcpy(hstr, usdo);
+            strcpy(w->hstr, w->usdo);
             break;
          case ECT_OCTET_STRING:
-            hstr[0] = 0x00;
+            w->hstr[0] = 0x00;
             for (i = 0 ; i < l ; i++)
             {
-               sprintf(es, "0x%2.2x ", usdo[i]);
-               strcat( hstr, es);
+               sprintf(es, "0x%2.2x ", w->usdo[i]);
+               strcat( w->hstr, es);
             }
             break;
          default:
-            sprintf(hstr, "Unknown type");
+            sprintf(w->hstr, "Unknown type");
       }
-      return hstr;
+      return w->hstr;
    }
 }
 
+/* cached entry description of the slave identity, NULL if not cached */
+si_entryt* si_findentry(si_reportt *r, uint16 index, uint8 subidx)
+{
+    int i;
+
+    if (r->type == NULL)
+        return NULL;
+    for (i = 0; i < r->type->nentry; i++)
+    {
+        if ((r->type->entry[i].index == index) && (r->type->entry[i].subidx == subidx))
+            return &(r->type->entry[i]);
+    }
+    return NULL;
+}
+
+/* add entry description to cache, only by the owner of the slave identity */
+void si_addentry(si_reportt *r, uint16 index, uint8 subidx, uint16 datatype, uint16 bitlength,
+                 uint16 access, char *name)
+{
+    si_typet *t = r->type;
+    si_entryt *entry;
+
+    if ((t == NULL) || (t->owner != r->slave) || t->filled)
+        return;
+    if (t->nentry >= t->maxentry)
+    {
+        entry = realloc(t->entry, (t->maxentry + 256) * sizeof(si_entryt));
+        if (entry == NULL)
+            return;
+        t->entry = entry;
+        t->maxentry += 256;
+    }
+    entry = &(t->entry[t->nentry++]);
+    entry->index = index;
+    entry->subidx = subidx;
+    entry->datatype = datatype;
+    entry->bitlength = bitlength;
+    entry->access = access;
+    strncpy(entry->name, name, EC_MAXNAME);
+    entry->name[EC_MAXNAME] = 0;
+}
+
+/* add object description to cache, only by the owner of the slave identity */
+si_objectt* si_addobject(si_reportt *r, uint16 index, uint16 datatype, uint8 objectcode, char *name)
+{
+    si_typet *t = r->type;
+    si_objectt *obj;
+
+    if ((t == NULL) || (t->owner != r->slave) || t->filled)
+        return NULL;
+    if (t->nobj >= t->maxobj)
+    {
+        obj = realloc(t->obj, (t->maxobj + 64) * sizeof(si_objectt));
+        if (obj == NULL)
+            return NULL;
+        t->obj = obj;
+        t->maxobj += 64;
+    }
+    obj = &(t->obj[t->nobj++]);
+    obj->index = index;
+    obj->datatype = datatype;
+    obj->objectcode = objectcode;
+    strncpy(obj->name, name, EC_MAXNAME);
+    obj->name[EC_MAXNAME] = 0;
+    obj->first = t->nentry;
+    obj->n = 0;
+    return obj;
+}
+
+void si_pdoentry(si_reportt *r, int abs_offset, int abs_bit, uint16 obj_idx, uint8 obj_subidx,
+                 uint8 bitlen, const char *dtype, const char *name)
+{
+    si_printf(&r->txt, "  [0x%4.4X.%1d] 0x%4.4X:0x%2.2X 0x%2.2X", abs_offset, abs_bit, obj_idx, obj_subidx, bitlen);
+    if (dtype)
+        si_printf(&r->txt, " %-12s %s\n", dtype, name);
+    else
+        si_printf(&r->txt, "\n");
+    if (jsonfile)
+    {
+        si_jsonsep(&r->jpdo);
+        si_printf(&r->jpdo, "{\"sm\":%d,\"dir\":\"%s\",\"offset\":%d,\"bit\":%d,\"index\":%d,\"subindex\":%d,\"bitlength\":%d,\"datatype\":",
+                  r->sm, r->dir, abs_offset, abs_bit, obj_idx, obj_subidx, bitlen);
+        si_jsonstr(&r->jpdo, dtype ? dtype : "");
+        si_printf(&r->jpdo, ",\"name\":");
+        si_jsonstr(&r->jpdo, dtype ? name : "");
+        si_printf(&r->jpdo, "}");
+    }
+}
+
 /** Read PDO assign structure */
-int si_PDOassign(uint16 slave, uint16 PDOassign, int mapoffset, int bitoffset)
+int si_PDOassign(si_workt *w, si_reportt *r, uint16 PDOassign, int mapoffset, int bitoffset)
 {
+    uint16 slave = r->slave;
     uint16 idxloop, nidx, subidxloop, rdat, idx, subidx;
     uint8 subcnt;
     int wkc, bsize = 0, rdl;
@@ -215,6 +507,8 @@ int si_PDOassign(uint16 slave, uint16 PDOassign, int mapoffset, int bitoffset)
     uint8 bitlen, obj_subidx;
     uint16 obj_idx;
     int abs_offset, abs_bit;
+    si_entryt *entry;
+    char dstr[32];
 
     rdl = sizeof(rdat); rdat = 0;
     /* read PDO assign subindex 0 ( = number of PDO's) */
@@ -254,20 +548,31 @@ int si_PDOassign(uint16 slave, uint16 PDOassign, int mapoffset, int bitoffset)
                     obj_subidx = (uint8)((rdat2 >> 8) & 0x000000ff);
                     abs_offset = mapoffset + (bitoffset / 8);
                     abs_bit = bitoffset % 8;
-                    ODlist.Slave = slave;
-                    ODlist.Index[0] = obj_idx;
-                    OElist.Entries = 0;
-                    wkc = 0;
-                    /* read object entry from dictionary if not a filler (0x0000:0x00) */
-                    if(obj_idx || obj_subidx)
-                        wkc = ec_readOEsingle(0, obj_subidx, &ODlist, &OElist);
-                    printf("  [0x%4.4X.%1d] 0x%4.4X:0x%2.2X 0x%2.2X", abs_offset, abs_bit, obj_idx, obj_subidx, bitlen);
-                    if((wkc > 0) && OElist.Entries)
+                    /* skip filler (0x0000:0x00) */
+                    if (!obj_idx && !obj_subidx)
+                        si_pdoentry(r, abs_offset, abs_bit, obj_idx, obj_subidx, bitlen, NULL, NULL);
+                    /* object entry already known from slave with same identity */
+                    else if ((entry = si_findentry(r, obj_idx, obj_subidx)) != NULL)
+                        si_pdoentry(r, abs_offset, abs_bit, obj_idx, obj_subidx, bitlen,
+                                    dtype2string(entry->datatype, dstr), entry->name);
+                    else
                     {
-                        printf(" %-12s %s\n", dtype2string(OElist.DataType[obj_subidx]), OElist.Name[obj_subidx]);
+                        /* read object entry from dictionary */
+                        w->ODlist.Slave = slave;
+                        w->ODlist.Index[0] = obj_idx;
+                        w->OElist.Entries = 0;
+                        wkc = ec_readOEsingle(0, obj_subidx, &w->ODlist, &w->OElist);
+                        if((wkc > 0) && w->OElist.Entries)
+                        {
+                            si_pdoentry(r, abs_offset, abs_bit, obj_idx, obj_subidx, bitlen,
+                                        dtype2string(w->OElist.DataType[obj_subidx], dstr), w->OElist.Name[obj_subidx]);
+                            si_addentry(r, obj_idx, obj_subidx, w->OElist.DataType[obj_subidx],
+                                        w->OElist.BitLength[obj_subidx], w->OElist.ObjAccess[obj_subidx],
+                                        w->OElist.Name[obj_subidx]);
+                        }
+                        else
+                            si_pdoentry(r, abs_offset, abs_bit, obj_idx, obj_subidx, bitlen, NULL, NULL);
                     }
-                    else
-                        printf("\n");
                     bitoffset += bitlen;
                 };
             };
@@ -277,15 +582,16 @@ int si_PDOassign(uint16 slave, uint16 PDOassign, int mapoffset, int bitoffset)
     return bsize;
 }
 
-int si_map_sdo(int slave)
+int si_map_sdo(si_workt *w, si_reportt *r)
 {
+    uint16 slave = r->slave;
     int wkc, rdl;
     int retVal = 0;
     uint8 nSM, iSM, tSM;
     int Tsize, outputs_bo, inputs_bo;
     uint8 SMt_bug_add;
 
-    printf("PDO mapping according to CoE :\n");
+    si_printf(&r->txt, "PDO mapping according to CoE :\n");
     SMt_bug_add = 0;
     outputs_bo = 0;
     inputs_bo = 0;
@@ -311,23 +617,26 @@ int si_map_sdo(int slave)
                 if((iSM == 2) && (tSM == 2)) // SM2 has type 2 == mailbox out, this is a bug in the slave!
                 {
                     SMt_bug_add = 1; // try to correct, this works if the types are 0 1 2 3 and should be 1 2 3 4
-                    printf("Activated SM type workaround, possible incorrect mapping.\n");
+                    si_printf(&r->txt, "Activated SM type workaround, possible incorrect mapping.\n");
                 }
                 if(tSM)
                     tSM += SMt_bug_add; // only add if SMt > 0
 
+                r->sm = iSM;
                 if (tSM == 3) // outputs
                 {
                     /* read the assign RXPDO */
-                    printf("  SM%1d outputs\n     addr b   index: sub bitl data_type    name\n", iSM);
-                    Tsize = si_PDOassign(slave, ECT_SDO_PDOASSIGN + iSM, (int)(ec_slave[slave].outputs - (uint8 *)&IOmap[0]), outputs_bo );
+                    si_printf(&r->txt, "  SM%1d outputs\n     addr b   index: sub bitl data_type    name\n", iSM);
+                    r->dir = "out";
+                    Tsize = si_PDOassign(w, r, ECT_SDO_PDOASSIGN + iSM, (int)(ec_slave[slave].outputs - (uint8 *)&IOmap[0]), outputs_bo );
                     outputs_bo += Tsize;
                 }
                 if (tSM == 4) // inputs
                 {
                     /* read the assign TXPDO */
-                    printf("  SM%1d inputs\n     addr b   index: sub bitl data_type    name\n", iSM);
-                    Tsize = si_PDOassign(slave, ECT_SDO_PDOASSIGN + iSM, (int)(ec_slave[slave].inputs - (uint8 *)&IOmap[0]), inputs_bo );
+                    si_printf(&r->txt, "  SM%1d inputs\n     addr b   index: sub bitl data_type    name\n", iSM);
+                    r->dir = "in";
+                    Tsize = si_PDOassign(w, r, ECT_SDO_PDOASSIGN + iSM, (int)(ec_slave[slave].inputs - (uint8 *)&IOmap[0]), inputs_bo );
                     inputs_bo += Tsize;
                 }
             }
@@ -340,8 +649,9 @@ int si_map_sdo(int slave)
     return retVal;
 }
 
-int si_siiPDO(uint16 slave, uint8 t, int mapoffset, int bitoffset)
+int si_siiPDO(si_reportt *r, uint8 t, int mapoffset, int bitoffset)
 {
+    uint16 slave = r->slave;
     uint16 a , w, c, e, er, Size;
     uint8 eectl;
     uint16 obj_idx;
@@ -354,6 +664,7 @@ int si_siiPDO(uint16 slave, uint8 t, int mapoffset, int bitoffset)
     ec_eepromPDOt *PDO;
     int abs_offset, abs_bit;
     char str_name[EC_MAXNAME + 1];
+    char dstr[32];
 
     eectl = ec_slave[slave].eep_pdi;
     Size = 0;
@@ -365,6 +676,7 @@ int si_siiPDO(uint16 slave, uint8 t, int mapoffset, int bitoffset)
     for (c = 0 ; c < EC_MAXSM ; c++) PDO->SMbitsize[c] = 0;
     if (t > 1)
         t = 1;
+    r->dir = t ? "out" : "in";
     PDO->Startpos = ec_siifind(slave, ECT_SII_PDO + t);
     if (PDO->Startpos > 0)
     {
@@ -390,14 +702,15 @@ int si_siiPDO(uint16 slave, uint8 t, int mapoffset, int bitoffset)
             c += 2;
             if (PDO->SyncM[PDO->nPDO] < EC_MAXSM) /* active and in range SM? */
             {
+                r->sm = PDO->SyncM[PDO->nPDO];
                 str_name[0] = 0;
                 if(obj_name)
                   ec_siistring(str_name, slave, obj_name);
                 if (t)
-                  printf("  SM%1d RXPDO 0x%4.4X %s\n", PDO->SyncM[PDO->nPDO], PDO->Index[PDO->nPDO], str_name);
+                  si_printf(&r->txt, "  SM%1d RXPDO 0x%4.4X %s\n", PDO->SyncM[PDO->nPDO], PDO->Index[PDO->nPDO], str_name);
                 else
-                  printf("  SM%1d TXPDO 0x%4.4X %s\n", PDO->SyncM[PDO->nPDO], PDO->Index[PDO->nPDO], str_name);
-                printf("     addr b   index: sub bitl data_type    name\n");
+                  si_printf(&r->txt, "  SM%1d TXPDO 0x%4.4X %s\n", PDO->SyncM[PDO->nPDO], PDO->Index[PDO->nPDO], str_name);
+                si_printf(&r->txt, "     addr b   index: sub bitl data_type    name\n");
                 /* read all entries defined in PDO */
                 for (er = 1; er <= e; er++)
                 {
@@ -421,8 +734,8 @@ int si_siiPDO(uint16 slave, uint8 t, int mapoffset, int bitoffset)
                        if(obj_name)
                           ec_siistring(str_name, slave, obj_name);
 
-                       printf("  [0x%4.4X.%1d] 0x%4.4X:0x%2.2X 0x%2.2X", abs_offset, abs_bit, obj_idx, obj_subidx, bitlen);
-                       printf(" %-12s %s\n", dtype2string(obj_datatype), str_name);
+                       si_pdoentry(r, abs_offset, abs_bit, obj_idx, obj_subidx, bitlen,
+                                   dtype2string(obj_datatype, dstr), str_name);
                     }
                     bitoffset += bitlen;
                     totalsize += bitlen;
@@ -446,20 +759,20 @@ int si_siiPDO(uint16 slave, uint8 t, int mapoffset, int bitoffset)
 }
 
 
-int si_map_sii(int slave)
+int si_map_sii(si_reportt *r)
 {
     int retVal = 0;
     int Tsize, outputs_bo, inputs_bo;
 
-    printf("PDO mapping according to SII :\n");
+    si_printf(&r->txt, "PDO mapping according to SII :\n");
 
     outputs_bo = 0;
     inputs_bo = 0;
     /* read the assign RXPDOs */
-    Tsize = si_siiPDO(slave, 1, (int)(ec_slave[slave].outputs - (uint8*)&IOmap), outputs_bo );
+    Tsize = si_siiPDO(r, 1, (int)(ec_slave[r->slave].outputs - (uint8*)&IOmap), outputs_bo );
     outputs_bo += Tsize;
     /* read the assign TXPDOs */
-    Tsize = si_siiPDO(slave, 0, (int)(ec_slave[slave].inputs - (uint8*)&IOmap), inputs_bo );
+    Tsize = si_siiPDO(r, 0, (int)(ec_slave[r->slave].inputs - (uint8*)&IOmap), inputs_bo );
     inputs_bo += Tsize;
     /* found some I/O bits ? */
     if ((outputs_bo > 0) || (inputs_bo > 0))
@@ -467,60 +780,454 @@ int si_map_sii(int slave)
     return retVal;
 }
 
-void si_sdo(int cnt)
+void si_sdoobject(si_reportt *r, uint16 index, uint16 datatype, uint8 objectcode, char *name)
+{
+    si_printf(&r->txt, " Index: %4.4x Datatype: %4.4x Objectcode: %2.2x Name: %s\n",
+        index, datatype, objectcode, name);
+    if (jsonfile)
+    {
+        si_jsonsep(&r->jsdo);
+        si_printf(&r->jsdo, "{\"index\":%d,\"datatype\":%d,\"objectcode\":%d,\"name\":", index, datatype, objectcode);
+        si_jsonstr(&r->jsdo, name);
+        si_printf(&r->jsdo, ",\"entries\":[");
+    }
+}
+
+void si_sdoentry(si_workt *w, si_reportt *r, int first, uint16 index, uint8 subidx, uint16 datatype,
+                 uint16 bitlength, uint16 access, char *name)
+{
+    char *value = NULL;
+
+    si_printf(&r->txt, "  Sub: %2.2x Datatype: %4.4x Bitlength: %4.4x Obj.access: %4.4x Name: %s\n",
+        subidx, datatype, bitlength, access, name);
+    if ((access & 0x0007))
+    {
+        value = SDO2string(w, r, index, subidx, datatype);
+        si_printf(&r->txt, "          Value :%s\n", value);
+    }
+    if (jsonfile)
+    {
+        if (!first) si_printf(&r->jsdo, ",");
+        si_printf(&r->jsdo, "{\"subindex\":%d,\"datatype\":%d,\"bitlength\":%d,\"access\":%d,\"name\":",
+            subidx, datatype, bitlength, access);
+        si_jsonstr(&r->jsdo, name);
+        if (value)
+        {
+            si_printf(&r->jsdo, ",\"value\":");
+            si_jsonstr(&r->jsdo, value);
+        }
+        si_printf(&r->jsdo, "}");
+    }
+}
+
+void si_sdo(si_workt *w, si_reportt *r)
 {
-    int i, j;
+    uint16 cnt = r->slave;
+    si_objectt *obj;
+    si_entryt *entry;
+    int i, j, n;
 
-    ODlist.Entries = 0;
-    memset(&ODlist, 0, sizeof(ODlist));
-    if( ec_readODlist(cnt, &ODlist))
+    /* object descriptions known from slave with same identity */
+    if (r->type && r->type->filled)
+    {
+        si_printf(&r->txt, " CoE Object Description found, %d entries.\n", r->type->nobj);
+        for (i = 0 ; i < r->type->nobj ; i++)
+        {
+            obj = &(r->type->obj[i]);
+            si_sdoobject(r, obj->index, obj->datatype, obj->objectcode, obj->name);
+            for (j = 0 ; j < obj->n ; j++)
+            {
+                entry = &(r->type->entry[obj->first + j]);
+                si_sdoentry(w, r, (j == 0), entry->index, entry->subidx, entry->datatype,
+                    entry->bitlength, entry->access, entry->name);
+            }
+            if (jsonfile) si_printf(&r->jsdo, "]}");
+        }
+        return;
+    }
+    w->ODlist.Entries = 0;
+    memset(&w->ODlist, 0, sizeof(w->ODlist));
+    if( ec_readODlist(cnt, &w->ODlist))
     {
-        printf(" CoE Object Description found, %d entries.\n",ODlist.Entries);
-        for( i = 0 ; i < ODlist.Entries ; i++)
+        si_printf(&r->txt, " CoE Object Description found, %d entries.\n",w->ODlist.Entries);
+        for( i = 0 ; i < w->ODlist.Entries ; i++)
         {
-            ec_readODdescription(i, &ODlist);
-            while(EcatError) printf("%s", ec_elist2string());
-            printf(" Index: %4.4x Datatype: %4.4x Objectcode: %2.2x Name: %s\n",
-                ODlist.Index[i], ODlist.DataType[i], ODlist.ObjectCode[i], ODlist.Name[i]);
-            memset(&OElist, 0, sizeof(OElist));
-            ec_readOE(i, &ODlist, &OElist);
-            while(EcatError) printf("%s", ec_elist2string());
-            for( j = 0 ; j < ODlist.MaxSub[i]+1 ; j++)
+            ec_readODdescription(i, &w->ODlist);
+            si_printf(&r->txt, "%s", si_errorstring(w, r));
+            si_sdoobject(r, w->ODlist.Index[i], w->ODlist.DataType[i], w->ODlist.ObjectCode[i], w->ODlist.Name[i]);
+            obj = si_addobject(r, w->ODlist.Index[i], w->ODlist.DataType[i], w->ODlist.ObjectCode[i], w->ODlist.Name[i]);
+            memset(&w->OElist, 0, sizeof(w->OElist));
+            ec_readOE(i, &w->ODlist, &w->OElist);
+            si_printf(&r->txt, "%s", si_errorstring(w, r));
+            n = 0;
+            for( j = 0 ; j < w->ODlist.MaxSub[i]+1 ; j++)
             {
-                if ((OElist.DataType[j] > 0) && (OElist.BitLength[j] > 0))
+                if ((w->OElist.DataType[j] > 0) && (w->OElist.BitLength[j] > 0))
                 {
-                    printf("  Sub: %2.2x Datatype: %4.4x Bitlength: %4.4x Obj.access: %4.4x Name: %s\n",
-                        j, OElist.DataType[j], OElist.BitLength[j], OElist.ObjAccess[j], OElist.Name[j]);
-                    if ((OElist.ObjAccess[j] & 0x0007))
+                    si_sdoentry(w, r, (n++ == 0), w->ODlist.Index[i], j, w->OElist.DataType[j],
+                        w->OElist.BitLength[j], w->OElist.ObjAccess[j], w->OElist.Name[j]);
+                    if (obj)
                     {
-                        printf("          Value :%s\n", SDO2string(cnt, ODlist.Index[i], j, OElist.DataType[j]));
+                        si_addentry(r, w->ODlist.Index[i], j, w->OElist.DataType[j],
+                            w->OElist.BitLength[j], w->OElist.ObjAccess[j], w->OElist.Name[j]);
+                        obj->n = r->type->nentry - obj->first;
                     }
                 }
             }
+            if (jsonfile) si_printf(&r->jsdo, "]}");
         }
+        if (r->type && (r->type->owner == cnt))
+            r->type->filled = TRUE;
     }
     else
     {
-        while(EcatError) printf("%s", ec_elist2string());
+        si_printf(&r->txt, "%s", si_errorstring(w, r));
     }
 }
 
-void slaveinfo(char *ifname)
+/* slave data known from configuration and SII, read by main thread */
+void si_slave(si_reportt *r)
 {
-   int cnt, i, j, nSM;
+    uint16 cnt = r->slave;
     uint16 ssigen;
+    int j, nSM;
+
+    si_printf(&r->txt, "\nSlave:%d\n Name:%s\n Output size: %dbits\n Input size: %dbits\n State: %d\n Delay: %d[ns]\n Has DC: %d\n",
+          cnt, ec_slave[cnt].name, ec_slave[cnt].Obits, ec_slave[cnt].Ibits,
+          ec_slave[cnt].state, ec_slave[cnt].pdelay, ec_slave[cnt].hasdc);
+    if (ec_slave[cnt].hasdc) si_printf(&r->txt, " DCParentport:%d\n", ec_slave[cnt].parentport);
+    si_printf(&r->txt, " Activeports:%d.%d.%d.%d\n", (ec_slave[cnt].activeports & 0x01) > 0 ,
+                                 (ec_slave[cnt].activeports & 0x02) > 0 ,
+                                 (ec_slave[cnt].activeports & 0x04) > 0 ,
+                                 (ec_slave[cnt].activeports & 0x08) > 0 );
+    si_printf(&r->txt, " Configured address: %4.4x\n", ec_slave[cnt].configadr);
+    si_printf(&r->txt, " Man: %8.8x ID: %8.8x Rev: %8.8x\n", (int)ec_slave[cnt].eep_man, (int)ec_slave[cnt].eep_id, (int)ec_slave[cnt].eep_rev);
+    if (jsonfile)
+    {
+        si_printf(&r->json, "{\"slave\":%d,\"name\":", cnt);
+        si_jsonstr(&r->json, ec_slave[cnt].name);
+        si_printf(&r->json, ",\"obits\":%d,\"ibits\":%d,\"state\":%d,\"delay\":%d,\"hasdc\":%d,\"parentport\":%d,"
+                  "\"activeports\":%d,\"configadr\":%d,\"man\":%u,\"id\":%u,\"rev\":%u,\"sm\":[",
+                  ec_slave[cnt].Obits, ec_slave[cnt].Ibits, ec_slave[cnt].state, ec_slave[cnt].pdelay,
+                  ec_slave[cnt].hasdc, ec_slave[cnt].parentport, ec_slave[cnt].activeports, ec_slave[cnt].configadr,
+                  ec_slave[cnt].eep_man, ec_slave[cnt].eep_id, ec_slave[cnt].eep_rev);
+    }
+    for(nSM = 0, j = 0 ; nSM < EC_MAXSM ; nSM++)
+    {
+       if(ec_slave[cnt].SM[nSM].StartAddr > 0)
+       {
+          si_printf(&r->txt, " SM%1d A:%4.4x L:%4d F:%8.8x Type:%d\n",nSM, ec_slave[cnt].SM[nSM].StartAddr, ec_slave[cnt].SM[nSM].SMlength,
+                 (int)ec_slave[cnt].SM[nSM].SMflags, ec_slave[cnt].SMtype[nSM]);
+          if (jsonfile)
+             si_printf(&r->json, "%s{\"sm\":%d,\"addr\":%d,\"length\":%d,\"flags\":%u,\"type\":%d}", j++ ? "," : "",
+                 nSM, ec_slave[cnt].SM[nSM].StartAddr, ec_slave[cnt].SM[nSM].SMlength,
+                 ec_slave[cnt].SM[nSM].SMflags, ec_slave[cnt].SMtype[nSM]);
+       }
+    }
+    if (jsonfile) si_printf(&r->json, "],\"fmmu\":[");
+    for(j = 0 ; j < ec_slave[cnt].FMMUunused ; j++)
+    {
+       si_printf(&r->txt, " FMMU%1d Ls:%8.8x Ll:%4d Lsb:%d Leb:%d Ps:%4.4x Psb:%d Ty:%2.2x Act:%2.2x\n", j,
+               (int)ec_slave[cnt].FMMU[j].LogStart, ec_slave[cnt].FMMU[j].LogLength, ec_slave[cnt].FMMU[j].LogStartbit,
+               ec_slave[cnt].FMMU[j].LogEndbit, ec_slave[cnt].FMMU[j].PhysStart, ec_slave[cnt].FMMU[j].PhysStartBit,
+               ec_slave[cnt].FMMU[j].FMMUtype, ec_slave[cnt].FMMU[j].FMMUactive);
+       if (jsonfile)
+          si_printf(&r->json, "%s{\"fmmu\":%d,\"logstart\":%u,\"loglength\":%d,\"logstartbit\":%d,\"logendbit\":%d,"
+                    "\"physstart\":%d,\"physstartbit\":%d,\"type\":%d,\"active\":%d}", j ? "," : "", j,
+                    ec_slave[cnt].FMMU[j].LogStart, ec_slave[cnt].FMMU[j].LogLength, ec_slave[cnt].FMMU[j].LogStartbit,
+                    ec_slave[cnt].FMMU[j].LogEndbit, ec_slave[cnt].FMMU[j].PhysStart, ec_slave[cnt].FMMU[j].PhysStartBit,
+                    ec_slave[cnt].FMMU[j].FMMUtype, ec_slave[cnt].FMMU[j].FMMUactive);
+    }
+    si_printf(&r->txt, " FMMUfunc 0:%d 1:%d 2:%d 3:%d\n",
+             ec_slave[cnt].FMMU0func, ec_slave[cnt].FMMU1func, ec_slave[cnt].FMMU2func, ec_slave[cnt].FMMU3func);
+    si_printf(&r->txt, " MBX length wr: %d rd: %d MBX protocols : %2.2x\n", ec_slave[cnt].mbx_l, ec_slave[cnt].mbx_rl, ec_slave[cnt].mbx_proto);
+    /* SII general section, in fast mode the copy read by configuration is used */
+    ssigen = fastmode ? 0 : ec_siifind(cnt, ECT_SII_GENERAL);
+    if (ssigen)
+    {
+       ec_slave[cnt].CoEdetails = ec_siigetbyte(cnt, ssigen + 0x07);
+       ec_slave[cnt].FoEdetails = ec_siigetbyte(cnt, ssigen + 0x08);
+       ec_slave[cnt].EoEdetails = ec_siigetbyte(cnt, ssigen + 0x09);
+       ec_slave[cnt].SoEdetails = ec_siigetbyte(cnt, ssigen + 0x0a);
+       if((ec_siigetbyte(cnt, ssigen + 0x0d) & 0x02) > 0)
+       {
+          ec_slave[cnt].blockLRW = 1;
+          ec_slave[0].blockLRW++;
+       }
+       ec_slave[cnt].Ebuscurrent = ec_siigetbyte(cnt, ssigen + 0x0e);
+       ec_slave[cnt].Ebuscurrent += ec_siigetbyte(cnt, ssigen + 0x0f) << 8;
+       ec_slave[0].Ebuscurrent += ec_slave[cnt].Ebuscurrent;
+    }
+    si_printf(&r->txt, " CoE details: %2.2x FoE details: %2.2x EoE details: %2.2x SoE details: %2.2x\n",
+            ec_slave[cnt].CoEdetails, ec_slave[cnt].FoEdetails, ec_slave[cnt].EoEdetails, ec_slave[cnt].SoEdetails);
+    si_printf(&r->txt, " Ebus current: %d[mA]\n only LRD/LWR:%d\n",
+            ec_slave[cnt].Ebuscurrent, ec_slave[cnt].blockLRW);
+    if (jsonfile)
+       si_printf(&r->json, "],\"fmmufunc\":[%d,%d,%d,%d],\"mbxwr\":%d,\"mbxrd\":%d,\"mbxproto\":%d,"
+                 "\"coedetails\":%d,\"foedetails\":%d,\"eoedetails\":%d,\"soedetails\":%d,\"ebuscurrent\":%d,\"blocklrw\":%d",
+                 ec_slave[cnt].FMMU0func, ec_slave[cnt].FMMU1func, ec_slave[cnt].FMMU2func, ec_slave[cnt].FMMU3func,
+                 ec_slave[cnt].mbx_l, ec_slave[cnt].mbx_rl, ec_slave[cnt].mbx_proto,
+                 ec_slave[cnt].CoEdetails, ec_slave[cnt].FoEdetails, ec_slave[cnt].EoEdetails, ec_slave[cnt].SoEdetails,
+                 ec_slave[cnt].Ebuscurrent, ec_slave[cnt].blockLRW);
+    /* SII mapping is read by main thread, EEPROM access is not parallel */
+    if (printMAP && !(ec_slave[cnt].mbx_proto & ECT_MBXPROT_COE))
+        si_map_sii(r);
+}
+
+/* slave data read by mailbox, by main thread or by a fast mode thread */
+void si_mailbox(si_workt *w, si_reportt *r)
+{
+    ec_timet start, end;
+
+    start = osal_current_time();
+    if ((ec_slave[r->slave].mbx_proto & ECT_MBXPROT_COE) && printSDO)
+        si_sdo(w, r);
+    if (printMAP && (ec_slave[r->slave].mbx_proto & ECT_MBXPROT_COE))
+        si_map_sdo(w, r);
+    end = osal_current_time();
+    osal_time_diff(&start, &end, &r->mbxtime);
+}
+
+OSAL_THREAD_FUNC si_mailbox_thread(void *param)
+{
+    si_threadt *t = param;
+    int job;
+
+    for (;;)
+    {
+        osal_mtx_lock(si_lock);
+        job = nextjob++;
+        osal_mtx_unlock(si_lock);
+        if (job >= njobs)
+            break;
+        si_mailbox(&t->work, &report[joblist[job]]);
+    }
+    t->running = 0;
+}
+
+/* run mailbox reads of all jobs on SI_THREADS threads and wait for them */
+void si_mailbox_parallel(si_threadt *thr)
+{
+    OSAL_THREAD_HANDLE thread[SI_THREADS];
+    int i, running;
+
+    nextjob = 0;
+    running = 0;
+    for (i = 0; i < SI_THREADS; i++)
+    {
+        thr[i].running = 1;
+        if (osal_thread_create(&thread[i], 256000, &si_mailbox_thread, &thr[i]))
+            running++;
+        else
+            thr[i].running = 0;
+    }
+    /* no threads could be created, run in main thread */
+    if (running == 0)
+        si_mailbox_thread(&thr[0]);
+    do
+    {
+        osal_usleep(1000);
+        running = 0;
+        for (i = 0; i < SI_THREADS; i++) running += thr[i].running;
+    } while (running);
+}
+
+/* fast mode: read the object dictionary of one slave per identity first,
+ * then all other slaves in parallel using the cached descriptions */
+void si_mailbox_fast(void)
+{
+    si_threadt *thr;
+    si_typet *t;
+    int cnt, i;
+
+    thr = malloc(SI_THREADS * sizeof(si_threadt));
+    types = calloc(ec_slavecount + 1, sizeof(si_typet));
+    si_lock = osal_mtx_create();
+    if ((thr == NULL) || (types == NULL) || (si_lock == NULL))
+    {
+        printf("Out of memory for fast mode\n");
+        exit(1);
+    }
+    ntypes = 0;
+    njobs = 0;
+    for (cnt = 1; cnt <= ec_slavecount; cnt++)
+    {
+        if (!(ec_slave[cnt].mbx_proto & ECT_MBXPROT_COE))
+            continue;
+        for (i = 0; i < ntypes; i++)
+        {
+            t = &types[i];
+            if ((t->man == ec_slave[cnt].eep_man) && (t->id == ec_slave[cnt].eep_id) &&
+                (t->rev == ec_slave[cnt].eep_rev))
+                break;
+        }
+        if (i == ntypes)
+        {
+            t = &types[ntypes++];
+            t->man = ec_slave[cnt].eep_man;
+            t->id = ec_slave[cnt].eep_id;
+            t->rev = ec_slave[cnt].eep_rev;
+            t->owner = cnt;
+            joblist[njobs++] = cnt;
+        }
+        report[cnt].type = &types[i];
+    }
+    /* owners of each identity */
+    si_mailbox_parallel(thr);
+    njobs = 0;
+    for (cnt = 1; cnt <= ec_slavecount; cnt++)
+    {
+        if (report[cnt].type && (report[cnt].type->owner != cnt))
+            joblist[njobs++] = cnt;
+    }
+    /* all other slaves */
+    si_mailbox_parallel(thr);
+    for (i = 0; i < ntypes; i++)
+    {
+        free(types[i].obj);
+        free(types[i].entry);
+    }
+    free(types);
+    types = NULL;
+    osal_mtx_destroy(si_lock);
+    si_lock = NULL;
+    free(thr);
+}
+
+void si_writejson(int expectedWKC, double *timing)
+{
+    static const char *phase[] = { "init", "config", "configdc", "safeop", "slaves", "mailbox", "total" };
+    FILE *fp;
+    si_reportt *r;
+    int cnt, i;
+
+    fp = fopen(jsonfile, "w");
+    if (fp == NULL)
+    {
+        printf("Can not open %s\n", jsonfile);
+        return;
+    }
+    fprintf(fp, "{\"slavecount\":%d,\"expectedwkc\":%d,\"slaves\":[", ec_slavecount, expectedWKC);
+    for (cnt = 1; cnt <= ec_slavecount; cnt++)
+    {
+        r = &report[cnt];
+        fprintf(fp, "%s\n%s", (cnt > 1) ? "," : "", r->json.buf ? r->json.buf : "{");
+        fprintf(fp, ",\"mailboxms\":%.3f", si_tms(&r->mbxtime));
+        if (r->jsdo.len) fprintf(fp, ",\"sdo\":[%s]", r->jsdo.buf);
+        if (r->jpdo.len) fprintf(fp, ",\"pdo\":[%s]", r->jpdo.buf);
+        fprintf(fp, "}");
+    }
+    fprintf(fp, "\n],\"timing\":{");
+    for (i = 0; i < 7; i++)
+        fprintf(fp, "%s\"%s\":%.3f", i ? "," : "", phase[i], timing[i]);
+    fprintf(fp, "}}\n");
+    fclose(fp);
+    printf("JSON report written to %s\n", jsonfile);
+}
+
+/* ESC register ranges of snapshot, all registers below process RAM */
+const ec_regranget regranges[] = { { 0x0000, 0x1000 } };
+
+void si_regdump(char *fname)
+{
+    FILE *fp;
+    uint8 *buf;
+    int size;
+
+    size = ec_regsnapshot_size(ec_slavecount, regranges, 1);
+    buf = malloc(size);
+    if (buf == NULL) return;
+    /* max 1 frame per ms */
+    size = ec_regsnapshot(regranges, 1, buf, size, 1000);
+    fp = fopen(fname, "wb");
+    if (size && fp)
+    {
+        fwrite(buf, 1, size, fp);
+        printf("Register snapshot of %d bytes written to %s\n", size, fname);
+    }
+    else
+    {
+        printf("Register snapshot to %s failed\n", fname);
+    }
+    if (fp) fclose(fp);
+    free(buf);
+}
+
+void si_regdecode(char *fname)
+{
+    FILE *fp;
+    uint8 *buf;
+    uint8 data[16];
+    ec_regranget range;
+    const char *name;
+    uint16 slave, configadr, length;
+    uint32 man, id, reg;
+    int size, nslaves, nranges, i, r, j;
+
+    fp = fopen(fname, "rb");
+    if (fp == NULL)
+    {
+        printf("Can not open %s\n", fname);
+        return;
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    buf = malloc(size);
+    if ((buf == NULL) || (fread(buf, 1, size, fp) != (size_t)size) ||
+        !ec_regsnapshot_info(buf, size, &nslaves, &nranges))
+    {
+        printf("%s is not a valid register snapshot\n", fname);
+        free(buf);
+        fclose(fp);
+        return;
+    }
+    fclose(fp);
+    for (i = 0; i < nslaves; i++)
+    {
+        ec_regsnapshot_slave(buf, size, i, &slave, &configadr, &man, &id);
+        printf("\nSlave:%d\n Configured address: %4.4x\n Man: %8.8x ID: %8.8x\n",
+            slave, configadr, (int)man, (int)id);
+        for (r = 0; r < nranges; r++)
+        {
+            ec_regsnapshot_range(buf, size, r, &range);
+            for (reg = range.start; reg < (uint32)(range.start + range.length); reg++)
+            {
+                name = ec_regname((uint16)reg, &length);
+                if (name && ec_regsnapshot_get(buf, size, i, (uint16)reg, data, length))
+                {
+                    printf(" %4.4x %-36s:", reg, name);
+                    for (j = 0; j < length; j++) printf(" %2.2x", data[j]);
+                    printf("\n");
+                }
+            }
+        }
+    }
+    free(buf);
+}
+
+void slaveinfo(char *ifname)
+{
+   int cnt, i;
     int expectedWKC;
+    ec_timet tstart, t[6];
+    double timing[7];
+    double mbxsum;
 
    printf("Starting slaveinfo\n");
 
    /* initialise SOEM, bind socket to ifname */
+   tstart = osal_current_time();
    if (ec_init(ifname))
    {
+      t[0] = osal_current_time();
       printf("ec_init on %s succeeded.\n",ifname);
       /* find and auto-config slaves */
       if ( ec_config(FALSE, &IOmap) > 0 )
       {
+         t[1] = osal_current_time();
          ec_configdc();
+         t[2] = osal_current_time();
          while(EcatError) printf("%s", ec_elist2string());
          printf("%d slaves found and configured.\n",ec_slavecount);
          expectedWKC = (ec_group[0].outputsWKC * 2) + ec_group[0].inputsWKC;
@@ -543,65 +1250,65 @@ void slaveinfo(char *ifname)
 
 
          ec_readstate();
+         t[3] = osal_current_time();
          for( cnt = 1 ; cnt <= ec_slavecount ; cnt++)
          {
-            printf("\nSlave:%d\n Name:%s\n Output size: %dbits\n Input size: %dbits\n State: %d\n Delay: %d[ns]\n Has DC: %d\n",
-                  cnt, ec_slave[cnt].name, ec_slave[cnt].Obits, ec_slave[cnt].Ibits,
-                  ec_slave[cnt].state, ec_slave[cnt].pdelay, ec_slave[cnt].hasdc);
-            if (ec_slave[cnt].hasdc) printf(" DCParentport:%d\n", ec_slave[cnt].parentport);
-            printf(" Activeports:%d.%d.%d.%d\n", (ec_slave[cnt].activeports & 0x01) > 0 ,
-                                         (ec_slave[cnt].activeports & 0x02) > 0 ,
-                                         (ec_slave[cnt].activeports & 0x04) > 0 ,
-                                         (ec_slave[cnt].activeports & 0x08) > 0 );
-            printf(" Configured address: %4.4x\n", ec_slave[cnt].configadr);
-            printf(" Man: %8.8x ID: %8.8x Rev: %8.8x\n", (int)ec_slave[cnt].eep_man, (int)ec_slave[cnt].eep_id, (int)ec_slave[cnt].eep_rev);
-            for(nSM = 0 ; nSM < EC_MAXSM ; nSM++)
-            {
-               if(ec_slave[cnt].SM[nSM].StartAddr > 0)
-                  printf(" SM%1d A:%4.4x L:%4d F:%8.8x Type:%d\n",nSM, ec_slave[cnt].SM[nSM].StartAddr, ec_slave[cnt].SM[nSM].SMlength,
-                         (int)ec_slave[cnt].SM[nSM].SMflags, ec_slave[cnt].SMtype[nSM]);
-            }
-            for(j = 0 ; j < ec_slave[cnt].FMMUunused ; j++)
+            report[cnt].slave = cnt;
+            /* in fast mode the report is printed after all mailbox reads */
+            report[cnt].txt.fp = fastmode ? NULL : stdout;
+            si_slave(&report[cnt]);
+            if (!fastmode)
             {
-               printf(" FMMU%1d Ls:%8.8x Ll:%4d Lsb:%d Leb:%d Ps:%4.4x Psb:%d Ty:%2.2x Act:%2.2x\n", j,
-                       (int)ec_slave[cnt].FMMU[j].LogStart, ec_slave[cnt].FMMU[j].LogLength, ec_slave[cnt].FMMU[j].LogStartbit,
-                       ec_slave[cnt].FMMU[j].LogEndbit, ec_slave[cnt].FMMU[j].PhysStart, ec_slave[cnt].FMMU[j].PhysStartBit,
-                       ec_slave[cnt].FMMU[j].FMMUtype, ec_slave[cnt].FMMU[j].FMMUactive);
+               si_mailbox(&work, &report[cnt]);
+               printf("%s", si_errorstring(&work, &report[cnt]));
             }
-            printf(" FMMUfunc 0:%d 1:%d 2:%d 3:%d\n",
-                     ec_slave[cnt].FMMU0func, ec_slave[cnt].FMMU1func, ec_slave[cnt].FMMU2func, ec_slave[cnt].FMMU3func);
-            printf(" MBX length wr: %d rd: %d MBX protocols : %2.2x\n", ec_slave[cnt].mbx_l, ec_slave[cnt].mbx_rl, ec_slave[cnt].mbx_proto);
-            ssigen = ec_siifind(cnt, ECT_SII_GENERAL);
-            /* SII general section */
-            if (ssigen)
-            {
-               ec_slave[cnt].CoEdetails = ec_siigetbyte(cnt, ssigen + 0x07);
-               ec_slave[cnt].FoEdetails = ec_siigetbyte(cnt, ssigen + 0x08);
-               ec_slave[cnt].EoEdetails = ec_siigetbyte(cnt, ssigen + 0x09);
-               ec_slave[cnt].SoEdetails = ec_siigetbyte(cnt, ssigen + 0x0a);
-               if((ec_siigetbyte(cnt, ssigen + 0x0d) & 0x02) > 0)
-               {
-                  ec_slave[cnt].blockLRW = 1;
-                  ec_slave[0].blockLRW++;
-               }
-               ec_slave[cnt].Ebuscurrent = ec_siigetbyte(cnt, ssigen + 0x0e);
-               ec_slave[cnt].Ebuscurrent += ec_siigetbyte(cnt, ssigen + 0x0f) << 8;
-               ec_slave[0].Ebuscurrent += ec_slave[cnt].Ebuscurrent;
-            }
-            printf(" CoE details: %2.2x FoE details: %2.2x EoE details: %2.2x SoE details: %2.2x\n",
-                    ec_slave[cnt].CoEdetails, ec_slave[cnt].FoEdetails, ec_slave[cnt].EoEdetails, ec_slave[cnt].SoEdetails);
-            printf(" Ebus current: %d[mA]\n only LRD/LWR:%d\n",
-                    ec_slave[cnt].Ebuscurrent, ec_slave[cnt].blockLRW);
-            if ((ec_slave[cnt].mbx_proto & ECT_MBXPROT_COE) && printSDO)
-                    si_sdo(cnt);
-                if(printMAP)
+         }
+         t[4] = osal_current_time();
+         if (fastmode)
+         {
+            si_mailbox_fast();
+            for( cnt = 1 ; cnt <= ec_slavecount ; cnt++)
             {
-                    if (ec_slave[cnt].mbx_proto & ECT_MBXPROT_COE)
-                        si_map_sdo(cnt);
-                    else
-                        si_map_sii(cnt);
+               if (report[cnt].txt.buf)
+                  fputs(report[cnt].txt.buf, stdout);
+               printf("%s", si_errorstring(&work, &report[cnt]));
             }
          }
+         t[5] = osal_current_time();
+         timing[0] = si_ms(&tstart, &t[0]);
+         timing[1] = si_ms(&t[0], &t[1]);
+         timing[2] = si_ms(&t[1], &t[2]);
+         timing[3] = si_ms(&t[2], &t[3]);
+         timing[4] = fastmode ? si_ms(&t[3], &t[4]) : 0.0;
+         timing[5] = fastmode ? si_ms(&t[4], &t[5]) : 0.0;
+         timing[6] = si_ms(&tstart, &t[5]);
+         mbxsum = 0.0;
+         for( cnt = 1 ; cnt <= ec_slavecount ; cnt++)
+            mbxsum += si_tms(&report[cnt].mbxtime);
+         if (!fastmode)
+         {
+            /* slave and mailbox reads are interleaved */
+            timing[5] = mbxsum;
+            timing[4] = si_ms(&t[3], &t[5]) - mbxsum;
+         }
+         if (jsonfile)
+            si_writejson(expectedWKC, timing);
+         if (fastmode)
+         {
+            printf("\nTiming [ms]: init %.1f config %.1f configdc %.1f safeop %.1f slaves %.1f mailbox %.1f"
+                   " (%.1f serial, %d threads) total %.1f\n", timing[0], timing[1], timing[2], timing[3],
+                   timing[4], timing[5], mbxsum, SI_THREADS, timing[6]);
+         }
+         for( cnt = 1 ; cnt <= ec_slavecount ; cnt++)
+         {
+            si_outfree(&report[cnt].txt);
+            si_outfree(&report[cnt].json);
+            si_outfree(&report[cnt].jsdo);
+            si_outfree(&report[cnt].jpdo);
+            si_outfree(&report[cnt].err);
+         }
+         if (regdumpfile)
+            si_regdump(regdumpfile);
       }
       else
       {
@@ -622,19 +1329,33 @@ char ifbuf[1024];
 int main(int argc, char *argv[])
 {
    ec_adaptert * adapter = NULL;
+   int i;
    printf("SOEM (Simple Open EtherCAT Master)\nSlaveinfo\n");
 
-   if (argc > 1)
+   if ((argc > 2) && (strncmp(argv[1], "-regdecode", sizeof("-regdecode")) == 0))
+   {
+      si_regdecode(argv[2]);
+   }
+   else if (argc > 1)
    {
-      if ((argc > 2) && (strncmp(argv[2], "-sdo", sizeof("-sdo")) == 0)) printSDO = TRUE;
-      if ((argc > 2) && (strncmp(argv[2], "-map", sizeof("-map")) == 0)) printMAP = TRUE;
+      for (i = 2; i < argc; i++)
+      {
+         if (strncmp(argv[i], "-sdo", sizeof("-sdo")) == 0) printSDO = TRUE;
+         if (strncmp(argv[i], "-map", sizeof("-map")) == 0) printMAP = TRUE;
+         if (strncmp(argv[i], "-fast", sizeof("-fast")) == 0) fastmode = TRUE;
+         if ((i + 1 < argc) && (strncmp(argv[i], "-json", sizeof("-json")) == 0)) jsonfile = argv[++i];
+         else if ((i + 1 < argc) && (strncmp(argv[i], "-regdump", sizeof("-regdump")) == 0)) regdumpfile = argv[++i];
+      }
       /* start slaveinfo */
       strcpy(ifbuf, argv[1]);
       slaveinfo(ifbuf);
    }
    else
    {
-      printf("Usage: slaveinfo ifname [options]\nifname = eth0 for example\nOptions :\n -sdo : print SDO info\n -map : print mapping\n");
+      printf("Usage: slaveinfo ifname [options]\nifname = eth0 for example\nOptions :\n -sdo : print SDO info\n -map : print mapping\n"
+             " -fast : read mailbox data in parallel, print timing\n -json file : save report as JSON\n"
+             " -regdump file : save ESC register snapshot\n"
+             "slaveinfo -regdecode file : print saved ESC register snapshot\n");
 
       printf ("Available adapters\n");
       adapter = ec_find_adapters ();